@@ -128,7 +128,7 @@ def validate_arguments(args, bc):
             'WITH_BF_ZLIB', 'BF_ZLIB', 'BF_ZLIB_INC', 'BF_ZLIB_LIB', 'BF_ZLIB_LIBPATH', 'WITH_BF_STATICZLIB', 'BF_ZLIB_LIB_STATIC',
             'WITH_BF_INTERNATIONAL',
             'WITH_BF_ICONV', 'BF_ICONV', 'BF_ICONV_INC', 'BF_ICONV_LIB', 'BF_ICONV_LIBPATH',
-            'WITH_BF_GAMEENGINE',
+            'WITH_BF_GAMEENGINE', 'WITH_BF_GAMEENGINE_FLOAT_MATH',
             'WITH_BF_BULLET', 'BF_BULLET', 'BF_BULLET_INC', 'BF_BULLET_LIB',
             # 'WITH_BF_ELTOPO',  # now only available in a branch
             'BF_LAPACK', 'BF_LAPACK_LIB', 'BF_LAPACK_LIBPATH', 'BF_LAPACK_LIB_STATIC',
@@ -418,6 +418,7 @@ def read_opts(env, cfg, args):
         (BoolVariable('WITH_BF_FREESTYLE', 'Compile with freestyle', True)),
 
         (BoolVariable('WITH_BF_GAMEENGINE', 'Build with gameengine' , False)),
+        (BoolVariable('WITH_BF_GAMEENGINE_FLOAT_MATH', 'Use single precision floats in the game engine math library (MoTo)' , False)),
 
         (BoolVariable('WITH_BF_BULLET', 'Use Bullet if true', True)),
         # (BoolVariable('WITH_BF_ELTOPO', 'Use Eltopo collision library if true', False)),  # this is now only available in a branch
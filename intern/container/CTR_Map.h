@@ -32,150 +32,273 @@
 #ifndef __CTR_MAP_H__
 #define __CTR_MAP_H__
 
+#include <vector>
+
+/**
+ * Hash map with open addressing, the keys need a hash() method and operator ==.
+ *
+ * The entries are stored packed in an array and the hash table only holds their
+ * index, so size(), at() and getKey() are constant time. The index of an entry
+ * stays the same until an entry is removed, then the last entry takes the place
+ * of the removed one. This keeps the usual loop working:
+ *
+ * \code
+ * for (int i = 0; i < map.size(); i++) {
+ *     if (remove_it(*map.at(i))) {
+ *         map.remove(*map.getKey(i));
+ *         i--;
+ *     }
+ * }
+ * \endcode
+ *
+ * Pointers returned by at(), getKey() and operator[] are invalidated by insert() and remove().
+ */
 template <class Key, class Value>
 class CTR_Map {
 private:
 	struct Entry {
-		Entry (Entry *next, Key key, Value value) :
-			m_next(next),
+		Entry(const Key& key, const Value& value, unsigned int hash) :
 			m_key(key),
-			m_value(value) {
+			m_value(value),
+			m_hash(hash) {
 		}
 
-		Entry *m_next;
 		Key m_key;
 		Value m_value;
+		unsigned int m_hash;
+	};
+
+	enum {
+		SLOT_EMPTY = -1,
+		SLOT_REMOVED = -2,
+		MIN_TABLE_SIZE = 16
 	};
 
 public:
-	CTR_Map(int num_buckets = 100) : m_num_buckets(num_buckets) {
-		m_buckets = new Entry *[num_buckets];
-		for (int i = 0; i < num_buckets; ++i) {
-			m_buckets[i] = 0;
-		}
+	/// \param num_buckets is the number of entries to make room for at the first insert.
+	CTR_Map(int num_buckets = 100) :
+		m_table(0),
+		m_table_bits(0),
+		m_num_removed(0),
+		m_reserve(num_buckets) {
 	}
 
-	CTR_Map(const CTR_Map& map)
-	{
-		m_num_buckets = map.m_num_buckets;
-		m_buckets = new Entry *[m_num_buckets];
-
-		for (int i = 0; i < m_num_buckets; ++i) {
-			m_buckets[i] = 0;
+	CTR_Map(const CTR_Map& map) :
+		m_table(0),
+		m_table_bits(0),
+		m_num_removed(0),
+		m_reserve(map.m_reserve) {
+		copy(map);
+	}
 
-			for (Entry *entry = map.m_buckets[i]; entry; entry = entry->m_next) {
-				insert(entry->m_key, entry->m_value);
-			}
+	CTR_Map& operator=(const CTR_Map& map)
+	{
+		if (this != &map) {
+			delete[] m_table;
+			m_table = 0;
+			m_table_bits = 0;
+			m_num_removed = 0;
+			m_reserve = map.m_reserve;
+			copy(map);
 		}
+		return *this;
 	}
 
-	int size()
+	~CTR_Map()
 	{
-		int count = 0;
-		for (int i = 0; i < m_num_buckets; i++) {
-			Entry *bucket = m_buckets[i];
-			while (bucket) {
-				bucket = bucket->m_next;
-				count++;
-			}
-		}
-		return count;
+		delete[] m_table;
+	}
+
+	int size() const
+	{
+		return (int)m_entries.size();
 	}
 
 	Value *at(int index)
 	{
-		int count = 0;
-		for (int i = 0; i < m_num_buckets; i++) {
-			Entry *bucket = m_buckets[i];
-			while (bucket) {
-				if (count == index) {
-					return &bucket->m_value;
-				}
-				bucket = bucket->m_next;
-				count++;
-			}
+		if (index < 0 || index >= size()) {
+			return 0;
 		}
-		return 0;
+		return &m_entries[index].m_value;
 	}
 
 	Key *getKey(int index)
 	{
-		int count = 0;
-		for (int i = 0; i < m_num_buckets; i++) {
-			Entry *bucket = m_buckets[i];
-			while (bucket) {
-				if (count == index) {
-					return &bucket->m_key;
-				}
-				bucket = bucket->m_next;
-				count++;
-			}
+		if (index < 0 || index >= size()) {
+			return 0;
 		}
-		return 0;
+		return &m_entries[index].m_key;
 	}
 
 	void clear()
 	{
-		for (int i = 0; i < m_num_buckets; ++i) {
-			Entry *entry_ptr = m_buckets[i];
+		m_entries.clear();
+		clearTable();
+	}
 
-			while (entry_ptr != 0) {
-				Entry *tmp_ptr = entry_ptr->m_next;
-				delete entry_ptr;
-				entry_ptr = tmp_ptr;
-			}
-			m_buckets[i] = 0;
+	void insert(const Key& key, const Value& value)
+	{
+		const unsigned int hash = key.hash();
+		const int index = lookup(key, hash);
+
+		if (index != SLOT_EMPTY) {
+			m_entries[index].m_value = value;
+			return;
 		}
+
+		/* keep at least a quarter of the slots empty, so probing stays short and ends */
+		if (((int)m_entries.size() + m_num_removed + 1) * 4 > tableSize() * 3) {
+			rehash((int)m_entries.size() + 1);
+		}
+
+		const unsigned int mask = tableSize() - 1;
+		unsigned int slot = firstSlot(hash);
+		while (m_table[slot] >= 0) {
+			slot = (slot + 1) & mask;
+		}
+		if (m_table[slot] == SLOT_REMOVED) {
+			m_num_removed--;
+		}
+
+		m_table[slot] = (int)m_entries.size();
+		m_entries.push_back(Entry(key, value, hash));
 	}
 
-	~CTR_Map()
+	void remove(const Key& key)
 	{
-		clear();
-		delete[] m_buckets;
+		const unsigned int hash = key.hash();
+		const int index = lookup(key, hash);
+
+		if (index == SLOT_EMPTY) {
+			return;
+		}
+
+		m_table[findSlot(hash, index)] = SLOT_REMOVED;
+		m_num_removed++;
+
+		/* move the last entry in the hole */
+		const int last = (int)m_entries.size() - 1;
+		if (index != last) {
+			m_table[findSlot(m_entries[last].m_hash, last)] = index;
+			m_entries[index] = m_entries[last];
+		}
+		m_entries.pop_back();
+
+		if (m_entries.empty()) {
+			clearTable();
+		}
 	}
 
-	void insert(const Key& key, const Value& value)
+	Value *operator[](const Key& key)
+	{
+		const int index = lookup(key, key.hash());
+		return (index != SLOT_EMPTY) ? &m_entries[index].m_value : 0;
+	}
+
+	/**
+	 * Look up with an other type than Key, to avoid building a key, \param key must give
+	 * the same hash() than the Key it stands for and compare equal to it with operator ==.
+	 * Returns the index of the entry, or -1.
+	 */
+	template <class OtherKey>
+	int find(const OtherKey& key) const
+	{
+		return lookup(key, key.hash());
+	}
+
+private:
+	int tableSize() const
+	{
+		return (m_table) ? (1 << m_table_bits) : 0;
+	}
+
+	/* fibonacci hashing, the top bits mix all the bits of the hash,
+	 * pointers and small integers don't end up in the same few slots */
+	unsigned int firstSlot(unsigned int hash) const
 	{
-		Entry *entry_ptr = m_buckets[key.hash() % m_num_buckets];
-		while ((entry_ptr != 0) && !(key == entry_ptr->m_key)) {
-			entry_ptr = entry_ptr->m_next;
+		return (hash * 2654435769u) >> (32 - m_table_bits);
+	}
+
+	template <class OtherKey>
+	int lookup(const OtherKey& key, unsigned int hash) const
+	{
+		if (!m_table) {
+			return SLOT_EMPTY;
 		}
 
-		if (entry_ptr != 0) {
-			entry_ptr->m_value = value;
+		const unsigned int mask = tableSize() - 1;
+		for (unsigned int slot = firstSlot(hash); m_table[slot] != SLOT_EMPTY; slot = (slot + 1) & mask) {
+			const int index = m_table[slot];
+			if (index >= 0 && m_entries[index].m_hash == hash && key == m_entries[index].m_key) {
+				return index;
+			}
 		}
-		else {
-			Entry **bucket = &m_buckets[key.hash() % m_num_buckets];
-			*bucket = new Entry(*bucket, key, value);
+		return SLOT_EMPTY;
+	}
+
+	/* slot of an entry known to be in the table */
+	unsigned int findSlot(unsigned int hash, int index) const
+	{
+		const unsigned int mask = tableSize() - 1;
+		unsigned int slot = firstSlot(hash);
+		while (m_table[slot] != index) {
+			slot = (slot + 1) & mask;
 		}
+		return slot;
 	}
 
-	void remove(const Key& key)
+	void clearTable()
 	{
-		Entry **entry_ptr = &m_buckets[key.hash() % m_num_buckets];
-		while ((*entry_ptr != 0) && !(key == (*entry_ptr)->m_key)) {
-			entry_ptr = &(*entry_ptr)->m_next;
+		for (int i = 0; i < tableSize(); i++) {
+			m_table[i] = SLOT_EMPTY;
 		}
+		m_num_removed = 0;
+	}
 
-		if (*entry_ptr != 0) {
-			Entry *tmp_ptr = (*entry_ptr)->m_next;
-			delete *entry_ptr;
-			*entry_ptr = tmp_ptr;
+	/* size the table for num_entries (and the first reserve), this also drops the removed slots */
+	void rehash(int num_entries)
+	{
+		int bits = 4;
+		while ((1 << bits) < MIN_TABLE_SIZE || (1 << bits) < num_entries * 2 || (1 << bits) < m_reserve * 2) {
+			bits++;
+		}
+		m_reserve = 0;
+
+		if (!m_table || bits != m_table_bits) {
+			delete[] m_table;
+			m_table = new int[1 << bits];
+			m_table_bits = bits;
+		}
+		clearTable();
+
+		const unsigned int mask = tableSize() - 1;
+		for (int i = 0; i < (int)m_entries.size(); i++) {
+			unsigned int slot = firstSlot(m_entries[i].m_hash);
+			while (m_table[slot] != SLOT_EMPTY) {
+				slot = (slot + 1) & mask;
+			}
+			m_table[slot] = i;
 		}
 	}
 
-	Value *operator[](Key key)
+	void copy(const CTR_Map& map)
 	{
-		Entry *bucket = m_buckets[key.hash() % m_num_buckets];
-		while ((bucket != 0) && !(key == bucket->m_key)) {
-			bucket = bucket->m_next;
+		m_entries = map.m_entries;
+		if (map.m_table) {
+			m_table = new int[map.tableSize()];
+			m_table_bits = map.m_table_bits;
+			m_num_removed = map.m_num_removed;
+			for (int i = 0; i < map.tableSize(); i++) {
+				m_table[i] = map.m_table[i];
+			}
 		}
-		return bucket != 0 ? &bucket->m_value : 0;
 	}
 
-private:
-	int     m_num_buckets;
-	Entry **m_buckets;
+	std::vector<Entry> m_entries;
+	int *m_table;
+	int m_table_bits;
+	int m_num_removed;
+	int m_reserve;
 };
 
 #endif  /* __CTR_MAP_H__ */
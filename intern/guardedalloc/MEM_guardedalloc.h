@@ -170,6 +170,10 @@ extern "C" {
 	extern size_t (*MEM_get_mapped_memory_in_use)(void);
 	/** Get amount of memory blocks in use. */
 	extern unsigned int (*MEM_get_memory_blocks_in_use)(void);
+	/** Get amount of memory blocks allocated so far, freed or not, to count the allocations made by some code. */
+	extern unsigned int (*MEM_get_memory_blocks_allocated)(void);
+	/** Get amount of memory allocated so far, freed or not. */
+	extern size_t (*MEM_get_memory_allocated)(void);
 
 	/** Reset the peak memory statistic to zero. */
 	extern void (*MEM_reset_peak_memory)(void);
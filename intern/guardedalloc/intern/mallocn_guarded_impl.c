@@ -200,6 +200,8 @@ static const char *check_memlist(MemHead *memh);
 	
 
 static unsigned int totblock = 0;
+static unsigned int totallocated = 0;
+static size_t mem_allocated = 0;
 static size_t mem_in_use = 0, mmap_in_use = 0, peak_mem = 0;
 
 static volatile struct localListBase _membase;
@@ -506,6 +508,8 @@ static void make_memhead_header(MemHead *memh, size_t len, const char *str)
 	memt->tag3 = MEMTAG3;
 
 	atomic_add_u(&totblock, 1);
+	atomic_add_u(&totallocated, 1);
+	atomic_add_z(&mem_allocated, len);
 	atomic_add_z(&mem_in_use, len);
 
 	mem_lock_thread();
@@ -1191,6 +1195,28 @@ unsigned int MEM_guarded_get_memory_blocks_in_use(void)
 	return _totblock;
 }
 
+unsigned int MEM_guarded_get_memory_blocks_allocated(void)
+{
+	unsigned int _totallocated;
+
+	mem_lock_thread();
+	_totallocated = totallocated;
+	mem_unlock_thread();
+
+	return _totallocated;
+}
+
+size_t MEM_guarded_get_memory_allocated(void)
+{
+	size_t _mem_allocated;
+
+	mem_lock_thread();
+	_mem_allocated = mem_allocated;
+	mem_unlock_thread();
+
+	return _mem_allocated;
+}
+
 #ifndef NDEBUG
 const char *MEM_guarded_name_ptr(void *vmemh)
 {
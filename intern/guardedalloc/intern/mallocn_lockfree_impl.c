@@ -52,6 +52,8 @@ typedef struct MemHeadAligned {
 } MemHeadAligned;
 
 static unsigned int totblock = 0;
+static unsigned int totallocated = 0;
+static size_t mem_allocated = 0;
 static size_t mem_in_use = 0, mmap_in_use = 0, peak_mem = 0;
 static bool malloc_debug_memset = false;
 
@@ -288,6 +290,8 @@ void *MEM_lockfree_callocN(size_t len, const char *str)
 	if (LIKELY(memh)) {
 		memh->len = len;
 		atomic_add_u(&totblock, 1);
+		atomic_add_u(&totallocated, 1);
+		atomic_add_z(&mem_allocated, len);
 		atomic_add_z(&mem_in_use, len);
 		update_maximum(&peak_mem, mem_in_use);
 
@@ -313,6 +317,8 @@ void *MEM_lockfree_mallocN(size_t len, const char *str)
 
 		memh->len = len;
 		atomic_add_u(&totblock, 1);
+		atomic_add_u(&totallocated, 1);
+		atomic_add_z(&mem_allocated, len);
 		atomic_add_z(&mem_in_use, len);
 		update_maximum(&peak_mem, mem_in_use);
 
@@ -362,6 +368,8 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
 		memh->len = len | (size_t) MEMHEAD_ALIGN_FLAG;
 		memh->alignment = (short) alignment;
 		atomic_add_u(&totblock, 1);
+		atomic_add_u(&totallocated, 1);
+		atomic_add_z(&mem_allocated, len);
 		atomic_add_z(&mem_in_use, len);
 		update_maximum(&peak_mem, mem_in_use);
 
@@ -401,6 +409,8 @@ void *MEM_lockfree_mapallocN(size_t len, const char *str)
 	if (memh != (MemHead *)-1) {
 		memh->len = len | (size_t) MEMHEAD_MMAP_FLAG;
 		atomic_add_u(&totblock, 1);
+		atomic_add_u(&totallocated, 1);
+		atomic_add_z(&mem_allocated, len);
 		atomic_add_z(&mem_in_use, len);
 		atomic_add_z(&mmap_in_use, len);
 
@@ -479,6 +489,16 @@ unsigned int MEM_lockfree_get_memory_blocks_in_use(void)
 	return totblock;
 }
 
+unsigned int MEM_lockfree_get_memory_blocks_allocated(void)
+{
+	return totallocated;
+}
+
+size_t MEM_lockfree_get_memory_allocated(void)
+{
+	return mem_allocated;
+}
+
 /* dummy */
 void MEM_lockfree_reset_peak_memory(void)
 {
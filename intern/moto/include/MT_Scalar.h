@@ -53,7 +53,11 @@
 #include "MT_random.h"
 #include "NM_Scalar.h"
 
+#ifdef WITH_GAMEENGINE_FLOAT_MATH
+typedef float MT_Scalar;
+#else
 typedef double MT_Scalar; //this should be float !
+#endif
 
 
 const MT_Scalar  MT_DEGS_PER_RAD(57.29577951308232286465);
@@ -62,7 +66,11 @@ const MT_Scalar  MT_PI(3.14159265358979323846);
 const MT_Scalar  MT_2_PI(6.28318530717958623200);
 const MT_Scalar  MT_EPSILON(1.0e-10);
 const MT_Scalar  MT_EPSILON2(1.0e-20);
+#ifdef WITH_GAMEENGINE_FLOAT_MATH
+const MT_Scalar  MT_INFINITY(FLT_MAX);
+#else
 const MT_Scalar  MT_INFINITY(1.0e50);
+#endif
 
 inline int       MT_sign(MT_Scalar x) {
     return x < 0.0 ? -1 : x > 0.0 ? 1 : 0;
@@ -101,7 +101,12 @@ public:
     }
     
 protected:
+#ifdef WITH_GAMEENGINE_FLOAT_MATH
+    /* padded to 16 bytes so vectors and matrix rows line up with SIMD registers */
+    MT_Scalar m_co[4];
+#else
     MT_Scalar m_co[3];                            
+#endif
 };
 
 inline bool operator==(const MT_Tuple3& t1, const MT_Tuple3& t2) {
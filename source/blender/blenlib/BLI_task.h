@@ -81,6 +81,10 @@ void BLI_task_pool_free(TaskPool *pool);
 void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 	void *taskdata, bool free_taskdata, TaskPriority priority);
 
+/* keep up to max_tasks done tasks for the next pushes instead of freeing them,
+ * for a pool pushing about as many tasks again and again. None by default */
+void BLI_task_pool_reuse_tasks(TaskPool *pool, int max_tasks);
+
 /* work and wait until all tasks are done */
 void BLI_task_pool_work_and_wait(TaskPool *pool);
 /* cancel all tasks, keep worker threads running */
@@ -670,6 +670,11 @@ extern void BLI_system_backtrace(FILE *fp);
     (!defined(__COVERITY__)) && \
     (defined(__GNUC__) && ((__GNUC__ * 100 + __GNUC_MINOR__) >= 406))  /* gcc4.6+ only */
 #  define BLI_STATIC_ASSERT(a, msg) __extension__ _Static_assert(a, msg);
+#elif defined(__cplusplus) && (!defined(__COVERITY__))
+   /* an array of negative size, named after the line */
+#  define _BLI_STATIC_ASSERT_NAME(line) _BLI_STATIC_ASSERT_NAME_EXPAND(line)
+#  define _BLI_STATIC_ASSERT_NAME_EXPAND(line) _bli_static_assert_ ## line
+#  define BLI_STATIC_ASSERT(a, msg) typedef char _BLI_STATIC_ASSERT_NAME(__LINE__)[(a) ? 1 : -1];
 #else
    /* TODO msvc, clang */
 #  define BLI_STATIC_ASSERT(a, msg)
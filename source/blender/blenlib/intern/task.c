@@ -59,6 +59,13 @@ struct TaskPool {
 	void *userdata;
 	ThreadMutex user_mutex;
 
+	/* done tasks kept for the next pushes, up to max_free_tasks, a pool reused
+	 * for each frame of the game engine then stops allocating */
+	Task *free_tasks;
+	int num_free_tasks;
+	int max_free_tasks;
+	SpinLock free_lock;
+
 	volatile bool do_cancel;
 };
 
@@ -107,6 +114,42 @@ static void task_pool_num_increase(TaskPool *pool)
 	BLI_mutex_unlock(&pool->num_mutex);
 }
 
+static Task *task_alloc(TaskPool *pool)
+{
+	Task *task;
+
+	BLI_spin_lock(&pool->free_lock);
+	task = pool->free_tasks;
+	if (task) {
+		pool->free_tasks = task->next;
+		pool->num_free_tasks--;
+	}
+	BLI_spin_unlock(&pool->free_lock);
+
+	if (task == NULL)
+		task = MEM_mallocN(sizeof(Task), "Task");
+
+	return task;
+}
+
+static void task_free(TaskPool *pool, Task *task)
+{
+	if (task->free_taskdata)
+		MEM_freeN(task->taskdata);
+
+	BLI_spin_lock(&pool->free_lock);
+	if (pool->num_free_tasks < pool->max_free_tasks) {
+		task->next = pool->free_tasks;
+		pool->free_tasks = task;
+		pool->num_free_tasks++;
+		task = NULL;
+	}
+	BLI_spin_unlock(&pool->free_lock);
+
+	if (task)
+		MEM_freeN(task);
+}
+
 static bool task_scheduler_thread_wait_pop(TaskScheduler *scheduler, Task **task)
 {
 	bool found_task = false;
@@ -161,9 +204,7 @@ static void *task_scheduler_thread_run(void *thread_p)
 		task->run(pool, task->taskdata, thread_id);
 
 		/* delete task */
-		if (task->free_taskdata)
-			MEM_freeN(task->taskdata);
-		MEM_freeN(task);
+		task_free(pool, task);
 
 		/* notify pool task was done */
 		task_pool_num_decrease(pool, 1);
@@ -321,6 +362,11 @@ TaskPool *BLI_task_pool_create(TaskScheduler *scheduler, void *userdata)
 	pool->userdata = userdata;
 	BLI_mutex_init(&pool->user_mutex);
 
+	pool->free_tasks = NULL;
+	pool->num_free_tasks = 0;
+	pool->max_free_tasks = 0;
+	BLI_spin_init(&pool->free_lock);
+
 	/* Ensure malloc will go fine from threads,
 	 *
 	 * This is needed because we could be in main thread here
@@ -341,6 +387,13 @@ void BLI_task_pool_free(TaskPool *pool)
 
 	BLI_mutex_end(&pool->user_mutex);
 
+	while (pool->free_tasks) {
+		Task *task = pool->free_tasks;
+		pool->free_tasks = task->next;
+		MEM_freeN(task);
+	}
+	BLI_spin_end(&pool->free_lock);
+
 	MEM_freeN(pool);
 
 	BLI_end_threaded_malloc();
@@ -349,8 +402,9 @@ void BLI_task_pool_free(TaskPool *pool)
 void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 	void *taskdata, bool free_taskdata, TaskPriority priority)
 {
-	Task *task = MEM_callocN(sizeof(Task), "Task");
+	Task *task = task_alloc(pool);
 
+	task->next = task->prev = NULL;
 	task->run = run;
 	task->taskdata = taskdata;
 	task->free_taskdata = free_taskdata;
@@ -359,6 +413,28 @@ void BLI_task_pool_push(TaskPool *pool, TaskRunFunction run,
 	task_scheduler_push(pool->scheduler, task, priority);
 }
 
+void BLI_task_pool_reuse_tasks(TaskPool *pool, int max_tasks)
+{
+	Task *tasks = NULL;
+
+	BLI_spin_lock(&pool->free_lock);
+	pool->max_free_tasks = max_tasks;
+	while (pool->num_free_tasks > max_tasks) {
+		Task *task = pool->free_tasks;
+		pool->free_tasks = task->next;
+		pool->num_free_tasks--;
+		task->next = tasks;
+		tasks = task;
+	}
+	BLI_spin_unlock(&pool->free_lock);
+
+	while (tasks) {
+		Task *task = tasks;
+		tasks = task->next;
+		MEM_freeN(task);
+	}
+}
+
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
 	TaskScheduler *scheduler = pool->scheduler;
@@ -398,9 +474,7 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
 			work_task->run(pool, work_task->taskdata, 0);
 
 			/* delete task */
-			if (work_task->free_taskdata)
-				MEM_freeN(work_task->taskdata);
-			MEM_freeN(work_task);
+			task_free(pool, work_task);
 
 			/* notify pool task was done */
 			task_pool_num_decrease(pool, 1);
@@ -108,6 +108,7 @@
 #include "BLI_math.h"
 #include "BLI_threads.h"
 #include "BLI_mempool.h"
+#include "BLI_ghash.h"
 
 #include "BLT_translation.h"
 
@@ -210,6 +211,9 @@
 /* use GHash for BHead name-based lookups (speeds up linking) */
 #define USE_GHASH_BHEAD
 
+/* use GHash for the old address lookups missing the lasthit guess (speeds up large files) */
+#define USE_GHASH_OLDNEWMAP
+
 /***/
 
 typedef struct OldNew {
@@ -222,8 +226,17 @@ typedef struct OldNewMap {
 	int nentries, entriessize;
 	int sorted;
 	int lasthit;
+#ifdef USE_GHASH_OLDNEWMAP
+	/* old address -> entry index, created by the first full lookup of a large map */
+	GHash *entries_hash;
+#endif
 } OldNewMap;
 
+#ifdef USE_GHASH_OLDNEWMAP
+/* smaller maps are searched linearly */
+#define OLDNEWMAP_HASH_MIN 64
+#endif
+
 
 /* local prototypes */
 static void *read_struct(FileData *fd, BHead *bh, const char *blockname);
@@ -288,6 +301,14 @@ static void oldnewmap_sort(FileData *fd)
 {
 	qsort(fd->libmap->entries, fd->libmap->nentries, sizeof(OldNew), verg_oldnewmap);
 	fd->libmap->sorted = 1;
+
+#ifdef USE_GHASH_OLDNEWMAP
+	/* the indices moved, sorted maps use a binary search anyway */
+	if (fd->libmap->entries_hash) {
+		BLI_ghash_free(fd->libmap->entries_hash, NULL, NULL);
+		fd->libmap->entries_hash = NULL;
+	}
+#endif
 }
 
 /* nr is zero for data, and ID code for libdata */
@@ -306,6 +327,13 @@ static void oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int n
 	entry->old = oldaddr;
 	entry->newp = newaddr;
 	entry->nr = nr;
+
+#ifdef USE_GHASH_OLDNEWMAP
+	if (onm->entries_hash) {
+		/* an address written twice resolves to the last entry, as the full search did */
+		BLI_ghash_reinsert(onm->entries_hash, oldaddr, SET_INT_IN_POINTER(onm->nentries - 1), NULL, NULL);
+	}
+#endif
 }
 
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newaddr, int nr)
@@ -319,18 +347,33 @@ void blo_do_versions_oldnewmap_insert(OldNewMap *onm, void *oldaddr, void *newad
  * \param lasthit: Use as a reference position to avoid a full search
  * from either end of the array, giving more efficient lookups.
  *
- * \note This would seem an ideal case for hash or btree lookups.
- * However the data is written in-order, using the \a lasthit will normally avoid calling this function.
- * Creating a btree/hash structure adds overhead for the common-case to optimize the corner-case
- * (since most entries will never be retrieved).
- * So just keep full lookups as a fall-back.
+ * \note The data is written in-order, using the \a lasthit will normally avoid calling this function.
+ * Files with many data-blocks still miss it often enough for the linear search to dominate
+ * the loading, so large maps index their entries in a hash on the first full lookup, keeping
+ * the common-case free of hashing.
  */
-static int oldnewmap_lookup_entry_full(const OldNewMap *onm, const void *addr, int lasthit)
+static int oldnewmap_lookup_entry_full(OldNewMap *onm, const void *addr, int lasthit)
 {
 	const int nentries = onm->nentries;
 	const OldNew *entries = onm->entries;
 	int i;
 
+#ifdef USE_GHASH_OLDNEWMAP
+	if (nentries >= OLDNEWMAP_HASH_MIN) {
+		void **val_p;
+
+		if (onm->entries_hash == NULL) {
+			onm->entries_hash = BLI_ghash_ptr_new_ex(__func__, (unsigned int)onm->entriessize);
+			for (i = 0; i < nentries; i++) {
+				BLI_ghash_reinsert(onm->entries_hash, entries[i].old, SET_INT_IN_POINTER(i), NULL, NULL);
+			}
+		}
+
+		val_p = BLI_ghash_lookup_p(onm->entries_hash, addr);
+		return val_p ? GET_INT_FROM_POINTER(*val_p) : -1;
+	}
+#endif
+
 	/* search relative to lasthit where possible */
 	if (lasthit >= 0 && lasthit < nentries) {
 
@@ -447,10 +490,21 @@ static void oldnewmap_clear(OldNewMap *onm)
 {
 	onm->nentries = 0;
 	onm->lasthit = 0;
+
+#ifdef USE_GHASH_OLDNEWMAP
+	if (onm->entries_hash) {
+		BLI_ghash_clear(onm->entries_hash, NULL, NULL);
+	}
+#endif
 }
 
 static void oldnewmap_free(OldNewMap *onm) 
 {
+#ifdef USE_GHASH_OLDNEWMAP
+	if (onm->entries_hash) {
+		BLI_ghash_free(onm->entries_hash, NULL, NULL);
+	}
+#endif
 	MEM_freeN(onm->entries);
 	MEM_freeN(onm);
 }
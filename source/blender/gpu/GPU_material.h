@@ -222,6 +222,7 @@ GPUMatType GPU_Material_get_type(GPUMaterial *material);
 
 void GPU_material_vertex_attributes(GPUMaterial *material,
 	struct GPUVertexAttribs *attrib);
+GPUBuiltin GPU_get_material_builtins(GPUMaterial *material);
 
 bool GPU_material_do_color_management(GPUMaterial *mat);
 bool GPU_material_use_new_shading_nodes(GPUMaterial *mat);
@@ -297,9 +298,14 @@ void GPU_lamp_free(struct Object *ob);
 
 bool GPU_lamp_has_shadow_buffer(GPULamp *lamp);
 void GPU_lamp_update_buffer_mats(GPULamp *lamp);
+void GPU_lamp_shadow_buffer_mats(GPULamp *lamp, float viewmat[4][4], float winmat[4][4]);
 void GPU_lamp_shadow_buffer_bind(GPULamp *lamp, float viewmat[4][4], int *winsize, float winmat[4][4]);
 void GPU_lamp_shadow_buffer_unbind(GPULamp *lamp);
 int GPU_lamp_shadow_buffer_type(GPULamp *lamp);
+void GPU_lamp_shadow_buffer_set_user(GPULamp *lamp, void *user);
+void *GPU_lamp_shadow_buffer_user(GPULamp *lamp);
+bool GPU_lamp_shadow_cache_store(GPULamp *lamp);
+bool GPU_lamp_shadow_cache_restore(GPULamp *lamp);
 
 void GPU_lamp_update(GPULamp *lamp, int lay, int hide, float obmat[4][4]);
 void GPU_lamp_update_colors(GPULamp *lamp, float r, float g, float b, float energy);
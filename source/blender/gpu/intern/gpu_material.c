@@ -162,6 +162,13 @@ struct GPULamp {
 	GPUTexture *depthtex;
 	GPUTexture *blurtex;
 
+	/* copy of the depth of the casters that don't move, see GPU_lamp_shadow_cache_store */
+	GPUFrameBuffer *cachefb;
+	GPUTexture *cachetex;
+
+	/* last user that drew in the shadow buffer, lamps added several times share it */
+	void *shadow_user;
+
 	ListBase materials;
 };
 
@@ -450,6 +457,11 @@ void GPU_material_vertex_attributes(GPUMaterial *material, GPUVertexAttribs *att
 	*attribs = material->attribs;
 }
 
+GPUBuiltin GPU_get_material_builtins(GPUMaterial *material)
+{
+	return material->builtins;
+}
+
 void GPU_material_output_link(GPUMaterial *material, GPUNodeLink *link)
 {
 	if (!material->outlink)
@@ -1968,6 +1980,15 @@ static void gpu_lamp_shadow_free(GPULamp *lamp)
 		GPU_framebuffer_free(lamp->blurfb);
 		lamp->blurfb = NULL;
 	}
+	if (lamp->cachetex) {
+		GPU_texture_free(lamp->cachetex);
+		lamp->cachetex = NULL;
+	}
+	if (lamp->cachefb) {
+		GPU_framebuffer_free(lamp->cachefb);
+		lamp->cachefb = NULL;
+	}
+	lamp->shadow_user = NULL;
 }
 
 GPULamp *GPU_lamp_from_blender(Scene *scene, Object *ob, Object *par)
@@ -2150,6 +2171,14 @@ void GPU_lamp_update_buffer_mats(GPULamp *lamp)
 	mul_m4_m4m4(lamp->persmat, rangemat, persmat);
 }
 
+void GPU_lamp_shadow_buffer_mats(GPULamp *lamp, float viewmat[4][4], float winmat[4][4])
+{
+	GPU_lamp_update_buffer_mats(lamp);
+
+	copy_m4_m4(viewmat, lamp->viewmat);
+	copy_m4_m4(winmat, lamp->winmat);
+}
+
 void GPU_lamp_shadow_buffer_bind(GPULamp *lamp, float viewmat[4][4], int *winsize, float winmat[4][4])
 {
 	GPU_lamp_update_buffer_mats(lamp);
@@ -2183,6 +2212,70 @@ int GPU_lamp_shadow_buffer_type(GPULamp *lamp)
 	return lamp->la->shadowmap_type;
 }
 
+void GPU_lamp_shadow_buffer_set_user(GPULamp *lamp, void *user)
+{
+	lamp->shadow_user = user;
+}
+
+void *GPU_lamp_shadow_buffer_user(GPULamp *lamp)
+{
+	return lamp->shadow_user;
+}
+
+/* The shadow cache keeps the depth of the casters that don't move, the others are
+ * drawn on top of it. Variance shadow maps are blurred so they can't be cached. */
+bool GPU_lamp_shadow_cache_store(GPULamp *lamp)
+{
+	if (lamp->la->shadowmap_type == LA_SHADMAP_VARIANCE)
+		return false;
+
+	if (!lamp->cachefb) {
+		lamp->cachefb = GPU_framebuffer_create();
+		if (!lamp->cachefb)
+			return false;
+
+		lamp->cachetex = GPU_texture_create_depth(lamp->size, lamp->size, NULL);
+		if (!lamp->cachetex ||
+		    !GPU_framebuffer_texture_attach(lamp->cachefb, lamp->cachetex, 0, NULL) ||
+		    !GPU_framebuffer_check_valid(lamp->cachefb, NULL))
+		{
+			if (lamp->cachetex) {
+				GPU_texture_free(lamp->cachetex);
+				lamp->cachetex = NULL;
+			}
+			GPU_framebuffer_free(lamp->cachefb);
+			lamp->cachefb = NULL;
+			return false;
+		}
+	}
+
+	/* copy the depth of the shadow buffer, which must not be bound */
+	GPU_texture_bind_as_framebuffer(lamp->tex);
+	glBindTexture(GL_TEXTURE_2D, GPU_texture_opengl_bindcode(lamp->cachetex));
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, lamp->size, lamp->size);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	GPU_framebuffer_texture_unbind(lamp->fb, lamp->tex);
+	GPU_framebuffer_restore();
+
+	return true;
+}
+
+bool GPU_lamp_shadow_cache_restore(GPULamp *lamp)
+{
+	if (!lamp->cachefb)
+		return false;
+
+	/* copy the cached depth in the shadow buffer, which must not be bound */
+	GPU_texture_bind_as_framebuffer(lamp->cachetex);
+	glBindTexture(GL_TEXTURE_2D, GPU_texture_opengl_bindcode(lamp->tex));
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, lamp->size, lamp->size);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	GPU_framebuffer_texture_unbind(lamp->cachefb, lamp->cachetex);
+	GPU_framebuffer_restore();
+
+	return true;
+}
+
 int GPU_lamp_shadow_layer(GPULamp *lamp)
 {
 	if (lamp->fb && lamp->tex && (lamp->mode & (LA_LAYER|LA_LAYER_SHADOW)))
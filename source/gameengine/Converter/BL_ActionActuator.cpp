@@ -37,6 +37,8 @@
 #include "BL_Action.h"
 #include "BL_ActionManager.h"
 #include "KX_GameObject.h"
+#include "KX_Scene.h"
+#include "KX_BlenderSceneConverter.h"
 #include "STR_HashedString.h"
 #include "MEM_guardedalloc.h"
 #include "DNA_nla_types.h"
@@ -115,6 +117,15 @@ void BL_ActionActuator::ProcessReplica()
 	
 }
 
+void BL_ActionActuator::ResetReplica()
+{
+	SCA_IActuator::ResetReplica();
+
+	m_flag &= ACT_FLAG_CONTINUE;
+	m_localtime=m_startframe;
+	m_lastUpdate=-1;
+}
+
 void BL_ActionActuator::SetBlendTime(float newtime)
 {
 	m_blendframe = newtime;
@@ -579,6 +590,12 @@ int BL_ActionActuator::pyattr_set_action(void *self_v, const KX_PYATTRIBUTE_DEF
 			PyErr_SetString(PyExc_ValueError, "actuator.action = val: Action Actuator, action not found!");
 			return PY_SET_ATTR_FAIL;
 		}
+
+		// the action may come from a library, it is cleared when the library is freed
+		KX_GameObject *obj = (KX_GameObject *)self->GetParent();
+		KX_BlenderSceneConverter *converter = obj->GetScene()->GetSceneConverter();
+		if (converter)
+			converter->RegisterActionUser(obj, action);
 	}
 	
 	self->SetAction(action);
@@ -61,6 +61,7 @@ public:
 	virtual	bool Update(double curtime, bool frame);
 	virtual CValue* GetReplica();
 	virtual void ProcessReplica();
+	virtual void ResetReplica();
 	
 	void SetBlendTime(float newtime);
 	void SetLocalTime(float curtime);
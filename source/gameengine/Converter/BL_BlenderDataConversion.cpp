@@ -49,6 +49,7 @@
 
 #include <math.h>
 #include <vector>
+#include <map>
 #include <algorithm>
 
 #include "BL_BlenderDataConversion.h"
@@ -102,6 +103,7 @@
 
 #include "KX_KetsjiEngine.h"
 #include "KX_BlenderSceneConverter.h"
+#include "BL_RuntimePack.h"
 
 /* This little block needed for linking to Blender... */
 #ifdef WIN32
@@ -178,6 +180,7 @@ extern Material defmaterial;	/* material.c */
 #include "KX_ObstacleSimulation.h"
 
 #include "BLI_threads.h"
+#include "BLI_task.h"
 
 
 static bool default_light_mode = 0;
@@ -491,25 +494,31 @@ typedef struct MTF_localLayer {
 	const char *name;
 } MTF_localLayer;
 
-static void GetUVs(BL_Material *material, MTF_localLayer *layers, MFace *mface, MTFace *tface, MT_Point2 uvs[4][MAXTEX])
+/* returns the number of uv layers filled in */
+static int GetUVs(BL_Material *material, MTF_localLayer *layers, MFace *mface, MTFace *tface, float uvs[4][MAXTEX][2])
 {
 	int unit = 0;
 	if (tface)
 	{
 			
-		uvs[0][0].setValue(tface->uv[0]);
-		uvs[1][0].setValue(tface->uv[1]);
-		uvs[2][0].setValue(tface->uv[2]);
+		copy_v2_v2(uvs[0][0], tface->uv[0]);
+		copy_v2_v2(uvs[1][0], tface->uv[1]);
+		copy_v2_v2(uvs[2][0], tface->uv[2]);
 
 		if (mface->v4) 
-			uvs[3][0].setValue(tface->uv[3]);
+			copy_v2_v2(uvs[3][0], tface->uv[3]);
 	}
 	else
 	{
-		uvs[0][0] = uvs[1][0] = uvs[2][0] = uvs[3][0] = MT_Point2(0.f, 0.f);
+		zero_v2(uvs[0][0]);
+		zero_v2(uvs[1][0]);
+		zero_v2(uvs[2][0]);
+		zero_v2(uvs[3][0]);
 	}
 	
-	vector<STR_String> found_layers;
+	/* called for every face, avoid allocating */
+	const STR_String *found_layers[MAXTEX];
+	int totfound = 0;
 
 	for (int vind = 0; vind<MAXTEX; vind++)
 	{
@@ -517,18 +526,21 @@ static void GetUVs(BL_Material *material, MTF_localLayer *layers, MFace *mface,
 
 		if (!(map.mapping & USEUV)) continue;
 
-		if (std::find(found_layers.begin(), found_layers.end(), map.uvCoName) != found_layers.end())
+		bool found = false;
+		for (int i = 0; i < totfound && !found; i++)
+			found = (*found_layers[i] == map.uvCoName);
+		if (found)
 			continue;
 
 		//If no UVSet is specified, try grabbing one from the UV/Image editor
 		if (map.uvCoName.IsEmpty() && tface)
 		{			
-			uvs[0][unit].setValue(tface->uv[0]);
-			uvs[1][unit].setValue(tface->uv[1]);
-			uvs[2][unit].setValue(tface->uv[2]);
+			copy_v2_v2(uvs[0][unit], tface->uv[0]);
+			copy_v2_v2(uvs[1][unit], tface->uv[1]);
+			copy_v2_v2(uvs[2][unit], tface->uv[2]);
 
 			if (mface->v4) 
-				uvs[3][unit].setValue(tface->uv[3]);
+				copy_v2_v2(uvs[3][unit], tface->uv[3]);
 
 			++unit;
 			continue;
@@ -542,21 +554,23 @@ static void GetUVs(BL_Material *material, MTF_localLayer *layers, MFace *mface,
 
 			if (map.uvCoName.IsEmpty() || strcmp(map.uvCoName.ReadPtr(), layer.name)==0)
 			{
-				uvs[0][unit].setValue(layer.face->uv[0]);
-				uvs[1][unit].setValue(layer.face->uv[1]);
-				uvs[2][unit].setValue(layer.face->uv[2]);
+				copy_v2_v2(uvs[0][unit], layer.face->uv[0]);
+				copy_v2_v2(uvs[1][unit], layer.face->uv[1]);
+				copy_v2_v2(uvs[2][unit], layer.face->uv[2]);
 
 				if (mface->v4) 
-					uvs[3][unit].setValue(layer.face->uv[3]);
+					copy_v2_v2(uvs[3][unit], layer.face->uv[3]);
 				else
-					uvs[3][unit].setValue(0.0f, 0.0f);
+					zero_v2(uvs[3][unit]);
 
 				++unit;
-				found_layers.push_back(map.uvCoName);
+				found_layers[totfound++] = &map.uvCoName;
 				break;
 			}
 		}
 	}
+
+	return unit;
 }
 
 // ------------------------------------
@@ -881,7 +895,7 @@ static bool ConvertMaterial(
 	return true;
 }
 
-static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace *tface, MCol *mcol, MTF_localLayer *layers, int lightlayer, unsigned int *rgb, MT_Point2 uvs[4][RAS_TexVert::MAX_UNIT], const char *tfaceName, KX_Scene* scene, KX_BlenderSceneConverter *converter)
+static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace *tface, MCol *mcol, MTF_localLayer *layers, int lightlayer, unsigned int *rgb, float uvs[4][RAS_TexVert::MAX_UNIT][2], const char *tfaceName, KX_Scene* scene, KX_BlenderSceneConverter *converter)
 {
 	RAS_IPolyMaterial* polymat = converter->FindCachedPolyMaterial(scene, ma);
 	BL_Material* bl_mat = converter->FindCachedBlenderMaterial(scene, ma);
@@ -902,7 +916,7 @@ static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace
 	const bool use_vcol = GetMaterialUseVColor(ma, bl_mat->glslmat);
 	GetRGB(use_vcol, mface, mcol, ma, rgb);
 
-	GetUVs(bl_mat, layers, mface, tface, uvs);
+	const int uvcount = GetUVs(bl_mat, layers, mface, tface, uvs);
 
 	/* then the KX_BlenderMaterial */
 	if (polymat == NULL)
@@ -920,6 +934,18 @@ static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace
 	bool bucketCreated; 
 	RAS_MaterialBucket* bucket = scene->FindBucket(polymat, bucketCreated);
 
+	// vertex data read by the material, so the storage can upload packed vertices.
+	// GLSL attributes are only known once the shader is built, the storage widens the format for those.
+	RAS_VertexFormat format;
+	format.m_uvSize = (uvcount > 0) ? uvcount : 1;
+	for (int i = 0; i < MAXTEX; i++) {
+		if (bl_mat->mapping[i].mapping & USETANG)
+			format.m_flag |= RAS_VertexFormat::TANGENT | RAS_VertexFormat::FLOAT_NORMAL;
+		else if (bl_mat->mapping[i].mapping & USENORM)
+			format.m_flag |= RAS_VertexFormat::FLOAT_NORMAL;
+	}
+	bucket->GetVertexFormat().Merge(format);
+
 	// this is needed to free up memory afterwards.
 	// the converter will also prevent duplicates from being registered,
 	// so just register everything.
@@ -929,8 +955,20 @@ static RAS_MaterialBucket *material_from_mesh(Material *ma, MFace *mface, MTFace
 	return bucket;
 }
 
+/* The faces of a material slot share a bucket, but the ones of a face texture
+ * material are split by image, see material_from_mesh() */
+typedef std::pair<int, Image *> BL_BucketKey;
+typedef std::map<BL_BucketKey, unsigned int> BL_BucketCorners;
+
+static BL_BucketKey bucket_corners_key(const MFace& face, const MTFace *tface, const vector<bool>& facetexture)
+{
+	const bool useimage = (tface && face.mat_nr < (int)facetexture.size() && facetexture[face.mat_nr]);
+	return BL_BucketKey(face.mat_nr, (useimage) ? tface->tpage : NULL);
+}
+
 /* blenderobj can be NULL, make sure its checked for */
-RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene, KX_BlenderSceneConverter *converter, bool libloading)
+RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene, KX_BlenderSceneConverter *converter, bool libloading,
+                               BL_MeshArrays *prepared)
 {
 	RAS_MeshObject *meshobj;
 	int lightlayer = blenderobj ? blenderobj->lay:(1<<20)-1; // all layers if no object.
@@ -945,33 +983,25 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 		}
 	}
 
-	// Get DerivedMesh data
-	DerivedMesh *dm = CDDM_from_mesh(mesh);
-	DM_ensure_tessface(dm);
+	// Get the tessellated mesh, baked in the runtime pack of the file or from a DerivedMesh
+	BL_MeshArrays localArrays;
+	BL_MeshArrays& arrays = (prepared) ? *prepared : localArrays;
+	if (!prepared) {
+		BL_RuntimePack *pack = converter->GetRuntimePack();
+		if (libloading || !pack || !pack->GetMesh(mesh, arrays))
+			arrays.FromMesh(mesh);
+	}
 
-	MVert *mvert = dm->getVertArray(dm);
-	int totvert = dm->getNumVerts(dm);
+	MVert *mvert = arrays.m_mvert;
+	int totvert = arrays.m_totvert;
 
-	MFace *mface = dm->getTessFaceArray(dm);
-	MTFace *tface = static_cast<MTFace*>(dm->getTessFaceDataArray(dm, CD_MTFACE));
-	MCol *mcol = static_cast<MCol*>(dm->getTessFaceDataArray(dm, CD_MCOL));
-	float (*tangent)[4] = NULL;
-	int totface = dm->getNumTessFaces(dm);
+	MFace *mface = arrays.m_mface;
+	MTFace *tface = arrays.m_tface;
+	MCol *mcol = arrays.m_mcol;
+	float (*tangent)[4] = arrays.m_tangent;
+	int totface = arrays.m_totface;
 	const char *tfaceName = "";
 
-	/* needs to be rewritten for loopdata */
-	if (tface) {
-		if (CustomData_get_layer_index(&dm->faceData, CD_TANGENT) == -1) {
-			bool generate_data = false;
-			if (CustomData_get_layer_index(&dm->loopData, CD_TANGENT) == -1) {
-				DM_calc_loop_tangents(dm);
-				generate_data = true;
-			}
-			DM_generate_tangent_tessface_data(dm, generate_data);
-		}
-		tangent = (float(*)[4])dm->getTessFaceDataArray(dm, CD_TANGENT);
-	}
-
 	meshobj = new RAS_MeshObject(mesh);
 
 	// Extract avaiable layers
@@ -981,91 +1011,73 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 		layers[lay].name = "";
 	}
 
-	int validLayers = 0;
-	for (int i=0; i<dm->faceData.totlayer; i++)
-	{
-		if (dm->faceData.layers[i].type == CD_MTFACE)
-		{
-			if (validLayers >= MAX_MTFACE) {
-				printf("%s: corrupted mesh %s - too many CD_MTFACE layers\n", __func__, mesh->id.name);
-				break;
-			}
-
-			layers[validLayers].face = (MTFace*)(dm->faceData.layers[i].data);
-			layers[validLayers].name = dm->faceData.layers[i].name;
-			if (tface == layers[validLayers].face)
-				tfaceName = layers[validLayers].name;
-			validLayers++;
-		}
+	for (int i = 0; i < arrays.m_numLayers; i++) {
+		layers[i].face = arrays.m_layers[i];
+		layers[i].name = arrays.m_layerNames[i];
+		if (tface == layers[i].face)
+			tfaceName = layers[i].name;
 	}
 
 	meshobj->SetName(mesh->id.name + 2);
-	meshobj->m_sharedvertex_map.resize(totvert);
-
-	Material* ma = 0;
-	MT_Point2 uvs[4][RAS_TexVert::MAX_UNIT];
-	unsigned int rgb[4] = {0};
+	/* the face texture materials get a bucket per image of their faces */
+	vector<bool> facetexture(mesh->totcol, false);
+	for (int i = 0; i < mesh->totcol; i++) {
+		Material *mat = (blenderobj) ? give_current_material(blenderobj, i + 1) : mesh->mat[i];
+		facetexture[i] = (mat && (mat->mode & MA_FACETEXTURE));
+	}
 
-	MT_Point3 pt[4];
-	MT_Vector3 no[4];
-	MT_Vector4 tan[4];
+	/* corners per bucket, to size the display arrays up front */
+	BL_BucketCorners bucketcorners;
+	unsigned int totcorners = 0;
+	for (int f = 0; f < totface; f++) {
+		const MFace &face = mface[f];
+		const unsigned int nverts = (face.v4) ? 4 : 3;
 
-	/* ugh, if there is a less annoying way to do this please use that.
-	 * since these are converted from floats to floats, theres no real
-	 * advantage to use MT_ types - campbell */
-	for (unsigned int i = 0; i < 4; i++) {
-		const float zero_vec[4] = {0.0f};
-		pt[i].setValue(zero_vec);
-		no[i].setValue(zero_vec);
-		tan[i].setValue(zero_vec);
+		bucketcorners[bucket_corners_key(face, (tface) ? &tface[f] : NULL, facetexture)] += nverts;
+		totcorners += nverts;
 	}
 
-	/* we need to manually initialize the uvs (MoTo doesn't do that) [#34550] */
-	for (unsigned int i = 0; i < RAS_TexVert::MAX_UNIT; i++) {
-		uvs[0][i] = uvs[1][i] = uvs[2][i] = uvs[3][i] = MT_Point2(0.f, 0.f);
-	}
+	meshobj->BeginConversion(totvert, totcorners);
+
+	Material* ma = 0;
+	float uvs[4][RAS_TexVert::MAX_UNIT][2] = {{{0.0f}}};
+	unsigned int rgb[4] = {0};
+
+	/* vertex data is passed as floats straight from the mesh */
+	float no[4][3] = {{0.0f}};
+	const float zero_tan[4] = {0.0f};
+	const float *tan[4] = {zero_tan, zero_tan, zero_tan, zero_tan};
 
 	for (int f=0;f<totface;f++,mface++)
 	{
 		/* get coordinates, normals and tangents */
-		pt[0].setValue(mvert[mface->v1].co);
-		pt[1].setValue(mvert[mface->v2].co);
-		pt[2].setValue(mvert[mface->v3].co);
-		if (mface->v4) pt[3].setValue(mvert[mface->v4].co);
+		const float *pt[4] = {mvert[mface->v1].co, mvert[mface->v2].co, mvert[mface->v3].co,
+		                      mvert[mface->v4].co};
 
 		if (mface->flag & ME_SMOOTH) {
-			float n0[3], n1[3], n2[3], n3[3];
-
-			normal_short_to_float_v3(n0, mvert[mface->v1].no);
-			normal_short_to_float_v3(n1, mvert[mface->v2].no);
-			normal_short_to_float_v3(n2, mvert[mface->v3].no);
-			no[0] = n0;
-			no[1] = n1;
-			no[2] = n2;
-
-			if (mface->v4) {
-				normal_short_to_float_v3(n3, mvert[mface->v4].no);
-				no[3] = n3;
-			}
+			normal_short_to_float_v3(no[0], mvert[mface->v1].no);
+			normal_short_to_float_v3(no[1], mvert[mface->v2].no);
+			normal_short_to_float_v3(no[2], mvert[mface->v3].no);
+
+			if (mface->v4)
+				normal_short_to_float_v3(no[3], mvert[mface->v4].no);
 		}
 		else {
-			float fno[3];
-
 			if (mface->v4)
-				normal_quad_v3(fno,mvert[mface->v1].co, mvert[mface->v2].co, mvert[mface->v3].co, mvert[mface->v4].co);
+				normal_quad_v3(no[0],mvert[mface->v1].co, mvert[mface->v2].co, mvert[mface->v3].co, mvert[mface->v4].co);
 			else
-				normal_tri_v3(fno,mvert[mface->v1].co, mvert[mface->v2].co, mvert[mface->v3].co);
+				normal_tri_v3(no[0],mvert[mface->v1].co, mvert[mface->v2].co, mvert[mface->v3].co);
 
-			no[0] = no[1] = no[2] = no[3] = MT_Vector3(fno);
+			copy_v3_v3(no[1], no[0]);
+			copy_v3_v3(no[2], no[0]);
+			copy_v3_v3(no[3], no[0]);
 		}
 
 		if (tangent) {
 			tan[0] = tangent[f*4 + 0];
 			tan[1] = tangent[f*4 + 1];
 			tan[2] = tangent[f*4 + 2];
-
-			if (mface->v4)
-				tan[3] = tangent[f*4 + 3];
+			tan[3] = tangent[f*4 + 3];
 		}
 		if (blenderobj)
 			ma = give_current_material(blenderobj, mface->mat_nr+1);
@@ -1091,7 +1103,9 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 				
 			int nverts = (mface->v4)? 4: 3;
 
-			RAS_Polygon *poly = meshobj->AddPolygon(bucket, nverts);
+			unsigned int &corners = bucketcorners[bucket_corners_key(*mface, tface, facetexture)];
+			RAS_Polygon *poly = meshobj->AddPolygon(bucket, nverts, corners);
+			corners -= nverts;
 
 			poly->SetVisible(visible);
 			poly->SetCollider(collider);
@@ -1135,8 +1149,6 @@ RAS_MeshObject* BL_ConvertMesh(Mesh* mesh, Object* blenderobj, KX_Scene* scene,
 
 	if (layers)
 		delete []layers;
-	
-	dm->release(dm);
 
 	converter->RegisterGameMesh(meshobj, mesh);
 	return meshobj;
@@ -1468,11 +1480,100 @@ static KX_Camera *gamecamera_from_bcamera(Object *ob, KX_Scene *kxscene, KX_Blen
 	return gamecamera;
 }
 
+/* The tessellated arrays of the meshes of a scene, made over the threads of the task
+ * scheduler before the objects are converted one after the other. */
+typedef std::map<Mesh *, BL_MeshArrays *> BL_PreparedMeshes;
+
+static void bl_AddMeshToPrepare(Mesh *mesh, KX_BlenderSceneConverter *converter, BL_PreparedMeshes& prepared)
+{
+	if (prepared.find(mesh) == prepared.end() && !converter->FindGameMesh(mesh))
+		prepared[mesh] = new BL_MeshArrays();
+}
+
+static void bl_AddObjectToPrepare(Object *ob, KX_BlenderSceneConverter *converter, BL_PreparedMeshes& prepared)
+{
+	if (ob->type != OB_MESH)
+		return;
+
+	bl_AddMeshToPrepare(static_cast<Mesh *>(ob->data), converter, prepared);
+	if (BLI_listbase_count_ex(&ob->lodlevels, 2) > 1) {
+		for (LodLevel *lod = ((LodLevel *)ob->lodlevels.first)->next; lod; lod = lod->next) {
+			if (lod->source && lod->source->type == OB_MESH && (lod->flags & OB_LOD_USE_MESH))
+				bl_AddMeshToPrepare(static_cast<Mesh *>(lod->source->data), converter, prepared);
+		}
+	}
+}
+
+static void prepare_mesh_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	BL_PreparedMeshes::value_type *item = (BL_PreparedMeshes::value_type *)taskdata;
+	item->second->FromMesh(item->first);
+}
+
+static void bl_PrepareMeshes(Scene *blenderscene, KX_BlenderSceneConverter *converter, TaskScheduler *scheduler,
+                             bool libloading, BL_PreparedMeshes& prepared)
+{
+	/* all the meshes are held until their objects are converted, which is only
+	 * worth it when there are threads to share the tessellation */
+	if (!scheduler || BLI_task_scheduler_num_threads(scheduler) < 2)
+		return;
+
+	// the meshes of the objects of the scene and of the groups they instance
+	Scene *sce_iter;
+	Base *base;
+	set<Group *> groups;
+	vector<Group *> pending;
+	for (SETLOOPER(blenderscene, sce_iter, base)) {
+		Object *ob = base->object;
+		bl_AddObjectToPrepare(ob, converter, prepared);
+		if ((ob->transflag & OB_DUPLIGROUP) && ob->dup_group && groups.insert(ob->dup_group).second)
+			pending.push_back(ob->dup_group);
+	}
+	while (!pending.empty()) {
+		Group *group = pending.back();
+		pending.pop_back();
+		for (GroupObject *go = (GroupObject *)group->gobject.first; go; go = go->next) {
+			Object *ob = go->ob;
+			bl_AddObjectToPrepare(ob, converter, prepared);
+			if ((ob->transflag & OB_DUPLIGROUP) && ob->dup_group && groups.insert(ob->dup_group).second)
+				pending.push_back(ob->dup_group);
+		}
+	}
+
+	if (prepared.empty())
+		return;
+
+	// the meshes baked in the runtime pack are only mapped, the others are tessellated by the tasks
+	BL_RuntimePack *pack = (libloading) ? NULL : converter->GetRuntimePack();
+	TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+	for (BL_PreparedMeshes::iterator it = prepared.begin(); it != prepared.end(); ++it) {
+		if (!pack || !pack->GetMesh(it->first, *it->second))
+			BLI_task_pool_push(pool, prepare_mesh_task, &(*it), false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
+
+static RAS_MeshObject *bl_ConvertPreparedMesh(Mesh *mesh, Object *ob, KX_Scene *kxscene, KX_BlenderSceneConverter *converter,
+                                              bool libloading, BL_PreparedMeshes& prepared)
+{
+	BL_PreparedMeshes::iterator it = prepared.find(mesh);
+	if (it == prepared.end())
+		return BL_ConvertMesh(mesh, ob, kxscene, converter, libloading);
+
+	RAS_MeshObject *meshobj = BL_ConvertMesh(mesh, ob, kxscene, converter, libloading, it->second);
+	// the next objects using the mesh share the game mesh, the arrays aren't needed anymore
+	delete it->second;
+	prepared.erase(it);
+	return meshobj;
+}
+
 static KX_GameObject *gameobject_from_blenderobject(
 								Object *ob, 
 								KX_Scene *kxscene, 
 								RAS_IRasterizer *rendertools,
 								KX_BlenderSceneConverter *converter,
+								BL_PreparedMeshes& preparedMeshes,
 								bool libloading) 
 {
 	KX_GameObject *gameobj = NULL;
@@ -1510,7 +1611,7 @@ static KX_GameObject *gameobject_from_blenderobject(
 		Mesh* mesh = static_cast<Mesh*>(ob->data);
 		float center[3], extents[3];
 		float radius = my_boundbox_mesh((Mesh*) ob->data, center, extents);
-		RAS_MeshObject* meshobj = BL_ConvertMesh(mesh,ob,kxscene,converter, libloading);
+		RAS_MeshObject* meshobj = bl_ConvertPreparedMesh(mesh, ob, kxscene, converter, libloading, preparedMeshes);
 		
 		// needed for python scripting
 		kxscene->GetLogicManager()->RegisterMeshName(meshobj->GetName(),meshobj);
@@ -1541,7 +1642,7 @@ static KX_GameObject *gameobject_from_blenderobject(
 				if (lod->flags & OB_LOD_USE_MAT) {
 					lodmatob = lod->source;
 				}
-				gameobj->AddLodMesh(BL_ConvertMesh(lodmesh, lodmatob, kxscene, converter, libloading));
+				gameobj->AddLodMesh(bl_ConvertPreparedMesh(lodmesh, lodmatob, kxscene, converter, libloading, preparedMeshes));
 			}
 			if (blenderscene->gm.lodflag & SCE_LOD_USE_HYST) {
 				kxscene->SetLodHysteresis(true);
@@ -1720,6 +1821,30 @@ static void UNUSED_FUNCTION(print_active_constraints2)(Object *ob) //not used, u
 	}
 }
 
+static void build_navmesh_task(TaskPool *UNUSED(pool), void *taskdata, int UNUSED(threadid))
+{
+	((KX_NavMeshObject *)taskdata)->FinishNavMesh();
+}
+
+/* The derived meshes are created here one after the other, only the detour
+ * meshes are built by the tasks */
+static void bl_BuildNavMeshes(const vector<KX_NavMeshObject *>& navmeshes, TaskScheduler *scheduler)
+{
+	if (!scheduler || navmeshes.size() < 2) {
+		for (unsigned int i = 0; i < navmeshes.size(); i++)
+			navmeshes[i]->BuildNavMesh();
+		return;
+	}
+
+	TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+	for (unsigned int i = 0; i < navmeshes.size(); i++) {
+		if (navmeshes[i]->PrepareNavMesh())
+			BLI_task_pool_push(pool, build_navmesh_task, navmeshes[i], false, TASK_PRIORITY_HIGH);
+	}
+	BLI_task_pool_work_and_wait(pool);
+	BLI_task_pool_free(pool);
+}
+
 // Copy base layer to object layer like in BKE_scene_set_background
 static void blenderSceneSetBackground(Scene *blenderscene)
 {
@@ -1848,6 +1973,7 @@ static void bl_ConvertBlenderObject_Single(
 		logicmgr->RegisterGameMeshName(gameobj->GetMesh(i)->GetName(), blenderobject);
 
 	converter->RegisterGameObject(gameobj, blenderobject);
+	converter->RegisterLibraryObject(gameobj, kxscene);
 	// this was put in rapidly, needs to be looked at more closely
 	// only draw/use objects in active 'blender' layers
 
@@ -1987,6 +2113,11 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 
 	blenderSceneSetBackground(blenderscene);
 
+	// The meshes are tessellated over the threads first, the objects are then converted in order
+	TaskScheduler *scheduler = ketsjiEngine->GetTaskScheduler();
+	BL_PreparedMeshes preparedMeshes;
+	bl_PrepareMeshes(blenderscene, converter, scheduler, libloading, preparedMeshes);
+
 	// Let's support scene set.
 	// Beware of name conflict in linked data, it will not crash but will create confusion
 	// in Python scripting and in certain actuators (replace mesh). Linked scene *should* have
@@ -2001,6 +2132,7 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 										kxscene, 
 										rendertools, 
 										converter,
+										preparedMeshes,
 										libloading);
 
 		bool isInActiveLayer = (blenderobject->lay & activeLayerBitInfo) !=0;
@@ -2053,6 +2185,7 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 														kxscene, 
 														rendertools, 
 														converter,
+														preparedMeshes,
 														libloading);
 
 						bool isInActiveLayer = false;
@@ -2082,6 +2215,11 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		}
 	}
 
+	// the meshes of objects that weren't converted in the end
+	for (BL_PreparedMeshes::iterator pit = preparedMeshes.begin(); pit != preparedMeshes.end(); ++pit)
+		delete pit->second;
+	preparedMeshes.clear();
+
 	// non-camera objects not supported as camera currently
 	if (blenderscene->camera && blenderscene->camera->type == OB_CAMERA) {
 		KX_Camera *gamecamera= (KX_Camera*) converter->FindGameObject(blenderscene->camera);
@@ -2261,6 +2399,9 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		}
 	}
 
+	// the shapes are finished over the threads once all the objects have one
+	kxscene->GetPhysicsEnvironment()->DeferShapeCooking();
+
 	bool processCompoundChildren = false;
 	// create physics information
 	for (i=0;i<sumolist->GetCount();i++)
@@ -2293,6 +2434,8 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		BL_CreatePhysicsObjectNew(gameobj,blenderobject,meshobj,kxscene,layerMask,converter,processCompoundChildren);
 	}
 
+	kxscene->GetPhysicsEnvironment()->CookDeferredShapes(scheduler);
+
 	// create physics joints
 	for (i=0;i<sumolist->GetCount();i++)
 	{
@@ -2368,7 +2511,8 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		}
 	}
 
-	//process navigation mesh objects
+	//process navigation mesh objects, each one is built by a task
+	vector<KX_NavMeshObject*> navmeshes;
 	for ( i=0; i<objectlist->GetCount();i++)
 	{
 		KX_GameObject* gameobj = static_cast<KX_GameObject*>(objectlist->GetValue(i));
@@ -2377,11 +2521,15 @@ void BL_ConvertBlenderObjects(struct Main* maggie,
 		{
 			KX_NavMeshObject* navmesh = static_cast<KX_NavMeshObject*>(gameobj);
 			navmesh->SetVisible(0, true);
-			navmesh->BuildNavMesh();
-			if (obssimulation)
-				obssimulation->AddObstaclesForNavMesh(navmesh);
+			navmeshes.push_back(navmesh);
 		}
 	}
+	bl_BuildNavMeshes(navmeshes, scheduler);
+	for (unsigned int n = 0; n < navmeshes.size(); n++)
+	{
+		if (obssimulation)
+			obssimulation->AddObstaclesForNavMesh(navmeshes[n]);
+	}
 	for ( i=0; i<inactivelist->GetCount();i++)
 	{
 		KX_GameObject* gameobj = static_cast<KX_GameObject*>(inactivelist->GetValue(i));
@@ -38,7 +38,9 @@
 #include "KX_PhysicsEngineEnums.h"
 #include "SCA_IInputDevice.h"
 
-class RAS_MeshObject* BL_ConvertMesh(struct Mesh* mesh,struct Object* lightobj,class KX_Scene* scene, class KX_BlenderSceneConverter *converter, bool libloading);
+/* prepared are the tessellated arrays of the mesh when they were made in advance, NULL to make them here */
+class RAS_MeshObject* BL_ConvertMesh(struct Mesh* mesh,struct Object* lightobj,class KX_Scene* scene, class KX_BlenderSceneConverter *converter, bool libloading,
+                                     class BL_MeshArrays *prepared=NULL);
 
 void BL_ConvertBlenderObjects(struct Main* maggie,
 							  class KX_Scene* kxscene,
@@ -71,6 +71,7 @@ bool BL_MeshDeformer::Apply(RAS_IPolyMaterial*)
 					RAS_TexVert& v = it.vertex[i];
 					v.SetXYZ(m_bmesh->mvert[v.getOrigIndex()].co);
 				}
+				it.array->SetModified(RAS_DisplayArray::POSITION_MODIFIED, it.startvertex, it.endvertex);
 			}
 		}
 
@@ -218,6 +219,7 @@ void BL_MeshDeformer::RecalcNormals()
 				if (!(v.getFlag() & RAS_TexVert::FLAT))
 					v.SetNormal(m_transnors[v.getOrigIndex()]); //.safe_normalized()
 			}
+			it.array->SetModified(RAS_DisplayArray::NORMAL_MODIFIED, it.startvertex, it.endvertex);
 		}
 	}
 }
@@ -0,0 +1,245 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Converter/BL_RuntimePack.cpp
+ *  \ingroup bgeconv
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "BL_RuntimePack.h"
+
+#include "DNA_ID.h"
+#include "DNA_image_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_path_util.h"
+
+#include "BKE_main.h"
+
+extern "C" {
+#include "BLI_hash_mm2a.h"
+#include "BKE_customdata.h"
+#include "BKE_cdderivedmesh.h"
+#include "BKE_DerivedMesh.h"
+}
+
+void BL_MeshArrays::FromMesh(Mesh *mesh)
+{
+	// Get DerivedMesh data
+	m_dm = CDDM_from_mesh(mesh);
+	DM_ensure_tessface(m_dm);
+
+	m_mvert = m_dm->getVertArray(m_dm);
+	m_totvert = m_dm->getNumVerts(m_dm);
+
+	m_mface = m_dm->getTessFaceArray(m_dm);
+	m_tface = static_cast<MTFace*>(m_dm->getTessFaceDataArray(m_dm, CD_MTFACE));
+	m_mcol = static_cast<MCol*>(m_dm->getTessFaceDataArray(m_dm, CD_MCOL));
+	m_totface = m_dm->getNumTessFaces(m_dm);
+
+	/* needs to be rewritten for loopdata */
+	if (m_tface) {
+		if (CustomData_get_layer_index(&m_dm->faceData, CD_TANGENT) == -1) {
+			bool generate_data = false;
+			if (CustomData_get_layer_index(&m_dm->loopData, CD_TANGENT) == -1) {
+				DM_calc_loop_tangents(m_dm);
+				generate_data = true;
+			}
+			DM_generate_tangent_tessface_data(m_dm, generate_data);
+		}
+		m_tangent = (float(*)[4])m_dm->getTessFaceDataArray(m_dm, CD_TANGENT);
+	}
+
+	// Extract avaiable layers
+	for (int i = 0; i < m_dm->faceData.totlayer; i++) {
+		if (m_dm->faceData.layers[i].type == CD_MTFACE) {
+			if (m_numLayers >= MAX_MTFACE) {
+				printf("%s: corrupted mesh %s - too many CD_MTFACE layers\n", __func__, mesh->id.name);
+				break;
+			}
+
+			m_layers[m_numLayers] = (MTFace*)(m_dm->faceData.layers[i].data);
+			m_layerNames[m_numLayers] = m_dm->faceData.layers[i].name;
+			m_numLayers++;
+		}
+	}
+}
+
+/* ------------------------------------------------------------------------- */
+/* mesh hash, the values are added as ints so that it's the same on all byte orders */
+
+static void hash_add_floats(BLI_HashMurmur2A *mm2, const float *values, int num)
+{
+	for (int i = 0; i < num; i++) {
+		int bits;
+		memcpy(&bits, &values[i], sizeof(bits));
+		BLI_hash_mm2a_add_int(mm2, bits);
+	}
+}
+
+static void hash_add_string(BLI_HashMurmur2A *mm2, const char *str)
+{
+	for (; *str; str++)
+		BLI_hash_mm2a_add_int(mm2, *str);
+	BLI_hash_mm2a_add_int(mm2, 0);
+}
+
+unsigned int BL_RuntimePack::HashMesh(Mesh *mesh)
+{
+	BLI_HashMurmur2A mm2;
+	int i;
+
+	BLI_hash_mm2a_init(&mm2, 0);
+	BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+	BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+	BLI_hash_mm2a_add_int(&mm2, mesh->totloop);
+
+	for (i = 0; i < mesh->totvert; i++) {
+		const MVert& mv = mesh->mvert[i];
+		hash_add_floats(&mm2, mv.co, 3);
+		BLI_hash_mm2a_add_int(&mm2, mv.no[0]);
+		BLI_hash_mm2a_add_int(&mm2, mv.no[1]);
+		BLI_hash_mm2a_add_int(&mm2, mv.no[2]);
+	}
+
+	/* the selection flags are left out, they don't change the conversion */
+	for (i = 0; i < mesh->totpoly; i++) {
+		const MPoly& mp = mesh->mpoly[i];
+		BLI_hash_mm2a_add_int(&mm2, mp.loopstart);
+		BLI_hash_mm2a_add_int(&mm2, mp.totloop);
+		BLI_hash_mm2a_add_int(&mm2, mp.mat_nr);
+		BLI_hash_mm2a_add_int(&mm2, mp.flag & ME_SMOOTH);
+	}
+
+	for (i = 0; i < mesh->totloop; i++)
+		BLI_hash_mm2a_add_int(&mm2, mesh->mloop[i].v);
+
+	for (int l = 0; l < mesh->ldata.totlayer; l++) {
+		const CustomDataLayer& layer = mesh->ldata.layers[l];
+
+		if (layer.type == CD_MLOOPUV) {
+			const MLoopUV *mloopuv = (const MLoopUV *)layer.data;
+			BLI_hash_mm2a_add_int(&mm2, layer.type);
+			hash_add_string(&mm2, layer.name);
+			for (i = 0; i < mesh->totloop; i++)
+				hash_add_floats(&mm2, mloopuv[i].uv, 2);
+		}
+		else if (layer.type == CD_MLOOPCOL) {
+			const MLoopCol *mloopcol = (const MLoopCol *)layer.data;
+			BLI_hash_mm2a_add_int(&mm2, layer.type);
+			hash_add_string(&mm2, layer.name);
+			for (i = 0; i < mesh->totloop; i++) {
+				const MLoopCol& col = mloopcol[i];
+				BLI_hash_mm2a_add_int(&mm2, col.r | (col.g << 8) | (col.b << 16) | (col.a << 24));
+			}
+		}
+	}
+	BLI_hash_mm2a_add_int(&mm2, CustomData_get_active_layer(&mesh->ldata, CD_MLOOPUV));
+
+	/* the images by name, as the pack finds them back */
+	for (int l = 0; l < mesh->pdata.totlayer; l++) {
+		const CustomDataLayer& layer = mesh->pdata.layers[l];
+		const Image *ima = NULL;
+
+		if (layer.type != CD_MTEXPOLY)
+			continue;
+
+		const MTexPoly *mtpoly = (const MTexPoly *)layer.data;
+		for (i = 0; i < mesh->totpoly; i++) {
+			const MTexPoly& tp = mtpoly[i];
+			BLI_hash_mm2a_add_int(&mm2, tp.mode);
+			BLI_hash_mm2a_add_int(&mm2, tp.transp);
+			BLI_hash_mm2a_add_int(&mm2, tp.tile);
+			if (tp.tpage != ima) {
+				ima = tp.tpage;
+				hash_add_string(&mm2, ima ? ima->id.name : "");
+			}
+		}
+	}
+
+	return BLI_hash_mm2a_end(&mm2);
+}
+
+/* ------------------------------------------------------------------------- */
+/* baking */
+
+/* the meshes using linked images can't find them back by name */
+static bool mesh_uses_linked_images(const BL_MeshArrays& arrays)
+{
+	for (int l = 0; l < arrays.m_numLayers; l++) {
+		for (int i = 0; i < arrays.m_totface; i++) {
+			const Image *ima = arrays.m_layers[l][i].tpage;
+			if (ima && ima->id.lib)
+				return true;
+		}
+	}
+	return false;
+}
+
+bool BL_RuntimePack::Bake(Main *maggie, bool bigEndian)
+{
+	char packpath[FILE_MAX];
+	GetPath(maggie->name, packpath);
+
+	BL_RuntimePackWriter writer(bigEndian);
+	for (Mesh *mesh = (Mesh *)maggie->mesh.first; mesh; mesh = (Mesh *)mesh->id.next) {
+		if (mesh->id.lib)
+			continue;
+
+		BL_MeshArrays arrays;
+		arrays.FromMesh(mesh);
+
+		if (mesh_uses_linked_images(arrays)) {
+			printf("Runtime pack: %s skipped, it uses linked images\n", mesh->id.name + 2);
+			continue;
+		}
+
+		writer.AddMesh(mesh->id.name, HashMesh(mesh), arrays);
+	}
+
+	if (!writer.Write(packpath)) {
+		printf("Runtime pack: couldn't write %s\n", packpath);
+		return false;
+	}
+
+	printf("Runtime pack: %d meshes, %d images, %u bytes written to %s (%s endian)\n",
+	       writer.GetNumMeshes(), writer.GetNumImages(), (unsigned int)writer.GetSize(), packpath,
+	       bigEndian ? "big" : "little");
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* loading */
+
+bool BL_RuntimePack::GetMesh(Mesh *mesh, BL_MeshArrays& arrays)
+{
+	/* only hash the meshes that were baked */
+	if (mesh->id.lib || !m_meshes[STR_HashedString(mesh->id.name)])
+		return false;
+
+	return GetMesh(mesh->id.name, HashMesh(mesh), arrays);
+}
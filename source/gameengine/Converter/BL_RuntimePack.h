@@ -0,0 +1,182 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_RuntimePack.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_RUNTIMEPACK_H__
+#define __BL_RUNTIMEPACK_H__
+
+#include <vector>
+#include <map>
+
+#include "CTR_Map.h"
+#include "STR_HashedString.h"
+
+#include "DNA_customdata_types.h"
+
+#include "BLI_sys_types.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+struct DerivedMesh;
+struct Image;
+struct Main;
+struct Mesh;
+struct MCol;
+struct MFace;
+struct MTFace;
+struct MVert;
+
+/**
+ * The tessellated arrays of a mesh read by BL_ConvertMesh(), from a derived mesh
+ * or from a runtime pack. The arrays are valid while this object lives.
+ */
+class BL_MeshArrays
+{
+public:
+	BL_MeshArrays();
+	~BL_MeshArrays();
+
+	/// Tessellate the mesh and compute the tangents of its active uv layer.
+	void FromMesh(struct Mesh *mesh);
+
+	MVert *m_mvert;
+	MFace *m_mface;
+	MCol *m_mcol;
+	float (*m_tangent)[4];
+	/* the uv layers, the active one is also in m_tface */
+	MTFace *m_layers[MAX_MTFACE];
+	const char *m_layerNames[MAX_MTFACE];
+	MTFace *m_tface;
+	int m_numLayers;
+	int m_totvert;
+	int m_totface;
+
+private:
+	friend class BL_RuntimePack;
+
+	/* not copyable, the arrays belong to the derived mesh or to this */
+	BL_MeshArrays(const BL_MeshArrays&);
+	BL_MeshArrays& operator=(const BL_MeshArrays&);
+
+	DerivedMesh *m_dm;
+	/* the uv layers read from a pack, with their image pointers */
+	bool m_ownLayers;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_MeshArrays")
+#endif
+};
+
+/**
+ * A runtime pack holds the tessellated meshes of a .blend file, baked offline by
+ * blenderplayer (-g bake) for the byte order of the target. The player maps the
+ * pack next to the file it starts and converts the meshes from it, skipping the
+ * derived mesh, the tessellation and the tangents.
+ *
+ * Everything in the file is addressed by offsets from its start and the image
+ * pointers of the uv layers are stored as indices in a table of image names, so
+ * the vertex and face arrays are used in place. Each mesh is stored with a hash
+ * of the mesh data it was baked from and is only used while the hash matches.
+ * A pack of the other byte order is switched in memory when opened.
+ */
+class BL_RuntimePack
+{
+public:
+	~BL_RuntimePack();
+
+	/// The pack of a .blend file: the same path with the .bgepack extension.
+	static void GetPath(const char *blendpath, char *r_packpath);
+
+	/// Map the pack of a .blend file, NULL when it is missing or damaged.
+	static BL_RuntimePack *Open(struct Main *maggie);
+
+	/// Map a pack, its images are looked up in \a maggie. NULL when it is missing or damaged.
+	static BL_RuntimePack *OpenFile(const char *packpath, struct Main *maggie);
+
+	/// Write the pack of the local meshes of a file, in big or little endian order.
+	static bool Bake(struct Main *maggie, bool bigEndian);
+
+	/// Hash of the data of a mesh the baked arrays depend on, the same on all byte orders.
+	static unsigned int HashMesh(struct Mesh *mesh);
+
+	/// Point the arrays to the baked mesh, false when the mesh isn't in the pack or changed since.
+	bool GetMesh(struct Mesh *mesh, BL_MeshArrays& arrays);
+
+	/// Point the arrays to the mesh baked under this name and hash.
+	bool GetMesh(const char *name, unsigned int hash, BL_MeshArrays& arrays);
+
+private:
+	BL_RuntimePack(struct Main *maggie, char *data, size_t size, bool mapped);
+
+	struct Main *m_maggie;
+	char *m_data;
+	size_t m_size;
+	bool m_mapped;
+	/* the mesh records by name */
+	CTR_Map<STR_HashedString, int> m_meshes;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_RuntimePack")
+#endif
+};
+
+/**
+ * Builds a runtime pack in memory, see BL_RuntimePack::Bake().
+ */
+class BL_RuntimePackWriter
+{
+public:
+	BL_RuntimePackWriter(bool bigEndian);
+
+	/// Copy the arrays of a mesh, \a hash is the one of BL_RuntimePack::HashMesh().
+	void AddMesh(const char *name, unsigned int hash, const BL_MeshArrays& arrays);
+
+	/// Finish the pack in the byte order of the target and write it, once.
+	bool Write(const char *packpath);
+
+	int GetNumMeshes() const;
+	int GetNumImages() const;
+	size_t GetSize() const;
+
+private:
+	/// Room for size bytes, zeroed, at an aligned offset.
+	uint64_t Reserve(size_t size);
+
+	std::vector<char> m_data;
+	/* the mesh records, copied after the arrays */
+	std::vector<char> m_meshes;
+	int m_numMeshes;
+	/* image table index, from 1 */
+	std::map<struct Image *, int> m_images;
+	bool m_bigEndian;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_RuntimePackWriter")
+#endif
+};
+
+#endif  /* __BL_RUNTIMEPACK_H__ */
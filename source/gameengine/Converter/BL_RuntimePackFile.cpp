@@ -0,0 +1,589 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Converter/BL_RuntimePackFile.cpp
+ *  \ingroup bgeconv
+ *
+ * The file format of the runtime packs, reading and writing. The Blender data
+ * side (tessellation, mesh hashes, baking a file) is in BL_RuntimePack.cpp.
+ */
+
+#if defined(__wii__) || defined(__vita__) || defined(__3DS__)
+#  include <unistd.h>
+#else
+#  define PACK_MMAP
+#  ifdef _WIN32
+#    include <io.h>
+#    include "mmap_win.h"
+#  else
+#    include <unistd.h>
+#    include <sys/mman.h>
+#  endif
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+
+#include "BL_RuntimePack.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+#include "DNA_image_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_sys_types.h"
+#include "BLI_utildefines.h"
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_string.h"
+
+#include "BKE_global.h"
+#include "BKE_main.h"
+
+extern "C" {
+#include "BLI_endian_switch.h"
+#include "BKE_DerivedMesh.h"
+}
+
+/* ------------------------------------------------------------------------- */
+/* file layout, only fixed size fields so that 32 and 64 bit targets read the same */
+
+#define PACK_VERSION 2
+/* read back as is by the target when the pack has its byte order */
+#define PACK_ENDIAN 0x01020304
+/* all the tables and arrays start on this boundary */
+#define PACK_ALIGN 16
+
+static const char pack_magic[8] = {'B', 'G', 'E', 'P', 'A', 'C', 'K', '\0'};
+
+typedef struct PackHeader {
+	char magic[8];
+	int endian;
+	int version;
+	int nummeshes;
+	int numimages;
+	/* offsets of the PackMesh and PackImage tables */
+	uint64_t meshes;
+	uint64_t images;
+} PackHeader;
+
+typedef struct PackImage {
+	char name[MAX_ID_NAME];
+} PackImage;
+
+typedef struct PackMesh {
+	char name[MAX_ID_NAME];
+	char pad[6];
+	char layernames[MAX_MTFACE][MAX_CUSTOMDATA_LAYER_NAME];
+	int totvert;
+	int totface;
+	int numlayers;
+	int activelayer;
+	/* BL_RuntimePack::HashMesh() of the mesh when baked */
+	unsigned int hash;
+	int pad2;
+	/* offsets of the arrays, 0 when missing */
+	uint64_t mvert, mface, mcol, tangent;
+	uint64_t layers[MAX_MTFACE];
+} PackMesh;
+
+/* MTFace with an index in the image table, 0 for none, instead of a pointer */
+typedef struct PackTFace {
+	float uv[4][2];
+	int tpage;
+	char flag, transp;
+	short mode, tile, unwrap;
+} PackTFace;
+
+/* ------------------------------------------------------------------------- */
+/* validation, on data in the byte order of this machine */
+
+static bool pack_in_range(uint64_t offset, uint64_t len, size_t size)
+{
+	return ((offset & (PACK_ALIGN - 1)) == 0 && offset <= size && len <= size - offset);
+}
+
+static bool pack_header_valid(const PackHeader *header, size_t size)
+{
+	/* the counts are checked first so the products can't overflow */
+	return (header->nummeshes >= 0 && header->numimages >= 0 &&
+	        pack_in_range(header->meshes, sizeof(PackMesh) * (uint64_t)header->nummeshes, size) &&
+	        pack_in_range(header->images, sizeof(PackImage) * (uint64_t)header->numimages, size));
+}
+
+static bool pack_mesh_valid(const PackMesh *pm, size_t size)
+{
+	if (pm->totvert < 0 || pm->totface < 0 || pm->numlayers < 0 || pm->numlayers > MAX_MTFACE ||
+	    pm->activelayer < -1 || pm->activelayer >= pm->numlayers ||
+	    pm->name[MAX_ID_NAME - 1] != '\0')
+	{
+		return false;
+	}
+
+	const uint64_t totface = (uint64_t)pm->totface;
+	if (!pack_in_range(pm->mvert, sizeof(MVert) * (uint64_t)pm->totvert, size) ||
+	    !pack_in_range(pm->mface, sizeof(MFace) * totface, size) ||
+	    (pm->mcol && !pack_in_range(pm->mcol, sizeof(MCol) * 4 * totface, size)) ||
+	    (pm->tangent && !pack_in_range(pm->tangent, sizeof(float[4]) * 4 * totface, size)))
+	{
+		return false;
+	}
+
+	for (int l = 0; l < pm->numlayers; l++) {
+		if (!pack_in_range(pm->layers[l], sizeof(PackTFace) * totface, size) ||
+		    pm->layernames[l][MAX_CUSTOMDATA_LAYER_NAME - 1] != '\0')
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+
+BL_MeshArrays::BL_MeshArrays()
+	:m_mvert(NULL),
+	m_mface(NULL),
+	m_mcol(NULL),
+	m_tangent(NULL),
+	m_tface(NULL),
+	m_numLayers(0),
+	m_totvert(0),
+	m_totface(0),
+	m_dm(NULL),
+	m_ownLayers(false)
+{
+	for (int i = 0; i < MAX_MTFACE; i++) {
+		m_layers[i] = NULL;
+		m_layerNames[i] = "";
+	}
+}
+
+BL_MeshArrays::~BL_MeshArrays()
+{
+	if (m_ownLayers) {
+		for (int i = 0; i < m_numLayers; i++)
+			MEM_freeN(m_layers[i]);
+	}
+	if (m_dm)
+		m_dm->release(m_dm);
+}
+
+/* ------------------------------------------------------------------------- */
+/* byte order */
+
+static void pack_switch_header(PackHeader *header)
+{
+	BLI_endian_switch_int32(&header->endian);
+	BLI_endian_switch_int32(&header->version);
+	BLI_endian_switch_int32(&header->nummeshes);
+	BLI_endian_switch_int32(&header->numimages);
+	BLI_endian_switch_uint64(&header->meshes);
+	BLI_endian_switch_uint64(&header->images);
+}
+
+static void pack_switch_mesh(PackMesh *pm)
+{
+	BLI_endian_switch_int32_array(&pm->totvert, 6);
+	BLI_endian_switch_uint64_array(&pm->mvert, 4 + MAX_MTFACE);
+}
+
+/* the mesh record is in the order of this machine, the arrays aren't yet */
+static void pack_switch_arrays(char *data, const PackMesh *pm)
+{
+	MVert *mvert = (MVert *)(data + pm->mvert);
+	for (int i = 0; i < pm->totvert; i++) {
+		BLI_endian_switch_float_array(mvert[i].co, 3);
+		BLI_endian_switch_int16_array(mvert[i].no, 3);
+	}
+
+	MFace *mface = (MFace *)(data + pm->mface);
+	for (int i = 0; i < pm->totface; i++) {
+		BLI_endian_switch_uint32(&mface[i].v1);
+		BLI_endian_switch_uint32(&mface[i].v2);
+		BLI_endian_switch_uint32(&mface[i].v3);
+		BLI_endian_switch_uint32(&mface[i].v4);
+		BLI_endian_switch_int16(&mface[i].mat_nr);
+	}
+
+	/* the colors are bytes only */
+	if (pm->tangent)
+		BLI_endian_switch_float_array((float *)(data + pm->tangent), 16 * pm->totface);
+
+	for (int l = 0; l < pm->numlayers; l++) {
+		PackTFace *ptface = (PackTFace *)(data + pm->layers[l]);
+		for (int i = 0; i < pm->totface; i++) {
+			BLI_endian_switch_float_array(&ptface[i].uv[0][0], 8);
+			BLI_endian_switch_int32(&ptface[i].tpage);
+			BLI_endian_switch_int16(&ptface[i].mode);
+			BLI_endian_switch_int16(&ptface[i].tile);
+			BLI_endian_switch_int16(&ptface[i].unwrap);
+		}
+	}
+}
+
+/**
+ * Switch the byte order of a whole pack in place, \a native tells if the pack is in
+ * the order of this machine before the switch. The ranges are checked on the native
+ * side, the arrays of a damaged mesh are left as they are and rejected by GetMesh().
+ * False when the tables are out of the data.
+ */
+static bool pack_switch_endian(char *data, size_t size, bool native)
+{
+	PackHeader *header = (PackHeader *)data;
+	PackHeader nheader;
+
+	if (!native)
+		pack_switch_header(header);
+	nheader = *header;
+	if (native)
+		pack_switch_header(header);
+
+	if (!pack_header_valid(&nheader, size))
+		return false;
+
+	PackMesh *meshes = (PackMesh *)(data + nheader.meshes);
+	for (int i = 0; i < nheader.nummeshes; i++) {
+		PackMesh npm;
+
+		if (!native)
+			pack_switch_mesh(&meshes[i]);
+		npm = meshes[i];
+		if (native)
+			pack_switch_mesh(&meshes[i]);
+
+		if (pack_mesh_valid(&npm, size))
+			pack_switch_arrays(data, &npm);
+	}
+	return true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* writing */
+
+BL_RuntimePackWriter::BL_RuntimePackWriter(bool bigEndian)
+	:m_numMeshes(0),
+	m_bigEndian(bigEndian)
+{
+	Reserve(sizeof(PackHeader));
+}
+
+uint64_t BL_RuntimePackWriter::Reserve(size_t size)
+{
+	const size_t offset = (m_data.size() + PACK_ALIGN - 1) & ~(size_t)(PACK_ALIGN - 1);
+	m_data.resize(offset + size, 0);
+	return offset;
+}
+
+void BL_RuntimePackWriter::AddMesh(const char *name, unsigned int hash, const BL_MeshArrays& arrays)
+{
+	const size_t totvert = arrays.m_totvert;
+	const size_t totface = arrays.m_totface;
+	PackMesh pm;
+
+	memset(&pm, 0, sizeof(pm));
+	BLI_strncpy(pm.name, name, sizeof(pm.name));
+	pm.totvert = arrays.m_totvert;
+	pm.totface = arrays.m_totface;
+	pm.numlayers = arrays.m_numLayers;
+	pm.activelayer = -1;
+	pm.hash = hash;
+
+	pm.mvert = Reserve(sizeof(MVert) * totvert);
+	memcpy(&m_data[pm.mvert], arrays.m_mvert, sizeof(MVert) * totvert);
+	pm.mface = Reserve(sizeof(MFace) * totface);
+	memcpy(&m_data[pm.mface], arrays.m_mface, sizeof(MFace) * totface);
+	if (arrays.m_mcol) {
+		pm.mcol = Reserve(sizeof(MCol) * 4 * totface);
+		memcpy(&m_data[pm.mcol], arrays.m_mcol, sizeof(MCol) * 4 * totface);
+	}
+	if (arrays.m_tangent) {
+		pm.tangent = Reserve(sizeof(float[4]) * 4 * totface);
+		memcpy(&m_data[pm.tangent], arrays.m_tangent, sizeof(float[4]) * 4 * totface);
+	}
+
+	/* the image pointers are replaced by their index in the image table */
+	for (int l = 0; l < arrays.m_numLayers; l++) {
+		BLI_strncpy(pm.layernames[l], arrays.m_layerNames[l], sizeof(pm.layernames[l]));
+		if (arrays.m_layers[l] == arrays.m_tface)
+			pm.activelayer = l;
+
+		pm.layers[l] = Reserve(sizeof(PackTFace) * totface);
+		PackTFace *data = (PackTFace *)&m_data[pm.layers[l]];
+		for (size_t i = 0; i < totface; i++) {
+			const MTFace& tf = arrays.m_layers[l][i];
+			PackTFace& ptf = data[i];
+
+			memcpy(ptf.uv, tf.uv, sizeof(ptf.uv));
+			ptf.flag = tf.flag;
+			ptf.transp = tf.transp;
+			ptf.mode = tf.mode;
+			ptf.tile = tf.tile;
+			ptf.unwrap = tf.unwrap;
+			ptf.tpage = 0;
+			if (tf.tpage) {
+				std::map<Image *, int>::iterator it = m_images.find(tf.tpage);
+				if (it == m_images.end())
+					it = m_images.insert(std::make_pair(tf.tpage, (int)m_images.size() + 1)).first;
+				ptf.tpage = it->second;
+			}
+		}
+	}
+
+	m_meshes.insert(m_meshes.end(), (const char *)&pm, (const char *)(&pm + 1));
+	m_numMeshes++;
+}
+
+bool BL_RuntimePackWriter::Write(const char *packpath)
+{
+	const uint64_t meshesoffset = Reserve(m_meshes.size());
+	if (!m_meshes.empty())
+		memcpy(&m_data[meshesoffset], &m_meshes[0], m_meshes.size());
+
+	/* image names by index, from 1 */
+	const uint64_t imagesoffset = Reserve(sizeof(PackImage) * m_images.size());
+	PackImage *images = (PackImage *)&m_data[imagesoffset];
+	for (std::map<Image *, int>::iterator it = m_images.begin(); it != m_images.end(); ++it)
+		BLI_strncpy(images[it->second - 1].name, it->first->id.name, MAX_ID_NAME);
+
+	PackHeader *header = (PackHeader *)&m_data[0];
+	memcpy(header->magic, pack_magic, sizeof(header->magic));
+	header->endian = PACK_ENDIAN;
+	header->version = PACK_VERSION;
+	header->nummeshes = m_numMeshes;
+	header->numimages = (int)m_images.size();
+	header->meshes = meshesoffset;
+	header->images = imagesoffset;
+
+	if (m_bigEndian != (ENDIAN_ORDER == B_ENDIAN))
+		pack_switch_endian(&m_data[0], m_data.size(), true);
+
+	FILE *fp = BLI_fopen(packpath, "wb");
+	if (!fp)
+		return false;
+	const bool ok = (fwrite(&m_data[0], 1, m_data.size(), fp) == m_data.size());
+	fclose(fp);
+	return ok;
+}
+
+int BL_RuntimePackWriter::GetNumMeshes() const
+{
+	return m_numMeshes;
+}
+
+int BL_RuntimePackWriter::GetNumImages() const
+{
+	return (int)m_images.size();
+}
+
+size_t BL_RuntimePackWriter::GetSize() const
+{
+	return m_data.size();
+}
+
+/* ------------------------------------------------------------------------- */
+/* loading */
+
+void BL_RuntimePack::GetPath(const char *blendpath, char *r_packpath)
+{
+	BLI_strncpy(r_packpath, blendpath, FILE_MAX);
+	BLI_replace_extension(r_packpath, FILE_MAX, ".bgepack");
+}
+
+BL_RuntimePack *BL_RuntimePack::Open(Main *maggie)
+{
+	char packpath[FILE_MAX];
+	GetPath(maggie->name, packpath);
+	return OpenFile(packpath, maggie);
+}
+
+static void pack_free(char *data, size_t size, bool mapped)
+{
+#ifdef PACK_MMAP
+	if (mapped) {
+		munmap(data, size);
+		return;
+	}
+#else
+	(void)size;
+	(void)mapped;
+#endif
+	MEM_freeN(data);
+}
+
+BL_RuntimePack *BL_RuntimePack::OpenFile(const char *packpath, Main *maggie)
+{
+	const int file = BLI_open(packpath, O_BINARY | O_RDONLY, 0);
+	if (file == -1)
+		return NULL;
+
+	const size_t size = BLI_file_descriptor_size(file);
+	if (size == (size_t)-1 || size < sizeof(PackHeader)) {
+		close(file);
+		return NULL;
+	}
+
+#ifdef PACK_MMAP
+	/* private and writable so that a pack of the other byte order can be switched,
+	 * the pages are only copied then */
+	char *data = (char *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	close(file);
+	const bool mapped = true;
+	if (data == (char *)MAP_FAILED)
+		return NULL;
+#else
+	/* no mapping, the pack is read at once */
+	char *data = (char *)MEM_mallocN(size, "BL_RuntimePack");
+	size_t done = 0;
+	while (done < size) {
+		const int len = read(file, data + done, size - done);
+		if (len <= 0)
+			break;
+		done += len;
+	}
+	close(file);
+	const bool mapped = false;
+	if (done != size) {
+		MEM_freeN(data);
+		return NULL;
+	}
+#endif
+
+	PackHeader header = *(const PackHeader *)data;
+	const bool native = (header.endian == PACK_ENDIAN);
+	const char *error = NULL;
+	if (!native)
+		pack_switch_header(&header);
+
+	if (memcmp(header.magic, pack_magic, sizeof(pack_magic)) != 0)
+		error = "not a runtime pack";
+	else if (header.endian != PACK_ENDIAN)
+		error = "unknown byte order";
+	else if (header.version != PACK_VERSION)
+		error = "baked by another version";
+	else if (!pack_header_valid(&header, size))
+		error = "truncated";
+	else if (!native) {
+		printf("Runtime pack %s: baked for the other byte order, switched while loading\n", packpath);
+		pack_switch_endian(data, size, false);
+	}
+
+	if (error) {
+		printf("Runtime pack %s ignored: %s\n", packpath, error);
+		pack_free(data, size, mapped);
+		return NULL;
+	}
+
+	return new BL_RuntimePack(maggie, data, size, mapped);
+}
+
+BL_RuntimePack::BL_RuntimePack(Main *maggie, char *data, size_t size, bool mapped)
+	:m_maggie(maggie),
+	m_data(data),
+	m_size(size),
+	m_mapped(mapped)
+{
+	const PackHeader *header = (const PackHeader *)m_data;
+	const PackMesh *meshes = (const PackMesh *)(m_data + header->meshes);
+
+	for (int i = 0; i < header->nummeshes; i++) {
+		if (meshes[i].name[MAX_ID_NAME - 1] == '\0')
+			m_meshes.insert(STR_HashedString(meshes[i].name), i);
+	}
+}
+
+BL_RuntimePack::~BL_RuntimePack()
+{
+	pack_free(m_data, m_size, m_mapped);
+}
+
+static Image *pack_find_image(Main *maggie, const PackImage *images, int numimages, int tpage)
+{
+	if (tpage <= 0 || tpage > numimages)
+		return NULL;
+
+	const char *name = images[tpage - 1].name;
+	if (BLI_strnlen(name, MAX_ID_NAME) == MAX_ID_NAME)
+		return NULL;
+	return (Image *)BLI_findstring(&maggie->image, name, offsetof(ID, name));
+}
+
+bool BL_RuntimePack::GetMesh(const char *name, unsigned int hash, BL_MeshArrays& arrays)
+{
+	int *index = m_meshes[STR_HashedString(name)];
+	if (!index)
+		return false;
+
+	const PackHeader *header = (const PackHeader *)m_data;
+	const PackMesh *pm = (const PackMesh *)(m_data + header->meshes) + *index;
+
+	/* the mesh was edited since the bake, or the pack is damaged */
+	if (pm->hash != hash || !pack_mesh_valid(pm, m_size))
+		return false;
+
+	arrays.m_mvert = (MVert *)(m_data + pm->mvert);
+	arrays.m_totvert = pm->totvert;
+	arrays.m_mface = (MFace *)(m_data + pm->mface);
+	arrays.m_totface = pm->totface;
+	arrays.m_mcol = pm->mcol ? (MCol *)(m_data + pm->mcol) : NULL;
+	arrays.m_tangent = pm->tangent ? (float (*)[4])(m_data + pm->tangent) : NULL;
+
+	/* the images are found back by name */
+	const PackImage *images = (const PackImage *)(m_data + header->images);
+	arrays.m_numLayers = pm->numlayers;
+	arrays.m_ownLayers = true;
+	for (int l = 0; l < pm->numlayers; l++) {
+		const PackTFace *ptface = (const PackTFace *)(m_data + pm->layers[l]);
+		MTFace *tface = (MTFace *)MEM_mallocN(sizeof(MTFace) * pm->totface, "BL_MeshArrays layer");
+		Image *ima = NULL;
+		int tpage = 0;
+
+		for (int i = 0; i < pm->totface; i++) {
+			const PackTFace& ptf = ptface[i];
+			MTFace& tf = tface[i];
+
+			memcpy(tf.uv, ptf.uv, sizeof(tf.uv));
+			tf.flag = ptf.flag;
+			tf.transp = ptf.transp;
+			tf.mode = ptf.mode;
+			tf.tile = ptf.tile;
+			tf.unwrap = ptf.unwrap;
+
+			/* the faces of a layer mostly share an image */
+			if (ptf.tpage != tpage) {
+				tpage = ptf.tpage;
+				ima = pack_find_image(m_maggie, images, header->numimages, tpage);
+			}
+			tf.tpage = ima;
+		}
+
+		arrays.m_layers[l] = tface;
+		arrays.m_layerNames[l] = pm->layernames[l];
+	}
+	arrays.m_tface = (pm->activelayer >= 0) ? arrays.m_layers[pm->activelayer] : NULL;
+
+	return true;
+}
@@ -36,6 +36,8 @@
 #include "BL_ShapeActionActuator.h"
 #include "BL_ShapeDeformer.h"
 #include "KX_GameObject.h"
+#include "KX_Scene.h"
+#include "KX_BlenderSceneConverter.h"
 #include "STR_HashedString.h"
 #include "DNA_nla_types.h"
 #include "DNA_action_types.h"
@@ -105,6 +107,14 @@ void BL_ShapeActionActuator::ProcessReplica()
 	m_lastUpdate=-1;
 }
 
+void BL_ShapeActionActuator::ResetReplica()
+{
+	SCA_IActuator::ResetReplica();
+	m_flag = 0;
+	m_localtime=m_startframe;
+	m_lastUpdate=-1;
+}
+
 void BL_ShapeActionActuator::SetBlendTime(float newtime)
 {
 	m_blendframe = newtime;
@@ -553,6 +563,12 @@ int BL_ShapeActionActuator::pyattr_set_action(void *self_v, const KX_PYATTRIBUTE
 			PyErr_SetString(PyExc_ValueError, "actuator.action = val: Shape Action Actuator, action not found!");
 			return PY_SET_ATTR_FAIL;
 		}
+
+		// the action may come from a library, it is cleared when the library is freed
+		KX_GameObject *obj = (KX_GameObject *)self->GetParent();
+		KX_BlenderSceneConverter *converter = obj->GetScene()->GetSceneConverter();
+		if (converter)
+			converter->RegisterActionUser(obj, action);
 	}
 	
 	self->SetAction(action);
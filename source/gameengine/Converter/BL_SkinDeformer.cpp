@@ -38,6 +38,9 @@
 #include <Eigen/LU>
 
 #include "BL_SkinDeformer.h"
+#include "BL_SkinKernel.h"
+#include "KX_KetsjiEngine.h"
+#include "KX_PythonInit.h"
 #include "CTR_Map.h"
 #include "STR_HashedString.h"
 #include "RAS_IPolygonMaterial.h"
@@ -96,7 +99,8 @@ BL_SkinDeformer::BL_SkinDeformer(BL_DeformableGameObject *gameobj,
 							m_poseApplied(false),
 							m_recalcNormal(true),
 							m_copyNormals(false),
-							m_dfnrToPC(NULL)
+							m_dfnrToPC(NULL),
+							m_kernel(NULL)
 {
 	copy_m4_m4(m_obmat, bmeshobj->obmat);
 	m_deformflags = get_deformflags(bmeshobj);
@@ -117,7 +121,8 @@ BL_SkinDeformer::BL_SkinDeformer(
 		m_releaseobject(release_object),
 		m_recalcNormal(recalc_normal),
 		m_copyNormals(false),
-		m_dfnrToPC(NULL)
+		m_dfnrToPC(NULL),
+		m_kernel(NULL)
 	{
 		// this is needed to ensure correct deformation of mesh:
 		// the deformation is done with Blender's armature_deform_verts() function
@@ -134,6 +139,7 @@ BL_SkinDeformer::~BL_SkinDeformer()
 		m_armobj->Release();
 	if (m_dfnrToPC)
 		delete [] m_dfnrToPC;
+	delete m_kernel;
 }
 
 void BL_SkinDeformer::Relink(CTR_Map<class CTR_HashedPtr, void*>*map)
@@ -172,6 +178,7 @@ void BL_SkinDeformer::ProcessReplica()
 	m_lastArmaUpdate = -1;
 	m_releaseobject = false;
 	m_dfnrToPC = NULL;
+	m_kernel = NULL;
 }
 
 void BL_SkinDeformer::BlenderDeformVerts()
@@ -201,7 +208,7 @@ void BL_SkinDeformer::BGEDeformVerts()
 	MDeformVert *dverts = m_bmesh->dvert;
 	bDeformGroup *dg;
 	int defbase_tot;
-	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
+	Eigen::Matrix4f pre_mat, post_mat;
 
 	if (!dverts)
 		return;
@@ -223,69 +230,32 @@ void BL_SkinDeformer::BGEDeformVerts()
 		}
 	}
 
-	post_mat = Eigen::Matrix4f::Map((float*)m_obmat).inverse() * Eigen::Matrix4f::Map((float*)m_armobj->GetArmatureObject()->obmat);
-	pre_mat = post_mat.inverse();
-
-	MDeformVert *dv= dverts;
-	MDeformWeight *dw;
-
-	for (int i=0; i<m_bmesh->totvert; ++i, dv++)
+	// The weights don't change, the groups that deform get a bone of the palette in their order
+	if (m_kernel == NULL)
 	{
-		float contrib = 0.f, weight, max_weight=-1.f;
-		bPoseChannel *pchan=NULL;
-		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(m_transnors[i]);
-		Eigen::Vector4f vec(0, 0, 0, 1);
-		Eigen::Vector4f co(m_transverts[i][0],
-							m_transverts[i][1],
-							m_transverts[i][2],
-							1.f);
-
-		if (!dv->totweight)
-			continue;
-
-		co = pre_mat * co;
-
-		dw= dv->dw;
-
-		for (unsigned int j= dv->totweight; j != 0; j--, dw++)
-		{
-			const int index = dw->def_nr;
-
-			if (index < defbase_tot && (pchan=m_dfnrToPC[index]))
-			{
-				weight = dw->weight;
-
-				if (weight)
-				{
-					chan_mat = Eigen::Matrix4f::Map((float*)pchan->chan_mat);
+		int *groupBones = new int[defbase_tot];
+		int numBones = 0;
+		for (int i = 0; i < defbase_tot; ++i)
+			groupBones[i] = m_dfnrToPC[i] ? numBones++ : -1;
 
-					// Update Vertex Position
-					vec.noalias() += (chan_mat*co - co)*weight;
+		m_kernel = new BL_SkinKernel(dverts, m_bmesh->totvert, groupBones, defbase_tot, numBones);
+		delete [] groupBones;
+	}
 
-					// Save the most influential channel so we can use it to update the vertex normal
-					if (weight > max_weight)
-					{
-						max_weight = weight;
-						norm_chan_mat = chan_mat;
-					}
+	post_mat = Eigen::Matrix4f::Map((float*)m_obmat).inverse() * Eigen::Matrix4f::Map((float*)m_armobj->GetArmatureObject()->obmat);
+	pre_mat = post_mat.inverse();
 
-					contrib += weight;
-				}
-			}
+	// A bone moves a vertex from the mesh space to the armature space, to its pose and back to the mesh space
+	float bone_mat[4][4];
+	for (int i = 0, bone = 0; i < defbase_tot; ++i)
+	{
+		if (m_dfnrToPC[i]) {
+			Eigen::Matrix4f::Map((float*)bone_mat) = post_mat * Eigen::Matrix4f::Map((float*)m_dfnrToPC[i]->chan_mat) * pre_mat;
+			m_kernel->SetBone(bone++, bone_mat);
 		}
-		
-		// Update Vertex Normal
-		norm = norm_chan_mat.topLeftCorner<3, 3>()*norm;
-
-		co.noalias() += vec/contrib;
-		co[3] = 1.f; // Make sure we have a 1 for the w component!
-
-		co = post_mat * co;
-
-		m_transverts[i][0] = co[0];
-		m_transverts[i][1] = co[1];
-		m_transverts[i][2] = co[2];
 	}
+
+	m_kernel->Deform(m_transverts, m_transnors, KX_GetActiveEngine()->GetTaskScheduler());
 	m_copyNormals = true;
 }
 
@@ -318,6 +288,9 @@ void BL_SkinDeformer::UpdateTransverts()
 					if (m_copyNormals)
 						v.SetNormal(m_transnors[v.getOrigIndex()]);
 				}
+				it.array->SetModified(RAS_DisplayArray::POSITION_MODIFIED |
+				                      (m_copyNormals ? RAS_DisplayArray::NORMAL_MODIFIED : 0),
+				                      it.startvertex, it.endvertex);
 			}
 		}
 
@@ -47,6 +47,7 @@
 
 #include "RAS_Deformer.h"
 
+class BL_SkinKernel;
 
 class BL_SkinDeformer : public BL_MeshDeformer  
 {
@@ -109,6 +110,8 @@ protected:
 	bool					m_recalcNormal;
 	bool					m_copyNormals; // dirty flag so we know if Apply() needs to copy normal information (used for BGEDeformVerts())
 	struct bPoseChannel**	m_dfnrToPC;
+	/* weights and bone palette of BGEDeformVerts(), built on the first deform */
+	BL_SkinKernel*			m_kernel;
 	short					m_deformflags;
 
 	void BlenderDeformVerts();
@@ -0,0 +1,156 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Converter/BL_SkinKernel.cpp
+ *  \ingroup bgeconv
+ */
+
+#include "BL_SkinKernel.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+
+BL_SkinKernel::BL_SkinKernel(const MDeformVert *dverts, int numVerts, const int *groupBones, int numGroups, int numBones)
+	:m_numVerts(numVerts),
+	m_numBones(numBones),
+	m_palette(numBones + 1, Eigen::Matrix4f::Identity()),
+	m_bones(MAX_INFLUENCES * numVerts, numBones),
+	m_weights(MAX_INFLUENCES * numVerts, 0.0f),
+	m_pool(NULL),
+	m_scheduler(NULL),
+	m_co(NULL),
+	m_no(NULL)
+{
+	for (int v = 0; v < numVerts; v++) {
+		const MDeformVert& dv = dverts[v];
+		unsigned short bones[MAX_INFLUENCES];
+		float weights[MAX_INFLUENCES];
+		int count = 0;
+
+		/* keep the largest influences, sorted by decreasing weight */
+		for (int j = 0; j < dv.totweight; j++) {
+			const MDeformWeight& dw = dv.dw[j];
+			if (dw.def_nr >= numGroups || groupBones[dw.def_nr] < 0 || dw.weight <= 0.0f)
+				continue;
+			if (count == MAX_INFLUENCES && dw.weight <= weights[count - 1])
+				continue;
+
+			int k = (count < MAX_INFLUENCES) ? count++ : count - 1;
+			for (; k > 0 && weights[k - 1] < dw.weight; k--) {
+				bones[k] = bones[k - 1];
+				weights[k] = weights[k - 1];
+			}
+			bones[k] = groupBones[dw.def_nr];
+			weights[k] = dw.weight;
+		}
+
+		if (count == 0) {
+			/* not deformed, the identity matrix with a full weight */
+			m_weights[v] = 1.0f;
+			continue;
+		}
+
+		float total = 0.0f;
+		for (int k = 0; k < count; k++)
+			total += weights[k];
+		for (int k = 0; k < count; k++) {
+			m_bones[k * numVerts + v] = bones[k];
+			m_weights[k * numVerts + v] = weights[k] / total;
+		}
+	}
+}
+
+BL_SkinKernel::~BL_SkinKernel()
+{
+	if (m_pool)
+		BLI_task_pool_free(m_pool);
+}
+
+void BL_SkinKernel::SetBone(int bone, const float mat[4][4])
+{
+	m_palette[bone] = Eigen::Matrix4f::Map((const float *)mat);
+}
+
+void BL_SkinKernel::DeformRange(float (*co)[3], float (*no)[3], int start, int end) const
+{
+	const Eigen::Matrix4f *palette = &m_palette[0];
+	const int n = m_numVerts;
+	const unsigned short *b0 = &m_bones[0], *b1 = b0 + n, *b2 = b1 + n, *b3 = b2 + n;
+	const float *w0 = &m_weights[0], *w1 = w0 + n, *w2 = w1 + n, *w3 = w2 + n;
+
+	for (int v = start; v < end; v++) {
+		/* the sum of the matrices and the products are done on 4 floats at once by Eigen */
+		Eigen::Matrix4f mat = palette[b0[v]] * w0[v];
+		mat.noalias() += palette[b1[v]] * w1[v];
+		mat.noalias() += palette[b2[v]] * w2[v];
+		mat.noalias() += palette[b3[v]] * w3[v];
+
+		const Eigen::Vector4f pos = mat * Eigen::Vector4f(co[v][0], co[v][1], co[v][2], 1.0f);
+		const Eigen::Vector4f nor = mat * Eigen::Vector4f(no[v][0], no[v][1], no[v][2], 0.0f);
+
+		co[v][0] = pos[0];
+		co[v][1] = pos[1];
+		co[v][2] = pos[2];
+		no[v][0] = nor[0];
+		no[v][1] = nor[1];
+		no[v][2] = nor[2];
+	}
+}
+
+void BL_SkinKernel::DeformTask(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	BL_SkinKernel *kernel = (BL_SkinKernel *)BLI_task_pool_userdata(pool);
+	const int start = GET_INT_FROM_POINTER(taskdata) * CHUNK_VERTS;
+	const int end = (start + CHUNK_VERTS < kernel->m_numVerts) ? start + CHUNK_VERTS : kernel->m_numVerts;
+
+	kernel->DeformRange(kernel->m_co, kernel->m_no, start, end);
+}
+
+void BL_SkinKernel::Deform(float (*co)[3], float (*no)[3], TaskScheduler *scheduler)
+{
+	if (!scheduler || m_numVerts < PARALLEL_VERTS) {
+		DeformRange(co, no, 0, m_numVerts);
+		return;
+	}
+
+	if (m_pool && m_scheduler != scheduler) {
+		BLI_task_pool_free(m_pool);
+		m_pool = NULL;
+	}
+	if (!m_pool) {
+		m_pool = BLI_task_pool_create(scheduler, this);
+		m_scheduler = scheduler;
+	}
+
+	m_co = co;
+	m_no = no;
+
+	const int chunks = (m_numVerts + CHUNK_VERTS - 1) / CHUNK_VERTS;
+	BLI_task_pool_reuse_tasks(m_pool, chunks);
+	for (int i = 0; i < chunks; i++)
+		BLI_task_pool_push(m_pool, DeformTask, SET_INT_IN_POINTER(i), false, TASK_PRIORITY_HIGH);
+
+	/* the calling thread, which can be an animation task, deforms chunks too */
+	BLI_task_pool_work_and_wait(m_pool);
+}
@@ -0,0 +1,111 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file BL_SkinKernel.h
+ *  \ingroup bgeconv
+ */
+
+#ifndef __BL_SKINKERNEL_H__
+#define __BL_SKINKERNEL_H__
+
+#include <Eigen/Core>
+#include <Eigen/StdVector>
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+struct MDeformVert;
+struct TaskPool;
+struct TaskScheduler;
+
+/**
+ * Linear blend skinning of the vertices of a mesh by a palette of bone matrices.
+ *
+ * The weights of the deform groups are read once: each vertex keeps its 4 largest
+ * influences, normalized, in arrays of bone indices and weights per influence. The
+ * palette has a matrix per bone going from the rest position to the posed one in
+ * mesh space, it is set each time the pose changes. A vertex is then deformed by
+ * the weighted sum of 4 palette matrices, the unused influences use an identity
+ * matrix with a zero weight so every vertex takes the same path.
+ *
+ * Large meshes are split over the threads of a task scheduler.
+ */
+class BL_SkinKernel
+{
+public:
+	enum {
+		MAX_INFLUENCES = 4,
+		/* meshes with less vertices are deformed by the calling thread alone */
+		PARALLEL_VERTS = 8192,
+		CHUNK_VERTS = 2048
+	};
+
+	/**
+	 * \param groupBones The palette index of each deform group, or -1 for the groups
+	 * that don't deform, \param numBones is the size of the palette.
+	 */
+	BL_SkinKernel(const MDeformVert *dverts, int numVerts, const int *groupBones, int numGroups, int numBones);
+	~BL_SkinKernel();
+
+	int GetNumBones() const
+	{
+		return m_numBones;
+	}
+
+	/// Set the matrix of a bone, in the column major layout of Blender matrices.
+	void SetBone(int bone, const float mat[4][4]);
+
+	/// Deform the positions and normals in place, with the threads of \param scheduler if it isn't NULL.
+	void Deform(float (*co)[3], float (*no)[3], TaskScheduler *scheduler);
+	void DeformRange(float (*co)[3], float (*no)[3], int start, int end) const;
+
+private:
+	typedef std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > Palette;
+
+	/* not copyable, replicas build their own */
+	BL_SkinKernel(const BL_SkinKernel&);
+	BL_SkinKernel& operator=(const BL_SkinKernel&);
+
+	static void DeformTask(TaskPool *pool, void *taskdata, int threadid);
+
+	int m_numVerts;
+	int m_numBones;
+	/* the bones then an identity matrix for the unused influences */
+	Palette m_palette;
+	/* MAX_INFLUENCES arrays of m_numVerts bone indices and weights */
+	std::vector<unsigned short> m_bones;
+	std::vector<float> m_weights;
+
+	/* kept between the deforms, with the arrays of the current one */
+	TaskPool *m_pool;
+	TaskScheduler *m_scheduler;
+	float (*m_co)[3];
+	float (*m_no)[3];
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:BL_SkinKernel")
+#endif
+};
+
+#endif  /* __BL_SKINKERNEL_H__ */
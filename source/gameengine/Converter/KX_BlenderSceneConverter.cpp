@@ -43,6 +43,7 @@
 #include "KX_PythonInit.h" // So we can handle adding new text datablocks for Python to import
 #include "BL_Material.h"
 #include "BL_ActionActuator.h"
+#include "BL_ShapeActionActuator.h"
 #include "KX_BlenderMaterial.h"
 
 
@@ -58,6 +59,7 @@
 #include "KX_LibLoadStatus.h"
 #include "KX_BlenderScalarInterpolator.h"
 #include "BL_BlenderDataConversion.h"
+#include "BL_RuntimePack.h"
 #include "KX_WorldInfo.h"
 
 /* This little block needed for linking to Blender... */
@@ -79,6 +81,7 @@ extern "C"
 #include "DNA_curve_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_material_types.h"
+#include "DNA_image_types.h"
 #include "BLI_blenlib.h"
 #include "MEM_guardedalloc.h"
 #include "BKE_global.h"
@@ -86,6 +89,9 @@ extern "C"
 #include "BKE_library.h"
 #include "BKE_material.h" // BKE_material_copy
 #include "BKE_mesh.h" // BKE_mesh_copy
+#include "BKE_image.h"
+#include "IMB_imbuf_types.h"
+#include "GPU_draw.h"
 #include "DNA_space_types.h"
 #include "DNA_anim_types.h"
 #include "DNA_action_types.h"
@@ -109,13 +115,37 @@ extern "C" {
 }
 
 #include <pthread.h>
+#include <algorithm>
+#include <set>
 
 /* This is used to avoid including pthread.h in KX_BlenderSceneConverter.h */
 typedef struct ThreadInfo {
 	vector<pthread_t>	threads;
 	pthread_mutex_t		merge_lock;
+	pthread_mutex_t		library_lock;
 } ThreadInfo;
 
+/* An async load being merged, its scenes go one after the other */
+typedef struct AsyncMerge {
+	KX_LibLoadStatus	*status;
+	unsigned int		scene;
+	KX_SceneMerge		merge;
+} AsyncMerge;
+
+/* What was converted from a dynamic main, the libraries of LibLoad and LibNew.
+ * Freeing the library only goes through these and not through the data of the
+ * other libraries or of the blend file */
+typedef struct LibraryData {
+	Main											*maggie;
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >	polymaterials;
+	vector<pair<KX_Scene *, BL_Material *> >		materials;
+	vector<pair<KX_Scene *, RAS_MeshObject *> >		meshobjects;
+	/* the objects converted from the library and their replicas, with their scene */
+	map<KX_GameObject *, KX_Scene *>				objects;
+	/* the objects that played or may play the actions of the library */
+	map<KX_GameObject *, KX_Scene *>				actionusers;
+} LibraryData;
+
 KX_BlenderSceneConverter::KX_BlenderSceneConverter(
 							Main *maggie,
 							KX_KetsjiEngine *engine)
@@ -124,12 +154,15 @@ KX_BlenderSceneConverter::KX_BlenderSceneConverter(
 							m_alwaysUseExpandFraming(false),
 							m_usemat(false),
 							m_useglslmat(false),
-							m_use_mat_cache(true)
+							m_use_mat_cache(true),
+							m_runtimePack(NULL)
 {
+	m_mergeBudget = 0.002; /* 2 ms of each frame */
 	BKE_main_id_tag_all(maggie, false);  /* avoid re-tagging later on */
 	m_newfilename = "";
 	m_threadinfo = new ThreadInfo();
 	pthread_mutex_init(&m_threadinfo->merge_lock, NULL);
+	pthread_mutex_init(&m_threadinfo->library_lock, NULL);
 }
 
 KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
@@ -145,9 +178,17 @@ KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
 		}
 
 		pthread_mutex_destroy(&m_threadinfo->merge_lock);
+		pthread_mutex_destroy(&m_threadinfo->library_lock);
 		delete m_threadinfo;
+		m_threadinfo = NULL;
 	}
 
+	// the scenes the async loads were merging into are gone
+	for (vector<AsyncMerge *>::iterator mit = m_merging.begin(); mit != m_merging.end(); ++mit)
+		delete *mit;
+	m_merging.clear();
+	m_mergequeue.clear();
+
 	int numAdtLists = m_map_blender_to_gameAdtList.size();
 	for (int i = 0; i < numAdtLists; i++) {
 		BL_InterpolatorList *adtList = *m_map_blender_to_gameAdtList.at(i);
@@ -184,12 +225,32 @@ KX_BlenderSceneConverter::~KX_BlenderSceneConverter()
 	}
 	m_meshobjects.clear();
 
+	/* same for the data of the libraries, FreeBlendFile then only frees their mains */
+	for (map<Main *, LibraryData *>::iterator libit = m_libraries.begin(); libit != m_libraries.end(); ++libit) {
+		LibraryData *library = libit->second;
+
+		for (itp = library->polymaterials.begin(); itp != library->polymaterials.end(); ++itp)
+			delete itp->second;
+		library->polymaterials.clear();
+
+		for (itmat = library->materials.begin(); itmat != library->materials.end(); ++itmat)
+			delete itmat->second;
+		library->materials.clear();
+
+		for (itm = library->meshobjects.begin(); itm != library->meshobjects.end(); ++itm)
+			delete itm->second;
+		library->meshobjects.clear();
+	}
+
 	/* free any data that was dynamically loaded */
 	while (m_DynamicMaggie.size() != 0) {
 		FreeBlendFile(m_DynamicMaggie[0]);
 	}
 
 	m_DynamicMaggie.clear();
+
+	if (m_runtimePack)
+		delete m_runtimePack;
 }
 
 void KX_BlenderSceneConverter::SetNewFileName(const STR_String &filename)
@@ -297,6 +358,16 @@ void KX_BlenderSceneConverter::ConvertScene(KX_Scene *destinationscene, RAS_IRas
 void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
 {
 	int i, size;
+
+	// the async loads going into the scene are merged before it goes
+	TakeAsyncLoads();
+	for (vector<AsyncMerge *>::iterator mit = m_merging.begin(); mit != m_merging.end(); ++mit) {
+		if ((*mit)->status->GetMergeScene() == scene) {
+			MergePendingLoads(0.0);
+			break;
+		}
+	}
+
 	// delete the scene first as it will stop the use of entities
 	delete scene;
 	// delete the entities of this scene
@@ -315,14 +386,49 @@ void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
 		}
 	}
 
+	RemoveSceneData(scene, m_polymaterials, m_materials, m_meshobjects);
+
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+	for (map<Main *, LibraryData *>::iterator libit = m_libraries.begin(); libit != m_libraries.end(); ++libit) {
+		LibraryData *library = libit->second;
+		RemoveSceneData(scene, library->polymaterials, library->materials, library->meshobjects);
+
+		/* the inactive objects are released with the scene without being removed */
+		map<KX_GameObject *, KX_Scene *> *objectmaps[] = {&library->objects, &library->actionusers, NULL};
+		for (int i = 0; objectmaps[i]; i++) {
+			map<KX_GameObject *, KX_Scene *>::iterator objit = objectmaps[i]->begin();
+			while (objit != objectmaps[i]->end()) {
+				if (objit->second == scene)
+					objectmaps[i]->erase(objit++);
+				else
+					++objit;
+			}
+		}
+	}
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+
+	m_polymat_cache.erase(scene);
+	m_mat_cache.erase(scene);
+}
+
+/* Delete the materials and meshes of the scene, from the converter or from a library */
+void KX_BlenderSceneConverter::RemoveSceneData(KX_Scene *scene,
+                                               vector<pair<KX_Scene *, RAS_IPolyMaterial *> >& polymaterials,
+                                               vector<pair<KX_Scene *, BL_Material *> >& materials,
+                                               vector<pair<KX_Scene *, RAS_MeshObject *> >& meshobjects)
+{
+	int i, size;
+
 	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
-	size = m_polymaterials.size();
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
+	size = polymaterials.size();
+	for (i = 0, polymit = polymaterials.begin(); i < size; ) {
 		if (polymit->first == scene) {
 			m_polymat_cache[scene].erase(polymit->second->GetBlenderMaterial());
 			delete polymit->second;
-			*polymit = m_polymaterials.back();
-			m_polymaterials.pop_back();
+			*polymit = polymaterials.back();
+			polymaterials.pop_back();
 			size--;
 		} 
 		else {
@@ -331,16 +437,14 @@ void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
 		}
 	}
 
-	m_polymat_cache.erase(scene);
-
 	vector<pair<KX_Scene *, BL_Material *> >::iterator matit;
-	size = m_materials.size();
-	for (i = 0, matit = m_materials.begin(); i < size; ) {
+	size = materials.size();
+	for (i = 0, matit = materials.begin(); i < size; ) {
 		if (matit->first == scene) {
 			m_mat_cache[scene].erase(matit->second->material);
 			delete matit->second;
-			*matit = m_materials.back();
-			m_materials.pop_back();
+			*matit = materials.back();
+			materials.pop_back();
 			size--;
 		} 
 		else {
@@ -349,15 +453,13 @@ void KX_BlenderSceneConverter::RemoveScene(KX_Scene *scene)
 		}
 	}
 
-	m_mat_cache.erase(scene);
-
 	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
-	size = m_meshobjects.size();
-	for (i = 0, meshit = m_meshobjects.begin(); i < size; ) {
+	size = meshobjects.size();
+	for (i = 0, meshit = meshobjects.begin(); i < size; ) {
 		if (meshit->first == scene) {
 			delete meshit->second;
-			*meshit = m_meshobjects.back();
-			m_meshobjects.pop_back();
+			*meshit = meshobjects.back();
+			meshobjects.pop_back();
 			size--;
 		} 
 		else {
@@ -385,6 +487,18 @@ void KX_BlenderSceneConverter::SetCacheMaterials(bool val)
 	m_use_mat_cache = val;
 }
 
+void KX_BlenderSceneConverter::SetRuntimePack(BL_RuntimePack *pack)
+{
+	if (m_runtimePack)
+		delete m_runtimePack;
+	m_runtimePack = pack;
+}
+
+BL_RuntimePack *KX_BlenderSceneConverter::GetRuntimePack()
+{
+	return m_runtimePack;
+}
+
 bool KX_BlenderSceneConverter::GetMaterials()
 {
 	return m_usemat;
@@ -402,13 +516,21 @@ bool KX_BlenderSceneConverter::GetCacheMaterials()
 
 void KX_BlenderSceneConverter::RegisterBlenderMaterial(BL_Material *mat)
 {
+	pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)mat->material);
+	vector<pair<KX_Scene *, BL_Material *> >& materials = library ? library->materials : m_materials;
+
 	// First make sure we don't register the material twice
 	vector<pair<KX_Scene *, BL_Material *> >::iterator it;
-	for (it = m_materials.begin(); it != m_materials.end(); ++it)
+	for (it = materials.begin(); it != materials.end(); ++it)
 		if (it->second == mat)
-			return;
+			break;
 
-	m_materials.push_back(pair<KX_Scene *, BL_Material *> (m_currentScene, mat));
+	if (it == materials.end())
+		materials.push_back(pair<KX_Scene *, BL_Material *> (m_currentScene, mat));
+
+	pthread_mutex_unlock(&m_threadinfo->library_lock);
 }
 
 void KX_BlenderSceneConverter::SetAlwaysUseExpandFraming(bool to_what)
@@ -445,12 +567,101 @@ KX_GameObject *KX_BlenderSceneConverter::FindGameObject(Object *for_blenderobjec
 	return obp ? *obp : NULL;
 }
 
+/* An object converted from a library or a replica of one, also while the library
+ * is converted in a thread */
+void KX_BlenderSceneConverter::RegisterLibraryObject(KX_GameObject *gameobject, KX_Scene *scene)
+{
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)gameobject->GetBlenderObject());
+	if (library)
+		library->objects[gameobject] = scene;
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+}
+
+/* The object leaves its scene for an object pool, the pool goes with the original */
+void KX_BlenderSceneConverter::UnregisterLibraryObject(KX_GameObject *gameobject)
+{
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)gameobject->GetBlenderObject());
+	if (library)
+		library->objects.erase(gameobject);
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+}
+
+/* The replica copies the actuators of the original, and with them the actions they use */
+void KX_BlenderSceneConverter::RegisterReplica(KX_GameObject *replica, KX_GameObject *original, KX_Scene *scene)
+{
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	if (!m_libraries.empty()) {
+		LibraryData *library = FindLibrary((ID *)replica->GetBlenderObject());
+		if (library)
+			library->objects[replica] = scene;
+
+		for (map<Main *, LibraryData *>::iterator libit = m_libraries.begin(); libit != m_libraries.end(); ++libit) {
+			if (libit->second->actionusers.count(original))
+				libit->second->actionusers[replica] = scene;
+		}
+	}
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+}
+
+void KX_BlenderSceneConverter::RegisterActionUser(KX_GameObject *gameobject, bAction *action)
+{
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)action);
+	if (library)
+		library->actionusers[gameobject] = gameobject->GetScene();
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+}
+
+/* The object is removed from its scene, see KX_Scene::NewRemoveObject() */
+void KX_BlenderSceneConverter::RemoveGameObject(KX_GameObject *gameobject)
+{
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	if (!m_libraries.empty()) {
+		LibraryData *library = FindLibrary((ID *)gameobject->GetBlenderObject());
+		if (library)
+			library->objects.erase(gameobject);
+
+		for (map<Main *, LibraryData *>::iterator libit = m_libraries.begin(); libit != m_libraries.end(); ++libit)
+			libit->second->actionusers.erase(gameobject);
+	}
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+}
+
 void KX_BlenderSceneConverter::RegisterGameMesh(RAS_MeshObject *gamemesh, Mesh *for_blendermesh)
 {
 	if (for_blendermesh) { /* dynamically loaded meshes we don't want to keep lookups for */
 		m_map_mesh_to_gamemesh.insert(CHashedPtr(for_blendermesh),gamemesh);
 	}
-	m_meshobjects.push_back(pair<KX_Scene *, RAS_MeshObject *> (m_currentScene,gamemesh));
+
+	pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)gamemesh->GetMesh());
+	vector<pair<KX_Scene *, RAS_MeshObject *> >& meshobjects = library ? library->meshobjects : m_meshobjects;
+	meshobjects.push_back(pair<KX_Scene *, RAS_MeshObject *> (m_currentScene,gamemesh));
+
+	pthread_mutex_unlock(&m_threadinfo->library_lock);
 }
 
 RAS_MeshObject *KX_BlenderSceneConverter::FindGameMesh(Mesh *for_blendermesh)
@@ -465,14 +676,84 @@ RAS_MeshObject *KX_BlenderSceneConverter::FindGameMesh(Mesh *for_blendermesh)
 	}
 }
 
+void KX_BlenderSceneConverter::PrintVertexMemory()
+{
+	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator it;
+	unsigned int fullsize, packedsize;
+	unsigned int totfull = 0, totpacked = 0;
+
+	printf("\nVertex memory (RAS_TexVert / packed)...\n");
+	for (it = m_meshobjects.begin(); it != m_meshobjects.end(); ++it) {
+		it->second->GetVertexMemory(fullsize, packedsize);
+		printf("\t %s: %u / %u bytes\n", it->second->GetName().ReadPtr(), fullsize, packedsize);
+		totfull += fullsize;
+		totpacked += packedsize;
+	}
+	printf("\t total: %u / %u bytes\n", totfull, totpacked);
+}
+
+size_t KX_BlenderSceneConverter::GetMeshMemory()
+{
+	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator it;
+	unsigned int fullsize, packedsize;
+	size_t size = 0;
+
+	for (it = m_meshobjects.begin(); it != m_meshobjects.end(); ++it) {
+		it->second->GetVertexMemory(fullsize, packedsize);
+		size += fullsize;
+	}
+	return size;
+}
+
+static size_t get_texture_memory(Main *maggie)
+{
+	size_t size = 0;
+	const bool mipmap = GPU_get_mipmap();
+
+	for (Image *ima = (Image *)maggie->image.first; ima; ima = (Image *)ima->id.next) {
+		/* only the images drawn so far have a texture, don't load the others */
+		if ((ima->bindcode == 0 && ima->gputexture == NULL) || !BKE_image_has_ibuf(ima, NULL))
+			continue;
+
+		void *lock;
+		ImBuf *ibuf = BKE_image_acquire_ibuf(ima, NULL, &lock);
+		if (ibuf) {
+			size_t imasize = (size_t)ibuf->x * ibuf->y * 4;
+			/* the mipmaps add a third */
+			size += mipmap ? imasize + imasize / 3 : imasize;
+		}
+		BKE_image_release_ibuf(ima, ibuf, lock);
+	}
+	return size;
+}
+
+size_t KX_BlenderSceneConverter::GetTextureMemory()
+{
+	size_t size = get_texture_memory(m_maggie);
+
+	for (vector<Main *>::iterator it = m_DynamicMaggie.begin(); it != m_DynamicMaggie.end(); ++it)
+		size += get_texture_memory(*it);
+
+	return size;
+}
+
 void KX_BlenderSceneConverter::RegisterPolyMaterial(RAS_IPolyMaterial *polymat)
 {
+	pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)polymat->GetBlenderMaterial());
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >& polymaterials = library ? library->polymaterials : m_polymaterials;
+
 	// First make sure we don't register the material twice
 	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator it;
-	for (it = m_polymaterials.begin(); it != m_polymaterials.end(); ++it)
+	for (it = polymaterials.begin(); it != polymaterials.end(); ++it)
 		if (it->second == polymat)
-			return;
-	m_polymaterials.push_back(pair<KX_Scene *, RAS_IPolyMaterial *> (m_currentScene, polymat));
+			break;
+
+	if (it == polymaterials.end())
+		polymaterials.push_back(pair<KX_Scene *, RAS_IPolyMaterial *> (m_currentScene, polymat));
+
+	pthread_mutex_unlock(&m_threadinfo->library_lock);
 }
 
 void KX_BlenderSceneConverter::CachePolyMaterial(KX_Scene *scene, Material *mat, RAS_IPolyMaterial *polymat)
@@ -771,6 +1052,38 @@ vector<Main *> &KX_BlenderSceneConverter::GetMainDynamic()
 	return m_DynamicMaggie;
 }
 
+/* The converted data of a dynamic main, made on the first use */
+LibraryData *KX_BlenderSceneConverter::GetLibraryData(Main *maggie)
+{
+	map<Main *, LibraryData *>::iterator libit = m_libraries.find(maggie);
+	if (libit != m_libraries.end())
+		return libit->second;
+
+	LibraryData *library = new LibraryData();
+	library->maggie = maggie;
+	m_libraries[maggie] = library;
+	return library;
+}
+
+/* Record the library of an ID, the data converted from it goes with the library.
+ * The callers hold the library lock, the async loads look it up while converting */
+void KX_BlenderSceneConverter::SetLibrary(ID *id, LibraryData *library)
+{
+	if (library)
+		m_map_id_to_library.insert(CHashedPtr(id), library);
+	else
+		m_map_id_to_library.remove(CHashedPtr(id));
+}
+
+LibraryData *KX_BlenderSceneConverter::FindLibrary(ID *id)
+{
+	if (id == NULL)
+		return NULL;
+
+	LibraryData **libraryp = m_map_id_to_library[CHashedPtr(id)];
+	return libraryp ? *libraryp : NULL;
+}
+
 Main *KX_BlenderSceneConverter::GetMainDynamicPath(const char *path)
 {
 	for (vector<Main *>::iterator it = m_DynamicMaggie.begin(); !(it == m_DynamicMaggie.end()); it++)
@@ -780,32 +1093,84 @@ Main *KX_BlenderSceneConverter::GetMainDynamicPath(const char *path)
 	return NULL;
 }
 
-void KX_BlenderSceneConverter::MergeAsyncLoads()
+/* Take the async loads converted since the last frame */
+void KX_BlenderSceneConverter::TakeAsyncLoads()
 {
-	vector<KX_Scene *> *merge_scenes;
+	pthread_mutex_lock(&m_threadinfo->merge_lock);
 
-	vector<KX_LibLoadStatus *>::iterator mit;
-	vector<KX_Scene *>::iterator sit;
+	for (vector<KX_LibLoadStatus *>::iterator mit = m_mergequeue.begin(); mit != m_mergequeue.end(); ++mit) {
+		AsyncMerge *pending = new AsyncMerge();
+		pending->status = *mit;
+		pending->scene = 0;
+		m_merging.push_back(pending);
+	}
 
-	pthread_mutex_lock(&m_threadinfo->merge_lock);
+	m_mergequeue.clear();
+
+	pthread_mutex_unlock(&m_threadinfo->merge_lock);
+}
+
+/* Merge the taken async loads in order until the deadline, 0 for no limit */
+void KX_BlenderSceneConverter::MergePendingLoads(double deadline)
+{
+	while (!m_merging.empty()) {
+		AsyncMerge *pending = m_merging.front();
+		KX_LibLoadStatus *status = pending->status;
+		vector<KX_Scene *> *merge_scenes = (vector<KX_Scene *> *)status->GetData();
 
-	for (mit = m_mergequeue.begin(); mit != m_mergequeue.end(); ++mit) {
-		merge_scenes = (vector<KX_Scene *> *)(*mit)->GetData();
+		while (pending->scene < merge_scenes->size()) {
+			KX_Scene *other = (*merge_scenes)[pending->scene];
 
-		for (sit=merge_scenes->begin(); sit!=merge_scenes->end(); ++sit) {
-			(*mit)->GetMergeScene()->MergeScene(*sit);
-			delete (*sit);
+			if (!status->GetMergeScene()->MergeSceneStep(other, pending->merge, deadline) || pending->merge.IsDone()) {
+				delete other;
+				pending->scene++;
+				pending->merge = KX_SceneMerge();
+			}
+
+			// Conversion is 90% of the progress and merging the last 10%
+			status->SetProgress(0.9f + 0.1f * (pending->scene + pending->merge.GetProgress()) / merge_scenes->size());
+
+			if (deadline > 0.0 && PIL_check_seconds_timer() >= deadline)
+				break;
 		}
 
+		if (pending->scene < merge_scenes->size())
+			return;
+
 		delete merge_scenes;
-		(*mit)->SetData(NULL);
+		status->SetData(NULL);
+
+		status->Finish();
 
-		(*mit)->Finish();
+		delete pending;
+		m_merging.erase(m_merging.begin());
 	}
+}
 
-	m_mergequeue.clear();
+void KX_BlenderSceneConverter::MergeAsyncLoads()
+{
+	TakeAsyncLoads();
 
-	pthread_mutex_unlock(&m_threadinfo->merge_lock);
+	if (m_merging.empty())
+		return;
+
+	MergePendingLoads((m_mergeBudget > 0.0) ? PIL_check_seconds_timer() + m_mergeBudget : 0.0);
+}
+
+void KX_BlenderSceneConverter::FinishAsyncLoads()
+{
+	TakeAsyncLoads();
+	MergePendingLoads(0.0);
+}
+
+void KX_BlenderSceneConverter::SetMergeBudget(double seconds)
+{
+	m_mergeBudget = seconds;
+}
+
+double KX_BlenderSceneConverter::GetMergeBudget()
+{
+	return m_mergeBudget;
 }
 
 void KX_BlenderSceneConverter::AddScenesToMergeQueue(KX_LibLoadStatus *status)
@@ -820,7 +1185,7 @@ static void *async_convert(void *ptr)
 	KX_Scene *new_scene = NULL;
 	KX_LibLoadStatus *status = (KX_LibLoadStatus *)ptr;
 	vector<Scene *> *scenes = (vector<Scene *> *)status->GetData();
-	vector<KX_Scene *> *merge_scenes = new vector<KX_Scene *>(); // Deleted in MergeAsyncLoads
+	vector<KX_Scene *> *merge_scenes = new vector<KX_Scene *>(); // Deleted in MergePendingLoads
 
 	for (unsigned int i = 0; i < scenes->size(); ++i) {
 		new_scene = status->GetEngine()->CreateScene((*scenes)[i], true);
@@ -932,6 +1297,25 @@ KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openl
 	/* needed for lookups*/
 	GetMainDynamic().push_back(main_newlib);
 	BLI_strncpy(main_newlib->name, path, sizeof(main_newlib->name));
+
+	/* the dynamic mains are left untagged, FreeBlendFile then only tags the one it frees */
+	BKE_main_id_tag_all(main_newlib, false);
+
+	/* what is converted from the library is recorded with it */
+	{
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+		LibraryData *library = GetLibraryData(main_newlib);
+		ListBase *lbarray[] = {&main_newlib->scene, &main_newlib->object, &main_newlib->mesh, &main_newlib->mat,
+		                       &main_newlib->action, NULL};
+
+		for (int lb = 0; lbarray[lb]; lb++) {
+			for (ID *id = (ID *)lbarray[lb]->first; id; id = (ID *)id->next)
+				SetLibrary(id, library);
+		}
+
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+	}
 	
 	
 	status = new KX_LibLoadStatus(this, m_ketsjiEngine, scene_merge, path);
@@ -939,6 +1323,8 @@ KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openl
 	if (idcode == ID_ME) {
 		/* Convert all new meshes into BGE meshes */
 		ID *mesh;
+
+		m_currentScene = scene_merge; // Registers the meshes and materials with the scene they go to
 	
 		for (mesh = (ID *)main_newlib->mesh.first; mesh; mesh = (ID *)mesh->next ) {
 			if (options & LIB_LOAD_VERBOSE)
@@ -1018,32 +1404,47 @@ KX_LibLoadStatus *KX_BlenderSceneConverter::LinkBlendFile(BlendHandle *bpy_openl
  * most are temp and NewRemoveObject frees m_map_gameobject_to_blender */
 bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 {
-	int maggie_index = -1;
 	int i = 0;
 
 	if (maggie == NULL)
 		return false;
-	
-	/* tag all false except the one we remove */
-	for (vector<Main *>::iterator it = m_DynamicMaggie.begin(); !(it == m_DynamicMaggie.end()); it++) {
-		Main *main = *it;
-		if (main != maggie) {
-			BKE_main_id_tag_all(main, false);
-		}
-		else {
-			maggie_index = i;
-		}
-		i++;
-	}
 
+	/* the pending async loads may use the data of the library */
+	if (m_threadinfo)
+		FinishAsyncLoads();
+	
 	/* should never happen but just to be safe */
-	if (maggie_index == -1)
+	vector<Main *>::iterator maggieit = std::find(m_DynamicMaggie.begin(), m_DynamicMaggie.end(), maggie);
+	if (maggieit == m_DynamicMaggie.end())
 		return false;
 
-	m_DynamicMaggie.erase(m_DynamicMaggie.begin() + maggie_index);
+	m_DynamicMaggie.erase(maggieit);
+	/* the other dynamic mains are never left tagged, see LinkBlendFile */
 	BKE_main_id_tag_all(maggie, true);
 
-	/* free all tagged objects */
+	/* take what was converted from the library, the objects stay mapped to it until
+	 * they are removed */
+	LibraryData *library;
+	map<KX_GameObject *, KX_Scene *> actionusers;
+	{
+		if (m_threadinfo)
+			pthread_mutex_lock(&m_threadinfo->library_lock);
+
+		library = GetLibraryData(maggie);
+		m_libraries.erase(maggie);
+		actionusers.swap(library->actionusers);
+
+		ListBase *lbarray[] = {&maggie->scene, &maggie->mesh, &maggie->mat, &maggie->action, NULL};
+		for (int lb = 0; lbarray[lb]; lb++) {
+			for (ID *id = (ID *)lbarray[lb]->first; id; id = (ID *)id->next)
+				SetLibrary(id, NULL);
+		}
+
+		if (m_threadinfo)
+			pthread_mutex_unlock(&m_threadinfo->library_lock);
+	}
+
+	/* remove the scenes of the library and its meshes and actions from the other scenes */
 	KX_SceneList *scenes = m_ketsjiEngine->CurrentScenes();
 	int numScenes = scenes->size();
 
@@ -1060,15 +1461,15 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 			/* in case the mesh might be refered to later */
 			{
 				CTR_Map<STR_HashedString, void *> &mapStringToMeshes = scene->GetLogicManager()->GetMeshMap();
-				
-				for (int i = 0; i < mapStringToMeshes.size(); i++) {
-					RAS_MeshObject *meshobj = (RAS_MeshObject *) *mapStringToMeshes.at(i);
-					if (meshobj && IS_TAGGED(meshobj->GetMesh())) {
-						STR_HashedString mn = meshobj->GetName();
+				vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
+
+				for (meshit = library->meshobjects.begin(); meshit != library->meshobjects.end(); ++meshit) {
+					RAS_MeshObject *meshobj = meshit->second;
+					STR_HashedString mn = meshobj->GetName();
+					void **meshp = mapStringToMeshes[mn];
+
+					if (meshp && *meshp == meshobj)
 						mapStringToMeshes.remove(mn);
-						m_map_mesh_to_gamemesh.remove(CHashedPtr(meshobj->GetMesh()));
-						i--;
-					}
 				}
 			}
 
@@ -1076,74 +1477,123 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 			{
 				CTR_Map<STR_HashedString, void *> &mapStringToActions = scene->GetLogicManager()->GetActionMap();
 
-				for (int i = 0; i < mapStringToActions.size(); i++) {
-					ID *action = (ID*) *mapStringToActions.at(i);
+				for (ID *action = (ID *)maggie->action.first; action; action = (ID *)action->next) {
+					STR_HashedString an = action->name + 2;
+					void **actionp = mapStringToActions[an];
 
-					if (IS_TAGGED(action)) {
-						STR_HashedString an = action->name + 2;
+					if (actionp && *actionp == action)
 						mapStringToActions.remove(an);
-						m_map_blender_to_gameAdtList.remove(CHashedPtr(action));
-						i--;
-					}
 				}
 			}
-			
-			//scene->FreeTagged(); /* removed tagged objects and meshes*/
-			CListValue *obj_lists[] = {scene->GetObjectList(), scene->GetInactiveList(), NULL};
-
-			for (int ob_ls_idx = 0; obj_lists[ob_ls_idx]; ob_ls_idx++) {
-				CListValue *obs = obj_lists[ob_ls_idx];
-				RAS_MeshObject *mesh;
-
-				for (int ob_idx = 0; ob_idx < obs->GetCount(); ob_idx++) {
-					KX_GameObject *gameobj = (KX_GameObject*)obs->GetValue(ob_idx);
-					if (IS_TAGGED(gameobj->GetBlenderObject())) {
-						int size_before = obs->GetCount();
-
-						/* Eventually calls RemoveNodeDestructObject
-						 * frees m_map_gameobject_to_blender from UnregisterGameObject */
-						scene->RemoveObject(gameobj);
-
-						if (size_before != obs->GetCount())
-							ob_idx--;
-						else {
-							printf("ERROR COULD NOT REMOVE \"%s\"\n", gameobj->GetName().ReadPtr());
-						}
-					}
-					else {
-						gameobj->RemoveTaggedActions();
-						/* free the mesh, we could be referecing a linked one! */
-						int mesh_index = gameobj->GetMeshCount();
-						while (mesh_index--) {
-							mesh = gameobj->GetMesh(mesh_index);
-							if (IS_TAGGED(mesh->GetMesh())) {
-								gameobj->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library items but mostly objects only have 1 mesh */
-								break;
-							}
-							else {
-								/* also free the mesh if it's using a tagged material */
-								int mat_index = mesh->NumMaterials();
-								while (mat_index--) {
-									if (IS_TAGGED(mesh->GetMeshMaterial(mat_index)->m_bucket->GetPolyMaterial()->GetBlenderMaterial())) {
-										gameobj->RemoveMeshes(); /* XXX - slack, same as above */
-										break;
-									}
-								}
-							}
-						}
+		}
+	}
 
-						/* make sure action actuators are not referencing tagged actions */
-						for (unsigned int act_idx = 0; act_idx < gameobj->GetActuators().size(); act_idx++) {
-							if (gameobj->GetActuators()[act_idx]->IsType(SCA_IActuator::KX_ACT_ACTION)) {
-								BL_ActionActuator *act = (BL_ActionActuator *)gameobj->GetActuators()[act_idx];
-								if (IS_TAGGED(act->GetAction()))
-									act->SetAction(NULL);
-							}
-						}
+	/* make sure the objects left are not playing or referencing the tagged actions */
+	for (map<KX_GameObject *, KX_Scene *>::iterator userit = actionusers.begin(); userit != actionusers.end(); ++userit) {
+		KX_GameObject *gameobj = userit->first;
+		gameobj->RemoveTaggedActions();
+
+		for (unsigned int act_idx = 0; act_idx < gameobj->GetActuators().size(); act_idx++) {
+			SCA_IActuator *act = gameobj->GetActuators()[act_idx];
+			if (act->IsType(SCA_IActuator::KX_ACT_ACTION)) {
+				if (IS_TAGGED(((BL_ActionActuator *)act)->GetAction()))
+					((BL_ActionActuator *)act)->SetAction(NULL);
+			}
+			else if (act->IsType(SCA_IActuator::KX_ACT_SHAPEACTION)) {
+				if (IS_TAGGED(((BL_ShapeActionActuator *)act)->GetAction()))
+					((BL_ShapeActionActuator *)act)->SetAction(NULL);
+			}
+		}
+	}
+
+	/* free the objects of the library, the objects of the removed scenes go with them.
+	 * Removing an object also removes its children and takes them out of library->objects */
+	for (;;) {
+		if (m_threadinfo)
+			pthread_mutex_lock(&m_threadinfo->library_lock);
+
+		map<KX_GameObject *, KX_Scene *>::iterator objit = library->objects.begin();
+		KX_GameObject *gameobj = NULL;
+		KX_Scene *scene = NULL;
+		if (objit != library->objects.end()) {
+			gameobj = objit->first;
+			scene = objit->second;
+			library->objects.erase(objit);
+		}
+
+		if (m_threadinfo)
+			pthread_mutex_unlock(&m_threadinfo->library_lock);
+
+		if (gameobj == NULL)
+			break;
+
+		if (!IS_TAGGED(scene->GetBlenderScene()))
+			scene->RemoveObject(gameobj);
+	}
+
+	{
+		if (m_threadinfo)
+			pthread_mutex_lock(&m_threadinfo->library_lock);
+
+		for (ID *id = (ID *)maggie->object.first; id; id = (ID *)id->next)
+			SetLibrary(id, NULL);
+
+		if (m_threadinfo)
+			pthread_mutex_unlock(&m_threadinfo->library_lock);
+	}
+
+	for (ID *action = (ID *)maggie->action.first; action; action = (ID *)action->next)
+		m_map_blender_to_gameAdtList.remove(CHashedPtr(action));
+
+	set<RAS_IPolyMaterial *> polymaterials;
+	set<KX_Scene *> polyscenes;
+	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
+	for (polymit = library->polymaterials.begin(); polymit != library->polymaterials.end(); ++polymit) {
+		polymaterials.insert(polymit->second);
+		polyscenes.insert(polymit->first);
+	}
+
+	/* the objects left using the meshes or the materials of the library are found from
+	 * their mesh slots, we could be referecing a linked one! */
+	{
+		set<KX_GameObject *> meshusers;
+		vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
+
+		for (meshit = library->meshobjects.begin(); meshit != library->meshobjects.end(); ++meshit) {
+			RAS_MeshObject *meshobj = meshit->second;
+			m_map_mesh_to_gamemesh.remove(CHashedPtr(meshobj->GetMesh()));
+
+			for (int mat_index = 0; mat_index < meshobj->NumMaterials(); mat_index++) {
+				CTR_Map<CTR_HashedPtr, RAS_MeshSlot *>& slots = meshobj->GetMeshMaterial(mat_index)->m_slots;
+
+				for (int slot_index = 0; slot_index < slots.size(); slot_index++)
+					meshusers.insert((KX_GameObject *)(*slots.at(slot_index))->m_clientObj);
+			}
+		}
+
+		/* the buckets of the library materials are deleted below, with the slots of
+		 * the meshes of other libraries or of the blend file using them */
+		for (set<KX_Scene *>::iterator sceneit = polyscenes.begin(); sceneit != polyscenes.end(); ++sceneit) {
+			RAS_BucketManager *bucketmgr = (*sceneit)->GetBucketManager();
+			RAS_BucketManager::BucketList *bucketlists[2] = {&bucketmgr->GetSolidBuckets(), &bucketmgr->GetAlphaBuckets()};
+
+			for (int list_index = 0; list_index < 2; list_index++) {
+				RAS_BucketManager::BucketList::iterator bit;
+				for (bit = bucketlists[list_index]->begin(); bit != bucketlists[list_index]->end(); ++bit) {
+					RAS_MaterialBucket *bucket = *bit;
+					if (polymaterials.count(bucket->GetPolyMaterial()) == 0)
+						continue;
+
+					for (list<RAS_MeshSlot>::iterator msit = bucket->msBegin(); msit != bucket->msEnd(); ++msit) {
+						if (msit->m_clientObj)
+							meshusers.insert((KX_GameObject *)msit->m_clientObj);
 					}
 				}
 			}
 		}
+
+		for (set<KX_GameObject *>::iterator userit = meshusers.begin(); userit != meshusers.end(); ++userit)
+			(*userit)->RemoveMeshes(); /* XXX - slack, should only remove meshes that are library items but mostly objects only have 1 mesh */
 	}
 
 	int size;
@@ -1193,110 +1643,42 @@ bool KX_BlenderSceneConverter::FreeBlendFile(Main *maggie)
 	worldset.clear();
 	/* done freeing the worlds */
 
-	vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
-	size = m_polymaterials.size();
-
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
-		RAS_IPolyMaterial *mat = polymit->second;
-		Material *bmat = NULL;
-
-		KX_BlenderMaterial *bl_mat = static_cast<KX_BlenderMaterial *>(mat);
-		bmat = bl_mat->GetBlenderMaterial();
+	// Before deleting the mesh objects, make sure the rasterizer is
+	// no longer referencing them, the buckets of the library go next
+	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
+	for (meshit = library->meshobjects.begin(); meshit != library->meshobjects.end(); ++meshit) {
+		RAS_MeshObject *meshobj = meshit->second;
 
-		if (IS_TAGGED(bmat)) {
-			/* only remove from bucket */
-			polymit->first->GetBucketManager()->RemoveMaterial(mat);
+		for (int mat_index = 0; mat_index < meshobj->NumMaterials(); mat_index++) {
+			RAS_MeshMaterial *meshmat = meshobj->GetMeshMaterial(mat_index);
+			if (polymaterials.count(meshmat->m_bucket->GetPolyMaterial()) == 0)
+				meshmat->m_bucket->RemoveMesh(meshmat->m_baseslot);
 		}
-
-		i++;
-		polymit++;
 	}
 
-	for (i = 0, polymit = m_polymaterials.begin(); i < size; ) {
-		RAS_IPolyMaterial *mat = polymit->second;
-		Material *bmat = NULL;
-
-		KX_BlenderMaterial *bl_mat = static_cast<KX_BlenderMaterial*>(mat);
-		bmat = bl_mat->GetBlenderMaterial();
+	for (polymit = library->polymaterials.begin(); polymit != library->polymaterials.end(); ++polymit) {
+		/* only remove from bucket */
+		polymit->first->GetBucketManager()->RemoveMaterial(polymit->second);
+	}
 
-		if (IS_TAGGED(bmat)) {
-			// Remove the poly material coresponding to this Blender Material.
-			m_polymat_cache[polymit->first].erase(bmat);
-			delete polymit->second;
-			*polymit = m_polymaterials.back();
-			m_polymaterials.pop_back();
-			size--;
-		} else {
-			i++;
-			polymit++;
-		}
+	for (polymit = library->polymaterials.begin(); polymit != library->polymaterials.end(); ++polymit) {
+		// Remove the poly material coresponding to this Blender Material.
+		m_polymat_cache[polymit->first].erase(polymit->second->GetBlenderMaterial());
+		delete polymit->second;
 	}
 
 	vector<pair<KX_Scene *, BL_Material *> >::iterator matit;
-	size = m_materials.size();
-	for (i = 0, matit = m_materials.begin(); i < size; ) {
-		BL_Material *mat = matit->second;
-		if (IS_TAGGED(mat->material)) {
-			// Remove the bl material coresponding to this Blender Material.
-			m_mat_cache[matit->first].erase(mat->material);
-			delete matit->second;
-			*matit = m_materials.back();
-			m_materials.pop_back();
-			size--;
-		} 
-		else {
-			i++;
-			matit++;
-		}
+	for (matit = library->materials.begin(); matit != library->materials.end(); ++matit) {
+		// Remove the bl material coresponding to this Blender Material.
+		m_mat_cache[matit->first].erase(matit->second->material);
+		delete matit->second;
 	}
 
-	vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
-	RAS_BucketManager::BucketList::iterator bit;
-	list<RAS_MeshSlot>::iterator msit;
-	RAS_BucketManager::BucketList buckets;
-
-	size = m_meshobjects.size();
-	for (i = 0, meshit = m_meshobjects.begin(); i < size;) {
-		RAS_MeshObject *me = meshit->second;
-		if (IS_TAGGED(me->GetMesh())) {
-			// Before deleting the mesh object, make sure the rasterizer is
-			// no longer referencing it.
-			buckets = meshit->first->GetBucketManager()->GetSolidBuckets();
-			for (bit = buckets.begin(); bit != buckets.end(); bit++) {
-				msit = (*bit)->msBegin();
-
-				while (msit != (*bit)->msEnd()) {
-					if (msit->m_mesh == meshit->second)
-						(*bit)->RemoveMesh(&(*msit++));
-					else
-						msit++;
-				}
-			}
+	// Now it should be safe to delete
+	for (meshit = library->meshobjects.begin(); meshit != library->meshobjects.end(); ++meshit)
+		delete meshit->second;
 
-			// And now the alpha buckets
-			buckets = meshit->first->GetBucketManager()->GetAlphaBuckets();
-			for (bit = buckets.begin(); bit != buckets.end(); bit++) {
-				msit = (*bit)->msBegin();
-
-				while (msit != (*bit)->msEnd()) {
-					if (msit->m_mesh == meshit->second)
-						(*bit)->RemoveMesh(&(*msit++));
-					else
-						msit++;
-				}
-			}
-
-			// Now it should be safe to delete
-			delete meshit->second;
-			*meshit = m_meshobjects.back();
-			m_meshobjects.pop_back();
-			size--;
-		} 
-		else {
-			i++;
-			meshit++;
-		}
-	}
+	delete library;
 
 #ifdef WITH_PYTHON
 	/* make sure this maggie is removed from the import list if it's there
@@ -1360,6 +1742,48 @@ bool KX_BlenderSceneConverter::MergeScene(KX_Scene *to, KX_Scene *from)
 		}
 	}
 
+	/* the materials and meshes of a library scene are with its library */
+	if (m_threadinfo)
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+	LibraryData *library = FindLibrary((ID *)from->GetBlenderScene());
+	if (library) {
+		vector<pair<KX_Scene *, RAS_IPolyMaterial *> >::iterator polymit;
+		for (polymit = library->polymaterials.begin(); polymit != library->polymaterials.end(); ++polymit) {
+			if (polymit->first == from) {
+				polymit->first = to;
+				polymit->second->Replace_IScene(to);
+			}
+		}
+
+		vector<pair<KX_Scene *, BL_Material *> >::iterator matit;
+		for (matit = library->materials.begin(); matit != library->materials.end(); ++matit) {
+			if (matit->first == from)
+				matit->first = to;
+		}
+
+		vector<pair<KX_Scene *, RAS_MeshObject *> >::iterator meshit;
+		for (meshit = library->meshobjects.begin(); meshit != library->meshobjects.end(); ++meshit) {
+			if (meshit->first == from)
+				meshit->first = to;
+		}
+	}
+
+	/* the objects of the scene may be replicas of the objects of the other libraries */
+	for (map<Main *, LibraryData *>::iterator libit = m_libraries.begin(); libit != m_libraries.end(); ++libit) {
+		map<KX_GameObject *, KX_Scene *> *objectmaps[] = {&libit->second->objects, &libit->second->actionusers, NULL};
+		for (int i = 0; objectmaps[i]; i++) {
+			map<KX_GameObject *, KX_Scene *>::iterator objit;
+			for (objit = objectmaps[i]->begin(); objit != objectmaps[i]->end(); ++objit) {
+				if (objit->second == from)
+					objit->second = to;
+			}
+		}
+	}
+
+	if (m_threadinfo)
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
+
 	MaterialCache::iterator matcacheit = m_mat_cache.find(from);
 	if (matcacheit != m_mat_cache.end()) {
 		// Merge cached BL_Material map.
@@ -1450,6 +1874,20 @@ RAS_MeshObject *KX_BlenderSceneConverter::ConvertMeshSpecial(KX_Scene *kx_scene,
 				}
 			}
 		}
+
+		/* the mesh and its materials now go with the main, left untagged as the other dynamic mains */
+		pthread_mutex_lock(&m_threadinfo->library_lock);
+
+		LibraryData *library = GetLibraryData(maggie);
+		SetLibrary(me, library);
+		for (int i = 0; i < mesh->totcol; i++) {
+			if (mesh->mat[i]) {
+				mesh->mat[i]->id.flag &= ~LIB_DOIT;
+				SetLibrary(&mesh->mat[i]->id, library);
+			}
+		}
+
+		pthread_mutex_unlock(&m_threadinfo->library_lock);
 	}
 
 	m_currentScene = kx_scene; // This needs to be set in case we LibLoaded earlier
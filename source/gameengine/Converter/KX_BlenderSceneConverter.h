@@ -50,9 +50,13 @@ class RAS_MeshObject;
 class RAS_IPolyMaterial;
 class BL_InterpolatorList;
 class BL_Material;
+class BL_RuntimePack;
 struct Main;
 struct Scene;
 struct ThreadInfo;
+struct AsyncMerge;
+struct LibraryData;
+struct ID;
 struct Material;
 
 typedef map<KX_Scene*, map<Material*, BL_Material*> > MaterialCache;
@@ -68,6 +72,10 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 
 	vector<class KX_LibLoadStatus*> m_mergequeue;
 	ThreadInfo	*m_threadinfo;
+	// Async loads taken from the queue and merged a part each frame, main thread only
+	vector<AsyncMerge*> m_merging;
+	// Time spent merging the async loads each frame in seconds, 0 for no limit
+	double		m_mergeBudget;
 
 	// Cached material conversions
 	MaterialCache m_mat_cache;
@@ -89,6 +97,11 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 	Main*					m_maggie;
 	vector<struct Main*>	m_DynamicMaggie;
 
+	// Materials and meshes converted from each dynamic main, freed with it in FreeBlendFile
+	map<struct Main*, LibraryData*>		m_libraries;
+	// The library of each scene, mesh and material ID of the dynamic mains
+	CTR_Map<CHashedPtr,LibraryData*>	m_map_id_to_library;
+
 	STR_String				m_newfilename;
 	class KX_KetsjiEngine*	m_ketsjiEngine;
 	class KX_Scene*			m_currentScene;	// Scene being converted
@@ -96,6 +109,18 @@ class KX_BlenderSceneConverter : public KX_ISceneConverter
 	bool					m_usemat;
 	bool					m_useglslmat;
 	bool					m_use_mat_cache;
+	BL_RuntimePack*			m_runtimePack;
+
+	void TakeAsyncLoads();
+	void MergePendingLoads(double deadline);
+
+	void RemoveSceneData(KX_Scene *scene,
+	                     vector<pair<KX_Scene*,RAS_IPolyMaterial*> >& polymaterials,
+	                     vector<pair<KX_Scene*,BL_Material *> >& materials,
+	                     vector<pair<KX_Scene*,RAS_MeshObject*> >& meshobjects);
+	LibraryData *GetLibraryData(struct Main *maggie);
+	void SetLibrary(struct ID *id, LibraryData *library);
+	LibraryData *FindLibrary(struct ID *id);
 
 public:
 	KX_BlenderSceneConverter(
@@ -126,6 +151,14 @@ public:
 	void UnregisterGameObject(KX_GameObject *gameobject);
 	KX_GameObject *FindGameObject(struct Object *for_blenderobject);
 
+	/* the objects of the libraries and the objects playing their actions, FreeBlendFile
+	 * only goes through these */
+	void RegisterLibraryObject(KX_GameObject *gameobject, KX_Scene *scene);
+	void UnregisterLibraryObject(KX_GameObject *gameobject);
+	void RegisterReplica(KX_GameObject *replica, KX_GameObject *original, KX_Scene *scene);
+	void RegisterActionUser(KX_GameObject *gameobject, struct bAction *action);
+	void RemoveGameObject(KX_GameObject *gameobject);
+
 	void RegisterGameMesh(RAS_MeshObject *gamemesh, struct Mesh *for_blendermesh);
 	RAS_MeshObject *FindGameMesh(struct Mesh *for_blendermesh/*, unsigned int onlayer*/);
 
@@ -169,6 +202,10 @@ public:
 	virtual void SetCacheMaterials(bool val);
 	virtual bool GetCacheMaterials();
 
+	// meshes baked for the runtime, owned by the converter
+	void SetRuntimePack(BL_RuntimePack *pack);
+	BL_RuntimePack *GetRuntimePack();
+
 	struct Scene* GetBlenderSceneForName(const STR_String& name);
 
 //	struct Main* GetMain() { return m_maggie; }
@@ -184,8 +221,15 @@ public:
 	bool FreeBlendFile(const char *path);
 
 	virtual void MergeAsyncLoads();
+	// Merge the pending async loads right away, before the scenes or the libraries they use go
+	void FinishAsyncLoads();
 	void AddScenesToMergeQueue(class KX_LibLoadStatus *status);
+	void SetMergeBudget(double seconds);
+	double GetMergeBudget();
  
+	void PrintVertexMemory();
+	virtual size_t GetMeshMemory();
+	virtual size_t GetTextureMemory();
 	void PrintStats() {
 		printf("BGE STATS!\n");
 
@@ -202,6 +246,8 @@ public:
 		printf("\t m_map_blender_to_gamecontroller: %d\n", m_map_blender_to_gamecontroller.size());
 		printf("\t m_map_blender_to_gameAdtList: %d\n", m_map_blender_to_gameAdtList.size());
 
+		PrintVertexMemory();
+
 #ifdef WITH_CXX_GUARDEDALLOC
 		MEM_printmemlist_pydict();
 #endif
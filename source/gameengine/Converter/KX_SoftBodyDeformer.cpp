@@ -114,6 +114,8 @@ bool KX_SoftBodyDeformer::Apply(class RAS_IPolyMaterial *polymat)
 			v.SetNormal(normal);
 
 		}
+		it.array->SetModified(RAS_DisplayArray::POSITION_MODIFIED | RAS_DisplayArray::NORMAL_MODIFIED,
+		                      it.startvertex, it.endvertex);
 	}
 	return true;
 }
@@ -0,0 +1,154 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_CompiledExpr.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_COMPILEDEXPR_H__
+#define __EXP_COMPILEDEXPR_H__
+
+#include "EXP_Value.h"
+#include "EXP_IntValue.h"
+
+#include <vector>
+#include <deque>
+
+class CExpression;
+
+/**
+ * An expression flattened to a small stack bytecode, evaluated without creating any CValue.
+ *
+ * Identifiers are resolved by the owner of the program: each one is bound to a live value
+ * (usually a game property) or set to a plain boolean before evaluating, and only needs to be
+ * bound again when the object it comes from gets or loses properties.
+ *
+ * Only int, float, bool and string operands are handled. Anything the CValue classes would
+ * turn in an error or a new string (division by zero, type mismatch, concatenation...) makes
+ * Evaluate() fail, the owner then calculates the expression tree as before to get the same
+ * result and error message.
+ */
+class CCompiledExpr
+{
+public:
+	/* a value on the stack, m_type is VALUE_INT_TYPE, VALUE_FLOAT_TYPE, VALUE_BOOL_TYPE or VALUE_STRING_TYPE */
+	struct Operand {
+		int m_type;
+		union {
+			cInt m_int;
+			float m_float;
+			bool m_bool;
+			const STR_String *m_string;
+		};
+	};
+
+	CCompiledExpr();
+	~CCompiledExpr();
+
+	/// Compile an expression tree, returns false if the tree can't be turned in bytecode.
+	bool Compile(CExpression *expr);
+
+	/* Building blocks, used by CExpression::Compile() */
+	bool AddConstant(CValue *value);
+	void AddBool(bool value);
+	void AddInt(cInt value);
+	void AddFloat(float value);
+	void AddString(const STR_String& value);
+	/// Push the value of an identifier, returns its index.
+	int AddIdentifier(const STR_String& name);
+	/// Replace the value on top of the stack by VALUE_NEG_OPERATOR, VALUE_POS_OPERATOR or VALUE_NOT_OPERATOR of it.
+	void AddUnary(VALUE_OPERATOR op);
+	/// Replace the two values on top of the stack by the operation on them.
+	void AddBinary(VALUE_OPERATOR op);
+	/// Replace the value on top of the stack by a float, reading strings like SCA_PropertySensor does.
+	void AddNumber();
+	/**
+	 * Add a jump to the position given later with SetJumpTarget(). A conditional jump pops
+	 * a boolean and jumps when it is false, an unconditional one carries the value on top of
+	 * the stack to the target.
+	 */
+	int AddJump(bool conditional);
+	void SetJumpTarget(int jump);
+
+	int GetIdentifierCount() const
+	{
+		return (int)m_identifiers.size();
+	}
+	const STR_String& GetIdentifierName(int index) const
+	{
+		return m_identifiers[index].m_name;
+	}
+	/// Read the identifier from a value (int, float, bool or string), NULL when it can't be found.
+	void SetIdentifier(int index, CValue *value);
+	/// Give the identifier a boolean value, for sensors states.
+	void SetIdentifier(int index, bool value);
+
+	/**
+	 * Run the program, \param result gets the number the result CValue would give.
+	 * Returns false when the expression tree has to be calculated instead.
+	 */
+	bool Evaluate(double& result);
+
+private:
+	enum Opcode {
+		OP_CONSTANT,
+		OP_IDENTIFIER,
+		OP_UNARY,
+		OP_BINARY,
+		OP_NUMBER,
+		OP_JUMP,
+		OP_JUMP_IF_FALSE
+	};
+
+	struct Instruction {
+		unsigned char m_opcode;
+		unsigned char m_operator;	/* VALUE_OPERATOR */
+		int m_arg;					/* constant, identifier or jump target */
+	};
+
+	struct Identifier {
+		STR_String m_name;
+		CValue *m_value;
+		Operand m_state;
+	};
+
+	/* not copyable, the identifiers hold references */
+	CCompiledExpr(const CCompiledExpr&);
+	CCompiledExpr& operator=(const CCompiledExpr&);
+
+	void AddInstruction(Opcode opcode, int arg, VALUE_OPERATOR op, int pushed);
+	void AddConstant(const Operand& constant);
+	bool ReadIdentifier(const Identifier& identifier, Operand& result);
+
+	std::vector<Instruction> m_instructions;
+	std::vector<Operand> m_constants;
+	std::deque<STR_String> m_strings;	/* string constants, deque keeps them in place */
+	std::vector<Identifier> m_identifiers;
+	std::vector<Operand> m_stack;
+	int m_depth;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CCompiledExpr")
+#endif
+};
+
+#endif  /* __EXP_COMPILEDEXPR_H__ */
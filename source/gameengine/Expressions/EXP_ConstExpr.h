@@ -37,6 +37,7 @@ public:
 	void ClearModified();
 	virtual double GetNumber();
 	virtual CValue* Calculate();
+	virtual bool Compile(class CCompiledExpr& program);
 	CConstExpr(CValue* constval);
 	CConstExpr();
 	virtual ~CConstExpr();
@@ -113,6 +113,8 @@ public:
 	virtual void				ClearModified() = 0; // another pure one
 	//virtual CExpression * Copy() =0;
 	virtual void		BroadcastOperators(VALUE_OPERATOR op) =0;
+	/// Add the bytecode of this expression to \a program, returns false if it can't be compiled.
+	virtual bool		Compile(class CCompiledExpr& program) { return false; }
 
 	virtual CExpression * AddRef() { // please leave multiline, for debugger !!!
 
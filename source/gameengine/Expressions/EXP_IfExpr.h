@@ -36,6 +36,7 @@ public:
 	virtual unsigned char GetExpressionID();
 	virtual ~CIfExpr();
 	virtual CValue* Calculate();
+	virtual bool Compile(class CCompiledExpr& program);
 	
 	virtual bool		IsInside(float x,float y,float z,bool bBorderInclude=true);
 	virtual bool		NeedsRecalculated();
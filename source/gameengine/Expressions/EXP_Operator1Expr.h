@@ -40,6 +40,7 @@ public:
 			m_lhs->ClearModified();
 	}
 	virtual CValue* Calculate();
+	virtual bool Compile(class CCompiledExpr& program);
 	COperator1Expr(VALUE_OPERATOR op, CExpression *lhs);
 	COperator1Expr();
 	virtual ~COperator1Expr();
@@ -0,0 +1,99 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_Profiler.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROFILER_H__
+#define __EXP_PROFILER_H__
+
+/**
+ * Records the time spent in named zones of code, from any thread, and writes
+ * them in the Chrome trace format (chrome://tracing) for a number of frames.
+ *
+ * Each thread writes its zones to its own ring buffer, without locking. The
+ * buffers are read at the end of each frame by the main thread, while the
+ * task pool workers are idle. Nothing is recorded and nothing is allocated
+ * while no trace is running, a zone then costs a test of a flag.
+ */
+class CProfiler
+{
+public:
+	/**
+	 * Start writing the zones of the next \param frames frames to \param filename.
+	 * \return false if the file can't be opened.
+	 */
+	static bool StartTrace(const char *filename, int frames);
+	/// Write the end of the trace and free the thread buffers.
+	static void EndTrace();
+
+	static bool IsTracing()
+	{
+		return s_tracing;
+	}
+
+	/// Time in seconds, on the clock of the zones.
+	static double GetTime();
+
+	enum Track {
+		/// The zones of the thread recording them, they nest by scope.
+		TRACK_THREAD,
+		/// The time categories of the engine, they follow each other without nesting with the thread zones.
+		TRACK_CATEGORIES
+	};
+
+	/// Record a zone of the calling thread from \param start to now, the name is copied.
+	static void AddZone(const char *name, double start, Track track = TRACK_THREAD);
+
+	/**
+	 * Called by the main thread at the end of each frame: the frame is recorded
+	 * as a zone and all the zones are written, the trace ends after the last frame.
+	 */
+	static void EndFrame();
+
+private:
+	static bool s_tracing;
+};
+
+/// Record the scope it is declared in as a zone, the name must stay valid until the end of the scope.
+class CProfileZone
+{
+public:
+	explicit CProfileZone(const char *name)
+		:m_name(name),
+		m_start(CProfiler::IsTracing() ? CProfiler::GetTime() : -1.0)
+	{
+	}
+
+	~CProfileZone()
+	{
+		if (m_start >= 0.0)
+			CProfiler::AddZone(m_name, m_start);
+	}
+
+private:
+	const char *m_name;
+	double m_start;
+};
+
+#endif  /* __EXP_PROFILER_H__ */
@@ -0,0 +1,186 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file EXP_PropertyLayout.h
+ *  \ingroup expressions
+ */
+
+#ifndef __EXP_PROPERTYLAYOUT_H__
+#define __EXP_PROPERTYLAYOUT_H__
+
+#include "STR_HashedString.h"
+#include "CTR_Map.h"
+
+#include <vector>
+#include <string.h>
+#include <stdint.h>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+/**
+ * The property names of a value and the slot each one takes in its property array.
+ *
+ * A layout is built while the properties of an object are set at conversion, then
+ * shared by all the replicas of the object, which only copy the values. A slot is
+ * never removed and keeps its index, a shared layout isn't changed: adding a new name
+ * to it gives a derived layout, and all the values adding the same name to the same
+ * layout get the same derived one while it is in use.
+ */
+class CPropertyLayout
+{
+public:
+	/// A name to look up without copying it, hashed like STR_HashedString.
+	struct Name {
+		Name(const char *str, int length)
+			:m_str(str),
+			m_length(length),
+			m_hash(STR_gHash(str, length, 0))
+		{
+		}
+
+		unsigned int hash() const
+		{
+			return m_hash;
+		}
+
+		friend bool operator==(const Name& name, const STR_HashedString& key)
+		{
+			return (name.m_length == key.Length() && memcmp(name.m_str, key.ReadPtr(), name.m_length) == 0);
+		}
+
+		const char *m_str;
+		int m_length;
+		unsigned int m_hash;
+	};
+
+	CPropertyLayout();
+
+	CPropertyLayout *AddRef()
+	{
+		m_refcount++;
+		return this;
+	}
+	void Release();
+
+	/// Changes each time a slot is added to this layout.
+	unsigned int GetId() const
+	{
+		return m_id;
+	}
+
+	int GetSlotCount() const
+	{
+		return (int)m_names.size();
+	}
+	const STR_String& GetSlotName(int slot) const
+	{
+		return m_names[slot];
+	}
+	/// Slot of the index-th name in alphabetical order.
+	int GetSortedSlot(int index) const
+	{
+		return m_sorted[index];
+	}
+
+	/// Slot of a name, -1 if the layout doesn't have it.
+	int FindSlot(const Name& name) const
+	{
+		return m_slots.find(name);
+	}
+
+	/**
+	 * Add a name, \param layout is released and replaced by the layout with the name,
+	 * the slot of the name in it is returned.
+	 */
+	static int AddSlot(CPropertyLayout *&layout, const Name& name);
+
+private:
+	/* not copyable, the derived layouts can only be reached from their parent */
+	CPropertyLayout(const CPropertyLayout&);
+	CPropertyLayout& operator=(const CPropertyLayout&);
+
+	~CPropertyLayout();
+
+	void Append(const Name& name);
+	void Detach();
+
+	/* the map index of a name is its slot */
+	CTR_Map<STR_HashedString, int> m_slots;
+	std::vector<STR_HashedString> m_names;	/* by slot */
+	std::vector<int> m_sorted;
+	/* layouts made by adding a name to this one, by the added name. They hold no
+	 * reference and leave the map when they go */
+	CTR_Map<STR_HashedString, CPropertyLayout *> m_derived;
+	/* the layout this one was derived from, while this one is in its map */
+	CPropertyLayout *m_parent;
+	int m_refcount;
+	unsigned int m_id;
+
+	/* changed from any thread, the scenes of LibLoad are converted in threads */
+	static uint32_t s_lastId;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CPropertyLayout")
+#endif
+};
+
+/**
+ * A property name that remembers its slot in the last layout it was looked up in,
+ * reading the same property of many replicas of an object then costs no hashing.
+ */
+class CPropertyKey
+{
+public:
+	explicit CPropertyKey(const char *name)
+		:m_name(name),
+		m_layoutId(0),
+		m_slot(-1)
+	{
+	}
+
+	explicit CPropertyKey(const STR_String& name)
+		:m_name(name),
+		m_layoutId(0),
+		m_slot(-1)
+	{
+	}
+
+	const STR_String& GetName() const
+	{
+		return m_name;
+	}
+
+private:
+	friend class CValue;
+
+	STR_String m_name;
+	unsigned int m_layoutId;
+	int m_slot;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CPropertyKey")
+#endif
+};
+
+#endif  /* __EXP_PROPERTYLAYOUT_H__ */
@@ -23,8 +23,10 @@
 #  pragma warning (disable:4786)
 #endif
 
-#include <map>		// array functionality for the propertylist
+#include <map>
+#include <vector>
 #include "STR_String.h"	// STR_String class
+#include "EXP_PropertyLayout.h"	// names and slots of the propertylist
 
 using namespace std;
 
@@ -289,11 +291,13 @@ public:
 	virtual void		SetProperty(const char* name,CValue* ioProperty);
 	virtual CValue*		GetProperty(const char* inName);							// Get pointer to a property with name <inName>, returns NULL if there is no property named <inName>
 	virtual CValue*		GetProperty(const STR_String & inName);
+	CValue*				GetProperty(CPropertyKey& key);								// Same as above, the key remembers the slot of the name in the layout of this value
 	const STR_String&	GetPropertyText(const STR_String & inName);						// Get text description of property with name <inName>, returns an empty string if there is no property named <inName>
 	float				GetPropertyNumber(const STR_String& inName,float defnumber);
 	virtual bool		RemoveProperty(const char *inName);						// Remove the property named <inName>, returns true if the property was succesfully removed, false if property was not found or could not be removed
 	virtual vector<STR_String>	GetPropertyNames();
 	virtual void		ClearProperties();										// Clear all properties
+	void				CopyProperties(CValue* source);							// Replace all properties by replicas of the properties of <source>, like a new replica of it
 
 	virtual void		SetPropertiesModified(bool inModified);					// Set all properties' modified flag to <inModified>
 	virtual bool		IsAnyPropertyModified();								// Check if any of the properties in this value have been modified
@@ -302,6 +306,8 @@ public:
 	virtual int			GetPropertyCount();										// Get the amount of properties assiocated with this value
 
 	virtual CValue*		FindIdentifier(const STR_String& identifiername);
+	/// Changes when a property is set, replaced or removed, so property values looked up before must be looked up again.
+	unsigned int		GetPropertyGeneration()									{ return m_propertyGeneration; }
 	/** Set the wireframe color of this value depending on the CSG
 	 * operator type <op>
 	 * \attention: not implemented */
@@ -349,10 +355,21 @@ protected:
 	//virtual void		AddDataToReplica(CValue* replica);
 	virtual				~CValue();
 private:
+	/* Properties by slot, the layout gives the slot of each name and is shared with the replicas */
+	struct PropertyArray {
+		CPropertyLayout *m_layout;
+		std::vector<CValue *> m_values;											// NULL for removed properties
+		int m_count;
+	};
+
+	CValue*				GetPropertySlot(const CPropertyLayout::Name& name);
+	void				SetPropertySlot(const CPropertyLayout::Name& name, CValue* ioProperty);
+
 	// Member variables
-	std::map<STR_String,CValue*>*		m_pNamedPropertyArray;									// Properties for user/game etc
+	PropertyArray*		m_pNamedPropertyArray;									// Properties for user/game etc
 	ValueFlags			m_ValFlags;												// Frequently used flags in a bitfield (low memoryusage)
 	int					m_refcount;												// Reference Counter
+	unsigned int		m_propertyGeneration;									// Incremented on each property set or removal
 	static	double m_sZeroVec[3];
 
 };
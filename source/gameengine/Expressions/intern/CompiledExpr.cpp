@@ -0,0 +1,437 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/intern/CompiledExpr.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_CompiledExpr.h"
+#include "EXP_Expression.h"
+#include "EXP_BoolValue.h"
+#include "EXP_FloatValue.h"
+
+#include <math.h>
+
+CCompiledExpr::CCompiledExpr()
+	:m_depth(0)
+{
+}
+
+CCompiledExpr::~CCompiledExpr()
+{
+	for (std::vector<Identifier>::iterator it = m_identifiers.begin(); it != m_identifiers.end(); ++it) {
+		if (it->m_value)
+			it->m_value->Release();
+	}
+}
+
+bool CCompiledExpr::Compile(CExpression *expr)
+{
+	return expr->Compile(*this) && m_depth == 1;
+}
+
+void CCompiledExpr::AddInstruction(Opcode opcode, int arg, VALUE_OPERATOR op, int pushed)
+{
+	Instruction instruction;
+	instruction.m_opcode = opcode;
+	instruction.m_operator = op;
+	instruction.m_arg = arg;
+	m_instructions.push_back(instruction);
+
+	m_depth += pushed;
+	if (m_depth > (int)m_stack.size())
+		m_stack.resize(m_depth);
+}
+
+void CCompiledExpr::AddConstant(const Operand& constant)
+{
+	m_constants.push_back(constant);
+	AddInstruction(OP_CONSTANT, m_constants.size() - 1, VALUE_NO_OPERATOR, 1);
+}
+
+bool CCompiledExpr::AddConstant(CValue *value)
+{
+	switch (value->GetValueType()) {
+		case VALUE_INT_TYPE:
+			AddInt(((CIntValue *)value)->GetInt());
+			return true;
+		case VALUE_FLOAT_TYPE:
+			AddFloat(((CFloatValue *)value)->GetFloat());
+			return true;
+		case VALUE_BOOL_TYPE:
+			AddBool(((CBoolValue *)value)->GetBool());
+			return true;
+		case VALUE_STRING_TYPE:
+			AddString(value->GetText());
+			return true;
+		default:
+			/* errors and the empty value of an 'if' without else */
+			return false;
+	}
+}
+
+void CCompiledExpr::AddBool(bool value)
+{
+	Operand constant;
+	constant.m_type = VALUE_BOOL_TYPE;
+	constant.m_bool = value;
+	AddConstant(constant);
+}
+
+void CCompiledExpr::AddInt(cInt value)
+{
+	Operand constant;
+	constant.m_type = VALUE_INT_TYPE;
+	constant.m_int = value;
+	AddConstant(constant);
+}
+
+void CCompiledExpr::AddFloat(float value)
+{
+	Operand constant;
+	constant.m_type = VALUE_FLOAT_TYPE;
+	constant.m_float = value;
+	AddConstant(constant);
+}
+
+void CCompiledExpr::AddString(const STR_String& value)
+{
+	m_strings.push_back(value);
+
+	Operand constant;
+	constant.m_type = VALUE_STRING_TYPE;
+	constant.m_string = &m_strings.back();
+	AddConstant(constant);
+}
+
+int CCompiledExpr::AddIdentifier(const STR_String& name)
+{
+	int index;
+
+	for (index = 0; index < (int)m_identifiers.size(); index++) {
+		if (m_identifiers[index].m_name == name)
+			break;
+	}
+
+	if (index == (int)m_identifiers.size()) {
+		Identifier identifier;
+		identifier.m_name = name;
+		identifier.m_value = NULL;
+		identifier.m_state.m_type = VALUE_NO_TYPE;
+		m_identifiers.push_back(identifier);
+	}
+
+	AddInstruction(OP_IDENTIFIER, index, VALUE_NO_OPERATOR, 1);
+	return index;
+}
+
+void CCompiledExpr::AddUnary(VALUE_OPERATOR op)
+{
+	AddInstruction(OP_UNARY, 0, op, 0);
+}
+
+void CCompiledExpr::AddBinary(VALUE_OPERATOR op)
+{
+	AddInstruction(OP_BINARY, 0, op, -1);
+}
+
+void CCompiledExpr::AddNumber()
+{
+	AddInstruction(OP_NUMBER, 0, VALUE_NO_OPERATOR, 0);
+}
+
+int CCompiledExpr::AddJump(bool conditional)
+{
+	/* the conditional jump pops the guard, the other one takes the branch value along */
+	AddInstruction((conditional) ? OP_JUMP_IF_FALSE : OP_JUMP, 0, VALUE_NO_OPERATOR, -1);
+	return m_instructions.size() - 1;
+}
+
+void CCompiledExpr::SetJumpTarget(int jump)
+{
+	m_instructions[jump].m_arg = m_instructions.size();
+}
+
+void CCompiledExpr::SetIdentifier(int index, CValue *value)
+{
+	Identifier& identifier = m_identifiers[index];
+
+	if (value)
+		value->AddRef();
+	if (identifier.m_value)
+		identifier.m_value->Release();
+
+	identifier.m_value = value;
+	identifier.m_state.m_type = VALUE_NO_TYPE;
+}
+
+void CCompiledExpr::SetIdentifier(int index, bool value)
+{
+	Identifier& identifier = m_identifiers[index];
+
+	if (identifier.m_value) {
+		identifier.m_value->Release();
+		identifier.m_value = NULL;
+	}
+	identifier.m_state.m_type = VALUE_BOOL_TYPE;
+	identifier.m_state.m_bool = value;
+}
+
+bool CCompiledExpr::ReadIdentifier(const Identifier& identifier, Operand& result)
+{
+	CValue *value = identifier.m_value;
+
+	if (!value) {
+		result = identifier.m_state;
+		return (result.m_type != VALUE_NO_TYPE);
+	}
+
+	result.m_type = value->GetValueType();
+	switch (result.m_type) {
+		case VALUE_INT_TYPE:
+			result.m_int = ((CIntValue *)value)->GetInt();
+			return true;
+		case VALUE_FLOAT_TYPE:
+			result.m_float = ((CFloatValue *)value)->GetFloat();
+			return true;
+		case VALUE_BOOL_TYPE:
+			result.m_bool = ((CBoolValue *)value)->GetBool();
+			return true;
+		case VALUE_STRING_TYPE:
+			result.m_string = &value->GetText();
+			return true;
+		default:
+			return false;
+	}
+}
+
+template <class T>
+static bool compare_operands(VALUE_OPERATOR op, const T& a, const T& b, bool& result)
+{
+	switch (op) {
+		case VALUE_EQL_OPERATOR: result = (a == b); return true;
+		case VALUE_NEQ_OPERATOR: result = (a != b); return true;
+		case VALUE_GRE_OPERATOR: result = (a > b); return true;
+		case VALUE_LES_OPERATOR: result = (a < b); return true;
+		case VALUE_GEQ_OPERATOR: result = (a >= b); return true;
+		case VALUE_LEQ_OPERATOR: result = (a <= b); return true;
+		default: return false;
+	}
+}
+
+/* Same results as CIntValue::CalcFinal() for two ints */
+static bool calc_int(VALUE_OPERATOR op, cInt a, cInt b, CCompiledExpr::Operand& result)
+{
+	result.m_type = VALUE_INT_TYPE;
+	switch (op) {
+		case VALUE_MOD_OPERATOR:
+			if (b == 0)
+				return false;
+			result.m_int = a % b;
+			return true;
+		case VALUE_ADD_OPERATOR:
+			result.m_int = a + b;
+			return true;
+		case VALUE_SUB_OPERATOR:
+			result.m_int = a - b;
+			return true;
+		case VALUE_MUL_OPERATOR:
+			result.m_int = a * b;
+			return true;
+		case VALUE_DIV_OPERATOR:
+			if (b == 0)
+				return false;
+			result.m_int = a / b;
+			return true;
+		default:
+			result.m_type = VALUE_BOOL_TYPE;
+			return compare_operands(op, a, b, result.m_bool);
+	}
+}
+
+/* Same results as CFloatValue::CalcFinal(), ints are converted to float first like in C++ */
+static bool calc_float(VALUE_OPERATOR op, float a, float b, double moda, double modb, CCompiledExpr::Operand& result)
+{
+	result.m_type = VALUE_FLOAT_TYPE;
+	switch (op) {
+		case VALUE_MOD_OPERATOR:
+			result.m_float = fmod(moda, modb);
+			return true;
+		case VALUE_ADD_OPERATOR:
+			result.m_float = a + b;
+			return true;
+		case VALUE_SUB_OPERATOR:
+			result.m_float = a - b;
+			return true;
+		case VALUE_MUL_OPERATOR:
+			result.m_float = a * b;
+			return true;
+		case VALUE_DIV_OPERATOR:
+			if (b == 0.0f)
+				return false;
+			result.m_float = a / b;
+			return true;
+		default:
+			result.m_type = VALUE_BOOL_TYPE;
+			return compare_operands(op, a, b, result.m_bool);
+	}
+}
+
+static bool calc_binary(VALUE_OPERATOR op, const CCompiledExpr::Operand& a, const CCompiledExpr::Operand& b,
+                        CCompiledExpr::Operand& result)
+{
+	if (op == VALUE_AND_OPERATOR || op == VALUE_OR_OPERATOR) {
+		if (a.m_type != VALUE_BOOL_TYPE || b.m_type != VALUE_BOOL_TYPE)
+			return false;
+		result.m_type = VALUE_BOOL_TYPE;
+		result.m_bool = (op == VALUE_AND_OPERATOR) ? (a.m_bool && b.m_bool) : (a.m_bool || b.m_bool);
+		return true;
+	}
+
+	switch (a.m_type) {
+		case VALUE_INT_TYPE:
+			if (b.m_type == VALUE_INT_TYPE)
+				return calc_int(op, a.m_int, b.m_int, result);
+			if (b.m_type == VALUE_FLOAT_TYPE)
+				return calc_float(op, (float)a.m_int, b.m_float, (double)a.m_int, b.m_float, result);
+			return false;
+		case VALUE_FLOAT_TYPE:
+			if (b.m_type == VALUE_FLOAT_TYPE)
+				return calc_float(op, a.m_float, b.m_float, a.m_float, b.m_float, result);
+			if (b.m_type == VALUE_INT_TYPE)
+				return calc_float(op, a.m_float, (float)b.m_int, a.m_float, (double)b.m_int, result);
+			return false;
+		case VALUE_BOOL_TYPE:
+			if (b.m_type != VALUE_BOOL_TYPE || (op != VALUE_EQL_OPERATOR && op != VALUE_NEQ_OPERATOR))
+				return false;
+			result.m_type = VALUE_BOOL_TYPE;
+			return compare_operands(op, a.m_bool, b.m_bool, result.m_bool);
+		case VALUE_STRING_TYPE:
+			/* concatenation would need a new string */
+			if (b.m_type != VALUE_STRING_TYPE)
+				return false;
+			result.m_type = VALUE_BOOL_TYPE;
+			return compare_operands(op, *a.m_string, *b.m_string, result.m_bool);
+		default:
+			return false;
+	}
+}
+
+/* Same results as CalcFinal() with an empty value, what COperator1Expr does */
+static bool calc_unary(VALUE_OPERATOR op, CCompiledExpr::Operand& value)
+{
+	switch (value.m_type) {
+		case VALUE_INT_TYPE:
+			if (op == VALUE_NEG_OPERATOR) {
+				value.m_int = -value.m_int;
+			}
+			else if (op == VALUE_NOT_OPERATOR) {
+				value.m_type = VALUE_BOOL_TYPE;
+				value.m_bool = (value.m_int == 0);
+			}
+			return true;
+		case VALUE_FLOAT_TYPE:
+			if (op == VALUE_NEG_OPERATOR) {
+				value.m_float = -value.m_float;
+			}
+			else if (op == VALUE_NOT_OPERATOR) {
+				value.m_type = VALUE_BOOL_TYPE;
+				value.m_bool = (value.m_float == 0.0f);
+			}
+			return true;
+		case VALUE_BOOL_TYPE:
+			if (op != VALUE_NOT_OPERATOR)
+				return false;
+			value.m_bool = !value.m_bool;
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool CCompiledExpr::Evaluate(double& result)
+{
+	Operand *stack = (m_stack.empty()) ? NULL : &m_stack[0];
+	const int numinstructions = m_instructions.size();
+	int top = -1;
+
+	for (int pc = 0; pc < numinstructions; pc++) {
+		const Instruction& instruction = m_instructions[pc];
+
+		switch (instruction.m_opcode) {
+			case OP_CONSTANT:
+				stack[++top] = m_constants[instruction.m_arg];
+				break;
+			case OP_IDENTIFIER:
+				if (!ReadIdentifier(m_identifiers[instruction.m_arg], stack[++top]))
+					return false;
+				break;
+			case OP_UNARY:
+				if (!calc_unary((VALUE_OPERATOR)instruction.m_operator, stack[top]))
+					return false;
+				break;
+			case OP_BINARY:
+			{
+				Operand value;
+				if (!calc_binary((VALUE_OPERATOR)instruction.m_operator, stack[top - 1], stack[top], value))
+					return false;
+				stack[--top] = value;
+				break;
+			}
+			case OP_NUMBER:
+			{
+				Operand& value = stack[top];
+				float number;
+				switch (value.m_type) {
+					case VALUE_INT_TYPE: number = (float)(double)value.m_int; break;
+					case VALUE_FLOAT_TYPE: number = value.m_float; break;
+					case VALUE_BOOL_TYPE: number = (value.m_bool) ? 1.0f : 0.0f; break;
+					case VALUE_STRING_TYPE: number = value.m_string->ToFloat(); break;
+					default: return false;
+				}
+				value.m_type = VALUE_FLOAT_TYPE;
+				value.m_float = number;
+				break;
+			}
+			case OP_JUMP:
+				pc = instruction.m_arg - 1;
+				break;
+			case OP_JUMP_IF_FALSE:
+				/* CIfExpr only accepts booleans */
+				if (stack[top].m_type != VALUE_BOOL_TYPE)
+					return false;
+				if (!stack[top--].m_bool)
+					pc = instruction.m_arg - 1;
+				break;
+		}
+	}
+
+	/* what GetNumber() gives for each type */
+	switch (stack[top].m_type) {
+		case VALUE_INT_TYPE: result = (double)stack[top].m_int; break;
+		case VALUE_FLOAT_TYPE: result = stack[top].m_float; break;
+		case VALUE_BOOL_TYPE: result = stack[top].m_bool; break;
+		case VALUE_STRING_TYPE: result = -1.0; break;
+		default: return false;
+	}
+	return true;
+}
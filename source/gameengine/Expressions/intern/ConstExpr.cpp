@@ -19,6 +19,7 @@
 #include "EXP_Value.h" // for precompiled header
 #include "EXP_ConstExpr.h"
 #include "EXP_VectorValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -61,6 +62,13 @@ unsigned char CConstExpr::GetExpressionID()
 
 
 
+bool CConstExpr::Compile(CCompiledExpr& program)
+{
+	return program.AddConstant(m_value);
+}
+
+
+
 CValue* CConstExpr::Calculate()
 /*
 pre:
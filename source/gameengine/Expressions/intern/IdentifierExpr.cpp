@@ -31,6 +31,7 @@
 
 
 #include "EXP_IdentifierExpr.h"
+#include "EXP_CompiledExpr.h"
 
 CIdentifierExpr::CIdentifierExpr(const STR_String& identifier,CValue* id_context)
 :m_identifier(identifier)
@@ -61,6 +62,14 @@ CValue*	CIdentifierExpr::Calculate()
 
 
 
+bool CIdentifierExpr::Compile(CCompiledExpr& program)
+{
+	program.AddIdentifier(m_identifier);
+	return true;
+}
+
+
+
 bool CIdentifierExpr::MergeExpression(CExpression* otherexpr)
 {
 	return false;
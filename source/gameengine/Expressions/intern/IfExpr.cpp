@@ -19,6 +19,7 @@
 #include "EXP_EmptyValue.h"
 #include "EXP_ErrorValue.h"
 #include "EXP_BoolValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -91,6 +92,26 @@ CValue* CIfExpr::Calculate()
 
 
 
+bool CIfExpr::Compile(CCompiledExpr& program)
+{
+	if (!m_guard->Compile(program))
+		return false;
+
+	const int elsejump = program.AddJump(true);
+	if (!m_e1->Compile(program))
+		return false;
+
+	const int endjump = program.AddJump(false);
+	program.SetJumpTarget(elsejump);
+	if (!m_e2->Compile(program))
+		return false;
+
+	program.SetJumpTarget(endjump);
+	return true;
+}
+
+
+
 bool CIfExpr::MergeExpression(CExpression *otherexpr)
 {
 	assertd(false);
@@ -17,6 +17,7 @@
 
 #include "EXP_Operator1Expr.h"
 #include "EXP_EmptyValue.h"
+#include "EXP_CompiledExpr.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -50,6 +51,15 @@ effect: deletes the object
 	if (m_lhs) m_lhs->Release();
 }
 
+bool COperator1Expr::Compile(CCompiledExpr& program)
+{
+	if (!m_lhs->Compile(program))
+		return false;
+
+	program.AddUnary(m_op);
+	return true;
+}
+
 CValue * COperator1Expr::Calculate()
 /*
 pre:
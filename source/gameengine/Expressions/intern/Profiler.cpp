@@ -0,0 +1,248 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/intern/Profiler.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_Profiler.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "MEM_guardedalloc.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_string.h"
+#include "BLI_threads.h"
+#include "PIL_time.h"
+#include "atomic_ops.h"
+}
+
+#define MAX_THREADS 64
+/* zones a thread can record between two frame ends, the oldest ones are lost after that */
+#define BUFFER_SIZE (1 << 15)
+#define NAME_SIZE 48
+/* thread id of the categories track in the trace */
+#define CATEGORIES_TID MAX_THREADS
+
+struct ProfileZone {
+	char m_name[NAME_SIZE];
+	double m_start;
+	double m_end;
+	CProfiler::Track m_track;
+};
+
+struct ProfileBuffer {
+	ProfileZone *m_zones;
+	/* zones written, only changed by the thread of the buffer */
+	uint32_t m_head;
+	/* zones written to the file, only used by the main thread */
+	uint32_t m_tail;
+};
+
+bool CProfiler::s_tracing = false;
+
+/* a thread keeps its index for all traces, only the buffers are freed at the end of a trace */
+static ProfileBuffer *s_buffers[MAX_THREADS] = {NULL};
+static bool s_mainThreads[MAX_THREADS];
+static int s_numThreads = 0;
+static ThreadMutex s_threadMutex = BLI_MUTEX_INITIALIZER;
+static pthread_key_t s_threadKey;
+static bool s_threadKeyCreated = false;
+
+static FILE *s_file = NULL;
+static bool s_firstEvent = true;
+static int s_framesLeft = 0;
+static int s_frame = 0;
+static double s_traceStart = 0.0;
+static double s_frameStart = 0.0;
+static unsigned int s_lostZones = 0;
+
+static ProfileBuffer *get_thread_buffer()
+{
+	/* the index plus one is stored, zero is a thread not seen yet */
+	intptr_t index = (intptr_t)pthread_getspecific(s_threadKey);
+
+	if (index == 0) {
+		BLI_mutex_lock(&s_threadMutex);
+		if (s_numThreads < MAX_THREADS) {
+			s_mainThreads[s_numThreads] = BLI_thread_is_main();
+			index = ++s_numThreads;
+		}
+		BLI_mutex_unlock(&s_threadMutex);
+
+		if (index == 0)
+			return NULL;
+		pthread_setspecific(s_threadKey, (void *)index);
+	}
+
+	ProfileBuffer *buffer = s_buffers[index - 1];
+	if (!buffer) {
+		buffer = (ProfileBuffer *)MEM_callocN(sizeof(ProfileBuffer), "CProfiler buffer");
+		buffer->m_zones = (ProfileZone *)MEM_mallocN(sizeof(ProfileZone) * BUFFER_SIZE, "CProfiler zones");
+		s_buffers[index - 1] = buffer;
+	}
+	return buffer;
+}
+
+static void write_event_name(const char *name)
+{
+	for (const char *c = name; *c; c++) {
+		if (*c == '"' || *c == '\\')
+			fputc('\\', s_file);
+		fputc(((unsigned char)*c < ' ') ? ' ' : *c, s_file);
+	}
+}
+
+static void write_zones(int thread, ProfileBuffer *buffer)
+{
+	const uint32_t head = atomic_add_uint32(&buffer->m_head, 0);
+	uint32_t tail = buffer->m_tail;
+
+	if (head - tail > BUFFER_SIZE) {
+		s_lostZones += head - tail - BUFFER_SIZE;
+		tail = head - BUFFER_SIZE;
+	}
+
+	for (; tail != head; tail++) {
+		const ProfileZone& zone = buffer->m_zones[tail & (BUFFER_SIZE - 1)];
+
+		fputs(s_firstEvent ? "\n{\"name\":\"" : ",\n{\"name\":\"", s_file);
+		write_event_name(zone.m_name);
+		fprintf(s_file, "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+		        (zone.m_start - s_traceStart) * 1e6, (zone.m_end - zone.m_start) * 1e6,
+		        (zone.m_track == CProfiler::TRACK_CATEGORIES) ? CATEGORIES_TID : thread);
+		s_firstEvent = false;
+	}
+	buffer->m_tail = head;
+}
+
+static void write_all_zones()
+{
+	BLI_mutex_lock(&s_threadMutex);
+	for (int i = 0; i < s_numThreads; i++) {
+		if (s_buffers[i])
+			write_zones(i, s_buffers[i]);
+	}
+	BLI_mutex_unlock(&s_threadMutex);
+}
+
+bool CProfiler::StartTrace(const char *filename, int frames)
+{
+	EndTrace();
+
+	if (frames <= 0)
+		return false;
+
+	s_file = fopen(filename, "w");
+	if (!s_file)
+		return false;
+
+	if (!s_threadKeyCreated) {
+		pthread_key_create(&s_threadKey, NULL);
+		s_threadKeyCreated = true;
+	}
+
+	fputs("{\"traceEvents\":[", s_file);
+	s_firstEvent = true;
+	s_framesLeft = frames;
+	s_frame = 0;
+	s_lostZones = 0;
+	s_traceStart = s_frameStart = GetTime();
+	s_tracing = true;
+
+	return true;
+}
+
+void CProfiler::EndTrace()
+{
+	if (!s_tracing)
+		return;
+
+	write_all_zones();
+	s_tracing = false;
+
+	for (int i = 0; i < s_numThreads; i++) {
+		fputs(s_firstEvent ? "\n" : ",\n", s_file);
+		if (s_mainThreads[i])
+			fprintf(s_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Main\"}}", i);
+		else
+			fprintf(s_file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Worker %d\"}}", i, i);
+		s_firstEvent = false;
+	}
+	fprintf(s_file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"Categories\"}}",
+	        s_firstEvent ? "\n" : ",\n", CATEGORIES_TID);
+	fprintf(s_file, "\n],\n\"displayTimeUnit\":\"ms\",\n\"otherData\":{\"frames\":%d,\"lost_zones\":%u}\n}\n",
+	        s_frame, s_lostZones);
+	fclose(s_file);
+	s_file = NULL;
+
+	for (int i = 0; i < s_numThreads; i++) {
+		if (s_buffers[i]) {
+			MEM_freeN(s_buffers[i]->m_zones);
+			MEM_freeN(s_buffers[i]);
+			s_buffers[i] = NULL;
+		}
+	}
+}
+
+double CProfiler::GetTime()
+{
+	return PIL_check_seconds_timer();
+}
+
+void CProfiler::AddZone(const char *name, double start, Track track)
+{
+	if (!s_tracing)
+		return;
+
+	ProfileBuffer *buffer = get_thread_buffer();
+	if (!buffer)
+		return;
+
+	ProfileZone& zone = buffer->m_zones[buffer->m_head & (BUFFER_SIZE - 1)];
+	BLI_strncpy(zone.m_name, name, NAME_SIZE);
+	zone.m_start = start;
+	zone.m_end = GetTime();
+	zone.m_track = track;
+
+	/* the zone is complete before the main thread can see it */
+	atomic_add_uint32(&buffer->m_head, 1);
+}
+
+void CProfiler::EndFrame()
+{
+	if (!s_tracing)
+		return;
+
+	char name[NAME_SIZE];
+	BLI_snprintf(name, sizeof(name), "Frame %d", s_frame++);
+	AddZone(name, s_frameStart);
+	s_frameStart = GetTime();
+
+	write_all_zones();
+
+	if (--s_framesLeft == 0)
+		EndTrace();
+}
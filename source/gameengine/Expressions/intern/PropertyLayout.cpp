@@ -0,0 +1,121 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Expressions/intern/PropertyLayout.cpp
+ *  \ingroup expressions
+ */
+
+#include "EXP_PropertyLayout.h"
+
+#include "atomic_ops.h"
+
+#include <algorithm>
+
+uint32_t CPropertyLayout::s_lastId = 0;
+
+CPropertyLayout::CPropertyLayout()
+	:m_slots(8),
+	m_derived(4),
+	m_parent(NULL),
+	m_refcount(1),
+	m_id(atomic_add_uint32(&s_lastId, 1))
+{
+}
+
+CPropertyLayout::~CPropertyLayout()
+{
+	Detach();
+
+	/* the derived layouts stay with their values, they can't be found anymore */
+	for (int i = 0; i < m_derived.size(); i++)
+		(*m_derived.at(i))->m_parent = NULL;
+}
+
+void CPropertyLayout::Release()
+{
+	if (--m_refcount == 0)
+		delete this;
+}
+
+void CPropertyLayout::Append(const Name& name)
+{
+	const STR_HashedString key(STR_String(name.m_str, name.m_length));
+	const int slot = (int)m_names.size();
+
+	m_slots.insert(key, slot);
+	m_names.push_back(key);
+
+	/* keep the alphabetical order of the old property map for the names and index access */
+	std::vector<int>::iterator pos = m_sorted.begin();
+	while (pos != m_sorted.end() && m_names[*pos] < key)
+		++pos;
+	m_sorted.insert(pos, slot);
+
+	/* the slot a key didn't find can now exist */
+	m_id = atomic_add_uint32(&s_lastId, 1);
+}
+
+/* Leave the map of the parent, the key is the last name while no other was added */
+void CPropertyLayout::Detach()
+{
+	if (m_parent) {
+		m_parent->m_derived.remove(m_names.back());
+		m_parent = NULL;
+	}
+}
+
+int CPropertyLayout::AddSlot(CPropertyLayout *&layout, const Name& name)
+{
+	if (layout->m_refcount == 1 && layout->m_parent == NULL) {
+		/* nobody else uses it or can find it, the derived layouts would miss the new name */
+		for (int i = 0; i < layout->m_derived.size(); i++)
+			(*layout->m_derived.at(i))->m_parent = NULL;
+		layout->m_derived.clear();
+
+		layout->Append(name);
+		return layout->GetSlotCount() - 1;
+	}
+
+	/* a layout still in the map of its parent is derived too, the values adding the same
+	 * names get the same layout. It leaves the map as soon as its last value does, so a
+	 * single value adding many names only copies them twice */
+	CPropertyLayout *derived = NULL;
+	const int index = layout->m_derived.find(name);
+	if (index != -1) {
+		derived = (*layout->m_derived.at(index))->AddRef();
+	}
+	else {
+		derived = new CPropertyLayout();
+		for (std::vector<STR_HashedString>::iterator it = layout->m_names.begin(); it != layout->m_names.end(); ++it) {
+			derived->m_slots.insert(*it, derived->GetSlotCount());
+			derived->m_names.push_back(*it);
+		}
+		derived->m_sorted = layout->m_sorted;
+		derived->Append(name);
+		derived->m_parent = layout;
+		layout->m_derived.insert(derived->m_names.back(), derived);
+	}
+
+	layout->Release();
+	layout = derived;
+	return derived->GetSlotCount() - 1;
+}
@@ -94,7 +94,8 @@ CValue::CValue()
 		: PyObjectPlus(),
 	
 m_pNamedPropertyArray(NULL),
-m_refcount(1)
+m_refcount(1),
+m_propertyGeneration(0)
 /*
 pre: false
 effect: constucts a CValue
@@ -208,7 +209,7 @@ STR_String CValue::op2str(VALUE_OPERATOR op)
 //
 // Set property <ioProperty>, overwrites and releases a previous property with the same name if needed
 //
-void CValue::SetProperty(const STR_String & name,CValue* ioProperty)
+void CValue::SetPropertySlot(const CPropertyLayout::Name& name, CValue* ioProperty)
 {
 	if (ioProperty==NULL)
 	{	// Check if somebody is setting an empty property
@@ -216,63 +217,75 @@ void CValue::SetProperty(const STR_String & name,CValue* ioProperty)
 		return;
 	}
 
-	if (m_pNamedPropertyArray)
-	{	// Try to replace property (if so -> exit as soon as we replaced it)
-		CValue* oldval = (*m_pNamedPropertyArray)[name];
-		if (oldval)
-			oldval->Release();
+	if (m_pNamedPropertyArray == NULL)
+	{	// Make sure we have a property array
+		m_pNamedPropertyArray = new PropertyArray;
+		m_pNamedPropertyArray->m_layout = new CPropertyLayout();
+		m_pNamedPropertyArray->m_count = 0;
 	}
-	else { // Make sure we have a property array
-		m_pNamedPropertyArray = new std::map<STR_String,CValue *>;
+
+	PropertyArray *props = m_pNamedPropertyArray;
+	int slot = props->m_layout->FindSlot(name);
+	if (slot < 0) {
+		slot = CPropertyLayout::AddSlot(props->m_layout, name);
+		props->m_values.resize(props->m_layout->GetSlotCount(), NULL);
 	}
-	
-	// Add property at end of array
-	(*m_pNamedPropertyArray)[name] = ioProperty->AddRef();//->Add(ioProperty);
+
+	CValue *oldval = props->m_values[slot];
+	if (oldval)
+		oldval->Release();
+	else
+		props->m_count++;
+
+	props->m_values[slot] = ioProperty->AddRef();
+	m_propertyGeneration++;
 }
 
-void CValue::SetProperty(const char* name,CValue* ioProperty)
+void CValue::SetProperty(const STR_String & name,CValue* ioProperty)
 {
-	if (ioProperty==NULL)
-	{	// Check if somebody is setting an empty property
-		trace("Warning:trying to set empty property!");
-		return;
-	}
+	SetPropertySlot(CPropertyLayout::Name(name.ReadPtr(), name.Length()), ioProperty);
+}
 
-	if (m_pNamedPropertyArray)
-	{	// Try to replace property (if so -> exit as soon as we replaced it)
-		CValue* oldval = (*m_pNamedPropertyArray)[name];
-		if (oldval)
-			oldval->Release();
-	}
-	else { // Make sure we have a property array
-		m_pNamedPropertyArray = new std::map<STR_String,CValue *>;
-	}
-	
-	// Add property at end of array
-	(*m_pNamedPropertyArray)[name] = ioProperty->AddRef();//->Add(ioProperty);
+void CValue::SetProperty(const char* name,CValue* ioProperty)
+{
+	SetPropertySlot(CPropertyLayout::Name(name, strlen(name)), ioProperty);
 }
 
 //
 // Get pointer to a property with name <inName>, returns NULL if there is no property named <inName>
 //
-CValue* CValue::GetProperty(const STR_String & inName)
+CValue* CValue::GetPropertySlot(const CPropertyLayout::Name& name)
 {
 	if (m_pNamedPropertyArray) {
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
-			return (*it).second;
+		const int slot = m_pNamedPropertyArray->m_layout->FindSlot(name);
+		if (slot >= 0)
+			return m_pNamedPropertyArray->m_values[slot];
 	}
 	return NULL;
 }
 
+CValue* CValue::GetProperty(const STR_String & inName)
+{
+	return GetPropertySlot(CPropertyLayout::Name(inName.ReadPtr(), inName.Length()));
+}
+
 CValue* CValue::GetProperty(const char *inName)
 {
-	if (m_pNamedPropertyArray) {
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
-			return (*it).second;
+	return GetPropertySlot(CPropertyLayout::Name(inName, strlen(inName)));
+}
+
+CValue* CValue::GetProperty(CPropertyKey& key)
+{
+	if (m_pNamedPropertyArray == NULL)
+		return NULL;
+
+	const CPropertyLayout *layout = m_pNamedPropertyArray->m_layout;
+	if (key.m_layoutId != layout->GetId()) {
+		const STR_String& name = key.m_name;
+		key.m_slot = layout->FindSlot(CPropertyLayout::Name(name.ReadPtr(), name.Length()));
+		key.m_layoutId = layout->GetId();
 	}
-	return NULL;
+	return (key.m_slot >= 0) ? m_pNamedPropertyArray->m_values[key.m_slot] : NULL;
 }
 
 //
@@ -308,11 +321,14 @@ bool CValue::RemoveProperty(const char *inName)
 	// Check if there are properties at all which can be removed
 	if (m_pNamedPropertyArray)
 	{
-		std::map<STR_String,CValue*>::iterator it = m_pNamedPropertyArray->find(inName);
-		if (it != m_pNamedPropertyArray->end())
+		const int slot = m_pNamedPropertyArray->m_layout->FindSlot(CPropertyLayout::Name(inName, strlen(inName)));
+		if (slot >= 0 && m_pNamedPropertyArray->m_values[slot])
 		{
-			((*it).second)->Release();
-			m_pNamedPropertyArray->erase(it);
+			// The slot stays in the layout, it is used again if the property is set back
+			m_pNamedPropertyArray->m_values[slot]->Release();
+			m_pNamedPropertyArray->m_values[slot] = NULL;
+			m_pNamedPropertyArray->m_count--;
+			m_propertyGeneration++;
 			return true;
 		}
 	}
@@ -327,12 +343,14 @@ vector<STR_String> CValue::GetPropertyNames()
 {
 	vector<STR_String> result;
 	if (!m_pNamedPropertyArray) return result;
-	result.reserve(m_pNamedPropertyArray->size());
+	result.reserve(m_pNamedPropertyArray->m_count);
 	
-	std::map<STR_String,CValue*>::iterator it;
-	for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
+	const CPropertyLayout *layout = m_pNamedPropertyArray->m_layout;
+	for (int i = 0; i < layout->GetSlotCount(); i++)
 	{
-		result.push_back((*it).first);
+		const int slot = layout->GetSortedSlot(i);
+		if (m_pNamedPropertyArray->m_values[slot])
+			result.push_back(layout->GetSlotName(slot));
 	}
 	return result;
 }
@@ -347,17 +365,55 @@ void CValue::ClearProperties()
 		return;
 
 	// Remove all properties
-	std::map<STR_String,CValue*>::iterator it;
-	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
+	std::vector<CValue *>::iterator it;
+	for (it= m_pNamedPropertyArray->m_values.begin();(it != m_pNamedPropertyArray->m_values.end()); it++)
 	{
-		CValue* tmpval = (*it).second;
-		//STR_String name = (*it).first;
-		tmpval->Release();
+		if (*it)
+			(*it)->Release();
 	}
 
 	// Delete property array
+	m_pNamedPropertyArray->m_layout->Release();
 	delete m_pNamedPropertyArray;
 	m_pNamedPropertyArray=NULL;
+	m_propertyGeneration++;
+}
+
+
+
+//
+// Replace all properties by replicas of the properties of <source>, like a new replica of it
+//
+void CValue::CopyProperties(CValue* source)
+{
+	PropertyArray *srcprops = source->m_pNamedPropertyArray;
+	if (srcprops == NULL) {
+		ClearProperties();
+		return;
+	}
+
+	if (m_pNamedPropertyArray == NULL) {
+		m_pNamedPropertyArray = new PropertyArray;
+		m_pNamedPropertyArray->m_layout = srcprops->m_layout->AddRef();
+	}
+	else if (m_pNamedPropertyArray->m_layout != srcprops->m_layout) {
+		m_pNamedPropertyArray->m_layout->Release();
+		m_pNamedPropertyArray->m_layout = srcprops->m_layout->AddRef();
+	}
+
+	PropertyArray *props = m_pNamedPropertyArray;
+	for (unsigned int i = 0; i < props->m_values.size(); i++)
+	{
+		if (props->m_values[i])
+			props->m_values[i]->Release();
+	}
+	props->m_values.resize(srcprops->m_values.size());
+	for (unsigned int i = 0; i < srcprops->m_values.size(); i++)
+	{
+		props->m_values[i] = (srcprops->m_values[i]) ? srcprops->m_values[i]->GetReplica() : NULL;
+	}
+	props->m_count = srcprops->m_count;
+	m_propertyGeneration++;
 }
 
 
@@ -368,10 +424,11 @@ void CValue::ClearProperties()
 void CValue::SetPropertiesModified(bool inModified)
 {
 	if (!m_pNamedPropertyArray) return;
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<CValue *>::iterator it;
 	
-	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
-		((*it).second)->SetModified(inModified);
+	for (it= m_pNamedPropertyArray->m_values.begin();(it != m_pNamedPropertyArray->m_values.end()); it++)
+		if (*it)
+			(*it)->SetModified(inModified);
 }
 
 
@@ -382,10 +439,10 @@ void CValue::SetPropertiesModified(bool inModified)
 bool CValue::IsAnyPropertyModified()
 {
 	if (!m_pNamedPropertyArray) return false;
-	std::map<STR_String,CValue*>::iterator it;
+	std::vector<CValue *>::iterator it;
 	
-	for (it= m_pNamedPropertyArray->begin();(it != m_pNamedPropertyArray->end()); it++)
-		if (((*it).second)->IsModified())
+	for (it= m_pNamedPropertyArray->m_values.begin();(it != m_pNamedPropertyArray->m_values.end()); it++)
+		if (*it && (*it)->IsModified())
 			return true;
 	
 	return false;
@@ -398,24 +455,23 @@ bool CValue::IsAnyPropertyModified()
 //
 CValue* CValue::GetProperty(int inIndex)
 {
+	if (!m_pNamedPropertyArray || inIndex < 0 || inIndex >= m_pNamedPropertyArray->m_count)
+		return NULL;
 
-	int count=0;
-	CValue* result = NULL;
+	// Properties are numbered in the alphabetical order of their names
+	const CPropertyLayout *layout = m_pNamedPropertyArray->m_layout;
+	const std::vector<CValue *>& values = m_pNamedPropertyArray->m_values;
+	if (m_pNamedPropertyArray->m_count == layout->GetSlotCount())
+		return values[layout->GetSortedSlot(inIndex)];
 
-	if (m_pNamedPropertyArray)
+	int count=0;
+	for (int i = 0; i < layout->GetSlotCount(); i++)
 	{
-		std::map<STR_String,CValue*>::iterator it;
-		for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
-		{
-			if (count++ == inIndex)
-			{
-				result = (*it).second;
-				break;
-			}
-		}
-
+		CValue *result = values[layout->GetSortedSlot(i)];
+		if (result && count++ == inIndex)
+			return result;
 	}
-	return result;
+	return NULL;
 }
 
 
@@ -426,7 +482,7 @@ CValue* CValue::GetProperty(int inIndex)
 int CValue::GetPropertyCount()
 {
 	if (m_pNamedPropertyArray)
-		return m_pNamedPropertyArray->size();
+		return m_pNamedPropertyArray->m_count;
 	else
 		return 0;
 }
@@ -479,17 +535,18 @@ void CValue::ProcessReplica() /* was AddDataToReplica in 2.48 */
 
 	m_ValFlags.RefCountDisabled = false;
 
-	/* copy all props */
+	/* copy all props, the replica shares the layout */
 	if (m_pNamedPropertyArray)
 	{
-		std::map<STR_String,CValue*> *pOldArray = m_pNamedPropertyArray;
-		m_pNamedPropertyArray=NULL;
-		std::map<STR_String,CValue*>::iterator it;
-		for (it= pOldArray->begin(); (it != pOldArray->end()); it++)
+		PropertyArray *pOldArray = m_pNamedPropertyArray;
+		m_pNamedPropertyArray = new PropertyArray;
+		m_pNamedPropertyArray->m_layout = pOldArray->m_layout->AddRef();
+		m_pNamedPropertyArray->m_values.resize(pOldArray->m_values.size(), NULL);
+		m_pNamedPropertyArray->m_count = pOldArray->m_count;
+		for (unsigned int i = 0; i < pOldArray->m_values.size(); i++)
 		{
-			CValue *val = (*it).second->GetReplica();
-			SetProperty((*it).first,val);
-			val->Release();
+			if (pOldArray->m_values[i])
+				m_pNamedPropertyArray->m_values[i] = pOldArray->m_values[i]->GetReplica();
 		}
 	}
 }
@@ -633,13 +690,15 @@ PyObject *CValue::ConvertKeysToPython(void)
 {
 	if (m_pNamedPropertyArray)
 	{
-		PyObject *pylist= PyList_New(m_pNamedPropertyArray->size());
+		PyObject *pylist= PyList_New(m_pNamedPropertyArray->m_count);
 		Py_ssize_t i= 0;
 
-		std::map<STR_String,CValue*>::iterator it;
-		for (it= m_pNamedPropertyArray->begin(); (it != m_pNamedPropertyArray->end()); it++)
+		const CPropertyLayout *layout = m_pNamedPropertyArray->m_layout;
+		for (int j = 0; j < layout->GetSlotCount(); j++)
 		{
-			PyList_SET_ITEM(pylist, i++, PyString_From_STR_String((*it).first));
+			const int slot = layout->GetSortedSlot(j);
+			if (m_pNamedPropertyArray->m_values[slot])
+				PyList_SET_ITEM(pylist, i++, PyString_From_STR_String(layout->GetSlotName(slot)));
 		}
 
 		return pylist;
@@ -60,7 +60,8 @@ public:
 		NETWORK_EVENTMGR,
 		JOY_EVENTMGR,
 		ACTUATOR_EVENTMGR,
-		BASIC_EVENTMGR
+		BASIC_EVENTMGR,
+		EVENTMGR_MAX
 	};
 
 	SCA_EventManager(SCA_LogicManager* logicmgr, EVENT_MANAGER_TYPE mgrtype);
@@ -38,6 +38,7 @@
 #include "SCA_LogicManager.h"
 #include "EXP_BoolValue.h"
 #include "EXP_InputParser.h"
+#include "EXP_CompiledExpr.h"
 #include "MT_Transform.h" // for fuzzyZero
 
 #include <stdio.h>
@@ -51,7 +52,11 @@ SCA_ExpressionController::SCA_ExpressionController(SCA_IObject* gameobj,
 												   const STR_String& exprtext)
 	:SCA_IController(gameobj),
 	m_exprText(exprtext),
-	m_exprCache(NULL)
+	m_exprCache(NULL),
+	m_program(NULL),
+	m_compiled(false),
+	m_boundPropertyGeneration(0),
+	m_boundSensorGeneration(0)
 {
 }
 
@@ -61,6 +66,7 @@ SCA_ExpressionController::~SCA_ExpressionController()
 {
 	if (m_exprCache)
 		m_exprCache->Release();
+	delete m_program;
 }
 
 
@@ -70,6 +76,9 @@ CValue* SCA_ExpressionController::GetReplica()
 	SCA_ExpressionController* replica = new SCA_ExpressionController(*this);
 	replica->m_exprText = m_exprText;
 	replica->m_exprCache = NULL;
+	replica->m_program = NULL;
+	replica->m_compiled = false;
+	replica->m_identifierSensors.clear();
 	// this will copy properties and so on...
 	replica->ProcessReplica();
 
@@ -86,21 +95,84 @@ void SCA_ExpressionController::Delete()
 		m_exprCache->Release();
 		m_exprCache = NULL;
 	}
+	delete m_program;
+	m_program = NULL;
 	Release();
 }
 
 
+/* Look up the identifiers the same way FindIdentifier() does, but only once */
+void SCA_ExpressionController::BindIdentifiers()
+{
+	CValue *parent = GetParent();
+	const int numidentifiers = m_program->GetIdentifierCount();
+
+	m_identifierSensors.assign(numidentifiers, NULL);
+
+	for (int i = 0; i < numidentifiers; i++) {
+		const STR_String& name = m_program->GetIdentifierName(i);
+
+		for (vector<SCA_ISensor*>::const_iterator is = m_linkedsensors.begin(); is != m_linkedsensors.end(); ++is) {
+			if ((*is)->GetName() == name) {
+				m_identifierSensors[i] = *is;
+				break;
+			}
+		}
+
+		if (!m_identifierSensors[i]) {
+			/* names with a dot are looked up in sub properties, leave them to the expression tree */
+			m_program->SetIdentifier(i, (name.Find('.') < 0) ? parent->GetProperty(name) : NULL);
+		}
+	}
+
+	m_boundPropertyGeneration = parent->GetPropertyGeneration();
+	m_boundSensorGeneration = m_sensorGeneration;
+}
+
 void SCA_ExpressionController::Trigger(SCA_LogicManager* logicmgr)
 {
 
 	bool expressionresult = false;
+	bool evaluated = false;
 	if (!m_exprCache)
 	{
 		CParser parser;
 		parser.SetContext(this->AddRef());
 		m_exprCache = parser.ProcessText(m_exprText);
 	}
-	if (m_exprCache)
+	if (m_exprCache && !m_compiled)
+	{
+		m_compiled = true;
+		m_program = new CCompiledExpr();
+		if (m_program->Compile(m_exprCache)) {
+			BindIdentifiers();
+		}
+		else {
+			delete m_program;
+			m_program = NULL;
+		}
+	}
+	if (m_program)
+	{
+		if (m_boundPropertyGeneration != GetParent()->GetPropertyGeneration() ||
+		    m_boundSensorGeneration != m_sensorGeneration)
+		{
+			BindIdentifiers();
+		}
+
+		for (unsigned int i = 0; i < m_identifierSensors.size(); i++) {
+			if (m_identifierSensors[i])
+				m_program->SetIdentifier(i, m_identifierSensors[i]->GetState());
+		}
+
+		double result;
+		if (m_program->Evaluate(result)) {
+			expressionresult = !MT_fuzzyZero((float)result);
+			evaluated = true;
+		}
+	}
+	/* errors and what the bytecode can't do */
+	if (m_exprCache && !evaluated)
 	{
 		CValue* value = m_exprCache->Calculate();
 		if (value)
@@ -42,6 +42,13 @@ class SCA_ExpressionController : public SCA_IController
 //	Py_Header
 	STR_String			m_exprText;
 	CExpression*		m_exprCache;
+	class CCompiledExpr*	m_program;			/* bytecode of m_exprCache, NULL when it can't be compiled */
+	bool				m_compiled;
+	std::vector<class SCA_ISensor*>	m_identifierSensors;	/* sensor read by each identifier of m_program */
+	unsigned int		m_boundPropertyGeneration;	/* generations of the bound properties and sensors */
+	unsigned int		m_boundSensorGeneration;
+
+	void				BindIdentifiers();
 
 public:
 	SCA_ExpressionController(SCA_IObject* gameobj,
@@ -89,6 +89,14 @@ void SCA_IActuator::ProcessReplica()
 	m_linkedcontrollers.clear();
 }
 
+void SCA_IActuator::ResetReplica()
+{
+	SetActive(false);
+	ClrLink();
+	RemoveAllEvents();
+	m_linkedcontrollers.clear();
+}
+
 
 
 SCA_IActuator::~SCA_IActuator()
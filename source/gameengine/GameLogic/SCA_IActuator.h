@@ -90,6 +90,7 @@ public:
 		KX_ACT_ARMATURE,
 		KX_ACT_STEERING,
 		KX_ACT_MOUSE,
+		KX_ACT_MAX
 	};
 
 	SCA_IActuator(SCA_IObject* gameobj, KX_ACTUATOR_TYPE type); 
@@ -130,6 +131,12 @@ public:
 	}
 
 	virtual void ProcessReplica();
+	/**
+	 * Bring the actuator of an ended replica back to the state of a new replica,
+	 * see SCA_IObject::ResetLogic(). Actuators that keep a state between
+	 * updates reset it too.
+	 */
+	virtual void ResetReplica();
 
 	/** 
 	 * Return true if all the current events
@@ -159,6 +166,7 @@ public:
 	void DecLink();
 	bool IsNoLink() const { return !m_links; }
 	bool IsType(KX_ACTUATOR_TYPE type) { return m_type == type; }
+	KX_ACTUATOR_TYPE GetActuatorType() const { return (KX_ACTUATOR_TYPE)m_type; }
 	
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:SCA_IActuator")
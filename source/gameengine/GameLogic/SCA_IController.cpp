@@ -45,6 +45,7 @@ SCA_IController::SCA_IController(SCA_IObject* gameobj)
 	:
 	SCA_ILogicBrick(gameobj),
 	m_statemask(0),
+	m_sensorGeneration(0),
 	m_justActivated(false)
 {
 }
@@ -84,6 +85,7 @@ void SCA_IController::UnlinkAllSensors()
 		(*sensit)->UnlinkController(this);
 	}
 	m_linkedsensors.clear();
+	m_sensorGeneration++;
 }
 
 
@@ -135,6 +137,7 @@ void	SCA_IController::UnlinkActuator(class SCA_IActuator* actua)
 void SCA_IController::LinkToSensor(SCA_ISensor* sensor)
 {
 	m_linkedsensors.push_back(sensor);
+	m_sensorGeneration++;
 	if (IsActive())
 	{
 		sensor->IncLink();
@@ -154,6 +157,7 @@ void SCA_IController::UnlinkSensor(class SCA_ISensor* sensor)
 			}
 			*sensit = m_linkedsensors.back();
 			m_linkedsensors.pop_back();
+			m_sensorGeneration++;
 			return;
 		}
 	}
@@ -200,6 +204,18 @@ void SCA_IController::ApplyState(unsigned int state)
 	}
 }
 
+void SCA_IController::ResetReplica(SCA_IController* templatecont)
+{
+	Deactivate();
+	SetActive(false);
+	m_justActivated = false;
+	// the links point to the bricks of the template, as in a new replica,
+	// KX_Scene::ReplicateLogic() maps them to the bricks of the replica
+	m_linkedsensors = templatecont->m_linkedsensors;
+	m_linkedactuators = templatecont->m_linkedactuators;
+	m_sensorGeneration++;
+}
+
 #ifdef WITH_PYTHON
 
 /* Python api */
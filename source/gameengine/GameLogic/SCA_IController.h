@@ -47,6 +47,7 @@ protected:
 	std::vector<class SCA_ISensor*>		m_linkedsensors;
 	std::vector<class SCA_IActuator*>	m_linkedactuators;
 	unsigned int						m_statemask;
+	unsigned int						m_sensorGeneration;	/* changes when sensors are linked or unlinked */
 	bool								m_justActivated;
 	bool								m_bookmark;
 public:
@@ -67,6 +68,11 @@ public:
 	void	UnlinkSensor(class SCA_ISensor* sensor);
 	void	SetState(unsigned int state) { m_statemask = state; }
 	void	ApplyState(unsigned int state);
+	/**
+	 * Bring the controller of an ended replica back to the state of a new replica,
+	 * with the links of \param templatecont, see SCA_IObject::ResetLogic().
+	 */
+	virtual void ResetReplica(SCA_IController* templatecont);
 	void	Deactivate()
 	{
 		// the controller can only be part of a sensor m_newControllers list
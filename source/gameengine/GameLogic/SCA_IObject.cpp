@@ -150,6 +150,27 @@ void SCA_IObject::UnregisterObject(SCA_IObject* obj)
 	}
 }
 
+void SCA_IObject::UnlinkRegistered()
+{
+	// the actuators of this object keep pointing to it
+	SCA_ActuatorList ownactuators;
+	SCA_ActuatorList::iterator ita;
+	for (ita = m_registeredActuators.begin(); !(ita==m_registeredActuators.end()); ++ita)
+	{
+		if ((*ita)->GetParent() == this)
+			ownactuators.push_back(*ita);
+		else
+			(*ita)->UnlinkObject(this);
+	}
+	SCA_ObjectList::iterator ito;
+	for (ito = m_registeredObjects.begin(); !(ito==m_registeredObjects.end()); ++ito)
+	{
+		(*ito)->UnlinkObject(this);
+	}
+	m_registeredActuators.swap(ownactuators);
+	m_registeredObjects.clear();
+}
+
 void SCA_IObject::ReParentLogic()
 {
 	SCA_ActuatorList& oldactuators  = GetActuators();
@@ -195,6 +216,28 @@ void SCA_IObject::ReParentLogic()
 	m_registeredObjects.clear();
 }
 
+void SCA_IObject::ResetLogic(SCA_IObject* templateobj)
+{
+	// the bricks are kept, they were unlinked when the object ended
+	SCA_SensorList::iterator its;
+	for (its = m_sensors.begin(); !(its == m_sensors.end()); ++its)
+	{
+		(*its)->ResetReplica();
+	}
+	SCA_ControllerList& templatecontrollers = templateobj->GetControllers();
+	int cont = 0;
+	SCA_ControllerList::iterator itc;
+	for (itc = m_controllers.begin(); !(itc == m_controllers.end()); ++itc)
+	{
+		(*itc)->ResetReplica(templatecontrollers[cont++]);
+	}
+	SCA_ActuatorList::iterator ita;
+	for (ita = m_actuators.begin(); !(ita==m_actuators.end()); ++ita)
+	{
+		(*ita)->ResetReplica();
+	}
+}
+
 
 
 SCA_ISensor* SCA_IObject::FindSensor(const STR_String& sensorname)
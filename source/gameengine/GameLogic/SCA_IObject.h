@@ -151,6 +151,12 @@ public:
 	
 	void RegisterObject(SCA_IObject* objs);
 	void UnregisterObject(SCA_IObject* objs);
+	/**
+	 * Inform the actuators and objects registered to this object that it is gone, as when it
+	 * is deleted, and forget them, except its own actuators. Used when an ended replica is
+	 * kept to be added again.
+	 */
+	void UnlinkRegistered();
 	/**
 	 * UnlinkObject(...)
 	 * this object is informed that one of the object to which it holds a reference is deleted
@@ -165,6 +171,11 @@ public:
 	void SetCurrentTime(float currentTime) {}
 
 	virtual void ReParentLogic();
+	/**
+	 * Reset the bricks to the state ReParentLogic() gives to the bricks of a new replica
+	 * of \param templateobj. Used when an ended replica is added again.
+	 */
+	void ResetLogic(SCA_IObject* templateobj);
 	
 	/**
 	 * Set whether or not to ignore activity culling requests
@@ -86,6 +86,18 @@ void SCA_ISensor::ProcessReplica()
 	m_linkedcontrollers.clear();
 }
 
+void SCA_ISensor::ResetReplica()
+{
+	SetActive(false);
+	ClrLink();
+	m_linkedcontrollers.clear();
+	m_state = false;
+	m_prev_state = false;
+	m_pos_ticks = 0;
+	m_neg_ticks = 0;
+	Init();
+}
+
 bool SCA_ISensor::IsPositiveTrigger()
 {
 	bool result = false;
@@ -146,6 +146,11 @@ public:
 	void ActivateControllers(class SCA_LogicManager* logicmgr);
 
 	virtual void ProcessReplica();
+	/**
+	 * Bring the sensor of an ended replica back to the state of a new replica,
+	 * see SCA_IObject::ResetLogic().
+	 */
+	void ResetReplica();
 
 	virtual double GetNumber();
 
@@ -37,8 +37,57 @@
 #include "SCA_IActuator.h"
 #include "SCA_EventManager.h"
 #include "SCA_PythonController.h"
+#include "EXP_Profiler.h"
+#include "BLI_utildefines.h"
 #include <set>
 
+/* profiler zone names, indexed by SCA_EventManager::EVENT_MANAGER_TYPE */
+static const char *event_manager_zones[] = {
+	"Keyboard sensors",
+	"Mouse sensors",
+	"Always sensors",
+	"Collision sensors",
+	"Property sensors",
+	"Time",
+	"Random sensors",
+	"Ray sensors",
+	"Network sensors",
+	"Joystick sensors",
+	"Actuator sensors",
+	"Basic sensors",
+};
+BLI_STATIC_ASSERT(ARRAY_SIZE(event_manager_zones) == SCA_EventManager::EVENTMGR_MAX, "missing event manager zone names");
+
+/* profiler zone names, indexed by SCA_IActuator::KX_ACTUATOR_TYPE */
+static const char *actuator_zones[] = {
+	"Motion actuator",
+	"Ipo actuator",
+	"Camera actuator",
+	"Sound actuator",
+	"Property actuator",
+	"Add object actuator",
+	"End object actuator",
+	"Dynamic actuator",
+	"Replace mesh actuator",
+	"Track to actuator",
+	"Constraint actuator",
+	"Scene actuator",
+	"Random actuator",
+	"Message actuator",
+	"Action actuator",
+	"CD actuator",
+	"Game actuator",
+	"Visibility actuator",
+	"2D filter actuator",
+	"Parent actuator",
+	"Shape action actuator",
+	"State actuator",
+	"Armature actuator",
+	"Steering actuator",
+	"Mouse actuator",
+};
+BLI_STATIC_ASSERT(ARRAY_SIZE(actuator_zones) == SCA_IActuator::KX_ACT_MAX, "missing actuator zone names");
+
 
 SCA_LogicManager::SCA_LogicManager()
 {
@@ -186,8 +235,10 @@ void SCA_LogicManager::RegisterToActuator(SCA_IController* controller,SCA_IActua
 
 void SCA_LogicManager::BeginFrame(double curtime, double fixedtime)
 {
-	for (vector<SCA_EventManager*>::const_iterator ie=m_eventmanagers.begin(); !(ie==m_eventmanagers.end()); ie++)
+	for (vector<SCA_EventManager*>::const_iterator ie=m_eventmanagers.begin(); !(ie==m_eventmanagers.end()); ie++) {
+		CProfileZone zone(event_manager_zones[(*ie)->GetType()]);
 		(*ie)->NextFrame(curtime, fixedtime);
+	}
 
 	for (SG_QList* obj = (SG_QList*)m_triggeredControllerSet.Remove();
 		obj != NULL;
@@ -222,7 +273,12 @@ void SCA_LogicManager::UpdateFrame(double curtime, bool frame)
 			SCA_IActuator* actua = *ia;
 			// increment first to allow removal of inactive actuators.
 			++ia;
-			if (!actua->Update(curtime, frame))
+			bool active;
+			{
+				CProfileZone zone(actuator_zones[actua->GetActuatorType()]);
+				active = actua->Update(curtime, frame);
+			}
+			if (!active)
 			{
 				// this actuator is not active anymore, remove
 				actua->QDelink(); 
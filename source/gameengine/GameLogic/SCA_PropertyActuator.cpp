@@ -48,6 +48,7 @@ SCA_PropertyActuator::SCA_PropertyActuator(SCA_IObject* gameobj,SCA_IObject* sou
    :	SCA_IActuator(gameobj, KX_ACT_PROPERTY),
 	m_type(acttype),
 	m_propname(propname),
+	m_propkey(propname),
 	m_exprtxt(expr),
 	m_sourceObj(sourceObj)
 {
@@ -76,7 +77,7 @@ bool SCA_PropertyActuator::Update()
 		if (m_type==KX_ACT_PROP_LEVEL)
 		{
 			CValue* newval = new CBoolValue(false);
-			CValue* oldprop = propowner->GetProperty(m_propname);
+			CValue* oldprop = propowner->GetProperty(m_propkey);
 			if (oldprop)
 			{
 				oldprop->SetValue(newval);
@@ -96,7 +97,7 @@ bool SCA_PropertyActuator::Update()
 	{
 		/* don't use */
 		CValue* newval;
-		CValue* oldprop = propowner->GetProperty(m_propname);
+		CValue* oldprop = propowner->GetProperty(m_propkey);
 		if (oldprop)
 		{
 			newval = new CBoolValue((oldprop->GetNumber()==0.0) ? true:false);
@@ -111,7 +112,7 @@ bool SCA_PropertyActuator::Update()
 	else if (m_type==KX_ACT_PROP_LEVEL)
 	{
 		CValue* newval = new CBoolValue(true);
-		CValue* oldprop = propowner->GetProperty(m_propname);
+		CValue* oldprop = propowner->GetProperty(m_propkey);
 		if (oldprop)
 		{
 			oldprop->SetValue(newval);
@@ -129,7 +130,7 @@ bool SCA_PropertyActuator::Update()
 			{
 				
 				CValue* newval = userexpr->Calculate();
-				CValue* oldprop = propowner->GetProperty(m_propname);
+				CValue* oldprop = propowner->GetProperty(m_propkey);
 				if (oldprop)
 				{
 					oldprop->SetValue(newval);
@@ -142,7 +143,7 @@ bool SCA_PropertyActuator::Update()
 			}
 		case KX_ACT_PROP_ADD:
 			{
-				CValue* oldprop = propowner->GetProperty(m_propname);
+				CValue* oldprop = propowner->GetProperty(m_propkey);
 				if (oldprop)
 				{
 					// int waarde = (int)oldprop->GetNumber();  /*unused*/
@@ -254,6 +255,17 @@ void SCA_PropertyActuator::Relink(CTR_Map<CTR_HashedPtr, void*> *obj_map)
 /* Python functions                                                          */
 /* ------------------------------------------------------------------------- */
 
+int SCA_PropertyActuator::validPropertyName(void *self, const PyAttributeDef *attrdef)
+{
+	SCA_PropertyActuator *actuator = static_cast<SCA_PropertyActuator *>(self);
+	const int error = CheckProperty(self, attrdef);
+
+	/* the name is restored on error */
+	if (!error)
+		actuator->m_propkey = CPropertyKey(actuator->m_propname);
+	return error;
+}
+
 /* Integration hooks ------------------------------------------------------- */
 PyTypeObject SCA_PropertyActuator::Type = {
 	PyVarObject_HEAD_INIT(NULL, 0)
@@ -282,7 +294,7 @@ PyMethodDef SCA_PropertyActuator::Methods[] = {
 };
 
 PyAttributeDef SCA_PropertyActuator::Attributes[] = {
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertyActuator,m_propname,CheckProperty),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertyActuator,m_propname,validPropertyName),
 	KX_PYATTRIBUTE_STRING_RW("value",0,100,false,SCA_PropertyActuator,m_exprtxt),
 	KX_PYATTRIBUTE_INT_RW("mode", KX_ACT_PROP_NODEF+1, KX_ACT_PROP_MAX-1, false, SCA_PropertyActuator, m_type), /* ATTR_TODO add constents to game logic dict */
 	{ NULL }	//Sentinel
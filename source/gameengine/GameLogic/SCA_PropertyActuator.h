@@ -53,6 +53,7 @@ class SCA_PropertyActuator : public SCA_IActuator
 	
 	int			m_type;
 	STR_String	m_propname;
+	CPropertyKey	m_propkey;	/* m_propname and its slot in the layout of the owner */
 	STR_String	m_exprtxt;
 	SCA_IObject* m_sourceObj; // for copy property actuator
 
@@ -81,10 +82,15 @@ public:
 	virtual bool 
 	Update();
 
+#ifdef WITH_PYTHON
+
 	/* --------------------------------------------------------------------- */
 	/* Python interface ---------------------------------------------------- */
 	/* --------------------------------------------------------------------- */
-	
+
+	static int validPropertyName(void* self, const PyAttributeDef*);
+
+#endif
 };
 
 #endif  /* __KX_PROPERTYACTUATOR_DOC */
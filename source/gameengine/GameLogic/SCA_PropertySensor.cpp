@@ -45,7 +45,12 @@
 #include "SCA_LogicManager.h"
 #include "EXP_BoolValue.h"
 #include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_CompiledExpr.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 									 SCA_IObject* gameobj,
@@ -57,7 +62,11 @@ SCA_PropertySensor::SCA_PropertySensor(SCA_EventManager* eventmgr,
 	  m_checktype(checktype),
 	  m_checkpropval(propval),
 	  m_checkpropmaxval(propmaxval),
-	  m_checkpropname(propname)
+	  m_checkpropname(propname),
+	  m_program(NULL),
+	  m_programValid(false),
+	  m_programType(checktype),
+	  m_propertyGeneration(0)
 {
 	//CParser pars;
 	//pars.SetContext(this->AddRef());
@@ -84,6 +93,8 @@ CValue* SCA_PropertySensor::GetReplica()
 {
 	SCA_PropertySensor* replica = new SCA_PropertySensor(*this);
 	// m_range_expr must be recalculated on replica!
+	replica->m_program = NULL;
+	replica->m_programValid = false;
 	replica->ProcessReplica();
 	replica->Init();
 	
@@ -105,6 +116,7 @@ bool SCA_PropertySensor::IsPositiveTrigger()
 
 SCA_PropertySensor::~SCA_PropertySensor()
 {
+	delete m_program;
 }
 
 
@@ -124,11 +136,185 @@ bool SCA_PropertySensor::Evaluate()
 }
 
 
+/* The text of an int property is equal to 'text' only for this value */
+static bool int_from_text(const STR_String& text, cInt& value)
+{
+	char *end;
+
+	if (text.IsEmpty())
+		return false;
+
+	value = strtoll(text.ReadPtr(), &end, 10);
+	return (*end == '\0') && (STR_String().Format("%lld", value) == text);
+}
+
+/* Could the text of a float property ("%f") be equal to 'text', and not only its value */
+static bool float_text_comparable(const STR_String& text)
+{
+	const char *str = text.ReadPtr();
+	int decimals = -1;
+
+	/* "inf" and "nan" */
+	if (strchr(str, 'n') || strchr(str, 'N'))
+		return true;
+
+	if (*str == '-')
+		str++;
+	if (!isdigit(*str))
+		return false;
+	for (; *str; str++) {
+		if (*str == '.' && decimals == -1)
+			decimals = 0;
+		else if (isdigit(*str) && decimals != -1)
+			decimals++;
+		else if (!isdigit(*str))
+			return false;
+	}
+	return (decimals == 6);
+}
+
+/**
+ * Turn the check in bytecode for the current property, done again when the
+ * properties of the object change. Returns false when the check is done the
+ * slow way, for the changed mode and sub properties.
+ */
+bool SCA_PropertySensor::UpdateProgram()
+{
+	CValue *parent = GetParent();
+
+	if (m_programValid && m_programType == m_checktype && m_propertyGeneration == parent->GetPropertyGeneration())
+		return (m_program != NULL);
+
+	delete m_program;
+	m_program = NULL;
+	m_programValid = true;
+	m_programType = m_checktype;
+	m_propertyGeneration = parent->GetPropertyGeneration();
+
+	if (m_checkpropname.Find('.') >= 0)
+		return false;
+
+	CValue *prop = parent->GetProperty(m_checkpropname);
+	const int type = (prop) ? prop->GetValueType() : VALUE_NO_TYPE;
+
+	if (prop && type != VALUE_INT_TYPE && type != VALUE_FLOAT_TYPE && type != VALUE_BOOL_TYPE && type != VALUE_STRING_TYPE)
+		return false;
+
+	CCompiledExpr *program = new CCompiledExpr();
+	bool reverse = false;
+
+	switch (m_checktype) {
+		case KX_PROPSENSOR_NOTEQUAL:
+			reverse = true;
+			/* fall-through */
+		case KX_PROPSENSOR_EQUAL:
+		{
+			const VALUE_OPERATOR op = (reverse) ? VALUE_NEQ_OPERATOR : VALUE_EQL_OPERATOR;
+			cInt intval;
+			float floatval;
+
+			/* the texts are compared, the constant is what gives the same text */
+			if (!prop) {
+				program->AddBool(reverse);
+			}
+			else if (type == VALUE_STRING_TYPE) {
+				program->AddIdentifier(m_checkpropname);
+				program->AddString(m_checkpropval);
+				program->AddBinary(op);
+			}
+			else if (type == VALUE_BOOL_TYPE) {
+				m_checkpropval.Upper();
+				if (m_checkpropval == CBoolValue::sTrueString || m_checkpropval == CBoolValue::sFalseString) {
+					program->AddIdentifier(m_checkpropname);
+					program->AddBool(m_checkpropval == CBoolValue::sTrueString);
+					program->AddBinary(op);
+				}
+				else {
+					program->AddBool(reverse);
+				}
+			}
+			else if (type == VALUE_INT_TYPE) {
+				if (int_from_text(m_checkpropval, intval)) {
+					program->AddIdentifier(m_checkpropname);
+					program->AddInt(intval);
+					program->AddBinary(op);
+				}
+				else {
+					program->AddBool(reverse);
+				}
+			}
+			else if (float_text_comparable(m_checkpropval)) {
+				delete program;
+				return false;
+			}
+			else if (sscanf(m_checkpropval.ReadPtr(), "%f", &floatval) == 1) {
+				program->AddIdentifier(m_checkpropname);
+				program->AddFloat(floatval);
+				program->AddBinary(op);
+			}
+			else {
+				program->AddBool(reverse);
+			}
+			break;
+		}
+		case KX_PROPSENSOR_INTERVAL:
+		{
+			if (!prop) {
+				program->AddBool(false);
+				break;
+			}
+			program->AddFloat(m_checkpropval.ToFloat());
+			program->AddIdentifier(m_checkpropname);
+			program->AddNumber();
+			program->AddBinary(VALUE_LEQ_OPERATOR);
+			program->AddIdentifier(m_checkpropname);
+			program->AddNumber();
+			program->AddFloat(m_checkpropmaxval.ToFloat());
+			program->AddBinary(VALUE_LEQ_OPERATOR);
+			program->AddBinary(VALUE_AND_OPERATOR);
+			break;
+		}
+		case KX_PROPSENSOR_LESSTHAN:
+			reverse = true;
+			/* fall-through */
+		case KX_PROPSENSOR_GREATERTHAN:
+		{
+			if (!prop) {
+				program->AddBool(false);
+				break;
+			}
+			program->AddIdentifier(m_checkpropname);
+			program->AddNumber();
+			program->AddFloat(m_checkpropval.ToFloat());
+			program->AddBinary((reverse) ? VALUE_LES_OPERATOR : VALUE_GRE_OPERATOR);
+			break;
+		}
+		default:
+			delete program;
+			return false;
+	}
+
+	if (program->GetIdentifierCount())
+		program->SetIdentifier(0, prop);
+
+	m_program = program;
+	return true;
+}
+
 bool	SCA_PropertySensor::CheckPropertyCondition()
 {
 	m_recentresult=false;
 	bool result=false;
 	bool reverse = false;
+
+	if (UpdateProgram()) {
+		double value;
+		if (m_program->Evaluate(value)) {
+			m_recentresult = (value != 0.0);
+			return m_recentresult;
+		}
+	}
+
 	switch (m_checktype)
 	{
 	case KX_PROPSENSOR_NOTEQUAL:
@@ -288,9 +474,16 @@ int SCA_PropertySensor::validValueForProperty(void *self, const PyAttributeDef*)
 	 * function directly */
 
 	/*  There is no type checking at this moment, unfortunately...           */
+	static_cast<SCA_PropertySensor *>(self)->m_programValid = false;
 	return 0;
 }
 
+int SCA_PropertySensor::validPropertyName(void *self, const PyAttributeDef *attrdef)
+{
+	static_cast<SCA_PropertySensor *>(self)->m_programValid = false;
+	return CheckProperty(self, attrdef);
+}
+
 /* Integration hooks ------------------------------------------------------- */
 PyTypeObject SCA_PropertySensor::Type = {
 	PyVarObject_HEAD_INIT(NULL, 0)
@@ -320,7 +513,7 @@ PyMethodDef SCA_PropertySensor::Methods[] = {
 
 PyAttributeDef SCA_PropertySensor::Attributes[] = {
 	KX_PYATTRIBUTE_INT_RW("mode",KX_PROPSENSOR_NODEF,KX_PROPSENSOR_MAX-1,false,SCA_PropertySensor,m_checktype),
-	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,CheckProperty),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,SCA_PropertySensor,m_checkpropname,validPropertyName),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("value",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("min",0,100,false,SCA_PropertySensor,m_checkpropval,validValueForProperty),
 	KX_PYATTRIBUTE_STRING_RW_CHECK("max",0,100,false,SCA_PropertySensor,m_checkpropmaxval,validValueForProperty),
@@ -46,6 +46,12 @@ class SCA_PropertySensor : public SCA_ISensor
 	STR_String		m_previoustext;
 	bool			m_lastresult;
 	bool			m_recentresult;
+	class CCompiledExpr*	m_program;	/* the check as bytecode, NULL if it can't be done like this */
+	bool			m_programValid;
+	int				m_programType;
+	unsigned int	m_propertyGeneration;
+
+	bool			UpdateProgram();
 
  protected:
 
@@ -90,6 +96,7 @@ public:
 	 * Test whether this is a sensible value (type check)
 	 */
 	static int validValueForProperty(void* self, const PyAttributeDef*);
+	static int validPropertyName(void* self, const PyAttributeDef*);
 
 #endif
 };
@@ -40,6 +40,7 @@
 #include "SCA_ISensor.h"
 #include "SCA_IActuator.h"
 #include "EXP_PyObjectPlus.h"
+#include "EXP_Profiler.h"
 
 #ifdef WITH_PYTHON
 #include "compile.h"
@@ -135,6 +136,24 @@ CValue* SCA_PythonController::GetReplica()
 	return replica;
 }
 
+void SCA_PythonController::ResetReplica(SCA_IController* templatecont)
+{
+	SCA_IController::ResetReplica(templatecont);
+	m_triggeredSensors.clear();
+
+#ifdef WITH_PYTHON
+	// the script starts again with a copy of the dictionary of the template, as in GetReplica()
+	SCA_PythonController* templatepy = static_cast<SCA_PythonController*>(templatecont);
+	if (m_pythondictionary) {
+		PyDict_Clear(m_pythondictionary);
+		Py_DECREF(m_pythondictionary);
+		m_pythondictionary = NULL;
+	}
+	if (templatepy->m_pythondictionary)
+		m_pythondictionary = PyDict_Copy(templatepy->m_pythondictionary);
+#endif
+}
+
 
 
 void SCA_PythonController::SetScriptText(const STR_String& text)
@@ -385,6 +404,8 @@ bool SCA_PythonController::Import()
 
 void SCA_PythonController::Trigger(SCA_LogicManager* logicmgr)
 {
+	CProfileZone zone(m_scriptName.ReadPtr());
+
 	m_sCurrentController = this;
 	m_sCurrentLogicManager = logicmgr;
 	
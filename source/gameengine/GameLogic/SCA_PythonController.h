@@ -80,6 +80,7 @@ class SCA_PythonController : public SCA_IController
 	virtual ~SCA_PythonController();
 
 	virtual CValue* GetReplica();
+	virtual void ResetReplica(SCA_IController* templatecont);
 	virtual void  Trigger(class SCA_LogicManager* logicmgr);
   
 	void	SetScriptText(const STR_String& text);
@@ -0,0 +1,94 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/GamePlayer/common/GPC_NullCanvas.cpp
+ *  \ingroup player
+ */
+
+#include "GPC_NullCanvas.h"
+
+GPC_NullCanvas::GPC_NullCanvas(int width, int height)
+	:m_swapInterval(0)
+{
+	m_mousestate = MOUSE_INVISIBLE;
+	ResizeWindow(width, height);
+}
+
+GPC_NullCanvas::~GPC_NullCanvas()
+{
+}
+
+bool GPC_NullCanvas::GetSwapInterval(int& intervalOut)
+{
+	intervalOut = m_swapInterval;
+	return true;
+}
+
+float GPC_NullCanvas::GetMouseNormalizedX(int x)
+{
+	return float(x) / float(m_width);
+}
+
+float GPC_NullCanvas::GetMouseNormalizedY(int y)
+{
+	return float(y) / float(m_height);
+}
+
+void GPC_NullCanvas::SetViewPort(int x1, int y1, int x2, int y2)
+{
+	// same convention as GPC_Canvas, x2 and y2 are included
+	m_viewport[0] = x1;
+	m_viewport[1] = y1;
+	m_viewport[2] = x2 - x1 + 1;
+	m_viewport[3] = y2 - y1 + 1;
+}
+
+void GPC_NullCanvas::UpdateViewPort(int x1, int y1, int x2, int y2)
+{
+	m_viewport[0] = x1;
+	m_viewport[1] = y1;
+	m_viewport[2] = x2;
+	m_viewport[3] = y2;
+}
+
+void GPC_NullCanvas::GetDisplayDimensions(int &width, int &height)
+{
+	width = m_width;
+	height = m_height;
+}
+
+void GPC_NullCanvas::ResizeWindow(int width, int height)
+{
+	m_width = (width > 0) ? width : 1;
+	m_height = (height > 0) ? height : 1;
+
+	m_displayarea.m_x1 = 0;
+	m_displayarea.m_y1 = 0;
+	m_displayarea.m_x2 = m_width;
+	m_displayarea.m_y2 = m_height;
+	SetViewPort(0, 0, m_width - 1, m_height - 1);
+}
@@ -61,6 +61,7 @@ extern "C"
 #include "BKE_sound.h"
 #include "IMB_imbuf.h"
 #include "DNA_scene_types.h"
+#include "PIL_time.h"
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -79,19 +80,24 @@ extern "C"
 #include "RAS_OpenGLRasterizer.h"
 #include "RAS_ListRasterizer.h"
 #include "RAS_GLExtensionManager.h"
+#include "RAS_NullRasterizer.h"
 #include "KX_PythonInit.h"
 #include "KX_PyConstraintBinding.h"
 #include "BL_Material.h" // MAXTEX
 
 #include "KX_BlenderSceneConverter.h"
+#include "BL_RuntimePack.h"
 #include "NG_LoopBackNetworkDeviceInterface.h"
 
 #include "GPC_MouseDevice.h"
+#include "GPC_NullCanvas.h"
+#include "GPC_NullInputDevice.h"
 #include "GPG_Canvas.h" 
 #include "GPG_KeyboardDevice.h"
 #include "GPG_System.h"
 
 #include "STR_String.h"
+#include "EXP_Profiler.h"
 
 #include "GHOST_ISystem.h"
 #include "GHOST_IEvent.h"
@@ -121,10 +127,14 @@ GPG_Application::GPG_Application(GHOST_ISystem* system)
 	  m_engineInitialized(0), 
 	  m_engineRunning(0), 
 	  m_isEmbedded(false),
+	  m_benchmark(false),
+	  m_headless(false),
 	  m_ketsjiengine(0),
 	  m_kxsystem(0), 
 	  m_keyboard(0), 
 	  m_mouse(0), 
+	  m_keyboardDevice(0),
+	  m_mouseDevice(0),
 	  m_canvas(0),
 	  m_rasterizer(0), 
 	  m_sceneconverter(0),
@@ -148,7 +158,11 @@ GPG_Application::~GPG_Application(void)
 	}
 
 	exitEngine();
-	fSystem->disposeWindow(m_mainWindow);
+	if (m_mainWindow)
+		fSystem->disposeWindow(m_mainWindow);
+	// the null canvas stands for the window, it's kept when the game restarts
+	if (m_headless)
+		delete m_canvas;
 }
 
 
@@ -356,6 +370,20 @@ bool GPG_Application::startWindow(
 	return success;
 }
 
+bool GPG_Application::startHeadless(int width, int height, const int stereoMode)
+{
+	bool success;
+	m_headless = true;
+
+	m_canvas = new GPC_NullCanvas(width, height);
+
+	success = initEngine(NULL, stereoMode);
+	if (success) {
+		success = startEngine();
+	}
+	return success;
+}
+
 bool GPG_Application::startEmbeddedWindow(
         STR_String& title,
         const GHOST_TEmbedderWindowID parentWindow,
@@ -442,10 +470,29 @@ void GPG_Application::StopGameEngine()
 
 
 
+static bool is_input_event(GHOST_TEventType type)
+{
+	switch (type) {
+		case GHOST_kEventButtonDown:
+		case GHOST_kEventButtonUp:
+		case GHOST_kEventWheel:
+		case GHOST_kEventCursorMove:
+		case GHOST_kEventKeyDown:
+		case GHOST_kEventKeyUp:
+			return true;
+		default:
+			return false;
+	}
+}
+
 bool GPG_Application::processEvent(GHOST_IEvent* event)
 {
 	bool handled = true;
 
+	// the input devices get no events during a benchmark, so that each run is the same
+	if (m_benchmark && is_input_event(event->getType()))
+		return handled;
+
 	switch (event->getType())
 	{
 		case GHOST_kEventUnknown:
@@ -523,7 +570,7 @@ bool GPG_Application::processEvent(GHOST_IEvent* event)
 			if (m_canvas) {
 				GHOST_Rect bnds;
 				window->getClientBounds(bnds);
-				m_canvas->Resize(bnds.getWidth(), bnds.getHeight());
+				static_cast<GPG_Canvas *>(m_canvas)->Resize(bnds.getWidth(), bnds.getHeight());
 				m_ketsjiengine->Resize();
 			}
 			}
@@ -562,8 +609,10 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 {
 	if (!m_engineInitialized)
 	{
-		GPU_init();
-		bgl::InitExtensions(true);
+		if (!m_headless) {
+			GPU_init();
+			bgl::InitExtensions(true);
+		}
 
 		// get and set the preferences
 		SYS_SystemHandle syshandle = SYS_GetSystem();
@@ -580,25 +629,36 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		SYS_WriteCommandLineInt(syshandle, "show_physics", showPhysics);
 
 		bool fixed_framerate= (SYS_GetCommandLineInt(syshandle, "fixedtime", (gm->flag & GAME_ENABLE_ALL_FRAMES)) != 0);
+		const char *benchmark = SYS_GetCommandLineString(syshandle, "benchmark", NULL);
+		m_benchmark = (benchmark != NULL);
 		bool frameRate = (SYS_GetCommandLineInt(syshandle, "show_framerate", 0) != 0);
-		bool useLists = (SYS_GetCommandLineInt(syshandle, "displaylists", gm->flag & GAME_DISPLAY_LISTS) != 0) && GPU_display_list_support();
+		bool useLists = !m_headless && (SYS_GetCommandLineInt(syshandle, "displaylists", gm->flag & GAME_DISPLAY_LISTS) != 0) && GPU_display_list_support();
 		bool nodepwarnings = (SYS_GetCommandLineInt(syshandle, "ignore_deprecation_warnings", 1) != 0);
+		int sortMode = SYS_GetCommandLineInt(syshandle, "solid_sort", RAS_IRasterizer::RAS_SORT_NONE);
+		int meshBatching = SYS_GetCommandLineInt(syshandle, "mesh_batching", 0);
 		bool restrictAnimFPS = (gm->flag & GAME_RESTRICT_ANIM_UPDATES) != 0;
 
-		if (GLEW_ARB_multitexture && GLEW_VERSION_1_1)
-			m_blendermat = (SYS_GetCommandLineInt(syshandle, "blender_material", 1) != 0);
+		// no shaders or textures are made without an OpenGL context
+		if (!m_headless) {
+			if (GLEW_ARB_multitexture && GLEW_VERSION_1_1)
+				m_blendermat = (SYS_GetCommandLineInt(syshandle, "blender_material", 1) != 0);
 
-		if (GPU_glsl_support())
-			m_blenderglslmat = (SYS_GetCommandLineInt(syshandle, "blender_glsl_material", 1) != 0);
-		else if (m_globalSettings->matmode == GAME_MAT_GLSL)
-			m_blendermat = false;
+			if (GPU_glsl_support())
+				m_blenderglslmat = (SYS_GetCommandLineInt(syshandle, "blender_glsl_material", 1) != 0);
+			else if (m_globalSettings->matmode == GAME_MAT_GLSL)
+				m_blendermat = false;
+		}
 
-		// create the canvas, rasterizer and rendertools
-		m_canvas = new GPG_Canvas(window);
+		// create the canvas, rasterizer and rendertools, startHeadless() made the null canvas
+		if (!m_headless)
+			m_canvas = new GPG_Canvas(window);
 		if (!m_canvas)
 			return false;
 
-		if (gm->vsync == VSYNC_ADAPTIVE)
+		// a benchmark runs as fast as it can
+		if (m_benchmark)
+			m_canvas->SetSwapInterval(0);
+		else if (gm->vsync == VSYNC_ADAPTIVE)
 			m_canvas->SetSwapInterval(-1);
 		else
 			m_canvas->SetSwapInterval((gm->vsync == VSYNC_ON) ? 1 : 0);
@@ -609,7 +669,9 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		
 		//Don't use displaylists with VBOs
 		//If auto starts using VBOs, make sure to check for that here
-		if (useLists && gm->raster_storage != RAS_STORE_VBO)
+		if (m_headless)
+			m_rasterizer = new RAS_NullRasterizer(m_canvas);
+		else if (useLists && gm->raster_storage != RAS_STORE_VBO)
 			m_rasterizer = new RAS_ListRasterizer(m_canvas, false, gm->raster_storage);
 		else
 			m_rasterizer = new RAS_OpenGLRasterizer(m_canvas, gm->raster_storage);
@@ -620,14 +682,21 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		
 		if (!m_rasterizer)
 			goto initFailed;
+
+		if (sortMode > RAS_IRasterizer::RAS_SORT_NONE && sortMode < RAS_IRasterizer::RAS_SORT_MAX)
+			m_rasterizer->SetSortMode((RAS_IRasterizer::SortMode)sortMode);
+		m_rasterizer->SetMeshBatching(meshBatching != 0);
 						
-		// create the inputdevices
-		m_keyboard = new GPG_KeyboardDevice();
-		if (!m_keyboard)
-			goto initFailed;
-			
-		m_mouse = new GPC_MouseDevice();
-		if (!m_mouse)
+		// create the inputdevices, without a window there are no events to feed them
+		if (m_headless) {
+			m_keyboardDevice = new GPC_NullInputDevice();
+			m_mouseDevice = new GPC_NullInputDevice();
+		}
+		else {
+			m_keyboardDevice = m_keyboard = new GPG_KeyboardDevice();
+			m_mouseDevice = m_mouse = new GPC_MouseDevice();
+		}
+		if (!m_keyboardDevice || !m_mouseDevice)
 			goto initFailed;
 			
 		// create a networkdevice
@@ -644,15 +713,20 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 		
 		// create the ketsjiengine
 		m_ketsjiengine = new KX_KetsjiEngine(m_kxsystem);
+		const int numThreads = SYS_GetCommandLineInt(syshandle, "threads", 0);
+		if (numThreads > 0)
+			m_ketsjiengine->SetNumThreads(numThreads);
 		
 		// set the devices
-		m_ketsjiengine->SetKeyboardDevice(m_keyboard);
-		m_ketsjiengine->SetMouseDevice(m_mouse);
+		m_ketsjiengine->SetKeyboardDevice(m_keyboardDevice);
+		m_ketsjiengine->SetMouseDevice(m_mouseDevice);
 		m_ketsjiengine->SetNetworkDevice(m_networkdevice);
 		m_ketsjiengine->SetCanvas(m_canvas);
 		m_ketsjiengine->SetRasterizer(m_rasterizer);
 
 		KX_KetsjiEngine::SetExitKey(ConvertKeyCode(gm->exitkey));
+		KX_KetsjiEngine::SetFlatTransforms(SYS_GetCommandLineInt(syshandle, "flat_transforms", 0) != 0);
+		KX_KetsjiEngine::SetHeadless(m_headless);
 #ifdef WITH_PYTHON
 		CValue::SetDeprecationWarnings(nodepwarnings);
 #else
@@ -661,6 +735,18 @@ bool GPG_Application::initEngine(GHOST_IWindow* window, const int stereoMode)
 
 		m_ketsjiengine->SetUseFixedTime(fixed_framerate);
 		m_ketsjiengine->SetTimingDisplay(frameRate, profile, properties);
+
+		const char *profileDump = SYS_GetCommandLineString(syshandle, "profile_dump", NULL);
+		if (profileDump && !m_ketsjiengine->StartProfileDump(profileDump))
+			printf("error: can't write the profile to %s\n", profileDump);
+		const char *trace = SYS_GetCommandLineString(syshandle, "trace", NULL);
+		if (trace && !CProfiler::StartTrace(trace, SYS_GetCommandLineInt(syshandle, "trace_frames", 300)))
+			printf("error: can't write the trace to %s\n", trace);
+		if (m_benchmark) {
+			int ticks = SYS_GetCommandLineInt(syshandle, "benchmark_ticks", 600);
+			int warmup = SYS_GetCommandLineInt(syshandle, "benchmark_warmup", 60);
+			m_ketsjiengine->StartBenchmark(benchmark, (ticks > 0) ? ticks : 1, (warmup > 0) ? warmup : 0);
+		}
 		m_ketsjiengine->SetRestrictAnimationFPS(restrictAnimFPS);
 
 		//set the global settings (carried over if restart/load new files)
@@ -674,14 +760,16 @@ initFailed:
 	BKE_sound_exit();
 	delete m_kxsystem;
 	delete m_networkdevice;
-	delete m_mouse;
-	delete m_keyboard;
+	delete m_mouseDevice;
+	delete m_keyboardDevice;
 	delete m_rasterizer;
 	delete m_canvas;
 	m_canvas = NULL;
 	m_rasterizer = NULL;
 	m_keyboard = NULL;
 	m_mouse = NULL;
+	m_keyboardDevice = NULL;
+	m_mouseDevice = NULL;
 	m_networkdevice = NULL;
 	m_kxsystem = NULL;
 	return false;
@@ -726,9 +814,15 @@ bool GPG_Application::startEngine(void)
 			m_sceneconverter->SetGLSLMaterials(true);
 		if (m_startScene->gm.flag & GAME_NO_MATERIAL_CACHING)
 			m_sceneconverter->SetCacheMaterials(false);
-
-		m_kxStartScene = new KX_Scene(m_keyboard,
-			m_mouse,
+		// the meshes baked next to the file with "-g bake"
+		if (SYS_GetCommandLineInt(SYS_GetSystem(), "runtime_pack", 1))
+			static_cast<KX_BlenderSceneConverter *>(m_sceneconverter)->SetRuntimePack(BL_RuntimePack::Open(m_maggie));
+		// milliseconds of each frame spent merging the async LibLoads, 0 merges them at once
+		static_cast<KX_BlenderSceneConverter *>(m_sceneconverter)->SetMergeBudget(
+		        SYS_GetCommandLineInt(SYS_GetSystem(), "libload_budget", 2) / 1000.0);
+
+		m_kxStartScene = new KX_Scene(m_keyboardDevice,
+			m_mouseDevice,
 			m_networkdevice,
 			m_kxStartScenename,
 			m_startScene,
@@ -741,7 +835,7 @@ bool GPG_Application::startEngine(void)
 #endif // WITH_PYTHON
 
 		//initialize Dome Settings
-		if (m_startScene->gm.stereoflag == STEREO_DOME)
+		if (m_startScene->gm.stereoflag == STEREO_DOME && !m_headless)
 			m_ketsjiengine->InitDome(m_startScene->gm.dome.res, m_startScene->gm.dome.mode, m_startScene->gm.dome.angle, m_startScene->gm.dome.resbuf, m_startScene->gm.dome.tilt, m_startScene->gm.dome.warptext);
 
 		// initialize 3D Audio Settings
@@ -755,14 +849,17 @@ bool GPG_Application::startEngine(void)
 		// load new blend files and keep data in GameLogic.globalDict
 		loadGamePythonConfig(m_pyGlobalDictString, m_pyGlobalDictString_Length);
 #endif
+		const double loadStart = PIL_check_seconds_timer();
 		m_sceneconverter->ConvertScene(
 			m_kxStartScene,
 			m_rasterizer,
 			m_canvas);
+		if (m_benchmark)
+			m_ketsjiengine->SetBenchmarkLoadTime(PIL_check_seconds_timer() - loadStart);
 		m_ketsjiengine->AddScene(m_kxStartScene);
 		
 		// Create a timer that is used to kick the engine
-		if (!m_frameTimer) {
+		if (!m_frameTimer && m_system) {
 			m_frameTimer = m_system->installTimer(0, kTimerFreq, frameTimerProc, m_mainWindow);
 		}
 		m_rasterizer->Init();
@@ -828,7 +925,7 @@ void GPG_Application::EngineNextFrame()
 		
 		// kick the engine
 		bool renderFrame = m_ketsjiengine->NextFrame();
-		if (renderFrame && m_mainWindow)
+		if (renderFrame && (m_mainWindow || m_headless))
 		{
 			// render the frame
 			m_ketsjiengine->Render();
@@ -860,14 +957,16 @@ void GPG_Application::exitEngine()
 		delete m_networkdevice;
 		m_networkdevice = 0;
 	}
-	if (m_mouse)
+	if (m_mouseDevice)
 	{
-		delete m_mouse;
+		delete m_mouseDevice;
+		m_mouseDevice = 0;
 		m_mouse = 0;
 	}
-	if (m_keyboard)
+	if (m_keyboardDevice)
 	{
-		delete m_keyboard;
+		delete m_keyboardDevice;
+		m_keyboardDevice = 0;
 		m_keyboard = 0;
 	}
 	if (m_rasterizer)
@@ -875,13 +974,14 @@ void GPG_Application::exitEngine()
 		delete m_rasterizer;
 		m_rasterizer = 0;
 	}
-	if (m_canvas)
+	if (m_canvas && !m_headless)
 	{
 		delete m_canvas;
 		m_canvas = 0;
 	}
 
-	GPU_exit();
+	if (!m_headless)
+		GPU_exit();
 
 #ifdef WITH_PYTHON
 	// Call this after we're sure nothing needs Python anymore (e.g., destructors)
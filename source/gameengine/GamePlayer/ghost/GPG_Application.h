@@ -49,9 +49,10 @@ class GHOST_ISystem;
 class GHOST_ITimerTask;
 class GHOST_IWindow;
 class GPC_MouseDevice;
-class GPG_Canvas;
 class GPG_KeyboardDevice;
 class GPG_System;
+class RAS_ICanvas;
+class SCA_IInputDevice;
 struct Main;
 struct Scene;
 
@@ -70,6 +71,11 @@ public:
 	                     int bpp, int frequency,
 	                     const bool stereoVisual, const int stereoMode,
 	                     const GHOST_TUns16 samples=0, bool useDesktop=false);
+	/**
+	 * Starts the engine without a window nor an OpenGL context, nothing is drawn.
+	 * Only used to run a benchmark without a display.
+	 */
+	bool startHeadless(int width, int height, const int stereoMode);
 	bool startEmbeddedWindow(STR_String& title, const GHOST_TEmbedderWindowID parent_window,
 	                         const bool stereoVisual, const int stereoMode, const GHOST_TUns16 samples=0);
 #ifdef WIN32
@@ -149,17 +155,24 @@ protected:
 	bool m_engineRunning;
 	/** Running on embedded window */
 	bool m_isEmbedded;
+	/** Running a benchmark, without input */
+	bool m_benchmark;
+	/** Running without a window, with a null canvas, rasterizer and input devices */
+	bool m_headless;
 
 	/** the gameengine itself */
 	KX_KetsjiEngine* m_ketsjiengine;
 	/** The game engine's system abstraction. */
 	GPG_System* m_kxsystem;
-	/** The game engine's keyboard abstraction. */
+	/** The game engine's keyboard abstraction, fed with the GHOST events. */
 	GPG_KeyboardDevice* m_keyboard;
-	/** The game engine's mouse abstraction. */
+	/** The game engine's mouse abstraction, fed with the GHOST events. */
 	GPC_MouseDevice* m_mouse;
+	/** The keyboard and mouse given to the engine, m_keyboard and m_mouse or null devices when headless. */
+	SCA_IInputDevice* m_keyboardDevice;
+	SCA_IInputDevice* m_mouseDevice;
 	/** The game engine's canvas abstraction. */
-	GPG_Canvas* m_canvas;
+	RAS_ICanvas* m_canvas;
 	/** the rasterizer */
 	RAS_IRasterizer* m_rasterizer;
 	/** Converts Blender data files. */
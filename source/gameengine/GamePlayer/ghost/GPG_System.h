@@ -44,8 +44,10 @@ class GHOST_ISystem;
 class GPG_System : public KX_ISystem
 {
 	GHOST_ISystem* m_system;
+	double m_startTime;
 
 public:
+	/** \param system The GHOST system, or NULL to use the blenlib timer without a display. */
 	GPG_System(GHOST_ISystem* system);
 
 	virtual double GetTimeInSeconds();
@@ -63,6 +63,7 @@ static void ResetCB()
 #include "KX_KetsjiEngine.h"
 #include "KX_PythonInit.h"
 #include "KX_PythonMain.h"
+#include "BL_RuntimePack.h"
 #include "KX_PyConstraintBinding.h" // for PHY_SetActiveEnvironment
 
 /**********************************
@@ -305,6 +306,23 @@ static void usage(const char* program, bool isBlenderPlayer)
 	printf("       show_profile                   0         Show profiling information\n");
 	printf("       blender_material               0         Enable material settings\n");
 	printf("       ignore_deprecation_warnings    1         Ignore deprecation warnings\n");
+	printf("       solid_sort                     0         Sort solid meshes by material state and depth\n");
+	printf("       mesh_batching                  0         Draw copies of small meshes in one call\n");
+	printf("       flat_transforms                0         Update the scene graph in one sweep over flat arrays\n");
+	printf("       profile_dump                             Write the profile of each frame to a CSV or JSON file\n");
+	printf("       trace                                    Write a Chrome trace (chrome://tracing) to a JSON file\n");
+	printf("       trace_frames                   300       Number of frames in the trace\n");
+	printf("       benchmark                                Run without input and write a JSON report, then quit\n");
+	printf("       benchmark_ticks                600       Number of measured logic ticks\n");
+	printf("       benchmark_warmup               60        Number of ticks run before measuring\n");
+	printf("       benchmark_window               0         Open a window and draw the frames in a benchmark,\n");
+	printf("                                                else it runs headless and draws nothing\n");
+	printf("       bake                                     Write the runtime pack of the file for a big or little\n");
+	printf("                                                endian target, then quit\n");
+	printf("       runtime_pack                   1         Convert the meshes from the runtime pack of the file\n");
+	printf("       threads                        0         Number of threads of the tasks, 0 for one per core\n");
+	printf("       libload_budget                 2         Milliseconds of each frame merging the async LibLoads,\n");
+	printf("                                                0 merges each library at once\n");
 	printf("\n");
 	printf("  - : all arguments after this are ignored, allowing python to access them from sys.argv\n");
 	printf("\n");
@@ -394,8 +412,10 @@ static BlendFileData *load_game_data(const char *progname, char *filename = NULL
 static bool GPG_NextFrame(GHOST_ISystem* system, GPG_Application *app, int &exitcode, STR_String &exitstring, GlobalSettings *gs)
 {
 	bool run = true;
-	system->processEvents(false);
-	system->dispatchEvents();
+	if (system) {
+		system->processEvents(false);
+		system->dispatchEvents();
+	}
 	app->EngineNextFrame();
 	if ((exitcode = app->getExitRequested())) {
 		run = false;
@@ -917,18 +937,25 @@ int real_main(int argc, char** argv)
 	if (scr_saver_mode != SCREEN_SAVER_MODE_CONFIGURATION)
 #endif
 	{
+		// a benchmark runs headless without a display unless it asks for a window
+		const bool headless = SYS_GetCommandLineString(syshandle, "benchmark", NULL) &&
+		                      !SYS_GetCommandLineInt(syshandle, "benchmark_window", 0);
+		GHOST_ISystem* system = NULL;
+
 		// Create the system
-		if (GHOST_ISystem::createSystem() == GHOST_kSuccess) {
-			GHOST_ISystem* system = GHOST_ISystem::getSystem();
-			assertd(system);
-			
-			if (!fullScreenWidth || !fullScreenHeight)
-				system->getMainDisplayDimensions(fullScreenWidth, fullScreenHeight);
-			// process first batch of events. If the user
-			// drops a file on top off the blenderplayer icon, we
-			// receive an event with the filename
-			
-			system->processEvents(0);
+		if (headless || GHOST_ISystem::createSystem() == GHOST_kSuccess) {
+			if (!headless) {
+				system = GHOST_ISystem::getSystem();
+				assertd(system);
+
+				if (!fullScreenWidth || !fullScreenHeight)
+					system->getMainDisplayDimensions(fullScreenWidth, fullScreenHeight);
+				// process first batch of events. If the user
+				// drops a file on top off the blenderplayer icon, we
+				// receive an event with the filename
+
+				system->processEvents(0);
+			}
 			
 			// this bracket is needed for app (see below) to get out
 			// of scope before GHOST_ISystem::disposeSystem() is called.
@@ -983,16 +1010,32 @@ int real_main(int argc, char** argv)
 					printf("Game data loaded from %s\n", filename);
 #endif
 					
+					const char *bake = SYS_GetCommandLineString(syshandle, "bake", NULL);
 					if (!bfd) {
 						usage(argv[0], isBlenderPlayer);
 						error = true;
 						exitcode = KX_EXIT_REQUEST_QUIT_GAME;
 					}
+					else if (bake) {
+						// convert the meshes for the target instead of playing
+						if (!STREQ(bake, "big") && !STREQ(bake, "little")) {
+							printf("error: bake '%s' unrecognized, use big or little.\n", bake);
+							error = true;
+						}
+						else {
+							G.main = bfd->main;
+							if (!BL_RuntimePack::Bake(bfd->main, STREQ(bake, "big")))
+								error = true;
+							G.main = NULL;
+						}
+						BLO_blendfiledata_free(bfd);
+						exitcode = KX_EXIT_REQUEST_QUIT_GAME;
+					}
 					else {
 						/* Setting options according to the blend file if not overriden in the command line */
 #ifdef WIN32
 #if !defined(DEBUG)
-						if (closeConsole) {
+						if (closeConsole && system) {
 							system->toggleConsole(0); // Close a console window
 						}
 #endif // !defined(DEBUG)
@@ -1081,7 +1124,14 @@ int real_main(int argc, char** argv)
 						if (firstTimeRunning) {
 							firstTimeRunning = false;
 
-							if (fullScreen) {
+							if (headless) {
+								// nothing is drawn, the canvas only has the size of the window
+								if (fullScreen)
+									app.startHeadless(fullScreenWidth, fullScreenHeight, stereomode);
+								else
+									app.startHeadless(windowWidth, windowHeight, stereomode);
+							}
+							else if (fullScreen) {
 #ifdef WIN32
 								if (scr_saver_mode == SCREEN_SAVER_MODE_SAVER)
 								{
@@ -1156,7 +1206,8 @@ int real_main(int argc, char** argv)
 						}
 						
 						// Add the application as event consumer
-						system->addEventConsumer(&app);
+						if (system)
+							system->addEventConsumer(&app);
 						
 						// Enter main loop
 						bool run = true;
@@ -1200,7 +1251,8 @@ int real_main(int argc, char** argv)
 
 						/* 'app' is freed automatic when out of scope.
 						 * removal is needed else the system will free an already freed value */
-						system->removeEventConsumer(&app);
+						if (system)
+							system->removeEventConsumer(&app);
 
 						BLO_blendfiledata_free(bfd);
 						/* G.main == bfd->main, it gets referenced in free_nodesystem so we can't have a dangling pointer */
@@ -1214,7 +1266,8 @@ int real_main(int argc, char** argv)
 			BKE_icons_free();
 
 			// Dispose the system
-			GHOST_ISystem::disposeSystem();
+			if (system)
+				GHOST_ISystem::disposeSystem();
 		}
 		else {
 			error = true;
@@ -38,6 +38,7 @@
 
 // These three are for getting the action from the logic manager
 #include "KX_Scene.h"
+#include "KX_BlenderSceneConverter.h"
 #include "SCA_LogicManager.h"
 
 extern "C" {
@@ -146,6 +147,10 @@ bool BL_Action::Play(const char* name,
 		return false;
 	}
 
+	// the action may come from a library, it has to be stopped when the library is freed
+	if (m_action != prev_action && kxscene->GetSceneConverter())
+		kxscene->GetSceneConverter()->RegisterActionUser(m_obj, m_action);
+
 	// If we have the same settings, don't play again
 	// This is to resolve potential issues with pulses on sensors such as the ones
 	// reported in bug #29412. The fix is here so it works for both logic bricks and Python.
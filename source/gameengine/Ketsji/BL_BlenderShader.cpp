@@ -173,6 +173,27 @@ void BL_BlenderShader::Update(const RAS_MeshSlot & ms, RAS_IRasterizer* rasty )
 	mAlphaBlend = GPU_material_alpha_blend(gpumat, obcol);
 }
 
+/* The batches are drawn in world space with an identity object matrix, the
+ * shader must not read the object matrix, color or space coordinates */
+bool BL_BlenderShader::CanBatch()
+{
+	GPUVertexAttribs attribs;
+	int i;
+
+	if (!VerifyShader())
+		return false;
+
+	if (GPU_get_material_builtins(mGPUMat) & (GPU_OBJECT_MATRIX | GPU_INVERSE_OBJECT_MATRIX | GPU_OBCOLOR))
+		return false;
+
+	GPU_material_vertex_attributes(mGPUMat, &attribs);
+	for (i = 0; i < attribs.totlayer; i++) {
+		if (ELEM(attribs.layer[i].type, CD_ORCO, CD_NORMAL))
+			return false;
+	}
+	return true;
+}
+
 int BL_BlenderShader::GetAlphaBlend()
 {
 	return mAlphaBlend;
@@ -84,6 +84,7 @@ public:
 	void Update(const class RAS_MeshSlot & ms, class RAS_IRasterizer* rasty);
 	void ReloadMaterial();
 	int GetAlphaBlend();
+	bool CanBatch();
 
 	bool Equals(BL_BlenderShader *blshader);
 	
@@ -0,0 +1,245 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_BatchCuller.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_BatchCuller.h"
+#include "KX_GameObject.h"
+#include "EXP_ListValue.h"
+#include "SG_Node.h"
+
+#include <math.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+/* Relative error allowed for the float coordinates, far above the float
+ * rounding of the plane distances so nothing the double test keeps is culled. */
+#define KX_CULL_MARGIN 1.0e-6f
+
+KX_BatchCuller::KX_BatchCuller()
+	:m_stride(0),
+	m_valid(false)
+{
+}
+
+void KX_BatchCuller::Gather(CListValue *objects)
+{
+	const unsigned int count = objects->GetCount();
+
+	m_objects.resize(count);
+	/* pad to a multiple of 4 so the last group can be read whole */
+	m_stride = (count + 3) & ~3u;
+	m_data.assign(NUM_ARRAYS * m_stride, 0.0f);
+	m_visible.resize(m_stride / 4);
+
+	float *arrays[NUM_ARRAYS];
+	for (int a = 0; a < NUM_ARRAYS; a++)
+		arrays[a] = Array(a);
+
+	for (unsigned int i = 0; i < count; i++) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject *>(objects->GetValue(i));
+		m_objects[i] = gameobj;
+
+		SG_Node *node = gameobj->GetSGNode();
+		if (!node)
+			continue;
+
+		const MT_Point3& pos = node->GetWorldPosition();
+		const MT_Vector3& scale = node->GetWorldScaling();
+		const MT_Scalar radius = fabs(scale[scale.closestAxis()] * node->Radius());
+
+		/* oriented box from the local box and the world transform */
+		const MT_Transform trans = node->GetWorldTransform();
+		MT_Point3 minmax[2];
+		node->BBox().getmm(minmax, MT_Transform::Identity());
+		const MT_Vector3 half = (minmax[1] - minmax[0]) * 0.5;
+		const MT_Point3 center = trans(minmax[0] + half);
+		const MT_Matrix3x3& basis = trans.getBasis();
+
+		const MT_Scalar margin = KX_CULL_MARGIN * (fabs(pos[0]) + fabs(pos[1]) + fabs(pos[2]) +
+		                                           fabs(center[0]) + fabs(center[1]) + fabs(center[2]) + radius);
+
+		arrays[POS_X][i] = pos[0];
+		arrays[POS_Y][i] = pos[1];
+		arrays[POS_Z][i] = pos[2];
+		arrays[RADIUS][i] = radius + margin;
+		arrays[BOX_X][i] = center[0];
+		arrays[BOX_Y][i] = center[1];
+		arrays[BOX_Z][i] = center[2];
+		arrays[MARGIN][i] = margin;
+
+		for (int c = 0; c < 3; c++) {
+			MT_Scalar ext = margin;
+			for (int axis = 0; axis < 3; axis++) {
+				const MT_Scalar val = basis[c][axis] * half[axis];
+				arrays[AXIS0_X + axis * 3 + c][i] = val;
+				ext += fabs(val);
+			}
+			arrays[EXT_X + c][i] = ext;
+		}
+	}
+
+	m_valid = true;
+}
+
+void KX_BatchCuller::Cull(CListValue *objects, const MT_Vector4 *planes, const MT_Point3& frustumCenter,
+                          MT_Scalar frustumRadius, const MT_Point3& cameraPos)
+{
+	const unsigned int count = objects->GetCount();
+
+	/* objects added or removed since the last gather */
+	bool valid = m_valid && m_objects.size() == count;
+	for (unsigned int i = 0; valid && i < count; i++)
+		valid = (m_objects[i] == objects->GetValue(i));
+	if (!valid)
+		Gather(objects);
+
+	const float *px = Array(POS_X), *py = Array(POS_Y), *pz = Array(POS_Z), *pr = Array(RADIUS);
+	const float *bx = Array(BOX_X), *by = Array(BOX_Y), *bz = Array(BOX_Z);
+	const float *ex = Array(EXT_X), *ey = Array(EXT_Y), *ez = Array(EXT_Z);
+	const float *a0x = Array(AXIS0_X), *a0y = Array(AXIS0_Y), *a0z = Array(AXIS0_Z);
+	const float *a1x = Array(AXIS1_X), *a1y = Array(AXIS1_Y), *a1z = Array(AXIS1_Z);
+	const float *a2x = Array(AXIS2_X), *a2y = Array(AXIS2_Y), *a2z = Array(AXIS2_Z);
+	const float *margin = Array(MARGIN);
+
+	float plane[6][4];
+	for (int p = 0; p < 6; p++) {
+		for (int c = 0; c < 4; c++)
+			plane[p][c] = planes[p][c];
+	}
+
+#ifdef __SSE__
+	const __m128 signmask = _mm_set1_ps(-0.0f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 camx = _mm_set1_ps(cameraPos[0]), camy = _mm_set1_ps(cameraPos[1]), camz = _mm_set1_ps(cameraPos[2]);
+	const __m128 fcx = _mm_set1_ps(frustumCenter[0]), fcy = _mm_set1_ps(frustumCenter[1]), fcz = _mm_set1_ps(frustumCenter[2]);
+	const __m128 fr = _mm_set1_ps(frustumRadius);
+
+	for (unsigned int i = 0; i < m_stride; i += 4) {
+		const __m128 x = _mm_loadu_ps(px + i), y = _mm_loadu_ps(py + i), z = _mm_loadu_ps(pz + i);
+		const __m128 r = _mm_loadu_ps(pr + i);
+		const __m128 cx = _mm_loadu_ps(bx + i), cy = _mm_loadu_ps(by + i), cz = _mm_loadu_ps(bz + i);
+
+		/* the camera is inside the bound sphere and the world aligned box */
+		__m128 dx = _mm_sub_ps(camx, x), dy = _mm_sub_ps(camy, y), dz = _mm_sub_ps(camz, z);
+		__m128 d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		__m128 inside = _mm_cmple_ps(d2, _mm_mul_ps(r, r));
+		inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_andnot_ps(signmask, _mm_sub_ps(camx, cx)), _mm_loadu_ps(ex + i)));
+		inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_andnot_ps(signmask, _mm_sub_ps(camy, cy)), _mm_loadu_ps(ey + i)));
+		inside = _mm_and_ps(inside, _mm_cmple_ps(_mm_andnot_ps(signmask, _mm_sub_ps(camz, cz)), _mm_loadu_ps(ez + i)));
+
+		/* the bound sphere doesn't touch the sphere of the frustum */
+		dx = _mm_sub_ps(x, fcx);
+		dy = _mm_sub_ps(y, fcy);
+		dz = _mm_sub_ps(z, fcz);
+		d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+		const __m128 rf = _mm_add_ps(r, fr);
+		__m128 outside = _mm_cmpgt_ps(d2, _mm_mul_ps(rf, rf));
+
+		const __m128 ax0 = _mm_loadu_ps(a0x + i), ay0 = _mm_loadu_ps(a0y + i), az0 = _mm_loadu_ps(a0z + i);
+		const __m128 ax1 = _mm_loadu_ps(a1x + i), ay1 = _mm_loadu_ps(a1y + i), az1 = _mm_loadu_ps(a1z + i);
+		const __m128 ax2 = _mm_loadu_ps(a2x + i), ay2 = _mm_loadu_ps(a2y + i), az2 = _mm_loadu_ps(a2z + i);
+		const __m128 m = _mm_loadu_ps(margin + i);
+		const __m128 negr = _mm_sub_ps(zero, r);
+		__m128 allInside = _mm_cmpeq_ps(zero, zero);
+		__m128 boxOutside = _mm_setzero_ps();
+
+		for (int p = 0; p < 6; p++) {
+			const __m128 nx = _mm_set1_ps(plane[p][0]), ny = _mm_set1_ps(plane[p][1]), nz = _mm_set1_ps(plane[p][2]);
+			const __m128 w = _mm_set1_ps(plane[p][3]);
+
+			/* sphere, see KX_Camera::SphereInsideFrustum */
+			const __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, x), _mm_mul_ps(ny, y)), _mm_add_ps(_mm_mul_ps(nz, z), w));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, negr));
+			allInside = _mm_and_ps(allInside, _mm_cmpgt_ps(dist, r));
+
+			/* box, the farthest corner in front of the plane is at the center plus the projected half axes */
+			const __m128 bdist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)), _mm_add_ps(_mm_mul_ps(nz, cz), w));
+			const __m128 p0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax0), _mm_mul_ps(ny, ay0)), _mm_mul_ps(nz, az0));
+			const __m128 p1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax1), _mm_mul_ps(ny, ay1)), _mm_mul_ps(nz, az1));
+			const __m128 p2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ax2), _mm_mul_ps(ny, ay2)), _mm_mul_ps(nz, az2));
+			const __m128 proj = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signmask, p0), _mm_andnot_ps(signmask, p1)),
+			                               _mm_add_ps(_mm_andnot_ps(signmask, p2), m));
+			boxOutside = _mm_or_ps(boxOutside, _mm_cmplt_ps(_mm_add_ps(bdist, proj), zero));
+		}
+
+		/* the box is only tested when the sphere intersects the frustum */
+		outside = _mm_or_ps(outside, _mm_andnot_ps(allInside, boxOutside));
+		m_visible[i >> 2] = (_mm_movemask_ps(inside) | ~_mm_movemask_ps(outside)) & 0xf;
+	}
+#else
+	for (unsigned int i = 0; i < m_stride; i += 4) {
+		unsigned char bits = 0;
+		for (unsigned int j = i; j < i + 4; j++) {
+			const float r = pr[j];
+
+			/* the camera is inside the bound sphere and the world aligned box */
+			float dx = cameraPos[0] - px[j], dy = cameraPos[1] - py[j], dz = cameraPos[2] - pz[j];
+			if (dx * dx + dy * dy + dz * dz <= r * r &&
+			    fabsf(cameraPos[0] - bx[j]) <= ex[j] &&
+			    fabsf(cameraPos[1] - by[j]) <= ey[j] &&
+			    fabsf(cameraPos[2] - bz[j]) <= ez[j])
+			{
+				bits |= 1 << (j - i);
+				continue;
+			}
+
+			/* the bound sphere doesn't touch the sphere of the frustum */
+			dx = px[j] - frustumCenter[0];
+			dy = py[j] - frustumCenter[1];
+			dz = pz[j] - frustumCenter[2];
+			const float rf = r + frustumRadius;
+			bool outside = (dx * dx + dy * dy + dz * dz > rf * rf);
+			bool allInside = true;
+			bool boxOutside = false;
+
+			for (int p = 0; p < 6 && !outside; p++) {
+				const float *n = plane[p];
+
+				/* sphere, see KX_Camera::SphereInsideFrustum */
+				const float dist = n[0] * px[j] + n[1] * py[j] + n[2] * pz[j] + n[3];
+				if (dist < -r)
+					outside = true;
+				else if (dist <= r)
+					allInside = false;
+
+				/* box, the farthest corner in front of the plane is at the center plus the projected half axes */
+				const float bdist = n[0] * bx[j] + n[1] * by[j] + n[2] * bz[j] + n[3];
+				const float proj = fabsf(n[0] * a0x[j] + n[1] * a0y[j] + n[2] * a0z[j]) +
+				                   fabsf(n[0] * a1x[j] + n[1] * a1y[j] + n[2] * a1z[j]) +
+				                   fabsf(n[0] * a2x[j] + n[1] * a2y[j] + n[2] * a2z[j]) + margin[j];
+				if (bdist + proj < 0.0f)
+					boxOutside = true;
+			}
+
+			/* the box is only tested when the sphere intersects the frustum */
+			if (!outside && !(!allInside && boxOutside))
+				bits |= 1 << (j - i);
+		}
+		m_visible[i >> 2] = bits;
+	}
+#endif
+}
@@ -0,0 +1,117 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_BatchCuller.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_BATCHCULLER_H__
+#define __KX_BATCHCULLER_H__
+
+#include "MT_Point3.h"
+#include "MT_Vector4.h"
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class CListValue;
+class KX_GameObject;
+
+/**
+ * Frustum culler testing all the objects of a scene at once.
+ *
+ * The world bounding sphere and oriented bounding box of every object are
+ * gathered in float arrays (one array per component) and tested four at a
+ * time against the frustum planes, with SSE when available. The bounds don't
+ * depend on the camera, so they are only gathered again after Invalidate(),
+ * the shadow lamps and the cameras of a frame share them.
+ *
+ * The result matches KX_Camera::SphereInsideFrustum followed by
+ * KX_Camera::BoxInsideFrustum, a small margin keeps the float test
+ * conservative.
+ */
+class KX_BatchCuller
+{
+	enum {
+		POS_X = 0, POS_Y, POS_Z, RADIUS,	/* bound sphere */
+		BOX_X, BOX_Y, BOX_Z,				/* box center */
+		EXT_X, EXT_Y, EXT_Z,				/* half size of the world aligned box */
+		AXIS0_X, AXIS0_Y, AXIS0_Z,			/* box half axes */
+		AXIS1_X, AXIS1_Y, AXIS1_Z,
+		AXIS2_X, AXIS2_Y, AXIS2_Z,
+		MARGIN,
+		NUM_ARRAYS
+	};
+
+	std::vector<KX_GameObject *> m_objects;
+	std::vector<float> m_data;				/* NUM_ARRAYS arrays of m_stride floats */
+	std::vector<unsigned char> m_visible;	/* one visibility bit per object, 4 per byte */
+	unsigned int m_stride;
+	bool m_valid;
+
+	float *Array(int i)
+	{
+		return &m_data[i * m_stride];
+	}
+
+	void Gather(CListValue *objects);
+
+public:
+	KX_BatchCuller();
+
+	/// Gather the bounds again at the next Cull(), must be called when objects moved.
+	void Invalidate()
+	{
+		m_valid = false;
+	}
+
+	/**
+	 * Test the objects of the list against normalized frustum planes, a bound sphere of the
+	 * frustum and a camera position (objects containing it are visible).
+	 */
+	void Cull(CListValue *objects, const MT_Vector4 *planes, const MT_Point3& frustumCenter,
+	          MT_Scalar frustumRadius, const MT_Point3& cameraPos);
+
+	unsigned int GetCount() const
+	{
+		return m_objects.size();
+	}
+
+	KX_GameObject *GetObject(unsigned int i) const
+	{
+		return m_objects[i];
+	}
+
+	bool GetVisible(unsigned int i) const
+	{
+		return (m_visible[i >> 2] >> (i & 3)) & 1;
+	}
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:KX_BatchCuller")
+#endif
+};
+
+#endif  /* __KX_BATCHCULLER_H__ */
@@ -30,6 +30,7 @@
 #include "KX_Light.h"
 #include "KX_GameObject.h"
 #include "KX_MeshProxy.h"
+#include "KX_KetsjiEngine.h"
 #include "KX_PyMath.h"
 
 #include "MT_Vector3.h"
@@ -236,6 +237,10 @@ void KX_BlenderMaterial::OnConstruction()
 	if (mConstructed)
 		// when material are reused between objects
 		return;
+
+	// no OpenGL context to load the textures and shaders in
+	if (KX_KetsjiEngine::GetHeadless())
+		return;
 	
 	if (mMaterial->glslmat)
 		SetBlenderGLSLShader();
@@ -846,6 +851,23 @@ void KX_BlenderMaterial::Replace_IScene(SCA_IScene *val)
 	OnConstruction();
 }
 
+bool KX_BlenderMaterial::CanBatch() const
+{
+	if (mShader || !RAS_IPolyMaterial::CanBatch())
+		return false;
+
+	/* the generated GLSL shader must not read the object data, see BL_BlenderShader::CanBatch */
+	if ((m_flag & RAS_BLENDERGLSL) && !(mBlenderShader && mBlenderShader->CanBatch()))
+		return false;
+
+	/* these texture coordinates are computed from the object space vertices */
+	for (int i = 0; i < mMaterial->num_enabled; i++) {
+		if (mMaterial->mapping[i].mapping & (USEOBJ | USEORCO | USENORM))
+			return false;
+	}
+	return true;
+}
+
 BL_Material *KX_BlenderMaterial::GetBLMaterial()
 {
 	return mMaterial;
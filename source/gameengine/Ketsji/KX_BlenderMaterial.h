@@ -104,6 +104,8 @@ public:
 	
 	virtual void Replace_IScene(SCA_IScene *val);
 
+	virtual bool CanBatch() const;
+
 	BL_Material *GetBLMaterial();
 
 #ifdef WITH_PYTHON
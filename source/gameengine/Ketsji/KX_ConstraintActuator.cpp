@@ -117,6 +117,12 @@ KX_ConstraintActuator::~KX_ConstraintActuator()
 	// there's nothing to be done here, really....
 } /* end of destructor */
 
+void KX_ConstraintActuator::ResetReplica()
+{
+	SCA_IActuator::ResetReplica();
+	m_currentTime = 0;
+}
+
 bool KX_ConstraintActuator::RayHit(KX_ClientObjectInfo *client, KX_RayCast *result, void * const data)
 {
 
@@ -133,6 +133,7 @@ protected:
 		replica->ProcessReplica();
 		return replica;
 	};
+	virtual void ResetReplica();
 
 	virtual bool Update(double curtime, bool frame);
 
@@ -106,6 +106,7 @@ KX_GameObject::KX_GameObject(
       m_bVisible(true),
       m_bCulled(true),
       m_bOccluder(false),
+      m_bOccluderLod(false),
       m_pPhysicsController(NULL),
       m_pGraphicController(NULL),
       m_xray(false),
@@ -113,6 +114,8 @@ KX_GameObject::KX_GameObject(
       m_pObstacleSimulation(NULL),
       m_pInstanceObjects(NULL),
       m_pDupliGroupObject(NULL),
+      m_pLifeTimer(NULL),
+      m_pObjectPool(NULL),
       m_actionManager(NULL),
       m_bRecordAnimation(false),
       m_isDeformable(false)
@@ -524,6 +527,7 @@ void KX_GameObject::ProcessReplica()
 	m_pClient_info = new KX_ClientObjectInfo(*m_pClient_info);
 	m_pClient_info->m_gameobject = this;
 	m_actionManager = NULL;
+	m_pLifeTimer = NULL;
 	m_state = 0;
 
 	KX_Scene* scene = KX_GetActiveScene();
@@ -541,6 +545,38 @@ void KX_GameObject::ProcessReplica()
 		
 }
 
+void KX_GameObject::ResetReplica(KX_GameObject* original)
+{
+	CopyProperties(original);
+
+	m_bVisible = original->m_bVisible;
+	m_bOccluder = original->m_bOccluder;
+	m_bOccluderLod = original->m_bOccluderLod;
+	m_bUseObjectColor = original->m_bUseObjectColor;
+	m_objectColor = original->m_objectColor;
+	m_pHitObject = NULL;
+
+	if (m_actionManager)
+	{
+		delete m_actionManager;
+		m_actionManager = NULL;
+	}
+
+#ifdef WITH_PYTHON
+	if (m_attr_dict) {
+		PyDict_Clear(m_attr_dict);
+		Py_CLEAR(m_attr_dict);
+	}
+	if (original->m_attr_dict)
+		m_attr_dict = PyDict_Copy(original->m_attr_dict);
+
+	if (m_collisionCallbacks) {
+		UnregisterCollisionCallbacks();
+		Py_CLEAR(m_collisionCallbacks);
+	}
+#endif
+}
+
 static void setGraphicController_recursive(SG_Node* node)
 {
 	NodeList& children = node->GetSGChildren();
@@ -782,10 +818,13 @@ void KX_GameObject::UpdateBuckets( bool recursive )
 			ms = *mit;
 			ms->m_bObjectColor = m_bUseObjectColor;
 			ms->m_RGBAcolor = m_objectColor;
+			ms->m_layer = m_layer;
 			ms->m_bVisible = m_bVisible;
 			ms->m_bCulled = m_bCulled || !m_bVisible;
 			if (!ms->m_bCulled) 
 				ms->m_bucket->ActivateMesh(ms);
+			else
+				ms->Delink(); /* culled again before being rendered, by the shadow cache */
 			
 			/* split if necessary */
 #ifdef USE_SPLIT
@@ -1989,6 +2028,7 @@ PyAttributeDef KX_GameObject::Attributes[] = {
 	KX_PYATTRIBUTE_RW_FUNCTION("visible",	KX_GameObject, pyattr_get_visible,	pyattr_set_visible),
 	KX_PYATTRIBUTE_RW_FUNCTION("record_animation",	KX_GameObject, pyattr_get_record_animation,	pyattr_set_record_animation),
 	KX_PYATTRIBUTE_BOOL_RW    ("occlusion", KX_GameObject, m_bOccluder),
+	KX_PYATTRIBUTE_BOOL_RW    ("occlusionLod", KX_GameObject, m_bOccluderLod),
 	KX_PYATTRIBUTE_RW_FUNCTION("position",	KX_GameObject, pyattr_get_worldPosition,	pyattr_set_localPosition),
 	KX_PYATTRIBUTE_RO_FUNCTION("localInertia",	KX_GameObject, pyattr_get_localInertia),
 	KX_PYATTRIBUTE_RW_FUNCTION("orientation",KX_GameObject,pyattr_get_worldOrientation,pyattr_set_localOrientation),
@@ -2417,11 +2457,10 @@ PyObject *KX_GameObject::pyattr_get_life(void *self_v, const KX_PYATTRIBUTE_DEF
 {
 	KX_GameObject* self = static_cast<KX_GameObject*>(self_v);
 
-	CValue *life = self->GetProperty("::timebomb");
-	if (life)
+	if (self->GetLifeTimer())
 		// this convert the timebomb seconds to frames, hard coded 50.0 (assuming 50fps)
 		// value hardcoded in KX_Scene::AddReplicaObject()
-		return PyFloat_FromDouble(life->GetNumber() * 50.0);
+		return PyFloat_FromDouble(self->GetScene()->GetObjectLifetime(self) * 50.0);
 	else
 		Py_RETURN_NONE;
 }
@@ -63,6 +63,7 @@ class PHY_IPhysicsController;
 class BL_ActionManager;
 struct Object;
 class KX_ObstacleSimulation;
+class KX_ObjectPool;
 struct bAction;
 
 #ifdef WITH_PYTHON
@@ -108,6 +109,8 @@ protected:
 	bool       							m_bVisible; 
 	bool       							m_bCulled; 
 	bool								m_bOccluder;
+	/* draw the last level of detail in the occlusion buffer */
+	bool								m_bOccluderLod;
 
 	PHY_IPhysicsController*				m_pPhysicsController;
 	PHY_IGraphicController*				m_pGraphicController;
@@ -125,6 +128,12 @@ protected:
 	CListValue*							m_pInstanceObjects;
 	KX_GameObject*						m_pDupliGroupObject;
 
+	// The timer ending the object when it was added with a time limit
+	KX_TimerWheel::Timer*				m_pLifeTimer;
+
+	// The pool of the replicas of this object, copied to the replicas which go back in it
+	KX_ObjectPool*						m_pObjectPool;
+
 	// The action manager is used to play/stop/update actions
 	BL_ActionManager*					m_actionManager;
 
@@ -905,6 +914,22 @@ public:
 		void
 	) { return m_bOccluder; }
 
+	/**
+	 * Mesh drawn in the occlusion buffer instead of the object meshes: the
+	 * last level of detail when enabled with SetOccluderLod(), NULL otherwise.
+	 */
+	RAS_MeshObject*
+	GetOccluderMesh(
+	) const { return (m_bOccluderLod && !m_lodmeshes.empty()) ? m_lodmeshes.back() : NULL; }
+
+	/**
+	 * Draw the last level of detail in the occlusion buffer, off by default.
+	 */
+	void
+	SetOccluderLod(
+		bool v
+	) { m_bOccluderLod = v; }
+
 	/**
 	 * Set occluder flag of this object
 	 */
@@ -965,6 +990,33 @@ public:
 	{
 		m_pObstacleSimulation = NULL;
 	}
+
+	KX_TimerWheel::Timer* GetLifeTimer()
+	{
+		return m_pLifeTimer;
+	}
+
+	void SetLifeTimer(KX_TimerWheel::Timer* timer)
+	{
+		m_pLifeTimer = timer;
+	}
+
+	KX_ObjectPool* GetObjectPool()
+	{
+		return m_pObjectPool;
+	}
+
+	void SetObjectPool(KX_ObjectPool* pool)
+	{
+		m_pObjectPool = pool;
+	}
+
+	/**
+	 * Put a replica that ended back in the state of a new replica of \param original
+	 * before adding it again: properties, color, visibility, actions and python attributes.
+	 * The scene resets the transform, the logic and the physics.
+	 */
+	void ResetReplica(KX_GameObject* original);
 	
 	/**
 	 * add debug object to the debuglist.
@@ -92,6 +92,11 @@ public:
 	virtual bool GetCacheMaterials()=0;
 
 	virtual struct Scene* GetBlenderSceneForName(const STR_String& name)=0;
+
+	/// Bytes used by the vertices of the converted meshes.
+	virtual size_t GetMeshMemory()=0;
+	/// Bytes used by the images loaded as textures, estimated from their size.
+	virtual size_t GetTextureMemory()=0;
 	
 	
 #ifdef WITH_CXX_GUARDEDALLOC
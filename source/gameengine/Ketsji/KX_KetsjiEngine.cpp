@@ -37,6 +37,9 @@
 
 #include <iostream>
 #include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
 
 #include "BLI_task.h"
 
@@ -69,6 +72,9 @@
 #include "KX_WorldInfo.h"
 #include "KX_ISceneConverter.h"
 #include "KX_TimeCategoryLogger.h"
+#include "EXP_Profiler.h"
+
+#include "MEM_guardedalloc.h"
 
 #include "RAS_FramingManager.h"
 #include "DNA_world_types.h"
@@ -81,6 +87,16 @@
 #define DEFAULT_LOGIC_TIC_RATE 60.0
 //#define DEFAULT_PHYSICS_TIC_RATE 60.0
 
+/* The C++ objects only go through guardedalloc with WITH_CXX_GUARDEDALLOC,
+ * without it the profiler counts the C allocations alone */
+#ifdef WITH_CXX_GUARDEDALLOC
+#  define PROFILE_ALLOCS_LABEL "allocs"
+#  define PROFILE_MEMORY_LABEL "Memory:"
+#else
+#  define PROFILE_ALLOCS_LABEL "C allocs"
+#  define PROFILE_MEMORY_LABEL "Memory (C):"
+#endif
+
 #ifdef FREE_WINDOWS /* XXX mingw64 (gcc 4.7.0) defines a macro for DrawText that translates to DrawTextA. Not good */
 #ifdef DrawText
 #undef DrawText
@@ -109,6 +125,8 @@ double KX_KetsjiEngine::m_suspendeddelta = 0.0;
 double KX_KetsjiEngine::m_average_framerate = 0.0;
 bool   KX_KetsjiEngine::m_restrict_anim_fps = false;
 short  KX_KetsjiEngine::m_exitkey = 130; //ESC Key
+bool   KX_KetsjiEngine::m_flatTransforms = false;
+bool   KX_KetsjiEngine::m_headless = false;
 
 
 /**
@@ -177,7 +195,7 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem* system)
 	m_logger = new KX_TimeCategoryLogger (25);
 
 	for (int i = tc_first; i < tc_numCategories; i++)
-		m_logger->AddCategory((KX_TimeCategory)i);
+		m_logger->AddCategory((KX_TimeCategory)i, m_profileLabels[i]);
 
 #ifdef WITH_PYTHON
 	m_pyprofiledict = PyDict_New();
@@ -185,6 +203,14 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem* system)
 
 	m_taskscheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
 
+	m_profileDump = NULL;
+	m_profileDumpJson = false;
+	m_profileDumpFrame = 0;
+
+	m_benchmarkWarmup = 0;
+	m_benchmarkTicks = 0;
+	m_benchmarkLoadTime = 0.0;
+
 	BL_Action::InitLock();
 }
 
@@ -195,6 +221,8 @@ KX_KetsjiEngine::KX_KetsjiEngine(KX_ISystem* system)
  */
 KX_KetsjiEngine::~KX_KetsjiEngine()
 {
+	EndProfileDump();
+	CProfiler::EndTrace();
 	delete m_logger;
 	if (m_usedome)
 		delete m_dome;
@@ -264,8 +292,273 @@ PyObject* KX_KetsjiEngine::GetPyProfileDict()
 	Py_INCREF(m_pyprofiledict);
 	return m_pyprofiledict;
 }
+
+PyObject* KX_KetsjiEngine::GetPyMemoryDict()
+{
+	MemoryStats stats;
+	GetMemoryStats(stats);
+
+	PyObject *dict = PyDict_New();
+	PyObject *allocations = PyDict_New();
+	PyObject *item;
+
+	for (int i = tc_first; i < tc_numCategories; ++i) {
+		double count, bytes;
+		m_logger->GetAverageAllocations((KX_TimeCategory)i, count, bytes);
+		item = PyTuple_New(2);
+		PyTuple_SetItem(item, 0, PyFloat_FromDouble(count));
+		PyTuple_SetItem(item, 1, PyFloat_FromDouble(bytes));
+		PyDict_SetItemString(allocations, m_profileLabels[i], item);
+		Py_DECREF(item);
+	}
+	PyDict_SetItemString(dict, "allocations", allocations);
+	Py_DECREF(allocations);
+
+	const struct { const char *name; size_t value; } sizes[] = {
+		{"in_use", stats.m_inUse},
+		{"peak", stats.m_peak},
+		{"meshes", stats.m_meshes},
+		{"textures", stats.m_textures},
+		{"physics", stats.m_physics}
+	};
+	for (unsigned int i = 0; i < sizeof(sizes) / sizeof(*sizes); ++i) {
+		item = PyLong_FromSize_t(sizes[i].value);
+		PyDict_SetItemString(dict, sizes[i].name, item);
+		Py_DECREF(item);
+	}
+	item = PyLong_FromLong(stats.m_pythonBlocks);
+	PyDict_SetItemString(dict, "python_blocks", item);
+	Py_DECREF(item);
+
+	return dict;
+}
 #endif
 
+void KX_KetsjiEngine::GetMemoryStats(MemoryStats& stats)
+{
+	stats.m_inUse = MEM_get_memory_in_use();
+	stats.m_peak = MEM_get_peak_memory();
+	stats.m_meshes = m_sceneconverter ? m_sceneconverter->GetMeshMemory() : 0;
+	stats.m_textures = m_sceneconverter ? m_sceneconverter->GetTextureMemory() : 0;
+
+	stats.m_physics = 0;
+	for (KX_SceneList::iterator sceneit = m_scenes.begin(); sceneit != m_scenes.end(); ++sceneit) {
+		PHY_IPhysicsEnvironment *physenv = (*sceneit)->GetPhysicsEnvironment();
+		if (physenv)
+			stats.m_physics += physenv->GetMemoryUsage();
+	}
+
+	stats.m_pythonBlocks = 0;
+#ifdef WITH_PYTHON
+	PyObject *getallocatedblocks = PySys_GetObject("getallocatedblocks");
+	PyObject *blocks = getallocatedblocks ? PyObject_CallObject(getallocatedblocks, NULL) : NULL;
+	if (blocks) {
+		stats.m_pythonBlocks = (int)PyLong_AsLong(blocks);
+		Py_DECREF(blocks);
+	}
+	else {
+		PyErr_Clear();
+	}
+#endif
+}
+
+/* "GPU Latency:" becomes "gpu_latency" */
+static void profile_dump_key(const char *label, char *key)
+{
+	int i;
+	for (i = 0; label[i] && label[i] != ':'; i++)
+		key[i] = (label[i] == ' ') ? '_' : tolower(label[i]);
+	key[i] = '\0';
+}
+
+bool KX_KetsjiEngine::StartProfileDump(const char *filename)
+{
+	EndProfileDump();
+
+	m_profileDump = fopen(filename, "w");
+	if (!m_profileDump)
+		return false;
+
+	const size_t len = strlen(filename);
+	m_profileDumpJson = (len >= 5 && strcmp(filename + len - 5, ".json") == 0);
+	m_profileDumpFrame = 0;
+
+	if (m_profileDumpJson) {
+		fputs("[", m_profileDump);
+	}
+	else {
+		char key[sizeof(m_profileLabels[0])];
+		fputs("frame", m_profileDump);
+		for (int i = tc_first; i < tc_numCategories; ++i) {
+			profile_dump_key(m_profileLabels[i], key);
+			fprintf(m_profileDump, ",%s_ms,%s_allocs,%s_bytes", key, key, key);
+		}
+		fputs(",in_use,peak,meshes,textures,physics,python_blocks\n", m_profileDump);
+	}
+	return true;
+}
+
+void KX_KetsjiEngine::EndProfileDump()
+{
+	if (!m_profileDump)
+		return;
+
+	if (m_profileDumpJson)
+		fputs("\n]\n", m_profileDump);
+	fclose(m_profileDump);
+	m_profileDump = NULL;
+}
+
+void KX_KetsjiEngine::WriteProfileDump()
+{
+	MemoryStats stats;
+	GetMemoryStats(stats);
+	char key[sizeof(m_profileLabels[0])];
+
+	if (m_profileDumpJson) {
+		fprintf(m_profileDump, "%s\n{\"frame\": %d", (m_profileDumpFrame == 0) ? "" : ",", m_profileDumpFrame);
+		for (int i = tc_first; i < tc_numCategories; ++i) {
+			KX_TimeLogger::Measurement m = m_logger->GetLastMeasurement((KX_TimeCategory)i);
+			profile_dump_key(m_profileLabels[i], key);
+			fprintf(m_profileDump, ", \"%s\": {\"ms\": %.3f, \"allocs\": %u, \"bytes\": %llu}",
+			        key, m.m_time * 1000.0, m.m_allocations, (unsigned long long)m.m_allocatedBytes);
+		}
+		fprintf(m_profileDump, ", \"in_use\": %llu, \"peak\": %llu, \"meshes\": %llu, \"textures\": %llu, "
+		        "\"physics\": %llu, \"python_blocks\": %d}",
+		        (unsigned long long)stats.m_inUse, (unsigned long long)stats.m_peak, (unsigned long long)stats.m_meshes,
+		        (unsigned long long)stats.m_textures, (unsigned long long)stats.m_physics, stats.m_pythonBlocks);
+	}
+	else {
+		fprintf(m_profileDump, "%d", m_profileDumpFrame);
+		for (int i = tc_first; i < tc_numCategories; ++i) {
+			KX_TimeLogger::Measurement m = m_logger->GetLastMeasurement((KX_TimeCategory)i);
+			fprintf(m_profileDump, ",%.3f,%u,%llu", m.m_time * 1000.0, m.m_allocations, (unsigned long long)m.m_allocatedBytes);
+		}
+		fprintf(m_profileDump, ",%llu,%llu,%llu,%llu,%llu,%d\n",
+		        (unsigned long long)stats.m_inUse, (unsigned long long)stats.m_peak, (unsigned long long)stats.m_meshes,
+		        (unsigned long long)stats.m_textures, (unsigned long long)stats.m_physics, stats.m_pythonBlocks);
+	}
+
+	m_profileDumpFrame++;
+}
+
+void KX_KetsjiEngine::StartBenchmark(const char *filename, int ticks, int warmup)
+{
+	m_benchmarkReport = filename;
+	m_benchmarkTicks = ticks;
+	m_benchmarkWarmup = warmup;
+	m_benchmarkFrameTimes.clear();
+	m_benchmarkFrameAllocations.clear();
+	m_benchmarkFrameTimes.reserve(ticks);
+	m_benchmarkFrameAllocations.reserve(ticks);
+	for (int i = tc_first; i < tc_numCategories; ++i)
+		m_benchmarkTimes[i] = m_benchmarkAllocations[i] = m_benchmarkBytes[i] = 0.0;
+	m_benchmarkMeshSlots = m_benchmarkDrawCalls = m_benchmarkBatchedSlots = 0.0;
+
+	// One logic tick per frame, whatever the time the frames take
+	SetUseFixedTime(true);
+}
+
+void KX_KetsjiEngine::SetBenchmarkLoadTime(double seconds)
+{
+	m_benchmarkLoadTime = seconds;
+}
+
+void KX_KetsjiEngine::SetNumThreads(int numThreads)
+{
+	if (m_taskscheduler)
+		BLI_task_scheduler_free(m_taskscheduler);
+	m_taskscheduler = BLI_task_scheduler_create((numThreads > 0) ? numThreads : TASK_SCHEDULER_AUTO_THREADS);
+}
+
+void KX_KetsjiEngine::AddBenchmarkFrame()
+{
+	if (m_benchmarkWarmup > 0) {
+		m_benchmarkWarmup--;
+		return;
+	}
+
+	double time = 0.0;
+	unsigned int allocations = 0;
+	for (int i = tc_first; i < tc_numCategories; ++i) {
+		KX_TimeLogger::Measurement m = m_logger->GetLastMeasurement((KX_TimeCategory)i);
+		m_benchmarkTimes[i] += m.m_time;
+		m_benchmarkAllocations[i] += m.m_allocations;
+		m_benchmarkBytes[i] += m.m_allocatedBytes;
+		time += m.m_time;
+		allocations += m.m_allocations;
+	}
+	m_benchmarkFrameTimes.push_back(time * 1000.0);
+	m_benchmarkFrameAllocations.push_back(allocations);
+
+	const RAS_IRasterizer::FrameStats& stats = m_rasterizer->GetFrameStats();
+	m_benchmarkMeshSlots += stats.m_meshSlots;
+	m_benchmarkDrawCalls += stats.m_drawCalls;
+	m_benchmarkBatchedSlots += stats.m_batchedSlots;
+
+	if ((int)m_benchmarkFrameTimes.size() == m_benchmarkTicks) {
+		WriteBenchmarkReport();
+		m_benchmarkReport = "";
+		RequestExit(KX_EXIT_REQUEST_QUIT_GAME);
+	}
+}
+
+void KX_KetsjiEngine::WriteBenchmarkReport()
+{
+	FILE *file = fopen(m_benchmarkReport.ReadPtr(), "w");
+	if (!file) {
+		printf("error: can't write the benchmark report to %s\n", m_benchmarkReport.ReadPtr());
+		return;
+	}
+
+	const int frames = (int)m_benchmarkFrameTimes.size();
+	MemoryStats stats;
+	GetMemoryStats(stats);
+	char key[sizeof(m_profileLabels[0])];
+
+	std::vector<double> times(m_benchmarkFrameTimes);
+	std::sort(times.begin(), times.end());
+	double sum = 0.0;
+	for (int i = 0; i < frames; ++i)
+		sum += times[i];
+
+	/* The second half of the run is taken as the steady state, once the
+	 * caches and pools are filled. */
+	double allocations = 0.0, steadyAllocations = 0.0;
+	for (int i = 0; i < frames; ++i) {
+		allocations += m_benchmarkFrameAllocations[i];
+		if (i >= frames / 2)
+			steadyAllocations += m_benchmarkFrameAllocations[i];
+	}
+
+	fprintf(file, "{\n\"ticks\": %d,\n\"tic_rate\": %g,\n\"seconds\": %.3f,\n", frames, m_ticrate, sum / 1000.0);
+	fprintf(file, "\"threads\": %d,\n\"load_ms\": %.3f,\n",
+	        BLI_task_scheduler_num_threads(m_taskscheduler), m_benchmarkLoadTime * 1000.0);
+	fprintf(file, "\"frame_ms\": {\"mean\": %.3f, \"median\": %.3f, \"p95\": %.3f, \"max\": %.3f},\n",
+	        sum / frames, times[frames / 2], times[(frames * 95) / 100], times[frames - 1]);
+	fprintf(file, "\"allocations\": {\"mean\": %.2f, \"steady\": %.2f},\n",
+	        allocations / frames, steadyAllocations / (frames - frames / 2));
+
+	fputs("\"categories\": {", file);
+	for (int i = tc_first; i < tc_numCategories; ++i) {
+		profile_dump_key(m_profileLabels[i], key);
+		fprintf(file, "%s\n\t\"%s\": {\"ms\": %.3f, \"allocs\": %.2f, \"bytes\": %.0f}", (i == tc_first) ? "" : ",",
+		        key, m_benchmarkTimes[i] * 1000.0 / frames, m_benchmarkAllocations[i] / frames, m_benchmarkBytes[i] / frames);
+	}
+	fputs("\n},\n", file);
+
+	/* nothing is drawn when headless, the counters stay at 0 */
+	fprintf(file, "\"render\": {\"mesh_slots\": %.1f, \"draw_calls\": %.1f, \"batched_slots\": %.1f},\n",
+	        m_benchmarkMeshSlots / frames, m_benchmarkDrawCalls / frames, m_benchmarkBatchedSlots / frames);
+
+	fprintf(file, "\"memory\": {\"in_use\": %llu, \"peak\": %llu, \"meshes\": %llu, \"textures\": %llu, "
+	        "\"physics\": %llu, \"python_blocks\": %d}\n}\n",
+	        (unsigned long long)stats.m_inUse, (unsigned long long)stats.m_peak, (unsigned long long)stats.m_meshes,
+	        (unsigned long long)stats.m_textures, (unsigned long long)stats.m_physics, stats.m_pythonBlocks);
+
+	fclose(file);
+}
+
 
 void KX_KetsjiEngine::SetSceneConverter(KX_ISceneConverter* sceneconverter)
 {
@@ -538,6 +831,13 @@ void KX_KetsjiEngine::EndFrame()
 	// Go to next profiling measurement, time spend after this call is shown in the next frame.
 	m_logger->NextMeasurement(m_kxsystem->GetTimeInSeconds());
 
+	// No category is logging, the dump isn't part of any
+	if (m_profileDump)
+		WriteProfileDump();
+	if (m_benchmarkTicks > 0 && !m_benchmarkReport.IsEmpty())
+		AddBenchmarkFrame();
+	CProfiler::EndFrame();
+
 	m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
 	m_rasterizer->EndFrame();
 	// swap backbuffer (drawing into this buffer) <-> front/visible buffer
@@ -620,6 +920,7 @@ bool KX_KetsjiEngine::NextFrame()
 		// for each scene, call the proceed functions
 		{
 			KX_Scene* scene = *sceneit;
+			CProfileZone zone(scene->GetName().ReadPtr());
 	
 			/* Suspension holds the physics and logic processing for an
 			 * entire scene. Objects can be suspended individually, and
@@ -746,6 +1047,10 @@ bool KX_KetsjiEngine::NextFrame()
 
 void KX_KetsjiEngine::Render()
 {
+	if (m_headless) {
+		RenderHeadless();
+		return;
+	}
 	if (m_usedome) {
 		RenderDome();
 		return;
@@ -801,6 +1106,7 @@ void KX_KetsjiEngine::Render()
 	// for each scene, call the proceed functions
 	{
 		KX_Scene* scene = *sceneit;
+		CProfileZone zone(scene->GetName().ReadPtr());
 		KX_Camera* cam = scene->GetActiveCamera();
 		// pass the scene's worldsettings to the rasterizer
 		scene->GetWorldInfo()->UpdateWorldSettings();
@@ -857,6 +1163,7 @@ void KX_KetsjiEngine::Render()
 		// for each scene, call the proceed functions
 		{
 			KX_Scene* scene = *sceneit;
+			CProfileZone zone(scene->GetName().ReadPtr());
 			KX_Camera* cam = scene->GetActiveCamera();
 
 			// pass the scene's worldsettings to the rasterizer
@@ -899,6 +1206,35 @@ void KX_KetsjiEngine::Render()
 
 
 
+void KX_KetsjiEngine::RenderHeadless()
+{
+	m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
+	SG_SetActiveStage(SG_STAGE_RENDER);
+
+	if (BeginFrame()) {
+		// the cameras are set up and the scenes culled and animated like in Render(),
+		// RenderFrame() returns before the drawing, the shadows and the filters
+		for (KX_SceneList::iterator sceneit = m_scenes.begin(); sceneit != m_scenes.end(); ++sceneit) {
+			KX_Scene *scene = *sceneit;
+			CProfileZone zone(scene->GetName().ReadPtr());
+			KX_Camera *cam = scene->GetActiveCamera();
+
+			if (cam && !cam->GetViewport())
+				RenderFrame(scene, cam);
+
+			list<KX_Camera *> *cameras = scene->GetCameras();
+			for (list<KX_Camera *>::iterator it = cameras->begin(); it != cameras->end(); ++it) {
+				if ((*it)->GetViewport())
+					RenderFrame(scene, *it);
+			}
+		}
+	}
+
+	EndFrame();
+}
+
+
+
 void KX_KetsjiEngine::RequestExit(int exitrequestmode)
 {
 	m_exitcode = exitrequestmode;
@@ -1061,22 +1397,20 @@ void KX_KetsjiEngine::RenderShadowBuffers(KX_Scene *scene)
 		raslight->Update();
 
 		if (m_rasterizer->GetDrawingMode() == RAS_IRasterizer::KX_TEXTURED && raslight->HasShadowBuffer()) {
-			/* make temporary camera */
-			RAS_CameraData camdata = RAS_CameraData();
-			KX_Camera *cam = new KX_Camera(scene, scene->m_callbacks, camdata, true, true);
-			cam->SetName("__shadow__cam__");
-
+			KX_Camera *cam = light->GetShadowCamera();
+			KX_ShadowCache& cache = light->GetShadowCache();
+			const int layer = raslight->GetShadowLayer();
 			MT_Transform camtrans;
 
 			/* switch drawmode for speed */
 			drawmode = m_rasterizer->GetDrawingMode();
 			m_rasterizer->SetDrawingMode(RAS_IRasterizer::KX_SHADOW);
 
-			/* binds framebuffer object, sets up camera .. */
-			raslight->BindShadowBuffer(m_canvas, cam, camtrans);
+			/* place the camera at the lamp */
+			raslight->SetShadowCamera(cam, camtrans);
 
 			/* update scene */
-			scene->CalculateVisibleMeshes(m_rasterizer, cam, raslight->GetShadowLayer());
+			scene->CalculateVisibleMeshes(m_rasterizer, cam, layer);
 
 			m_logger->StartLog(tc_animations, m_kxsystem->GetTimeInSeconds(), true);
 			SG_SetActiveStage(SG_STAGE_ANIMATION_UPDATE);
@@ -1084,15 +1418,45 @@ void KX_KetsjiEngine::RenderShadowBuffers(KX_Scene *scene)
 			m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
 			SG_SetActiveStage(SG_STAGE_RENDER);
 
-			/* render */
-			m_rasterizer->ClearDepthBuffer();
-			m_rasterizer->ClearColorBuffer();
-			scene->RenderBuckets(camtrans, m_rasterizer);
+			/* only draw the shadow map again if the lamp or a caster changed */
+			const bool split = light->GetStaticShadow() && raslight->HasShadowCache();
+			const KX_ShadowCache::UpdateMode mode = cache.Update(scene->GetObjectList(), layer, cam, split,
+			                                                     raslight->IsShadowBufferUser());
 
-			/* unbind framebuffer object, restore drawmode, free camera */
-			raslight->UnbindShadowBuffer();
+			if (mode == KX_ShadowCache::SHADOW_UNCHANGED) {
+				/* nothing to render, take the casters out of the buckets */
+				cache.ActivateCasters(KX_ShadowCache::CASTER_NONE);
+			}
+			else if (!split) {
+				raslight->BindShadowBuffer(m_canvas, cam);
+				m_rasterizer->ClearDepthBuffer();
+				m_rasterizer->ClearColorBuffer();
+				scene->RenderBuckets(camtrans, m_rasterizer);
+				raslight->UnbindShadowBuffer();
+			}
+			else {
+				/* the static depth is missing if the cache couldn't be made */
+				if (mode == KX_ShadowCache::SHADOW_ALL || !raslight->RestoreShadowCache()) {
+					/* draw the static casters and keep their depth aside */
+					cache.ActivateCasters(KX_ShadowCache::CASTER_STATIC);
+					raslight->BindShadowBuffer(m_canvas, cam);
+					m_rasterizer->ClearDepthBuffer();
+					m_rasterizer->ClearColorBuffer();
+					scene->RenderBuckets(camtrans, m_rasterizer);
+					raslight->UnbindShadowBuffer();
+
+					raslight->StoreShadowCache();
+				}
+
+				/* draw the dynamic casters over the static depth */
+				cache.ActivateCasters(KX_ShadowCache::CASTER_DYNAMIC);
+				raslight->BindShadowBuffer(m_canvas, cam);
+				scene->RenderBuckets(camtrans, m_rasterizer);
+				raslight->UnbindShadowBuffer();
+			}
+
+			/* restore drawmode */
 			m_rasterizer->SetDrawingMode(drawmode);
-			cam->Release();
 		}
 	}
 }
@@ -1111,7 +1475,8 @@ void KX_KetsjiEngine::RenderFrame(KX_Scene* scene, KX_Camera* cam)
 	KX_SetActiveScene(scene);
 
 #ifdef WITH_PYTHON
-	scene->RunDrawingCallbacks(scene->GetPreDrawSetupCB());
+	if (!m_headless)
+		scene->RunDrawingCallbacks(scene->GetPreDrawSetupCB());
 #endif
 
 	GetSceneViewport(scene, cam, area, viewport);
@@ -1233,6 +1598,10 @@ void KX_KetsjiEngine::RenderFrame(KX_Scene* scene, KX_Camera* cam)
 	m_logger->StartLog(tc_rasterizer, m_kxsystem->GetTimeInSeconds(), true);
 	SG_SetActiveStage(SG_STAGE_RENDER);
 
+	// without a window the frame stops after the culling, see RenderHeadless()
+	if (m_headless)
+		return;
+
 #ifdef WITH_PYTHON
 	PHY_SetActiveEnvironment(scene->GetPhysicsEnvironment());
 	// Run any pre-drawing python callbacks
@@ -1436,8 +1805,89 @@ void KX_KetsjiEngine::RenderDebugProperties()
 			                            m_canvas->GetHeight());
 
 			m_rasterizer->RenderBox2D(xcoord + (int)(2.2 * profile_indent), ycoord, m_canvas->GetWidth(), m_canvas->GetHeight(), time/tottime);
+
+			double allocations, bytes;
+			m_logger->GetAverageAllocations((KX_TimeCategory)j, allocations, bytes);
+			debugtxt.Format("%d " PROFILE_ALLOCS_LABEL " | %.1fKB", (int)(allocations + 0.5), bytes / 1024.0);
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                            debugtxt.ReadPtr(),
+			                            xcoord + const_xindent + 3 * profile_indent, ycoord,
+			                            m_canvas->GetWidth(),
+			                            m_canvas->GetHeight());
 			ycoord += const_ysize;
 		}
+
+		/* Rendering counters of this frame */
+		const RAS_IRasterizer::FrameStats& stats = m_rasterizer->GetFrameStats();
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            "Draw calls:",
+		                            xcoord + const_xindent,
+		                            ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+
+		debugtxt.Format("%u | %u mat | %u slots | %u batched", stats.m_drawCalls, stats.m_materialChanges, stats.m_meshSlots, stats.m_batchedSlots);
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            debugtxt.ReadPtr(),
+		                            xcoord + const_xindent + profile_indent, ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+		ycoord += const_ysize;
+
+		if (stats.m_occlusionTests) {
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                            "Occlusion:",
+			                            xcoord + const_xindent,
+			                            ycoord,
+			                            m_canvas->GetWidth(),
+			                            m_canvas->GetHeight());
+
+			debugtxt.Format("%u occluders | %u/%u hidden | %.2fms", stats.m_occluders, stats.m_occlusionRejects,
+			                stats.m_occlusionTests, stats.m_occlusionTime * 1000.0);
+			m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+			                            debugtxt.ReadPtr(),
+			                            xcoord + const_xindent + profile_indent, ycoord,
+			                            m_canvas->GetWidth(),
+			                            m_canvas->GetHeight());
+			ycoord += const_ysize;
+		}
+
+		/* Memory in use and the part of the engine resources */
+		MemoryStats memstats;
+		GetMemoryStats(memstats);
+		const double megabyte = 1024.0 * 1024.0;
+
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            PROFILE_MEMORY_LABEL,
+		                            xcoord + const_xindent,
+		                            ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+
+		debugtxt.Format("%.1fMB | %.1fMB peak", memstats.m_inUse / megabyte, memstats.m_peak / megabyte);
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            debugtxt.ReadPtr(),
+		                            xcoord + const_xindent + profile_indent, ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+		ycoord += const_ysize;
+
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            "Resources:",
+		                            xcoord + const_xindent,
+		                            ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+
+		debugtxt.Format("%.1fMB meshes | %.1fMB textures | %.1fMB physics | %d python blocks",
+		                memstats.m_meshes / megabyte, memstats.m_textures / megabyte,
+		                memstats.m_physics / megabyte, memstats.m_pythonBlocks);
+		m_rasterizer->RenderText2D(RAS_IRasterizer::RAS_TEXT_PADDED,
+		                            debugtxt.ReadPtr(),
+		                            xcoord + const_xindent + profile_indent, ycoord,
+		                            m_canvas->GetWidth(),
+		                            m_canvas->GetHeight());
+		ycoord += const_ysize;
 	}
 	// Add the ymargin for titles below the other section of debug info
 	ycoord += title_y_top_margin;
@@ -1861,6 +2311,26 @@ short KX_KetsjiEngine::GetExitKey()
 	return m_exitkey;
 }
 
+void KX_KetsjiEngine::SetFlatTransforms(bool flat)
+{
+	m_flatTransforms = flat;
+}
+
+bool KX_KetsjiEngine::GetFlatTransforms()
+{
+	return m_flatTransforms;
+}
+
+void KX_KetsjiEngine::SetHeadless(bool headless)
+{
+	m_headless = headless;
+}
+
+bool KX_KetsjiEngine::GetHeadless()
+{
+	return m_headless;
+}
+
 void KX_KetsjiEngine::SetShowFramerate(bool frameRate)
 {
 	m_show_framerate = frameRate;
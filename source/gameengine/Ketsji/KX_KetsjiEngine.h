@@ -41,6 +41,7 @@
 #include "EXP_Python.h"
 #include "KX_WorldInfo.h"
 #include <vector>
+#include <stdio.h>
 
 struct TaskScheduler;
 class KX_TimeCategoryLogger;
@@ -126,6 +127,9 @@ private:
 
 	static short			m_exitkey; /* Key used to exit the BGE */
 
+	static bool				m_flatTransforms; /* update the scene graph with SG_FlatHierarchy */
+	static bool				m_headless; /* no window nor OpenGL context, nothing is drawn */
+
 	int					m_exitcode;
 	STR_String			m_exitstring;
 
@@ -201,10 +205,37 @@ private:
 	/** Task scheduler for multi-threading */
 	TaskScheduler* m_taskscheduler;
 
+	/** File the profile of each frame is written to, NULL when not dumping */
+	FILE*					m_profileDump;
+	bool					m_profileDumpJson;
+	int						m_profileDumpFrame;
+	void					WriteProfileDump();
+
+	/** File the benchmark report is written to, empty when not benchmarking */
+	STR_String				m_benchmarkReport;
+	/** Frames left to run before the measured ones, and measured frames to run */
+	int						m_benchmarkWarmup;
+	int						m_benchmarkTicks;
+	double					m_benchmarkLoadTime;
+	/** Time in ms and allocations of each measured frame */
+	std::vector<double>		m_benchmarkFrameTimes;
+	std::vector<unsigned int>	m_benchmarkFrameAllocations;
+	/** Sums of the measured frames for each category */
+	double					m_benchmarkTimes[tc_numCategories];
+	double					m_benchmarkAllocations[tc_numCategories];
+	double					m_benchmarkBytes[tc_numCategories];
+	/** Sums of the rendering counters of the measured frames, see RAS_IRasterizer::FrameStats */
+	double					m_benchmarkMeshSlots;
+	double					m_benchmarkDrawCalls;
+	double					m_benchmarkBatchedSlots;
+	void					AddBenchmarkFrame();
+	void					WriteBenchmarkReport();
+
 	void					RenderFrame(KX_Scene* scene, KX_Camera* cam);
 	void					PostRenderScene(KX_Scene* scene);
 	void					RenderDebugProperties();
 	void					RenderShadowBuffers(KX_Scene *scene);
+	void					RenderHeadless();
 
 public:
 	KX_KetsjiEngine(class KX_ISystem* system);
@@ -220,6 +251,7 @@ public:
 	void			SetPyNamespace(PyObject *pythondictionary);
 	PyObject*		GetPyNamespace() { return m_pythondictionary; }
 	PyObject*		GetPyProfileDict();
+	PyObject*		GetPyMemoryDict();
 #endif
 	void			SetSceneConverter(KX_ISceneConverter* sceneconverter);
 	KX_ISceneConverter* GetSceneConverter() { return m_sceneconverter; }
@@ -360,6 +392,22 @@ public:
 
 	static short GetExitKey();
 
+	/**
+	 * Update the scene graph in one sweep over a flattened hierarchy
+	 * instead of recursing through the nodes, see SG_FlatHierarchy.
+	 */
+	static void SetFlatTransforms(bool flat);
+
+	static bool GetFlatTransforms();
+
+	/**
+	 * Run without a window or an OpenGL context: Render() only updates the
+	 * animations and the materials aren't constructed. Used by the benchmark.
+	 */
+	static void SetHeadless(bool headless);
+
+	static bool GetHeadless();
+
 	/**
 	 * \Sets the display for frame rate on or off.
 	 */
@@ -416,6 +464,41 @@ public:
 	 */ 
 	void GetTimingDisplay(bool& frameRate, bool& profile, bool& properties) const;
 
+	/** Memory used by Blender and the engine resources, in bytes. */
+	struct MemoryStats {
+		size_t m_inUse;			/* all guardedalloc blocks */
+		size_t m_peak;
+		size_t m_meshes;
+		size_t m_textures;
+		size_t m_physics;
+		int m_pythonBlocks;		/* python doesn't allocate with guardedalloc, only its block count is known */
+	};
+
+	/**
+	 * Gathers the memory stats, the resources of all scenes are walked, so it
+	 * is only done when the profile is shown, dumped or asked for.
+	 */
+	void GetMemoryStats(MemoryStats& stats);
+
+	/**
+	 * Writes the time and the allocations of each category for each frame, and the memory stats,
+	 * as CSV or as JSON if the file name ends with ".json".
+	 * \return false if the file can't be opened.
+	 */
+	bool StartProfileDump(const char *filename);
+	void EndProfileDump();
+
+	/**
+	 * Runs \param ticks measured frames after \param warmup frames, with a fixed time step,
+	 * then writes the timings, allocations and memory to \param filename as JSON and quits the game.
+	 */
+	void StartBenchmark(const char *filename, int ticks, int warmup);
+	/// The time taken to convert the start scene, written in the benchmark report.
+	void SetBenchmarkLoadTime(double seconds);
+
+	/// Use \param numThreads threads for the tasks, 0 for one per core. Only before the first scene.
+	void SetNumThreads(int numThreads);
+
 	/** 
 	 * Sets cursor hiding on every frame.
 	 * \param hideCursor Turns hiding on or off.
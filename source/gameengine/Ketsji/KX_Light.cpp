@@ -37,6 +37,7 @@
 
 #include "KX_Light.h"
 #include "KX_Camera.h"
+#include "KX_Scene.h"
 #include "RAS_IRasterizer.h"
 #include "RAS_ICanvas.h"
 #include "RAS_ILightObject.h"
@@ -66,6 +67,8 @@ KX_LightObject::KX_LightObject(void* sgReplicationInfo,SG_Callbacks callbacks,
 	m_lightobj->m_glsl = glsl;
 	m_blenderscene = ((KX_Scene*)sgReplicationInfo)->GetBlenderScene();
 	m_base = NULL;
+	m_shadowCamera = NULL;
+	m_staticShadow = false;
 };
 
 
@@ -80,6 +83,9 @@ KX_LightObject::~KX_LightObject()
 		BKE_scene_base_unlink(m_blenderscene, m_base);
 		MEM_freeN(m_base);
 	}
+
+	if (m_shadowCamera)
+		m_shadowCamera->Release();
 }
 
 
@@ -93,6 +99,8 @@ CValue*		KX_LightObject::GetReplica()
 	replica->m_lightobj = m_lightobj->Clone();
 	replica->m_lightobj->m_light = replica;
 	m_rasterizer->AddLight(replica->m_lightobj);
+	replica->m_shadowCamera = NULL;
+	replica->m_shadowCache = KX_ShadowCache();
 	if (m_base)
 		m_base = NULL;
 
@@ -104,6 +112,13 @@ void KX_LightObject::UpdateScene(KX_Scene *kxscene)
 	m_lightobj->m_scene = (void*)kxscene;
 	m_blenderscene = kxscene->GetBlenderScene();
 	m_base = BKE_scene_base_add(m_blenderscene, GetBlenderObject());
+
+	/* the shadow camera belongs to the previous scene */
+	if (m_shadowCamera) {
+		m_shadowCamera->Release();
+		m_shadowCamera = NULL;
+	}
+	m_shadowCache.Invalidate();
 }
 
 void KX_LightObject::SetLayer(int layer)
@@ -112,6 +127,18 @@ void KX_LightObject::SetLayer(int layer)
 	m_lightobj->m_layer = layer;
 }
 
+KX_Camera *KX_LightObject::GetShadowCamera()
+{
+	/* kept between frames, it's placed at the lamp before each shadow render */
+	if (!m_shadowCamera) {
+		RAS_CameraData camdata = RAS_CameraData();
+		m_shadowCamera = new KX_Camera(GetScene(), KX_Scene::m_callbacks, camdata, true, true);
+		m_shadowCamera->SetName("__shadow__cam__");
+	}
+
+	return m_shadowCamera;
+}
+
 #ifdef WITH_PYTHON
 /* ------------------------------------------------------------------------- */
 /* Python Integration Hooks					                                 */
@@ -146,6 +173,7 @@ PyTypeObject KX_LightObject::Type = {
 };
 
 PyMethodDef KX_LightObject::Methods[] = {
+	KX_PYMETHODTABLE_NOARGS(KX_LightObject, updateShadow),
 	{NULL,NULL} //Sentinel
 };
 
@@ -162,9 +190,18 @@ PyAttributeDef KX_LightObject::Attributes[] = {
 	KX_PYATTRIBUTE_RO_FUNCTION("SUN", KX_LightObject, pyattr_get_typeconst),
 	KX_PYATTRIBUTE_RO_FUNCTION("NORMAL", KX_LightObject, pyattr_get_typeconst),
 	KX_PYATTRIBUTE_RW_FUNCTION("type", KX_LightObject, pyattr_get_type, pyattr_set_type),
+	KX_PYATTRIBUTE_BOOL_RW("static_shadow", KX_LightObject, m_staticShadow),
 	{ NULL }	//Sentinel
 };
 
+KX_PYMETHODDEF_DOC_NOARGS(KX_LightObject, updateShadow,
+"updateShadow()\n"
+"\tDraw the shadow map again at the next frame.\n")
+{
+	m_shadowCache.Invalidate();
+	Py_RETURN_NONE;
+}
+
 PyObject *KX_LightObject::pyattr_get_layer(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
 {
 	KX_LightObject *self = static_cast<KX_LightObject *>(self_v);
@@ -33,6 +33,7 @@
 #define __KX_LIGHT_H__
 
 #include "KX_GameObject.h"
+#include "KX_ShadowCache.h"
 
 #define MAX_LIGHT_LAYERS ((1 << 20) - 1)
 
@@ -52,6 +53,9 @@ protected:
 	class RAS_IRasterizer*	m_rasterizer;	//needed for registering and replication of lightobj
 	Scene*				m_blenderscene;
 	Base*				m_base;
+	KX_Camera*			m_shadowCamera;		// created at the first shadow render
+	KX_ShadowCache		m_shadowCache;
+	bool				m_staticShadow;		// keep the depth of the static casters aside
 
 public:
 	KX_LightObject(void* sgReplicationInfo,SG_Callbacks callbacks,RAS_IRasterizer* rasterizer,RAS_ILightObject*	lightobj, bool glsl);
@@ -62,9 +66,15 @@ public:
 	void UpdateScene(class KX_Scene *kxscene);
 	virtual void SetLayer(int layer);
 
+	KX_Camera*			GetShadowCamera();
+	KX_ShadowCache&		GetShadowCache() { return m_shadowCache; }
+	bool				GetStaticShadow() { return m_staticShadow; }
+
 	virtual int GetGameObjectType() { return OBJ_LIGHT; }
 
 #ifdef WITH_PYTHON
+	KX_PYMETHOD_DOC_NOARGS(KX_LightObject, updateShadow);
+
 	/* attributes */
 	static PyObject*	pyattr_get_layer(void* self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static int			pyattr_set_layer(void* self_v, const KX_PYATTRIBUTE_DEF *attrdef, PyObject *value);
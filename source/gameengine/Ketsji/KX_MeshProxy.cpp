@@ -92,6 +92,11 @@ void KX_MeshProxy::SetMeshModified(bool v)
 	m_meshobj->SetMeshModified(v);
 }
 
+void KX_MeshProxy::SetVertexModified(RAS_TexVert *vertex)
+{
+	m_meshobj->SetVertexModified(vertex);
+}
+
 KX_MeshProxy::KX_MeshProxy(RAS_MeshObject* mesh)
 	: CValue(), m_meshobj(mesh)
 {
@@ -261,6 +266,7 @@ PyObject *KX_MeshProxy::PyTransform(PyObject *args, PyObject *kwds)
 				RAS_TexVert *vert = &it.vertex[i];
 				vert->Transform(transform, ntransform);
 			}
+			it.array->SetModified(RAS_DisplayArray::ALL_MODIFIED, it.startvertex, it.endvertex);
 		}
 
 		/* if we set a material index, quit when done */
@@ -353,6 +359,7 @@ PyObject *KX_MeshProxy::PyTransformUV(PyObject *args, PyObject *kwds)
 						break;
 				}
 			}
+			it.array->SetModified(RAS_DisplayArray::ATTRIB_MODIFIED, it.startvertex, it.endvertex);
 		}
 
 		/* if we set a material index, quit when done */
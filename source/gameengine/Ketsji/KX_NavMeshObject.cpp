@@ -74,9 +74,38 @@ inline void flipAxes(float* vec)
 {
 	std::swap(vec[1],vec[2]);
 }
+
+/* The arrays read from the derived mesh by PrepareNavMesh() */
+struct KX_NavMeshObject::BuildData
+{
+	float *vertices, *dvertices;
+	unsigned short *polys, *dtris, *dmeshes;
+	int nverts, npolys, ndvertsuniq, ndtris;
+	int vertsPerPoly;
+
+	BuildData()
+		:vertices(NULL), dvertices(NULL),
+		polys(NULL), dtris(NULL), dmeshes(NULL),
+		nverts(0), npolys(0), ndvertsuniq(0), ndtris(0),
+		vertsPerPoly(0)
+	{
+	}
+
+	~BuildData()
+	{
+		if (vertices) delete [] vertices;
+		if (dvertices) delete [] dvertices;
+		/* navmesh conversion is using C guarded alloc for memory allocaitons */
+		if (polys) MEM_freeN(polys);
+		if (dmeshes) MEM_freeN(dmeshes);
+		if (dtris) MEM_freeN(dtris);
+	}
+};
+
 KX_NavMeshObject::KX_NavMeshObject(void* sgReplicationInfo, SG_Callbacks callbacks)
 :	KX_GameObject(sgReplicationInfo, callbacks)
 ,	m_navMesh(NULL)
+,	m_buildData(NULL)
 {
 	
 }
@@ -85,6 +114,8 @@ KX_NavMeshObject::~KX_NavMeshObject()
 {
 	if (m_navMesh)
 		delete m_navMesh;
+	if (m_buildData)
+		delete m_buildData;
 }
 
 CValue* KX_NavMeshObject::GetReplica()
@@ -98,6 +129,7 @@ void KX_NavMeshObject::ProcessReplica()
 {
 	KX_GameObject::ProcessReplica();
 	m_navMesh = NULL;  /* without this, building frees the navmesh we copied from */
+	m_buildData = NULL;
 	if (!BuildNavMesh()) {
 		std::cout << "Error in " << __func__ << ": unable to build navigation mesh" << std::endl;
 		return;
@@ -243,7 +275,7 @@ bool KX_NavMeshObject::BuildVertIndArrays(float *&vertices, int& nverts,
 		float* vert = vertices;
 		for (int vi=0; vi<nverts; vi++)
 		{
-			const float* pos = !meshobj->m_sharedvertex_map[vi].empty() ? meshobj->GetVertexLocation(vi) : NULL;
+			const float* pos = meshobj->m_sharedvertex_map[vi].m_darray ? meshobj->GetVertexLocation(vi) : NULL;
 			if (pos)
 				copy_v3_v3(vert, pos);
 			else
@@ -284,12 +316,22 @@ bool KX_NavMeshObject::BuildVertIndArrays(float *&vertices, int& nverts,
 
 
 bool KX_NavMeshObject::BuildNavMesh()
+{
+	return PrepareNavMesh() && FinishNavMesh();
+}
+
+bool KX_NavMeshObject::PrepareNavMesh()
 {
 	if (m_navMesh)
 	{
 		delete m_navMesh;
 		m_navMesh = NULL;
 	}
+	if (m_buildData)
+	{
+		delete m_buildData;
+		m_buildData = NULL;
+	}
 
 	if (GetMeshCount()==0)
 	{
@@ -297,20 +339,41 @@ bool KX_NavMeshObject::BuildNavMesh()
 		return false;
 	}
 
-	float *vertices = NULL, *dvertices = NULL;
-	unsigned short *polys = NULL, *dtris = NULL, *dmeshes = NULL;
-	int nverts = 0, npolys = 0, ndvertsuniq = 0, ndtris = 0;
-	int vertsPerPoly = 0;
-	if (!BuildVertIndArrays(vertices, nverts, polys, npolys, 
-							dmeshes, dvertices, ndvertsuniq, dtris, ndtris, vertsPerPoly ) 
-			|| vertsPerPoly<3)
+	BuildData *build = new BuildData();
+	if (!BuildVertIndArrays(build->vertices, build->nverts, build->polys, build->npolys,
+							build->dmeshes, build->dvertices, build->ndvertsuniq, build->dtris, build->ndtris,
+							build->vertsPerPoly)
+			|| build->vertsPerPoly<3)
 	{
 		printf("Can't build navigation mesh data for object:%s\n", m_name.ReadPtr());
-		if (vertices) delete[] vertices;
+		delete build;
 		return false;
 	}
-	
-	MT_Point3 pos;
+
+	m_buildData = build;
+	return true;
+}
+
+bool KX_NavMeshObject::FinishNavMesh()
+{
+	if (!m_buildData)
+		return false;
+
+	BuildData *build = m_buildData;
+	m_buildData = NULL;
+	m_navMesh = CreateDetourMesh(*build);
+	delete build;
+
+	return (m_navMesh != NULL);
+}
+
+dtStatNavMesh *KX_NavMeshObject::CreateDetourMesh(BuildData& build)
+{
+	float *vertices = build.vertices, *dvertices = build.dvertices;
+	unsigned short *polys = build.polys, *dtris = build.dtris, *dmeshes = build.dmeshes;
+	const int nverts = build.nverts, npolys = build.npolys, ndvertsuniq = build.ndvertsuniq, ndtris = build.ndtris;
+	const int vertsPerPoly = build.vertsPerPoly;
+
 	if (dmeshes==NULL)
 	{
 		for (int i=0; i<nverts; i++)
@@ -325,17 +388,13 @@ bool KX_NavMeshObject::BuildNavMesh()
 
 	if (!buildMeshAdjacency(polys, npolys, nverts, vertsPerPoly)) {
 		std::cout << __func__ << ": unable to build mesh adjacency information." << std::endl;
-		delete[] vertices;
-		return false;
+		return NULL;
 	}
 	
 	float cs = 0.2f;
 
 	if (!nverts || !npolys)
-	{
-		if (vertices) delete[] vertices;
-		return false;
-	}
+		return NULL;
 
 	float bmin[3], bmax[3];
 	calcMeshBounds(vertices, nverts, bmin, bmax);
@@ -361,8 +420,10 @@ bool KX_NavMeshObject::BuildNavMesh()
 	const int dataSize = headerSize + vertsSize + polysSize + nodesSize +
 		detailMeshesSize + detailVertsSize + detailTrisSize;
 	unsigned char* data = new unsigned char[dataSize];
-	if (!data)
-		return false;
+	if (!data) {
+		delete [] vertsi;
+		return NULL;
+	}
 	memset(data, 0, dataSize);
 
 	unsigned char* d = data;
@@ -462,23 +523,12 @@ bool KX_NavMeshObject::BuildNavMesh()
 		}
 	}
 
-	m_navMesh = new dtStatNavMesh;
-	m_navMesh->init(data, dataSize, true);
+	dtStatNavMesh *navmesh = new dtStatNavMesh;
+	navmesh->init(data, dataSize, true);
 
-	delete [] vertices;
+	delete [] vertsi;
 
-	/* navmesh conversion is using C guarded alloc for memory allocaitons */
-	MEM_freeN(polys);
-	if (dmeshes) MEM_freeN(dmeshes);
-	if (dtris) MEM_freeN(dtris);
-
-	if (dvertices)
-		delete [] dvertices;
-
-	if (vertsi)
-		delete [] vertsi;
-
-	return true;
+	return navmesh;
 }
 
 dtStatNavMesh* KX_NavMeshObject::GetNavMesh()
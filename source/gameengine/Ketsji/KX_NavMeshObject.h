@@ -39,12 +39,17 @@ class KX_NavMeshObject: public KX_GameObject
 	Py_Header
 
 protected:
+	struct BuildData;
+
 	dtStatNavMesh* m_navMesh;
+	/* the arrays between the two steps of a build */
+	BuildData* m_buildData;
 	
 	bool BuildVertIndArrays(float *&vertices, int& nverts,
 							unsigned short* &polys, int& npolys, unsigned short *&dmeshes, 
 							float *&dvertices, int &ndvertsuniq, unsigned short* &dtris, 
 							int& ndtris, int &vertsPerPoly);
+	dtStatNavMesh *CreateDetourMesh(BuildData& build);
 	
 public:
 	KX_NavMeshObject(void* sgReplicationInfo, SG_Callbacks callbacks);
@@ -55,6 +60,10 @@ public:
 
 
 	bool BuildNavMesh();
+	/// First step of BuildNavMesh(), reads the derived mesh of the object, from the main thread only.
+	bool PrepareNavMesh();
+	/// Second step of BuildNavMesh(), builds the detour mesh from the prepared arrays, can run in a task.
+	bool FinishNavMesh();
 	dtStatNavMesh* GetNavMesh();
 	int FindPath(const MT_Point3& from, const MT_Point3& to, float* path, int maxPathLen);
 	float Raycast(const MT_Point3& from, const MT_Point3& to);
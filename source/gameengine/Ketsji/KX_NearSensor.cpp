@@ -198,7 +198,7 @@ bool	KX_NearSensor::BroadPhaseFilterCollision(void*obj1,void*obj2)
 		if (client_info->m_type == KX_ClientObjectInfo::ACTOR)
 		{
 			if ((m_touchedpropname.Length() == 0) || 
-				(gameobj->GetProperty(m_touchedpropname)))
+				(gameobj->GetProperty(m_touchedpropkey)))
 			{
 				return true;
 			}
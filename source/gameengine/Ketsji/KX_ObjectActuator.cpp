@@ -347,6 +347,20 @@ void KX_ObjectActuator::ProcessReplica()
 		m_reference->RegisterActuator(this);
 }
 
+void KX_ObjectActuator::ResetReplica()
+{
+	SCA_IActuator::ResetReplica();
+	// the velocity of a new life is the one of the template, nothing to resolve
+	m_active_combined_velocity = false;
+	m_linear_damping_active = false;
+	m_angular_damping_active = false;
+	m_current_linear_factor = 0.0;
+	m_current_angular_factor = 0.0;
+	m_error_accumulator.setValue(0.0,0.0,0.0);
+	m_previous_error.setValue(0.0,0.0,0.0);
+	m_jumping = false;
+}
+
 bool KX_ObjectActuator::UnlinkObject(SCA_IObject* clientobj)
 {
 	if (clientobj == (SCA_IObject*)m_reference)
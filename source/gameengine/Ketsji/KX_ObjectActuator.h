@@ -150,6 +150,7 @@ public:
 	~KX_ObjectActuator();
 	CValue* GetReplica();
 	void ProcessReplica();
+	void ResetReplica();
 	bool UnlinkObject(SCA_IObject* clientobj);
 	void Relink(CTR_Map<CTR_HashedPtr, void*> *obj_map);
 
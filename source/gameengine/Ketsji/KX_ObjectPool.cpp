@@ -0,0 +1,66 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_ObjectPool.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_ObjectPool.h"
+
+#include <stddef.h>
+
+KX_ObjectPool::KX_ObjectPool(KX_GameObject *templateobj, int maxsize)
+	:m_template(templateobj),
+	m_maxSize(maxsize),
+	m_hits(0),
+	m_misses(0)
+{
+}
+
+KX_ObjectPool::~KX_ObjectPool()
+{
+	/* the scene frees the replicas before */
+}
+
+void KX_ObjectPool::Push(KX_GameObject *gameobj)
+{
+	m_objects.push_back(gameobj);
+}
+
+KX_GameObject *KX_ObjectPool::Pop()
+{
+	if (m_objects.empty()) {
+		m_misses++;
+		return NULL;
+	}
+
+	KX_GameObject *gameobj = m_objects.back();
+	m_objects.pop_back();
+	m_hits++;
+	return gameobj;
+}
+
+void KX_ObjectPool::Clear(std::vector<KX_GameObject *>& objects)
+{
+	objects.insert(objects.end(), m_objects.begin(), m_objects.end());
+	m_objects.clear();
+}
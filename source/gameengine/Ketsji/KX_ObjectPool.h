@@ -0,0 +1,111 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_ObjectPool.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_OBJECTPOOL_H__
+#define __KX_OBJECTPOOL_H__
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class KX_GameObject;
+
+/**
+ * Replicas of an object of an inactive layer that ended and are kept to be added again.
+ *
+ * A pooled replica is out of the scene: it has no logic links, is out of the physics
+ * world and isn't rendered. KX_Scene::AddReplicaObject() takes a replica from the pool
+ * when there is one (a hit) and resets it like a new replica, instead of replicating
+ * the object again (a miss).
+ *
+ * The pool holds a reference on each of its replicas.
+ */
+class KX_ObjectPool
+{
+public:
+	KX_ObjectPool(KX_GameObject *templateobj, int maxsize);
+	~KX_ObjectPool();
+
+	KX_GameObject *GetTemplate() const
+	{
+		return m_template;
+	}
+	/// Set to NULL when the object leaves the scene while some of its replicas are still in use.
+	void SetTemplate(KX_GameObject *templateobj)
+	{
+		m_template = templateobj;
+	}
+
+	int GetMaxSize() const
+	{
+		return m_maxSize;
+	}
+	void SetMaxSize(int maxsize)
+	{
+		m_maxSize = maxsize;
+	}
+
+	int GetSize() const
+	{
+		return (int)m_objects.size();
+	}
+	bool IsFull() const
+	{
+		return (int)m_objects.size() >= m_maxSize;
+	}
+
+	int GetHits() const
+	{
+		return m_hits;
+	}
+	int GetMisses() const
+	{
+		return m_misses;
+	}
+
+	/// Keep a replica, the pool takes the reference of the caller.
+	void Push(KX_GameObject *gameobj);
+	/// Take a replica with its reference, NULL if the pool is empty.
+	KX_GameObject *Pop();
+
+	/// Give back all the replicas without counting them in the statistics.
+	void Clear(std::vector<KX_GameObject *>& objects);
+
+private:
+	KX_GameObject *m_template;
+	std::vector<KX_GameObject *> m_objects;
+	int m_maxSize;
+	int m_hits;
+	int m_misses;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:KX_ObjectPool")
+#endif
+};
+
+#endif  /* __KX_OBJECTPOOL_H__ */
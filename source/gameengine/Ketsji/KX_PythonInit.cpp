@@ -405,6 +405,16 @@ static PyObject *gPyGetProfileInfo(PyObject *)
 	return gp_KetsjiEngine->GetPyProfileDict();
 }
 
+PyDoc_STRVAR(gPyGetMemoryInfo_doc,
+"getMemoryInfo()\n"
+"returns a dictionary with the memory in use and the allocations of each profile category,\n"
+"the C++ objects are only counted when built with WITH_CXX_GUARDEDALLOC"
+);
+static PyObject *gPyGetMemoryInfo(PyObject *)
+{
+	return gp_KetsjiEngine->GetPyMemoryDict();
+}
+
 PyDoc_STRVAR(gPySendMessage_doc,
 "sendMessage(subject, [body, to, from])\n"
 "sends a message in same manner as a message actuator"
@@ -470,6 +480,21 @@ static PyObject *gPyGetExitKey(PyObject *)
 	return PyLong_FromLong(KX_KetsjiEngine::GetExitKey());
 }
 
+static PyObject *gPySetFlatTransforms(PyObject *, PyObject *args)
+{
+	int flat;
+	if (!PyArg_ParseTuple(args, "i:setFlatTransforms", &flat))
+		return NULL;
+
+	KX_KetsjiEngine::SetFlatTransforms(flat != 0);
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetFlatTransforms(PyObject *)
+{
+	return PyBool_FromLong(KX_KetsjiEngine::GetFlatTransforms());
+}
+
 static PyObject *gPySetMaxLogicFrame(PyObject *, PyObject *args)
 {
 	int frame;
@@ -904,6 +929,8 @@ static struct PyMethodDef game_methods[] = {
 	{"getRandomFloat",(PyCFunction) gPyGetRandomFloat, METH_NOARGS, (const char *)gPyGetRandomFloat_doc},
 	{"setGravity",(PyCFunction) gPySetGravity, METH_O, (const char *)"set Gravitation"},
 	{"getSpectrum",(PyCFunction) gPyGetSpectrum, METH_NOARGS, (const char *)"get audio spectrum"},
+	{"getFlatTransforms", (PyCFunction) gPyGetFlatTransforms, METH_NOARGS, (const char *)"Gets if the scene graph is updated in one sweep"},
+	{"setFlatTransforms", (PyCFunction) gPySetFlatTransforms, METH_VARARGS, (const char *)"Sets if the scene graph is updated in one sweep"},
 	{"getMaxLogicFrame", (PyCFunction) gPyGetMaxLogicFrame, METH_NOARGS, (const char *)"Gets the max number of logic frame per render frame"},
 	{"setMaxLogicFrame", (PyCFunction) gPySetMaxLogicFrame, METH_VARARGS, (const char *)"Sets the max number of logic frame per render frame"},
 	{"getMaxPhysicsFrame", (PyCFunction) gPyGetMaxPhysicsFrame, METH_NOARGS, (const char *)"Gets the max number of physics frame per render frame"},
@@ -922,6 +949,7 @@ static struct PyMethodDef game_methods[] = {
 	{"PrintMemInfo", (PyCFunction)pyPrintStats, METH_NOARGS, (const char *)"Print engine statistics"},
 	{"NextFrame", (PyCFunction)gPyNextFrame, METH_NOARGS, (const char *)"Render next frame (if Python has control)"},
 	{"getProfileInfo", (PyCFunction)gPyGetProfileInfo, METH_NOARGS, gPyGetProfileInfo_doc},
+	{"getMemoryInfo", (PyCFunction)gPyGetMemoryInfo, METH_NOARGS, gPyGetMemoryInfo_doc},
 	/* library functions */
 	{"LibLoad", (PyCFunction)gLibLoad, METH_VARARGS|METH_KEYWORDS, (const char *)""},
 	{"LibNew", (PyCFunction)gLibNew, METH_VARARGS, (const char *)""},
@@ -1348,6 +1376,107 @@ static PyObject *gPyGetMipmapping(PyObject *)
 	return PyLong_FromLong(gp_Rasterizer->GetMipmapping());
 }
 
+static PyObject *gPySetSortMode(PyObject *, PyObject *args)
+{
+	int val = 0;
+
+	if (!PyArg_ParseTuple(args, "i:setSortMode", &val))
+		return NULL;
+
+	if (val < 0 || val >= RAS_IRasterizer::RAS_SORT_MAX) {
+		PyErr_SetString(PyExc_ValueError, "Rasterizer.setSortMode(val): invalid sort mode");
+		return NULL;
+	}
+
+	if (!gp_Rasterizer) {
+		PyErr_SetString(PyExc_RuntimeError, "Rasterizer.setSortMode(val): Rasterizer not available");
+		return NULL;
+	}
+
+	gp_Rasterizer->SetSortMode((RAS_IRasterizer::SortMode)val);
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetSortMode(PyObject *)
+{
+	if (!gp_Rasterizer) {
+		PyErr_SetString(PyExc_RuntimeError, "Rasterizer.getSortMode(): Rasterizer not available");
+		return NULL;
+	}
+	return PyLong_FromLong(gp_Rasterizer->GetSortMode());
+}
+
+static PyObject *gPySetMeshBatching(PyObject *, PyObject *args)
+{
+	int enable;
+
+	if (!PyArg_ParseTuple(args, "i:setMeshBatching", &enable))
+		return NULL;
+
+	if (!gp_Rasterizer) {
+		PyErr_SetString(PyExc_RuntimeError, "Rasterizer.setMeshBatching(enable): Rasterizer not available");
+		return NULL;
+	}
+
+	gp_Rasterizer->SetMeshBatching(enable != 0);
+	Py_RETURN_NONE;
+}
+
+static PyObject *gPyGetMeshBatching(PyObject *)
+{
+	if (!gp_Rasterizer) {
+		PyErr_SetString(PyExc_RuntimeError, "Rasterizer.getMeshBatching(): Rasterizer not available");
+		return NULL;
+	}
+	return PyBool_FromLong(gp_Rasterizer->GetMeshBatching());
+}
+
+static PyObject *gPyGetFrameStats(PyObject *)
+{
+	if (!gp_Rasterizer) {
+		PyErr_SetString(PyExc_RuntimeError, "Rasterizer.getFrameStats(): Rasterizer not available");
+		return NULL;
+	}
+
+	const RAS_IRasterizer::FrameStats& stats = gp_Rasterizer->GetFrameStats();
+	PyObject *dict = PyDict_New();
+	PyObject *item;
+
+	item = PyLong_FromLong(stats.m_meshSlots);
+	PyDict_SetItemString(dict, "mesh_slots", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_drawCalls);
+	PyDict_SetItemString(dict, "draw_calls", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_materialChanges);
+	PyDict_SetItemString(dict, "material_changes", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_batchedSlots);
+	PyDict_SetItemString(dict, "batched_slots", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_occluders);
+	PyDict_SetItemString(dict, "occluders", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_occlusionTests);
+	PyDict_SetItemString(dict, "occlusion_tests", item);
+	Py_DECREF(item);
+
+	item = PyLong_FromLong(stats.m_occlusionRejects);
+	PyDict_SetItemString(dict, "occlusion_rejects", item);
+	Py_DECREF(item);
+
+	item = PyFloat_FromDouble(stats.m_occlusionTime);
+	PyDict_SetItemString(dict, "occlusion_time", item);
+	Py_DECREF(item);
+
+	return dict;
+}
+
 static PyObject *gPySetVsync(PyObject *, PyObject *args)
 {
 	int interval;
@@ -1499,6 +1628,11 @@ static struct PyMethodDef rasterizer_methods[] = {
 	 "Get the actual dimensions, in pixels, of the physical display (e.g., the monitor)."},
 	{"setMipmapping", (PyCFunction) gPySetMipmapping, METH_VARARGS, ""},
 	{"getMipmapping", (PyCFunction) gPyGetMipmapping, METH_NOARGS, ""},
+	{"setSortMode", (PyCFunction) gPySetSortMode, METH_VARARGS, "set how the solid mesh slots are ordered"},
+	{"getSortMode", (PyCFunction) gPyGetSortMode, METH_NOARGS, "get how the solid mesh slots are ordered"},
+	{"setMeshBatching", (PyCFunction) gPySetMeshBatching, METH_VARARGS, "draw copies of small meshes in one call"},
+	{"getMeshBatching", (PyCFunction) gPyGetMeshBatching, METH_NOARGS, "get if copies of small meshes are drawn in one call"},
+	{"getFrameStats", (PyCFunction) gPyGetFrameStats, METH_NOARGS, "get the rendering counters of the last frame"},
 	{"setVsync", (PyCFunction) gPySetVsync, METH_VARARGS, ""},
 	{"getVsync", (PyCFunction) gPyGetVsync, METH_NOARGS, ""},
 	{"showFramerate",(PyCFunction) gPyShowFramerate, METH_VARARGS, "show or hide the framerate"},
@@ -2327,6 +2461,10 @@ PyMODINIT_FUNC initRasterizerPythonBinding()
 	KX_MACRO_addTypesToDict(d, RAS_MIPMAP_NEAREST, RAS_IRasterizer::RAS_MIPMAP_NEAREST);
 	KX_MACRO_addTypesToDict(d, RAS_MIPMAP_LINEAR, RAS_IRasterizer::RAS_MIPMAP_LINEAR);
 
+	/* for get/setSortMode */
+	KX_MACRO_addTypesToDict(d, RAS_SORT_NONE, RAS_IRasterizer::RAS_SORT_NONE);
+	KX_MACRO_addTypesToDict(d, RAS_SORT_STATE, RAS_IRasterizer::RAS_SORT_STATE);
+
 	/* for get/setVsync */
 	KX_MACRO_addTypesToDict(d, VSYNC_OFF, VSYNC_OFF);
 	KX_MACRO_addTypesToDict(d, VSYNC_ON, VSYNC_ON);
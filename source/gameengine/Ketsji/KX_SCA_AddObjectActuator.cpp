@@ -131,6 +131,14 @@ void KX_SCA_AddObjectActuator::ProcessReplica()
 	SCA_IActuator::ProcessReplica();
 }
 
+void KX_SCA_AddObjectActuator::ResetReplica()
+{
+	if (m_lastCreatedObject)
+		m_lastCreatedObject->UnregisterActuator(this);
+	m_lastCreatedObject=NULL;
+	SCA_IActuator::ResetReplica();
+}
+
 bool KX_SCA_AddObjectActuator::UnlinkObject(SCA_IObject* clientobj)
 {
 	if (clientobj == m_OriginalObject)
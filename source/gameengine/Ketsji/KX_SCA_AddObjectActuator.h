@@ -98,6 +98,9 @@ public:
 	virtual void 
 	ProcessReplica();
 
+	virtual void 
+	ResetReplica();
+
 	virtual void Replace_IScene(SCA_IScene *val)
 	{
 		m_scene= val;
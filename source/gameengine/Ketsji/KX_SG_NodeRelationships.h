@@ -81,6 +81,12 @@ public :
 	~KX_NormalParentRelation(
 	);
 
+		bool
+	IsNormalRelation(
+	) { 
+		return true;
+	}
+
 private :
 
 	KX_NormalParentRelation(
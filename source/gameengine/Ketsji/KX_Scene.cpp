@@ -36,6 +36,7 @@
 #endif
 
 #include <stdio.h>
+#include <math.h>
 
 #include "KX_Scene.h"
 #include "KX_PythonInit.h"
@@ -67,6 +68,7 @@
 #include "RAS_IRasterizer.h"
 #include "RAS_ICanvas.h"
 #include "RAS_BucketManager.h"
+#include "RAS_MaterialBucket.h"
 
 #include "EXP_FloatValue.h"
 #include "SCA_IController.h"
@@ -94,6 +96,8 @@
 #include "BL_ShapeDeformer.h"
 #include "BL_DeformableGameObject.h"
 #include "KX_ObstacleSimulation.h"
+#include "KX_ObjectPool.h"
+#include "EXP_Profiler.h"
 
 #ifdef WITH_BULLET
 #  include "KX_SoftBodyDeformer.h"
@@ -106,6 +110,7 @@
 #include "KX_Light.h"
 
 #include "BLI_task.h"
+#include "PIL_time.h"
 
 static void *KX_SceneReplicationFunc(SG_IObject* node,void* gameobj,void* scene)
 {
@@ -166,13 +171,14 @@ KX_Scene::KX_Scene(class SCA_IInputDevice* keyboarddevice,
 {
 	m_suspendedtime = 0.0;
 	m_suspendeddelta = 0.0;
+	m_animationPool = NULL;
+	m_animationTime = 0.0;
 
 	m_dbvt_culling = false;
 	m_dbvt_occlusion_res = 0;
 	m_activity_culling = false;
 	m_suspend = false;
 	m_isclearingZbuffer = true;
-	m_tempObjectList = new CListValue();
 	m_objectlist = new CListValue();
 	m_parentlist = new CListValue();
 	m_lightlist= new CListValue();
@@ -254,15 +260,34 @@ KX_Scene::~KX_Scene()
 	// reference might be hanging and causing late release of objects
 	RemoveAllDebugProperties();
 
+	// the pooled replicas are out of the object lists, they are removed first
+	std::vector<KX_ObjectPool*>::iterator pit;
+	for (pit = m_objectPools.begin(); pit != m_objectPools.end(); ++pit)
+	{
+		ShrinkObjectPool(*pit, 0);
+		(*pit)->SetMaxSize(0);
+	}
+
 	while (GetRootParentList()->GetCount() > 0) 
 	{
 		KX_GameObject* parentobj = (KX_GameObject*) GetRootParentList()->GetValue(0);
 		this->RemoveObject(parentobj);
 	}
 
+	for (pit = m_objectPools.begin(); pit != m_objectPools.end(); ++pit)
+	{
+		if ((*pit)->GetTemplate())
+			(*pit)->GetTemplate()->SetObjectPool(NULL);
+		delete *pit;
+	}
+	m_objectPools.clear();
+
 	if (m_obstacleSimulation)
 		delete m_obstacleSimulation;
 
+	if (m_animationPool)
+		BLI_task_pool_free(m_animationPool);
+
 	if (m_objectlist)
 		m_objectlist->Release();
 
@@ -275,8 +300,12 @@ KX_Scene::~KX_Scene()
 	if (m_lightlist)
 		m_lightlist->Release();
 	
-	if (m_tempObjectList)
-		m_tempObjectList->Release();
+	std::vector<KX_GameObject *> timebombs;
+	m_timebombs.Clear(timebombs);
+	for (std::vector<KX_GameObject *>::iterator it = timebombs.begin(); it != timebombs.end(); ++it) {
+		(*it)->SetLifeTimer(NULL);
+		(*it)->Release();
+	}
 
 	if (m_euthanasyobjects)
 		m_euthanasyobjects->Release();
@@ -317,9 +346,12 @@ RAS_BucketManager* KX_Scene::GetBucketManager()
 }
 
 
-CListValue* KX_Scene::GetTempObjectList()
+double KX_Scene::GetObjectLifetime(KX_GameObject* gameobj)
 {
-	return m_tempObjectList;
+	KX_TimerWheel::Timer *timer = gameobj->GetLifeTimer();
+	if (!timer)
+		return 0.0;
+	return m_timebombs.GetRemaining(timer) / KX_KetsjiEngine::GetTicRate();
 }
 
 CListValue* KX_Scene::GetObjectList()
@@ -496,6 +528,8 @@ KX_GameObject* KX_Scene::AddNodeReplicaObject(class SG_IObject* node, class CVal
 	KX_GameObject* orgobj = (KX_GameObject*)gameobj;
 	KX_GameObject* newobj = (KX_GameObject*)orgobj->GetReplica();
 	m_map_gameobject_to_replica.insert(orgobj, newobj);
+	if (m_sceneConverter)
+		m_sceneConverter->RegisterReplica(newobj, orgobj, this);
 
 	// also register 'timers' (time properties) of the replica
 	int numprops = newobj->GetPropertyCount();
@@ -887,21 +921,25 @@ SCA_IObject* KX_Scene::AddReplicaObject(class CValue* originalobject,
 
 	m_ueberExecutionPriority++;
 
+	// take a replica that ended from the pool of the object if there is one
+	KX_ObjectPool* pool = originalobj->GetObjectPool();
+	if (pool && pool->GetTemplate() == originalobj && pool->GetMaxSize() > 0)
+	{
+		KX_GameObject* pooled = pool->Pop();
+		if (pooled)
+		{
+			AddPooledObject(pooled, originalobj, referenceobj);
+			SetObjectLifespan(pooled, lifespan);
+			// the reference of the pool is the one returned
+			return pooled;
+		}
+	}
+
 	// lets create a replica
 	KX_GameObject* replica = (KX_GameObject*) AddNodeReplicaObject(NULL,originalobj);
 
 	// add a timebomb to this object
-	// lifespan of zero means 'this object lives forever'
-	if (lifespan > 0)
-	{
-		// for now, convert between so called frames and realtime
-		m_tempObjectList->Add(replica->AddRef());
-		// this convert the life from frames to sort-of seconds, hard coded 0.02 that assumes we have 50 frames per second
-		// if you change this value, make sure you change it in KX_GameObject::pyattr_get_life property too
-		CValue *fval = new CFloatValue(lifespan*0.02);
-		replica->SetProperty("::timebomb",fval);
-		fval->Release();
-	}
+	SetObjectLifespan(replica, lifespan);
 
 	// add to 'rootparent' list (this is the list of top hierarchy objects, updated each frame)
 	m_parentlist->Add(replica->AddRef());
@@ -986,6 +1024,223 @@ SCA_IObject* KX_Scene::AddReplicaObject(class CValue* originalobject,
 	return replica;
 }
 
+void KX_Scene::SetObjectLifespan(KX_GameObject* replica, int lifespan)
+{
+	// lifespan of zero means 'this object lives forever'
+	if (lifespan > 0)
+	{
+		// for now, convert between so called frames and realtime
+		// this convert the life from frames to sort-of seconds, hard coded 0.02 that assumes we have 50 frames per second
+		// if you change this value, make sure you change it in KX_GameObject::pyattr_get_life property too
+		// the object ends at the first logic tick that leaves no time
+		const double ticks = ceil(lifespan * 0.02 * KX_KetsjiEngine::GetTicRate() - 1.0e-6);
+		replica->SetLifeTimer(m_timebombs.Add(replica, (ticks > 1.0) ? (unsigned int)ticks : 1));
+		replica->AddRef();
+	}
+}
+
+void KX_Scene::AddPooledObject(KX_GameObject* replica, KX_GameObject* originalobj, KX_GameObject* referenceobj)
+{
+	replica->ResetReplica(originalobj);
+
+	// register the timers of the new properties
+	int numprops = replica->GetPropertyCount();
+	for (int i = 0; i < numprops; i++)
+	{
+		CValue* prop = replica->GetProperty(i);
+		if (prop->GetProperty("timer"))
+			m_timemgr->AddTimeProperty(prop);
+	}
+
+	m_objectlist->Add(replica->AddRef());
+	m_parentlist->Add(replica->AddRef());
+
+	PHY_IPhysicsController* ctrl = replica->GetPhysicsController();
+	if (ctrl)
+	{
+		ctrl->SetActive(true);
+		if (ctrl->IsSuspended() && !originalobj->GetPhysicsController()->IsSuspended())
+			ctrl->RestoreDynamics();
+		ctrl->SetLinearVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+		ctrl->SetAngularVelocity(MT_Vector3(0.0f, 0.0f, 0.0f), false);
+	}
+
+	// the transform of a new replica, the physics follows
+	SG_Node* orgnode = originalobj->GetSGNode();
+	replica->NodeSetLocalScale(orgnode->GetLocalScale());
+	replica->NodeSetLocalPosition(orgnode->GetLocalPosition());
+	replica->NodeSetLocalOrientation(orgnode->GetLocalOrientation());
+
+	if (referenceobj) {
+		replica->NodeSetLocalPosition(referenceobj->NodeGetWorldPosition());
+		replica->NodeSetLocalOrientation(referenceobj->NodeGetWorldOrientation());
+		replica->NodeSetRelativeScale(referenceobj->GetSGNode()->GetRootSGParent()->GetLocalScale());
+		replica->SetLayer(referenceobj->GetLayer());
+	}
+	else {
+		replica->SetLayer(m_blenderScene->lay);
+	}
+
+	replica->GetSGNode()->UpdateWorldData(0);
+	replica->ActivateGraphicController(false);
+
+	// the bricks are kept, their state goes back to the one of a new replica
+	// and ReplicateLogic() links them again like in AddReplicaObject()
+	replica->ResetLogic(originalobj);
+	m_map_gameobject_to_replica.insert(originalobj, replica);
+	replica->Relink(&m_map_gameobject_to_replica);
+	if (m_sceneConverter)
+		m_sceneConverter->RegisterReplica(replica, originalobj, this);
+	ReplicateLogic(replica);
+}
+
+bool KX_Scene::PoolObject(KX_GameObject* gameobj)
+{
+	KX_ObjectPool* pool = gameobj->GetObjectPool();
+	if (!pool || pool->IsFull() || gameobj == pool->GetTemplate())
+		return false;
+
+	// only what AddPooledObject() resets can be kept
+	KX_GameObject* templateobj = pool->GetTemplate();
+	SG_Node* node = gameobj->GetSGNode();
+	if (!node || node->GetSGParent() || !node->GetSGChildren().empty() ||
+	    gameobj->GetDupliGroupObject() || gameobj->GetInstanceObjects() ||
+	    gameobj->GetMeshCount() != templateobj->GetMeshCount() ||
+	    (gameobj->GetPhysicsController() == NULL) != (templateobj->GetPhysicsController() == NULL))
+	{
+		return false;
+	}
+	for (int i = 0; i < gameobj->GetMeshCount(); i++)
+	{
+		// replaced mesh
+		if (gameobj->GetMesh(i) != templateobj->GetMesh(i))
+			return false;
+	}
+
+	gameobj->AddRef();
+
+	RemoveObjectDebugProperties(gameobj);
+	gameobj->InvalidateProxy();
+
+	// the bricks are unlinked like in NewRemoveObject(), the state goes to 0
+	// first so that the sensors are unregistered and the controllers inactive.
+	// The bricks are kept for the next life, the scripts lose them
+	gameobj->SetState(0);
+
+	SCA_SensorList& sensors = gameobj->GetSensors();
+	for (SCA_SensorList::iterator its = sensors.begin(); !(its==sensors.end()); its++)
+	{
+		m_logicmgr->RemoveSensor(*its);
+		(*its)->InvalidateProxy();
+	}
+	SCA_ControllerList& controllers = gameobj->GetControllers();
+	for (SCA_ControllerList::iterator itc = controllers.begin(); !(itc==controllers.end()); itc++)
+	{
+		m_logicmgr->RemoveController(*itc);
+		(*itc)->InvalidateProxy();
+	}
+	SCA_ActuatorList& actuators = gameobj->GetActuators();
+	for (SCA_ActuatorList::iterator ita = actuators.begin(); !(ita==actuators.end()); ita++)
+	{
+		m_logicmgr->RemoveActuator(*ita);
+		(*ita)->InvalidateProxy();
+	}
+	gameobj->UnlinkRegistered();
+
+	int numprops = gameobj->GetPropertyCount();
+	for (int i = 0; i < numprops; i++)
+	{
+		CValue* propval = gameobj->GetProperty(i);
+		if (propval->GetProperty("timer"))
+			m_timemgr->RemoveTimeProperty(propval);
+	}
+
+	if (gameobj->GetLifeTimer()) {
+		m_timebombs.Remove(gameobj->GetLifeTimer());
+		gameobj->SetLifeTimer(NULL);
+		gameobj->Release();
+	}
+	if (m_objectlist->RemoveValue(gameobj))
+		gameobj->Release();
+	if (m_parentlist->RemoveValue(gameobj))
+		gameobj->Release();
+	if (m_animatedlist->RemoveValue(gameobj))
+		gameobj->Release();
+
+	// out of the rendering, the culling and the physics
+	gameobj->SetCulled(true);
+	gameobj->UpdateBuckets(false);
+	if (gameobj->GetGraphicController())
+		gameobj->GetGraphicController()->Activate(false);
+	if (gameobj->GetPhysicsController())
+		gameobj->GetPhysicsController()->SetActive(false);
+
+	if (m_sceneConverter)
+		m_sceneConverter->UnregisterLibraryObject(gameobj);
+
+	pool->Push(gameobj);
+	return true;
+}
+
+void KX_Scene::ShrinkObjectPool(KX_ObjectPool* pool, int size)
+{
+	std::vector<KX_GameObject*> objects;
+	pool->Clear(objects);
+
+	for (unsigned int i = 0; i < objects.size(); i++)
+	{
+		KX_GameObject* gameobj = objects[i];
+		if ((int)i < size) {
+			pool->Push(gameobj);
+		}
+		else {
+			// the object list takes the reference of the pool, RemoveObject() releases it
+			m_objectlist->Add(gameobj);
+			RemoveObject(gameobj);
+		}
+	}
+}
+
+const char *KX_Scene::GetObjectPoolError(KX_GameObject* templateobj)
+{
+	if (!m_inactivelist->SearchValue(templateobj))
+		return "object must be in an inactive layer";
+
+	switch (templateobj->GetGameObjectType()) {
+		case SCA_IObject::OBJ_LIGHT:
+		case SCA_IObject::OBJ_CAMERA:
+		case SCA_IObject::OBJ_TEXT:
+		case SCA_IObject::OBJ_ARMATURE:
+			return "lights, cameras, texts and armatures can't be pooled";
+	}
+
+	if (!templateobj->GetSGNode()->GetSGChildren().empty() || templateobj->IsDupliGroup())
+		return "objects with children or a dupli group can't be pooled";
+
+	if (templateobj->GetBlenderObject() && (templateobj->GetBlenderObject()->gameflag & OB_HASOBSTACLE))
+		return "obstacles can't be pooled";
+
+	return NULL;
+}
+
+void KX_Scene::SetObjectPoolSize(KX_GameObject* templateobj, int size)
+{
+	KX_ObjectPool* pool = templateobj->GetObjectPool();
+	if (!pool) {
+		if (size <= 0)
+			return;
+		pool = new KX_ObjectPool(templateobj, size);
+		m_objectPools.push_back(pool);
+		templateobj->SetObjectPool(pool);
+		return;
+	}
+
+	if (size < 0)
+		size = 0;
+	ShrinkObjectPool(pool, size);
+	pool->SetMaxSize(size);
+}
+
 
 
 void KX_Scene::RemoveObject(class CValue* gameobj)
@@ -1022,6 +1277,16 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	int ret;
 	KX_GameObject* newobj = (KX_GameObject*) gameobj;
 
+	/* the replicas kept for an object of an inactive layer go with it, the pool
+	 * stays with the scene for the replicas still in use */
+	KX_ObjectPool* pool = newobj->GetObjectPool();
+	if (pool && pool->GetTemplate() == newobj) {
+		ShrinkObjectPool(pool, 0);
+		pool->SetMaxSize(0);
+		pool->SetTemplate(NULL);
+		newobj->SetObjectPool(NULL);
+	}
+
 	/* remove property from debug list */
 	RemoveObjectDebugProperties(newobj);
 
@@ -1038,6 +1303,10 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 	// as only the deletion of the original object must be recorded
 	m_logicmgr->UnregisterGameObj(newobj->GetBlenderObject(), gameobj);
 
+	// the libraries keep the objects they may have to free
+	if (m_sceneConverter)
+		m_sceneConverter->RemoveGameObject(newobj);
+
 	//todo: look at this
 	//GetPhysicsEnvironment()->RemovePhysicsController(gameobj->getPhysicsController());
 
@@ -1108,8 +1377,11 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 		ret = newobj->Release();
 	if (m_objectlist->RemoveValue(newobj))
 		ret = newobj->Release();
-	if (m_tempObjectList->RemoveValue(newobj))
+	if (newobj->GetLifeTimer()) {
+		m_timebombs.Remove(newobj->GetLifeTimer());
+		newobj->SetLifeTimer(NULL);
 		ret = newobj->Release();
+	}
 	if (m_parentlist->RemoveValue(newobj))
 		ret = newobj->Release();
 	if (m_inactivelist->RemoveValue(newobj))
@@ -1129,12 +1401,6 @@ int KX_Scene::NewRemoveObject(class CValue* gameobj)
 		m_active_camera = NULL;
 	}
 
-	/* currently does nothing, keep in case we need to Unregister something */
-#if 0
-	if (m_sceneConverter)
-		m_sceneConverter->UnregisterGameObject(newobj);
-#endif
-	
 	// return value will be 0 if the object is actually deleted (all reference gone)
 	
 	return ret;
@@ -1551,15 +1817,49 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 		double pmat[16] = {0};
 		cam->GetProjectionMatrix().getValue(pmat);
 
+		const double starttime = (m_dbvt_occlusion_res) ? PIL_check_seconds_timer() : 0.0;
 		dbvt_culling = m_physicsEnvironment->CullingTest(PhysicsCullingCallback,&info,planes,5,m_dbvt_occlusion_res,
 		                                                 KX_GetActiveEngine()->GetCanvas()->GetViewPort(),
 		                                                 mvmat, pmat);
+		if (dbvt_culling && m_dbvt_occlusion_res) {
+			RAS_IRasterizer::FrameStats& stats = rasty->GetFrameStats();
+			int occluders, tested, rejected;
+			m_physicsEnvironment->GetOcclusionStats(occluders, tested, rejected);
+			stats.m_occluders += occluders;
+			stats.m_occlusionTests += tested;
+			stats.m_occlusionRejects += rejected;
+			stats.m_occlusionTime += PIL_check_seconds_timer() - starttime;
+		}
 	}
 	if (!dbvt_culling) {
 		// the physics engine couldn't help us, do it the hard way
-		for (int i = 0; i < m_objectlist->GetCount(); i++)
-		{
-			MarkVisible(rasty, static_cast<KX_GameObject*>(m_objectlist->GetValue(i)), cam, layer);
+		if (cam->GetFrustumCulling()) {
+			// test the bounds of all objects at once
+			cam->ExtractFrustumSphere();
+			m_batchCuller.Cull(m_objectlist, cam->GetNormalizedClipPlanes(), cam->m_frustum_center,
+			                   cam->m_frustum_radius, cam->GetCameraLocation());
+
+			for (unsigned int i = 0; i < m_batchCuller.GetCount(); i++) {
+				KX_GameObject *gameobj = m_batchCuller.GetObject(i);
+				// User (Python/Actuator) has forced object invisible...
+				if (!gameobj->GetSGNode() || !gameobj->GetVisible())
+					continue;
+
+				// Shadow lamp layers
+				const bool vis = m_batchCuller.GetVisible(i) && (!layer || (gameobj->GetLayer() & layer));
+				if (vis) {
+					for (int m = 0; m < gameobj->GetMeshCount(); m++)
+						gameobj->GetMesh(m)->SchedulePolygons(rasty->GetDrawingMode());
+				}
+				gameobj->SetCulled(!vis);
+				gameobj->UpdateBuckets(false);
+			}
+		}
+		else {
+			for (int i = 0; i < m_objectlist->GetCount(); i++)
+			{
+				MarkVisible(rasty, static_cast<KX_GameObject*>(m_objectlist->GetValue(i)), cam, layer);
+			}
 		}
 	}
 }
@@ -1567,32 +1867,16 @@ void KX_Scene::CalculateVisibleMeshes(RAS_IRasterizer* rasty,KX_Camera* cam, int
 // logic stuff
 void KX_Scene::LogicBeginFrame(double curtime)
 {
-	// have a look at temp objects ...
-	int lastobj = m_tempObjectList->GetCount() - 1;
-	
-	for (int i = lastobj; i >= 0; i--)
+	// end the temp objects whose time is over
+	std::vector<KX_GameObject *> expired;
+	m_timebombs.Advance(expired);
+
+	for (std::vector<KX_GameObject *>::iterator it = expired.begin(); it != expired.end(); ++it)
 	{
-		CValue* objval = m_tempObjectList->GetValue(i);
-		CFloatValue* propval = (CFloatValue*) objval->GetProperty("::timebomb");
-		
-		if (propval)
-		{
-			float timeleft = propval->GetNumber() - 1.0/KX_KetsjiEngine::GetTicRate();
-			
-			if (timeleft > 0)
-			{
-				propval->SetFloat(timeleft);
-			}
-			else
-			{
-				DelayedRemoveObject(objval);
-				// remove obj
-			}
-		}
-		else
-		{
-			// all object is the tempObjectList should have a clock
-		}
+		KX_GameObject *gameobj = *it;
+		gameobj->SetLifeTimer(NULL);
+		DelayedRemoveObject(gameobj);
+		gameobj->Release();
 	}
 	m_logicmgr->BeginFrame(curtime, 1.0/KX_KetsjiEngine::GetTicRate());
 }
@@ -1603,14 +1887,60 @@ void KX_Scene::AddAnimatedObject(CValue* gameobj)
 	m_animatedlist->Add(gameobj);
 }
 
+/* Call func for the children of a node as KX_GameObject::GetChildren() lists them,
+ * without making the list: the animation threads don't allocate, or touch reference counts */
+static bool for_each_child(SG_Node *node, bool (*func)(KX_GameObject *child, void *data), void *data)
+{
+	if (!node)
+		return true;
+
+	NodeList& children = node->GetSGChildren();
+
+	for (NodeList::iterator childit = children.begin(); !(childit == children.end()); ++childit) {
+		KX_GameObject *child = (KX_GameObject *)(*childit)->GetSGClientObject();
+
+		// a node without object may be an inverse parent link, look down it
+		if (child ? !func(child, data) : !for_each_child(*childit, func, data))
+			return false;
+	}
+	return true;
+}
+
+struct AnimChildrenState {
+	bool has_mesh;
+	bool has_non_mesh;
+};
+
+static bool check_anim_child(KX_GameObject *child, void *data)
+{
+	AnimChildrenState *state = (AnimChildrenState *)data;
+
+	// a mesh that hasn't been culled needs the pose
+	if (!child->GetCulled())
+		return false;
+
+	if (child->GetMeshCount() == 0)
+		state->has_non_mesh = true;
+	else
+		state->has_mesh = true;
+	return true;
+}
+
+static bool update_anim_child(KX_GameObject *child, void *UNUSED(data))
+{
+	if (child->GetDeformer())
+		child->GetDeformer()->Update();
+	return true;
+}
+
 static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(threadid))
 {
-	KX_GameObject *gameobj, *child, *parent;
-	CListValue *children;
+	KX_GameObject *gameobj, *parent;
 	bool needs_update;
 	double curtime = *(double*)BLI_task_pool_userdata(pool);
 
 	gameobj = (KX_GameObject*)taskdata;
+	CProfileZone zone(gameobj->GetName().ReadPtr());
 
 	// Non-armature updates are fast enough, so just update them
 	needs_update = gameobj->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE;
@@ -1618,37 +1948,20 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 	if (!needs_update) {
 		// If we got here, we're looking to update an armature, so check its children meshes
 		// to see if we need to bother with a more expensive pose update
-		children = gameobj->GetChildren();
-
-		bool has_mesh = false, has_non_mesh = false;
+		AnimChildrenState state = {false, false};
 
 		// Check for meshes that haven't been culled
-		for (int j=0; j<children->GetCount(); ++j) {
-			child = (KX_GameObject*)children->GetValue(j);
-
-			if (!child->GetCulled()) {
-				needs_update = true;
-				break;
-			}
-
-			if (child->GetMeshCount() == 0)
-				has_non_mesh = true;
-			else
-				has_mesh = true;
-		}
+		needs_update = !for_each_child(gameobj->GetSGNode(), check_anim_child, &state);
 
 		// If we didn't find a non-culled mesh, check to see
 		// if we even have any meshes, and update if this
 		// armature has only non-mesh children.
-		if (!needs_update && !has_mesh && has_non_mesh)
+		if (!needs_update && !state.has_mesh && state.has_non_mesh)
 			needs_update = true;
-
-		children->Release();
 	}
 
 	if (needs_update) {
 		gameobj->UpdateActionManager(curtime);
-		children = gameobj->GetChildren();
 		parent = gameobj->GetParent();
 
 		// Only do deformers here if they are not parented to an armature, otherwise the armature will
@@ -1656,28 +1969,26 @@ static void update_anim_thread_func(TaskPool *pool, void *taskdata, int UNUSED(t
 		if (gameobj->GetDeformer() && (!parent || (parent && parent->GetGameObjectType() != SCA_IObject::OBJ_ARMATURE)))
 			gameobj->GetDeformer()->Update();
 
-		for (int j=0; j<children->GetCount(); ++j) {
-			child = (KX_GameObject*)children->GetValue(j);
-
-			if (child->GetDeformer()) {
-				child->GetDeformer()->Update();
-			}
-		}
-
-		children->Release();
+		for_each_child(gameobj->GetSGNode(), update_anim_child, NULL);
 	}
 }
 
 void KX_Scene::UpdateAnimations(double curtime)
 {
-	TaskPool *pool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &curtime);
+	// actions can move objects between the shadow and the camera culling
+	m_batchCuller.Invalidate();
+
+	// the pool is kept for the next frames, with as many tasks as there are animated objects
+	if (!m_animationPool)
+		m_animationPool = BLI_task_pool_create(KX_GetActiveEngine()->GetTaskScheduler(), &m_animationTime);
+	BLI_task_pool_reuse_tasks(m_animationPool, m_animatedlist->GetCount());
+	m_animationTime = curtime;
 
 	for (int i=0; i<m_animatedlist->GetCount(); ++i) {
-		BLI_task_pool_push(pool, update_anim_thread_func, m_animatedlist->GetValue(i), false, TASK_PRIORITY_LOW);
+		BLI_task_pool_push(m_animationPool, update_anim_thread_func, m_animatedlist->GetValue(i), false, TASK_PRIORITY_LOW);
 	}
 
-	BLI_task_pool_work_and_wait(pool);
-	BLI_task_pool_free(pool);
+	BLI_task_pool_work_and_wait(m_animationPool);
 }
 
 void KX_Scene::LogicUpdateFrame(double curtime, bool frame)
@@ -1700,7 +2011,8 @@ void KX_Scene::LogicEndFrame()
 		obj = (KX_GameObject*)m_euthanasyobjects->GetValue(numobj-1);
 		m_euthanasyobjects->Remove(numobj-1);
 		obj->Release();
-		RemoveObject(obj);
+		if (!PoolObject(obj))
+			RemoveObject(obj);
 	}
 
 	//prepare obstacle simulation for new frame
@@ -1718,9 +2030,27 @@ void KX_Scene::UpdateParents(double curtime)
 	// we use the SG dynamic list
 	SG_Node* node;
 
-	while ((node = SG_Node::GetNextScheduled(m_sghead)) != NULL)
-	{
-		node->UpdateWorldData(curtime);
+	// the culling bounds follow the world transforms
+	m_batchCuller.Invalidate();
+
+	if (KX_KetsjiEngine::GetFlatTransforms()) {
+		if (m_sgflat.IsOutdated()) {
+			std::vector<SG_Node *> roots;
+
+			roots.reserve(m_parentlist->GetCount());
+			for (int i = 0; i < m_parentlist->GetCount(); i++) {
+				if ((node = ((KX_GameObject *)m_parentlist->GetValue(i))->GetSGNode()))
+					roots.push_back(node);
+			}
+			m_sgflat.Build(roots);
+		}
+		m_sgflat.UpdateScheduled(m_sghead, curtime);
+	}
+	else {
+		while ((node = SG_Node::GetNextScheduled(m_sghead)) != NULL)
+		{
+			node->UpdateWorldData(curtime);
+		}
 	}
 
 	//for (int i=0; i<GetRootParentList()->GetCount(); i++)
@@ -1910,19 +2240,9 @@ short KX_Scene::GetAnimationFPS()
 
 static void MergeScene_LogicBrick(SCA_ILogicBrick* brick, KX_Scene *from, KX_Scene *to)
 {
-	SCA_LogicManager *logicmgr= to->GetLogicManager();
-
 	brick->Replace_IScene(to);
 	brick->Replace_NetworkScene(to->GetNetworkScene());
 
-	// If we end up replacing a KX_TouchEventManager, we need to make sure
-	// physics controllers are properly in place. In other words, do this
-	// after merging physics controllers!
-	SCA_ISensor *sensor=  dynamic_cast<class SCA_ISensor *>(brick);
-	if (sensor) {
-		sensor->Replace_EventManager(logicmgr);
-	}
-
 	SCA_2DFilterActuator *filter_actuator = dynamic_cast<class SCA_2DFilterActuator*>(brick);
 	if (filter_actuator) {
 		filter_actuator->SetScene(to);
@@ -1976,18 +2296,13 @@ static void MergeScene_GameObject(KX_GameObject* gameobj, KX_Scene *to, KX_Scene
 		}
 	}
 
-	/* graphics controller */
+	/* graphics controller, the physics controller moves in MergeSceneEnd() with the constraints */
 	PHY_IController *ctrl = gameobj->GetGraphicController();
 	if (ctrl) {
 		/* SHOULD update the m_cullingTree */
 		ctrl->SetPhysicsEnvironment(to->GetPhysicsEnvironment());
 	}
 
-	ctrl = gameobj->GetPhysicsController();
-	if (ctrl) {
-		ctrl->SetPhysicsEnvironment(to->GetPhysicsEnvironment());
-	}
-
 	/* SG_Node can hold a scene reference */
 	SG_Node *sg= gameobj->GetSGNode();
 	if (sg) {
@@ -2023,82 +2338,311 @@ static void MergeScene_GameObject(KX_GameObject* gameobj, KX_Scene *to, KX_Scene
 	}
 }
 
-bool KX_Scene::MergeScene(KX_Scene *other)
+/* The sensors start in the event managers of the scene once all the objects
+ * are merged. If we end up replacing a KX_TouchEventManager, we need to make
+ * sure physics controllers are properly in place. In other words, do this
+ * after merging physics controllers! */
+static void MergeScene_Sensors(KX_GameObject* gameobj, KX_Scene *to)
 {
-	PHY_IPhysicsEnvironment *env = this->GetPhysicsEnvironment();
-	PHY_IPhysicsEnvironment *env_other = other->GetPhysicsEnvironment();
+	SCA_LogicManager *logicmgr= to->GetLogicManager();
+	SCA_SensorList& sensors= gameobj->GetSensors();
+	SCA_SensorList::iterator its;
 
-	if ((env==NULL) != (env_other==NULL)) /* TODO - even when both scenes have NONE physics, the other is loaded with bullet enabled, ??? */
+	for (its = sensors.begin(); !(its==sensors.end()); ++its)
 	{
-		printf("KX_Scene::MergeScene: physics scenes type differ, aborting\n");
-		printf("\tsource %d, terget %d\n", (int)(env!=NULL), (int)(env_other!=NULL));
-		return false;
+		(*its)->Replace_EventManager(logicmgr);
 	}
+}
 
-	if (GetSceneConverter() != other->GetSceneConverter()) {
-		printf("KX_Scene::MergeScene: converters differ, aborting\n");
-		return false;
+KX_SceneMerge::KX_SceneMerge()
+	:m_stage(MERGE_BEGIN),
+	m_index(0),
+	m_numLights(0),
+	m_numSteps(0),
+	m_numDone(0)
+{
+}
+
+float KX_SceneMerge::GetProgress() const
+{
+	if (m_stage == MERGE_DONE)
+		return 1.0f;
+	if (m_stage == MERGE_BEGIN)
+		return 0.0f;
+	return (float)m_numDone / (float)m_numSteps;
+}
+
+bool KX_Scene::MergeScene(KX_Scene *other)
+{
+	KX_SceneMerge merge;
+
+	while (!merge.IsDone()) {
+		if (!MergeSceneStep(other, merge, 0.0))
+			return false;
 	}
+	return true;
+}
 
+bool KX_Scene::MergeSceneStep(KX_Scene *other, KX_SceneMerge& merge, double deadline)
+{
+	if (merge.m_stage == KX_SceneMerge::MERGE_BEGIN) {
+		PHY_IPhysicsEnvironment *env = this->GetPhysicsEnvironment();
+		PHY_IPhysicsEnvironment *env_other = other->GetPhysicsEnvironment();
 
-	GetBucketManager()->MergeBucketManager(other->GetBucketManager(), this);
+		if ((env==NULL) != (env_other==NULL)) /* TODO - even when both scenes have NONE physics, the other is loaded with bullet enabled, ??? */
+		{
+			printf("KX_Scene::MergeScene: physics scenes type differ, aborting\n");
+			printf("\tsource %d, terget %d\n", (int)(env!=NULL), (int)(env_other!=NULL));
+			merge.m_stage = KX_SceneMerge::MERGE_DONE;
+			return false;
+		}
 
+		if (GetSceneConverter() != other->GetSceneConverter()) {
+			printf("KX_Scene::MergeScene: converters differ, aborting\n");
+			merge.m_stage = KX_SceneMerge::MERGE_DONE;
+			return false;
+		}
 
-	/* active + inactive == all ??? - lets hope so */
-	for (int i = 0; i < other->GetObjectList()->GetCount(); i++)
-	{
-		KX_GameObject* gameobj = (KX_GameObject*)other->GetObjectList()->GetValue(i);
-		MergeScene_GameObject(gameobj, this, other);
+		/* the pooled replicas are freed with the other scene, the pools come here
+		 * with their objects and the replicas in use */
+		for (std::vector<KX_ObjectPool*>::iterator pit = other->m_objectPools.begin(); pit != other->m_objectPools.end(); ++pit)
+		{
+			other->ShrinkObjectPool(*pit, 0);
+			m_objectPools.push_back(*pit);
+		}
+		other->m_objectPools.clear();
+
+		std::set<CValue *> roots, lights;
+		for (int i = 0; i < other->GetRootParentList()->GetCount(); i++)
+			roots.insert(other->GetRootParentList()->GetValue(i));
+		for (int i = 0; i < other->GetLightList()->GetCount(); i++)
+			lights.insert(other->GetLightList()->GetValue(i));
+
+		/* active + inactive == all ??? - lets hope so */
+		std::vector<KX_SceneMerge::Entry> others;
+		for (int l = 0; l < 2; l++) {
+			CListValue *list = (l == 0) ? other->GetObjectList() : other->GetInactiveList();
+
+			for (int i = 0; i < list->GetCount(); i++) {
+				KX_SceneMerge::Entry entry;
+				entry.m_gameobj = (KX_GameObject *)list->GetValue(i);
+				entry.m_active = (l == 0);
+				entry.m_root = roots.count(entry.m_gameobj) != 0;
+				entry.m_light = lights.count(entry.m_gameobj) != 0;
+
+				if (entry.m_light)
+					merge.m_objects.push_back(entry);
+				else
+					others.push_back(entry);
+			}
+		}
+		merge.m_numLights = merge.m_objects.size();
+		merge.m_objects.insert(merge.m_objects.end(), others.begin(), others.end());
 
-		/* add properties to debug list for LibLoad objects */
-		if (KX_GetActiveEngine()->GetAutoAddDebugProperties()) {
-			AddObjectDebugProperties(gameobj);
+		/* the materials drawn by the objects, compiled before the objects show up */
+		RAS_BucketManager *bucketmgr_other = other->GetBucketManager();
+		for (int b = 0; b < 2; b++) {
+			RAS_BucketManager::BucketList& buckets = (b == 0) ? bucketmgr_other->GetSolidBuckets() : bucketmgr_other->GetAlphaBuckets();
+
+			for (RAS_BucketManager::BucketList::iterator bit = buckets.begin(); bit != buckets.end(); ++bit)
+				merge.m_materials.push_back((*bit)->GetPolyMaterial());
 		}
 
-		gameobj->UpdateBuckets(false); /* only for active objects */
-	}
+		if (env) {
+			for (unsigned int i = 0; i < merge.m_objects.size(); ++i) {
+				const KX_SceneMerge::Entry& entry = merge.m_objects[i];
+				if (entry.m_gameobj->GetPhysicsController()) {
+					merge.m_bodies.push_back(entry.m_gameobj);
+					if (entry.m_active)
+						merge.m_physicsObjects.push_back(entry.m_gameobj);
+				}
+			}
+		}
 
-	for (int i = 0; i < other->GetInactiveList()->GetCount(); i++)
-	{
-		KX_GameObject* gameobj = (KX_GameObject*)other->GetInactiveList()->GetValue(i);
-		MergeScene_GameObject(gameobj, this, other);
+		/* one more for the end */
+		merge.m_numSteps = merge.m_objects.size() + merge.m_materials.size() +
+		                   merge.m_bodies.size() + merge.m_physicsObjects.size() + 1;
+		merge.m_stage = KX_SceneMerge::MERGE_LIGHTS;
+		merge.m_index = 0;
 	}
 
-	if (env) {
-		env->MergeEnvironment(env_other);
-		CListValue *otherObjects = other->GetObjectList();
-
-		// List of all physics objects to merge (needed by ReplicateConstraints).
-		std::vector<KX_GameObject *> physicsObjects;
-		for (unsigned int i = 0; i < otherObjects->GetCount(); ++i) {
-			KX_GameObject *gameobj = (KX_GameObject *)otherObjects->GetValue(i);
-			if (gameobj->GetPhysicsController()) {
-				physicsObjects.push_back(gameobj);
+	/* at least one unit of work per step, so the merge always ends */
+	bool first = true;
+
+	while (merge.m_stage != KX_SceneMerge::MERGE_DONE) {
+		if (!first && deadline > 0.0 && PIL_check_seconds_timer() >= deadline)
+			break;
+		first = false;
+
+		switch (merge.m_stage) {
+			case KX_SceneMerge::MERGE_LIGHTS:
+			case KX_SceneMerge::MERGE_OBJECTS:
+			{
+				const unsigned int end = (merge.m_stage == KX_SceneMerge::MERGE_LIGHTS) ? merge.m_numLights : merge.m_objects.size();
+
+				if (merge.m_index >= end) {
+					if (merge.m_stage == KX_SceneMerge::MERGE_LIGHTS)
+						merge.m_stage = KX_SceneMerge::MERGE_MATERIALS;
+					else
+						MergeScenePhysicsBegin(merge);
+					merge.m_index = 0;
+					first = true;
+					break;
+				}
+
+				const KX_SceneMerge::Entry& entry = merge.m_objects[merge.m_index++];
+				KX_GameObject *gameobj = entry.m_gameobj;
+
+				MergeScene_GameObject(gameobj, this, other);
+
+				if (entry.m_active) {
+					/* add properties to debug list for LibLoad objects */
+					if (KX_GetActiveEngine()->GetAutoAddDebugProperties()) {
+						AddObjectDebugProperties(gameobj);
+					}
+
+					gameobj->UpdateBuckets(false); /* only for active objects */
+					m_objectlist->Add(gameobj->AddRef());
+				}
+				else {
+					m_inactivelist->Add(gameobj->AddRef());
+				}
+
+				if (entry.m_root)
+					m_parentlist->Add(gameobj->AddRef());
+				if (entry.m_light)
+					m_lightlist->Add(gameobj->AddRef());
+
+				merge.m_numDone++;
+				break;
+			}
+			case KX_SceneMerge::MERGE_MATERIALS:
+			{
+				if (merge.m_index >= merge.m_materials.size()) {
+					/* the buckets only draw the mesh slots culled visible, the
+					 * objects not merged yet aren't culled by this scene */
+					GetBucketManager()->MergeBucketManager(other->GetBucketManager(), this);
+
+					/* the lights are merged already */
+					merge.m_stage = KX_SceneMerge::MERGE_OBJECTS;
+					merge.m_index = merge.m_numLights;
+					first = true;
+					break;
+				}
+
+				/* compiles the shader and loads the textures, after the lights are merged */
+				merge.m_materials[merge.m_index++]->Replace_IScene(this);
+				merge.m_numDone++;
+				break;
 			}
+			case KX_SceneMerge::MERGE_PHYSICS:
+			case KX_SceneMerge::MERGE_CONSTRAINTS:
+			{
+				const bool physics = (merge.m_stage == KX_SceneMerge::MERGE_PHYSICS);
+				const std::vector<KX_GameObject *>& objects = (physics) ? merge.m_bodies : merge.m_physicsObjects;
+
+				if (merge.m_index >= objects.size()) {
+					merge.m_stage = (physics) ? KX_SceneMerge::MERGE_CONSTRAINTS : KX_SceneMerge::MERGE_END;
+					merge.m_index = 0;
+					first = true;
+					break;
+				}
+
+				KX_GameObject *gameobj = objects[merge.m_index++];
+				PHY_IPhysicsController *ctrl = gameobj->GetPhysicsController();
+
+				if (physics) {
+					/* the body stayed in the other environment, it sleeps in this one
+					 * until all of them are there with their joints */
+					ctrl->SetPhysicsEnvironment(GetPhysicsEnvironment());
+					ctrl->SetSleeping(true);
+				}
+				else {
+					// Replicate all constraints in the right physics environment.
+					ctrl->ReplicateConstraints(gameobj, merge.m_physicsObjects);
+					gameobj->ClearConstraints();
+				}
+
+				merge.m_numDone++;
+				break;
+			}
+			case KX_SceneMerge::MERGE_END:
+			{
+				MergeSceneEnd(other, merge);
+				merge.m_stage = KX_SceneMerge::MERGE_DONE;
+				merge.m_numDone++;
+				break;
+			}
+			default:
+				break;
+		}
+	}
+
+	return true;
+}
+
+/* The objects removed while they were merged are left out of the physics stages,
+ * their bodies stay in the other environment and go with it */
+void KX_Scene::MergeScenePhysicsBegin(KX_SceneMerge& merge)
+{
+	std::set<CValue *>& merged = merge.m_merged;
+	for (int i = 0; i < m_objectlist->GetCount(); i++)
+		merged.insert(m_objectlist->GetValue(i));
+	for (int i = 0; i < m_inactivelist->GetCount(); i++)
+		merged.insert(m_inactivelist->GetValue(i));
+
+	for (int l = 0; l < 2; l++) {
+		std::vector<KX_GameObject *>& objects = (l == 0) ? merge.m_bodies : merge.m_physicsObjects;
+		std::vector<KX_GameObject *> kept;
+
+		for (unsigned int i = 0; i < objects.size(); ++i) {
+			if (merged.count(objects[i]))
+				kept.push_back(objects[i]);
 		}
+		merge.m_numDone += objects.size() - kept.size();
+		objects.swap(kept);
+	}
+
+	merge.m_stage = KX_SceneMerge::MERGE_PHYSICS;
+}
+
+void KX_Scene::MergeSceneEnd(KX_Scene *other, KX_SceneMerge& merge)
+{
+	PHY_IPhysicsEnvironment *env = this->GetPhysicsEnvironment();
+
+	/* objects removed while the merge went on are left out */
+	std::set<CValue *> merged;
+	for (int i = 0; i < m_objectlist->GetCount(); i++)
+		merged.insert(m_objectlist->GetValue(i));
+	for (int i = 0; i < m_inactivelist->GetCount(); i++)
+		merged.insert(m_inactivelist->GetValue(i));
 
-		for (unsigned int i = 0; i < physicsObjects.size(); ++i) {
-			KX_GameObject *gameobj = physicsObjects[i];
-			// Replicate all constraints in the right physics environment.
-			gameobj->GetPhysicsController()->ReplicateConstraints(gameobj, physicsObjects);
-			gameobj->ClearConstraints();
+	if (env) {
+		/* the replicas added from the objects meanwhile */
+		env->MergeEnvironment(other->GetPhysicsEnvironment());
+
+		/* the bodies start simulating with their joints and the ground they rest on in the same step */
+		for (unsigned int i = 0; i < merge.m_bodies.size(); ++i) {
+			KX_GameObject *gameobj = merge.m_bodies[i];
+			if (merged.count(gameobj))
+				gameobj->GetPhysicsController()->SetSleeping(false);
 		}
 	}
 
+	for (unsigned int i = 0; i < merge.m_objects.size(); ++i) {
+		KX_GameObject *gameobj = merge.m_objects[i].m_gameobj;
+		if (merged.count(gameobj))
+			MergeScene_Sensors(gameobj, this);
+	}
 
-	GetTempObjectList()->MergeList(other->GetTempObjectList());
-	other->GetTempObjectList()->ReleaseAndRemoveAll();
+	m_timebombs.Merge(other->m_timebombs);
 
-	GetObjectList()->MergeList(other->GetObjectList());
-	other->GetObjectList()->ReleaseAndRemoveAll();
+	/* the merged roots are gathered by the flat update of this scene */
+	m_sgflat.Invalidate();
 
-	GetInactiveList()->MergeList(other->GetInactiveList());
+	other->GetObjectList()->ReleaseAndRemoveAll();
 	other->GetInactiveList()->ReleaseAndRemoveAll();
-
-	GetRootParentList()->MergeList(other->GetRootParentList());
 	other->GetRootParentList()->ReleaseAndRemoveAll();
-
-	GetLightList()->MergeList(other->GetLightList());
 	other->GetLightList()->ReleaseAndRemoveAll();
 
 	/* move materials across, assume they both use the same scene-converters
@@ -2136,7 +2680,6 @@ bool KX_Scene::MergeScene(KX_Scene *other)
 		}
 		
 	}
-	return true;
 }
 
 void KX_Scene::Update2DFilter(vector<STR_String>& propNames, void* gameObj, RAS_2DFilterManager::RAS_2DFILTER_MODE filtermode, int pass, STR_String& text)
@@ -2195,6 +2738,8 @@ PyMethodDef KX_Scene::Methods[] = {
 	KX_PYMETHODTABLE(KX_Scene, suspend),
 	KX_PYMETHODTABLE(KX_Scene, resume),
 	KX_PYMETHODTABLE(KX_Scene, drawObstacleSimulation),
+	KX_PYMETHODTABLE(KX_Scene, setObjectPoolSize),
+	KX_PYMETHODTABLE(KX_Scene, getObjectPoolStats),
 
 	
 	/* dict style access */
@@ -2609,6 +3154,59 @@ KX_PYMETHODDEF_DOC(KX_Scene, drawObstacleSimulation,
 	Py_RETURN_NONE;
 }
 
+KX_PYMETHODDEF_DOC(KX_Scene, setObjectPoolSize,
+"setObjectPoolSize(object, size)\n"
+"Keeps up to size replicas of the object when they end, to add them again.\n")
+{
+	PyObject *pyob;
+	KX_GameObject *ob;
+	int size;
+
+	if (!PyArg_ParseTuple(args, "Oi:setObjectPoolSize", &pyob, &size))
+		return NULL;
+
+	if (!ConvertPythonToGameObject(pyob, &ob, false, "scene.setObjectPoolSize(object, size): KX_Scene (first argument)"))
+		return NULL;
+
+	const char *error = GetObjectPoolError(ob);
+	if (error) {
+		PyErr_Format(PyExc_ValueError, "scene.setObjectPoolSize(object, size): KX_Scene (first argument): %s", error);
+		return NULL;
+	}
+
+	SetObjectPoolSize(ob, size);
+	Py_RETURN_NONE;
+}
+
+KX_PYMETHODDEF_DOC(KX_Scene, getObjectPoolStats,
+"getObjectPoolStats(object)\n"
+"Returns a dict with the hits, misses, size and maxSize of the pool of the object.\n")
+{
+	PyObject *pyob;
+	KX_GameObject *ob;
+
+	if (!PyArg_ParseTuple(args, "O:getObjectPoolStats", &pyob))
+		return NULL;
+
+	if (!ConvertPythonToGameObject(pyob, &ob, false, "scene.getObjectPoolStats(object): KX_Scene (first argument)"))
+		return NULL;
+
+	KX_ObjectPool *pool = ob->GetObjectPool();
+	PyObject *stats = PyDict_New();
+	PyObject *item;
+
+	PyDict_SetItemString(stats, "hits", item = PyLong_FromLong(pool ? pool->GetHits() : 0));
+	Py_DECREF(item);
+	PyDict_SetItemString(stats, "misses", item = PyLong_FromLong(pool ? pool->GetMisses() : 0));
+	Py_DECREF(item);
+	PyDict_SetItemString(stats, "size", item = PyLong_FromLong(pool ? pool->GetSize() : 0));
+	Py_DECREF(item);
+	PyDict_SetItemString(stats, "maxSize", item = PyLong_FromLong(pool ? pool->GetMaxSize() : 0));
+	Py_DECREF(item);
+
+	return stats;
+}
+
 /* Matches python dict.get(key, [default]) */
 KX_PYMETHODDEF_DOC(KX_Scene, get, "")
 {
@@ -42,6 +42,8 @@
 #include "CTR_Map.h"
 #include "CTR_HashedPtr.h"
 #include "SG_IObject.h"
+#include "KX_BatchCuller.h"
+#include "SG_FlatHierarchy.h"
 #include "SCA_IScene.h"
 #include "MT_Transform.h"
 
@@ -50,6 +52,7 @@
 
 
 #include "EXP_PyObjectPlus.h"
+#include "KX_TimerWheel.h"
 #include "RAS_2DFilterManager.h"
 
 /**
@@ -58,6 +61,7 @@
 struct SM_MaterialProps;
 struct SM_ShapeProps;
 struct Scene;
+struct TaskPool;
 
 class CTR_HashedPtr;
 class CListValue;
@@ -87,6 +91,7 @@ class btCollisionShape;
 class KX_BlenderSceneConverter;
 struct KX_ClientObjectInfo;
 class KX_ObstacleSimulation;
+class KX_ObjectPool;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #include "MEM_guardedalloc.h"
@@ -95,6 +100,65 @@ class KX_ObstacleSimulation;
 /* for ID freeing */
 #define IS_TAGGED(_id) ((_id) && (((ID *)_id)->flag & LIB_DOIT))
 
+/**
+ * The progress of a scene merged into another over several frames, see
+ * KX_Scene::MergeSceneStep(). The lights go first so the materials compiled
+ * next can use them, then the objects one at a time. The bodies of the merged
+ * objects then go in the physics environment and their constraints are made,
+ * one object at a time too. The bodies sleep and the logic of the objects waits
+ * until the last step.
+ */
+class KX_SceneMerge
+{
+public:
+	enum Stage {
+		MERGE_BEGIN,
+		MERGE_LIGHTS,
+		MERGE_MATERIALS,
+		MERGE_OBJECTS,
+		MERGE_PHYSICS,
+		MERGE_CONSTRAINTS,
+		MERGE_END,
+		MERGE_DONE
+	};
+
+private:
+	friend class KX_Scene;
+
+	struct Entry {
+		KX_GameObject *m_gameobj;
+		bool m_active;
+		bool m_root;
+		bool m_light;
+	};
+
+	Stage m_stage;
+	unsigned int m_index;
+	/* the lights first, the materials are compiled once they are merged */
+	std::vector<Entry> m_objects;
+	unsigned int m_numLights;
+	std::vector<RAS_IPolyMaterial *> m_materials;
+	/* the objects with a physics controller, and those of them that are active for the constraints */
+	std::vector<KX_GameObject *> m_bodies;
+	std::vector<KX_GameObject *> m_physicsObjects;
+	/* the objects still in the scene once they were all merged */
+	std::set<CValue *> m_merged;
+	unsigned int m_numSteps;
+	unsigned int m_numDone;
+
+public:
+	KX_SceneMerge();
+
+	Stage GetStage() const { return m_stage; }
+	bool IsDone() const { return m_stage == MERGE_DONE; }
+	/* fraction of the merge done, from 0 to 1 */
+	float GetProgress() const;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:KX_SceneMerge")
+#endif
+};
+
 /**
  * The KX_Scene holds all data for an independent scene. It relates
  * KX_Objects to the specific objects in the modules.
@@ -117,7 +181,10 @@ class KX_Scene : public PyObjectPlus, public SCA_IScene
 
 protected:
 	RAS_BucketManager*	m_bucketmanager;
-	CListValue*			m_tempObjectList;
+	/* the lifetime of the objects added with a time limit, each timer holds a reference to its object */
+	KX_TimerWheel		m_timebombs;
+	/* the pools of the objects of the inactive layers set with SetObjectPoolSize() */
+	std::vector<KX_ObjectPool*>	m_objectPools;
 
 	/**
 	 * The list of objects which have been removed during the
@@ -136,6 +203,10 @@ protected:
 										// the Dlist is not object that must be updated
 										// the Qlist is for objects that needs to be rescheduled
 										// for updates after udpate is over (slow parent, bone parent)
+	SG_FlatHierarchy	m_sgflat;		// depth ordered nodes of the flat scenegraph update
+	KX_BatchCuller		m_batchCuller;	// object bounds for the frustum culling without DBVT
+	TaskPool*			m_animationPool;	// kept between frames so its tasks are reused
+	double				m_animationTime;	// time of the animation update, user data of the pool
 
 
 	/**
@@ -342,6 +413,15 @@ public:
 	void DelayedRemoveObject(CValue* gameobj);
 	
 	int NewRemoveObject(CValue* gameobj);
+
+	/**
+	 * Keep the replicas of an object of an inactive layer that end, up to \param size
+	 * of them, to add them again instead of replicating the object. A size of 0 frees
+	 * the kept replicas and stops pooling, the statistics are kept.
+	 */
+	void SetObjectPoolSize(class KX_GameObject* templateobj, int size);
+	/// Why \param templateobj can't be pooled, NULL if it can.
+	const char *GetObjectPoolError(class KX_GameObject* templateobj);
 	void ReplaceMesh(CValue* gameobj,
 	                 void* meshob, bool use_gfx, bool use_phys);
 
@@ -359,8 +439,10 @@ public:
 	LogicEndFrame(
 	);
 
-		CListValue*
-	GetTempObjectList(
+	/// Seconds left before an object added with a time limit ends, 0 if it has no limit.
+		double
+	GetObjectLifetime(
+		class KX_GameObject* gameobj
 	);
 
 		CListValue*
@@ -541,6 +623,24 @@ public:
 	 */
 
 	void ReplicateLogic(class KX_GameObject* newobj);
+
+protected:
+	/// Add a replica ending with the object after \param lifespan logic ticks of 50 Hz.
+	void SetObjectLifespan(class KX_GameObject* replica, int lifespan);
+	/// Put a replica that ends in its object pool, returns false if it must be removed instead.
+	bool PoolObject(class KX_GameObject* gameobj);
+	/// Add again a replica taken from the pool of \param originalobj, like AddReplicaObject().
+	void AddPooledObject(class KX_GameObject* replica,
+	                     class KX_GameObject* originalobj,
+	                     class KX_GameObject* referenceobj);
+	/// Remove the replicas of the pool after the first \param size ones.
+	void ShrinkObjectPool(KX_ObjectPool* pool, int size);
+	/// Steps of MergeSceneStep(), the physics stages once the objects are merged and the last one,
+	/// which wakes the bodies and starts the logic of the merged objects.
+	void MergeScenePhysicsBegin(KX_SceneMerge& merge);
+	void MergeSceneEnd(KX_Scene *other, KX_SceneMerge& merge);
+
+public:
 	static SG_Callbacks	m_callbacks;
 
 	const STR_String& GetName();
@@ -617,6 +717,8 @@ public:
 	KX_PYMETHOD_DOC(KX_Scene, resume);
 	KX_PYMETHOD_DOC(KX_Scene, get);
 	KX_PYMETHOD_DOC(KX_Scene, drawObstacleSimulation);
+	KX_PYMETHOD_DOC(KX_Scene, setObjectPoolSize);
+	KX_PYMETHOD_DOC(KX_Scene, getObjectPoolStats);
 
 
 	/* attributes */
@@ -677,6 +779,13 @@ public:
 	struct Scene *GetBlenderScene() { return m_blenderScene; }
 
 	bool MergeScene(KX_Scene *other);
+	/**
+	 * Merge a part of the other scene, at least one object or material and
+	 * then as many as fit before the deadline (PIL_check_seconds_timer() time,
+	 * 0 for no limit). The other scene is left empty once merge.IsDone(),
+	 * it returns false when the scenes can't be merged.
+	 */
+	bool MergeSceneStep(KX_Scene *other, KX_SceneMerge& merge, double deadline);
 
 
 	//void PrintStats(int verbose_level) {
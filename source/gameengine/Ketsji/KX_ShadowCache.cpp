@@ -0,0 +1,170 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_ShadowCache.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_ShadowCache.h"
+#include "KX_GameObject.h"
+#include "KX_Camera.h"
+#include "RAS_MeshObject.h"
+#include "RAS_Deformer.h"
+
+#include "EXP_ListValue.h"
+
+#include <algorithm>
+#include <string.h>
+
+/* Updates a dynamic caster must stay still before its depth goes to the static cache */
+#define STILL_UPDATES 120
+
+KX_ShadowCache::KX_ShadowCache()
+	:m_valid(false),
+	m_staticValid(false)
+{
+}
+
+void KX_ShadowCache::Gather(CListValue *objects, int layer)
+{
+	m_casters.clear();
+
+	for (int i = 0; i < objects->GetCount(); i++) {
+		KX_GameObject *gameobj = static_cast<KX_GameObject *>(objects->GetValue(i));
+
+		/* the objects left in the buckets by KX_Scene::CalculateVisibleMeshes */
+		if (!gameobj->GetSGNode() || !gameobj->GetVisible() || gameobj->GetCulled() || !gameobj->GetMeshCount())
+			continue;
+		if (layer && !(gameobj->GetLayer() & layer))
+			continue;
+
+		Caster caster;
+		caster.m_object = gameobj;
+		caster.m_mesh = gameobj->GetMesh(0);
+		memcpy(caster.m_matrix, gameobj->GetOpenGLMatrix(), sizeof(caster.m_matrix));
+		caster.m_stillUpdates = 0;
+		caster.m_deformed = (gameobj->GetDeformer() && gameobj->GetDeformer()->IsDynamic());
+		caster.m_dynamic = true;
+		caster.m_new = true;
+
+		for (int m = 0; m < gameobj->GetMeshCount() && !caster.m_deformed; m++) {
+			/* vertices changed from python */
+			if (gameobj->GetMesh(m)->MeshModified())
+				caster.m_deformed = true;
+		}
+
+		m_casters.push_back(caster);
+	}
+
+	std::sort(m_casters.begin(), m_casters.end());
+}
+
+KX_ShadowCache::UpdateMode KX_ShadowCache::Update(CListValue *objects, int layer, KX_Camera *cam, bool split, bool current)
+{
+	double lampmat[32];
+	cam->GetModelviewMatrix().getValue(lampmat);
+	cam->GetProjectionMatrix().getValue(lampmat + 16);
+
+	bool rebuild = !m_valid || !current || (split && !m_staticValid) ||
+	               memcmp(lampmat, m_lampmat, sizeof(lampmat)) != 0;
+	bool staticChanged = false;
+	bool dynamicChanged = false;
+
+	memcpy(m_lampmat, lampmat, sizeof(m_lampmat));
+	m_previous.swap(m_casters);
+	Gather(objects, layer);
+
+	/* both lists are sorted, walk them together */
+	std::vector<Caster>::iterator prev = m_previous.begin();
+	for (std::vector<Caster>::iterator it = m_casters.begin(); it != m_casters.end(); ++it) {
+		for (; prev != m_previous.end() && prev->m_object < it->m_object; ++prev) {
+			/* left the frustum or was removed */
+			if (prev->m_dynamic)
+				dynamicChanged = true;
+			else
+				staticChanged = true;
+		}
+
+		if (prev == m_previous.end() || prev->m_object != it->m_object) {
+			/* entered the frustum */
+			dynamicChanged = true;
+			continue;
+		}
+
+		const bool changed = it->m_deformed || it->m_mesh != prev->m_mesh ||
+		                     memcmp(it->m_matrix, prev->m_matrix, sizeof(it->m_matrix)) != 0;
+
+		it->m_new = false;
+		it->m_dynamic = prev->m_dynamic;
+		it->m_stillUpdates = (changed) ? 0 : std::min(prev->m_stillUpdates + 1, STILL_UPDATES);
+
+		if (changed) {
+			if (it->m_dynamic) {
+				dynamicChanged = true;
+			}
+			else {
+				it->m_dynamic = true;
+				staticChanged = true;
+			}
+		}
+		else if (it->m_dynamic && it->m_stillUpdates == STILL_UPDATES && split) {
+			it->m_dynamic = false;
+			staticChanged = true;
+		}
+		++prev;
+	}
+	for (; prev != m_previous.end(); ++prev) {
+		if (prev->m_dynamic)
+			dynamicChanged = true;
+		else
+			staticChanged = true;
+	}
+
+	m_valid = true;
+
+	if (!split) {
+		m_staticValid = false;
+		return (rebuild || staticChanged || dynamicChanged) ? SHADOW_ALL : SHADOW_UNCHANGED;
+	}
+
+	if (rebuild || staticChanged) {
+		/* the static depth is drawn again, the casters that just came in can be part of it,
+		 * and all the casters that didn't change if the lamp moved */
+		for (std::vector<Caster>::iterator it = m_casters.begin(); it != m_casters.end(); ++it) {
+			if (!it->m_deformed && (it->m_new || (rebuild && it->m_stillUpdates > 0)))
+				it->m_dynamic = false;
+		}
+		m_staticValid = true;
+		return SHADOW_ALL;
+	}
+
+	return (dynamicChanged) ? SHADOW_DYNAMIC : SHADOW_UNCHANGED;
+}
+
+void KX_ShadowCache::ActivateCasters(int types)
+{
+	for (std::vector<Caster>::iterator it = m_casters.begin(); it != m_casters.end(); ++it) {
+		const int type = (it->m_dynamic) ? CASTER_DYNAMIC : CASTER_STATIC;
+		it->m_object->SetCulled(!(types & type));
+		it->m_object->UpdateBuckets(false);
+	}
+}
@@ -0,0 +1,114 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_ShadowCache.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_SHADOWCACHE_H__
+#define __KX_SHADOWCACHE_H__
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class CListValue;
+class KX_Camera;
+class KX_GameObject;
+class RAS_MeshObject;
+
+/**
+ * Remembers what a lamp drew in its shadow buffer, so the shadow map is only
+ * drawn again when the lamp or one of the casters in its frustum changed.
+ *
+ * Casters are split in static and dynamic ones: a caster becomes dynamic when
+ * it moves, is deformed or enters the frustum, and static again after staying
+ * still for a while. With the static cache, the depth of the static casters is
+ * kept aside and only the dynamic casters are drawn on top of it as long as no
+ * static caster changed.
+ */
+class KX_ShadowCache
+{
+public:
+	enum UpdateMode {
+		SHADOW_UNCHANGED,	/* the shadow map is up to date */
+		SHADOW_DYNAMIC,		/* draw the dynamic casters over the static depth */
+		SHADOW_ALL			/* draw all the casters */
+	};
+
+	enum CasterType {
+		CASTER_NONE = 0,
+		CASTER_STATIC = 1,
+		CASTER_DYNAMIC = 2
+	};
+
+private:
+	struct Caster {
+		KX_GameObject *m_object;
+		RAS_MeshObject *m_mesh;
+		double m_matrix[16];
+		unsigned short m_stillUpdates;	/* updates without change */
+		bool m_deformed;
+		bool m_dynamic;
+		bool m_new;
+
+		bool operator<(const Caster& other) const
+		{
+			return m_object < other.m_object;
+		}
+	};
+
+	std::vector<Caster> m_casters;		/* sorted by object */
+	std::vector<Caster> m_previous;
+	double m_lampmat[32];				/* view and projection matrices */
+	bool m_valid;
+	bool m_staticValid;
+
+	void Gather(CListValue *objects, int layer);
+
+public:
+	KX_ShadowCache();
+
+	/// Draw everything again at the next Update().
+	void Invalidate()
+	{
+		m_valid = false;
+	}
+
+	/**
+	 * Compare the lamp camera and the casters it sees, once the scene was culled
+	 * with it, to the last update. \param split enables the static depth cache,
+	 * \param current is false when an other lamp drew in the shadow buffer.
+	 */
+	UpdateMode Update(CListValue *objects, int layer, KX_Camera *cam, bool split, bool current);
+
+	/// Keep only the casters of the given types (CasterType flags) in the buckets to render.
+	void ActivateCasters(int types);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:KX_ShadowCache")
+#endif
+};
+
+#endif  /* __KX_SHADOWCACHE_H__ */
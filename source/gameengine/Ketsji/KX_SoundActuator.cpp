@@ -168,6 +168,18 @@ void KX_SoundActuator::ProcessReplica()
 	m_sound = AUD_Sound_copy(m_sound);
 }
 
+void KX_SoundActuator::ResetReplica()
+{
+	SCA_IActuator::ResetReplica();
+	// the sound of the previous life stops like when the actuator is deleted
+	if (m_handle)
+	{
+		AUD_Handle_stop(m_handle);
+		m_handle = NULL;
+	}
+	m_isplaying = false;
+}
+
 bool KX_SoundActuator::Update(double curtime, bool frame)
 {
 	if (!frame)
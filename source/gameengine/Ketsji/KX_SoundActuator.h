@@ -95,6 +95,7 @@ public:
 
 	CValue* GetReplica();
 	void ProcessReplica();
+	void ResetReplica();
 
 #ifdef WITH_PYTHON
 
@@ -60,11 +60,11 @@ unsigned int KX_TimeCategoryLogger::GetMaxNumMeasurements(void) const
 }
 
 
-void KX_TimeCategoryLogger::AddCategory(TimeCategory tc)
+void KX_TimeCategoryLogger::AddCategory(TimeCategory tc, const char *name)
 {
 	// Only add if not already present
 	if (m_loggers.find(tc) == m_loggers.end()) {
-		KX_TimeLogger* logger = new KX_TimeLogger(m_maxNumMeasurements);
+		KX_TimeLogger* logger = new KX_TimeLogger(m_maxNumMeasurements, name);
 		//assert(logger);
 		m_loggers.insert(KX_TimeLoggerMap::value_type(tc, logger));
 	}
@@ -131,6 +131,18 @@ double KX_TimeCategoryLogger::GetAverage(void)
 }
 
 
+void KX_TimeCategoryLogger::GetAverageAllocations(TimeCategory tc, double& allocations, double& bytes)
+{
+	m_loggers[tc]->GetAverageAllocations(allocations, bytes);
+}
+
+
+KX_TimeLogger::Measurement KX_TimeCategoryLogger::GetLastMeasurement(TimeCategory tc)
+{
+	return m_loggers[tc]->GetLastMeasurement();
+}
+
+
 void KX_TimeCategoryLogger::DisposeLoggers(void)
 {
 	KX_TimeLoggerMap::iterator it;
@@ -74,8 +74,9 @@ public:
 	/**
 	 * Adds a category.
 	 * \param category	The new category.
+	 * \param name		The name of the category in the profiler traces, NULL to leave it out.
 	 */
-	virtual void AddCategory(TimeCategory tc);
+	virtual void AddCategory(TimeCategory tc, const char *name = NULL);
 
 	/**
 	 * Starts logging in current measurement for the given category.
@@ -115,6 +116,16 @@ public:
 	 */
 	virtual double GetAverage(void);
 
+	/**
+	 * Returns average allocation count and bytes of all but the current measurement.
+	 */
+	virtual void GetAverageAllocations(TimeCategory tc, double& allocations, double& bytes);
+
+	/**
+	 * Returns the last measurement before the current one.
+	 */
+	virtual KX_TimeLogger::Measurement GetLastMeasurement(TimeCategory tc);
+
 protected:
 	/**  
 	 * Disposes loggers.
@@ -32,9 +32,17 @@
 
 #include "KX_TimeLogger.h"
 
-KX_TimeLogger::KX_TimeLogger(unsigned int maxNumMeasurements) : 
+#include "EXP_Profiler.h"
+
+#include "MEM_guardedalloc.h"
+
+KX_TimeLogger::KX_TimeLogger(unsigned int maxNumMeasurements, const char *name) : 
 	m_maxNumMeasurements(maxNumMeasurements), 
 	m_logStart(0),
+	m_allocationStart(0),
+	m_allocatedBytesStart(0),
+	m_name(name),
+	m_zoneStart(-1.0),
 	m_logging(false)
 {
 }
@@ -65,6 +73,9 @@ void KX_TimeLogger::StartLog(double now)
 	if (!m_logging) {
 		m_logging = true;
 		m_logStart = now;
+		m_allocationStart = MEM_get_memory_blocks_allocated();
+		m_allocatedBytesStart = MEM_get_memory_allocated();
+		m_zoneStart = (m_name && CProfiler::IsTracing()) ? CProfiler::GetTime() : -1.0;
 	}
 }
 
@@ -75,7 +86,13 @@ void KX_TimeLogger::EndLog(double now)
 		m_logging = false;
 		double time = now - m_logStart;
 		if (m_measurements.size() > 0) {
-			m_measurements[0] += time;
+			Measurement& m = m_measurements[0];
+			m.m_time += time;
+			m.m_allocations += MEM_get_memory_blocks_allocated() - m_allocationStart;
+			m.m_allocatedBytes += MEM_get_memory_allocated() - m_allocatedBytesStart;
+		}
+		if (m_zoneStart >= 0.0) {
+			CProfiler::AddZone(m_name, m_zoneStart, CProfiler::TRACK_CATEGORIES);
 		}
 	}
 }
@@ -87,7 +104,7 @@ void KX_TimeLogger::NextMeasurement(double now)
 	EndLog(now);
 
 	// Add a new measurement at the front
-	double m = 0.0;
+	Measurement m = {0.0, 0, 0};
 	m_measurements.push_front(m);
 
 	// Remove measurement if we grow beyond the maximum size
@@ -107,7 +124,7 @@ double KX_TimeLogger::GetAverage(void) const
 	unsigned int numMeasurements = m_measurements.size();
 	if (numMeasurements > 1) {
 		for (unsigned int i = 1; i < numMeasurements; i++) {
-			avg += m_measurements[i];
+			avg += m_measurements[i].m_time;
 		}
 		avg /= (float)numMeasurements - 1;
 	}
@@ -115,3 +132,29 @@ double KX_TimeLogger::GetAverage(void) const
 	return avg;
 }
 
+void KX_TimeLogger::GetAverageAllocations(double& allocations, double& bytes) const
+{
+	allocations = 0.0;
+	bytes = 0.0;
+
+	unsigned int numMeasurements = m_measurements.size();
+	if (numMeasurements > 1) {
+		for (unsigned int i = 1; i < numMeasurements; i++) {
+			allocations += m_measurements[i].m_allocations;
+			bytes += m_measurements[i].m_allocatedBytes;
+		}
+		allocations /= numMeasurements - 1;
+		bytes /= numMeasurements - 1;
+	}
+}
+
+KX_TimeLogger::Measurement KX_TimeLogger::GetLastMeasurement(void) const
+{
+	if (m_measurements.size() > 1) {
+		return m_measurements[1];
+	}
+
+	Measurement m = {0.0, 0, 0};
+	return m;
+}
+
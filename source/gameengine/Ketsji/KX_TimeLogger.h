@@ -37,21 +37,31 @@
 #endif
 
 #include <deque>
+#include <stddef.h>
 
 #ifdef WITH_CXX_GUARDEDALLOC
 #  include "MEM_guardedalloc.h"
 #endif
 
 /**
- * Stores and manages time measurements.
+ * Stores and manages time measurements, with the allocations made
+ * through guardedalloc while logging.
  */
 class KX_TimeLogger {
 public:
+	/** A measurement, the allocations are counted from all threads. */
+	struct Measurement {
+		double m_time;
+		unsigned int m_allocations;
+		size_t m_allocatedBytes;
+	};
+
 	/**
 	 * Constructor.
 	 * \param maxNumMesasurements Maximum number of measurements stored (>1).
+	 * \param name Name of the zone recorded in the profiler traces for each logging, NULL for none.
 	 */
-	KX_TimeLogger(unsigned int maxNumMeasurements = 10);
+	KX_TimeLogger(unsigned int maxNumMeasurements = 10, const char *name = NULL);
 
 	/**
 	 * Destructor.
@@ -92,9 +102,19 @@ public:
 	 */
 	virtual double GetAverage(void) const;
 
+	/**
+	 * Returns average allocation count and bytes of all but the current measurement.
+	 */
+	virtual void GetAverageAllocations(double& allocations, double& bytes) const;
+
+	/**
+	 * Returns the last measurement before the current one, zero if there is none.
+	 */
+	virtual Measurement GetLastMeasurement(void) const;
+
 protected:
 	/** Storage for the measurements. */
-	std::deque<double> m_measurements;
+	std::deque<Measurement> m_measurements;
 
 	/** Maximum number of measurements. */
 	unsigned int m_maxNumMeasurements;
@@ -102,6 +122,14 @@ protected:
 	/** Time at start of logging. */
 	double m_logStart;
 
+	/** Allocation counters at start of logging. */
+	unsigned int m_allocationStart;
+	size_t m_allocatedBytesStart;
+
+	/** Name and start of the profiler zone, -1 if it isn't recorded. */
+	const char *m_name;
+	double m_zoneStart;
+
 	/** State of logging. */
 	bool m_logging;
 
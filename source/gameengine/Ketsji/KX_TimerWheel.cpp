@@ -0,0 +1,197 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Ketsji/KX_TimerWheel.cpp
+ *  \ingroup ketsji
+ */
+
+#include "KX_TimerWheel.h"
+
+#include <stddef.h>
+
+/* index of the list of a tick in a wheel, level -1 is the root wheel */
+#define LEVEL_INDEX(tick, level) \
+	(((tick) >> (ROOT_BITS + (level) * LEVEL_BITS)) & (LEVEL_SIZE - 1))
+
+KX_TimerWheel::KX_TimerWheel()
+	:m_free(NULL),
+	m_tick(0),
+	m_count(0)
+{
+	for (int i = 0; i < ROOT_SIZE; i++)
+		m_root[i] = NULL;
+	for (int l = 0; l < NUM_LEVELS; l++) {
+		for (int i = 0; i < LEVEL_SIZE; i++)
+			m_levels[l][i] = NULL;
+	}
+}
+
+KX_TimerWheel::~KX_TimerWheel()
+{
+	std::vector<KX_GameObject *> objects;
+	Clear(objects);
+
+	while (m_free) {
+		Timer *timer = m_free;
+		m_free = timer->m_next;
+		delete timer;
+	}
+}
+
+KX_TimerWheel::Timer *KX_TimerWheel::Add(KX_GameObject *object, unsigned int ticks)
+{
+	Timer *timer = m_free;
+	if (timer)
+		m_free = timer->m_next;
+	else
+		timer = new Timer;
+
+	timer->m_object = object;
+	timer->m_expiry = m_tick + ticks - 1;
+	Insert(timer);
+	m_count++;
+
+	return timer;
+}
+
+void KX_TimerWheel::Remove(Timer *timer)
+{
+	Unlink(timer);
+	timer->m_next = m_free;
+	m_free = timer;
+	m_count--;
+}
+
+void KX_TimerWheel::Insert(Timer *timer)
+{
+	const unsigned int ticks = timer->m_expiry - m_tick;
+	Timer **list;
+
+	if ((int)ticks < 0) {
+		/* already expired, it goes in the list of the next tick */
+		list = &m_root[m_tick & (ROOT_SIZE - 1)];
+	}
+	else if (ticks < ROOT_SIZE) {
+		list = &m_root[timer->m_expiry & (ROOT_SIZE - 1)];
+	}
+	else {
+		int level = 0;
+		while (level < NUM_LEVELS - 1 && (ticks >> (ROOT_BITS + (level + 1) * LEVEL_BITS)) != 0)
+			level++;
+		list = &m_levels[level][LEVEL_INDEX(timer->m_expiry, level)];
+	}
+
+	timer->m_next = *list;
+	timer->m_prev = list;
+	if (*list)
+		(*list)->m_prev = &timer->m_next;
+	*list = timer;
+}
+
+void KX_TimerWheel::Unlink(Timer *timer)
+{
+	*timer->m_prev = timer->m_next;
+	if (timer->m_next)
+		timer->m_next->m_prev = timer->m_prev;
+}
+
+int KX_TimerWheel::Cascade(int level, int index)
+{
+	Timer *timer = m_levels[level][index];
+	m_levels[level][index] = NULL;
+
+	while (timer) {
+		Timer *next = timer->m_next;
+		Insert(timer);
+		timer = next;
+	}
+	return index;
+}
+
+void KX_TimerWheel::Advance(std::vector<KX_GameObject *>& expired)
+{
+	const int index = m_tick & (ROOT_SIZE - 1);
+
+	/* the root wheel went round, spread the next list of the upper wheels in it */
+	if (index == 0) {
+		for (int level = 0; level < NUM_LEVELS; level++) {
+			if (Cascade(level, LEVEL_INDEX(m_tick, level)) != 0)
+				break;
+		}
+	}
+
+	Timer *timer = m_root[index];
+	m_root[index] = NULL;
+	m_tick++;
+
+	while (timer) {
+		Timer *next = timer->m_next;
+		expired.push_back(timer->m_object);
+		timer->m_next = m_free;
+		m_free = timer;
+		m_count--;
+		timer = next;
+	}
+}
+
+void KX_TimerWheel::GetTimers(std::vector<Timer *>& timers)
+{
+	timers.reserve(timers.size() + m_count);
+
+	for (int i = 0; i < ROOT_SIZE; i++) {
+		for (Timer *timer = m_root[i]; timer; timer = timer->m_next)
+			timers.push_back(timer);
+	}
+	for (int l = 0; l < NUM_LEVELS; l++) {
+		for (int i = 0; i < LEVEL_SIZE; i++) {
+			for (Timer *timer = m_levels[l][i]; timer; timer = timer->m_next)
+				timers.push_back(timer);
+		}
+	}
+}
+
+void KX_TimerWheel::Merge(KX_TimerWheel& other)
+{
+	std::vector<Timer *> timers;
+	other.GetTimers(timers);
+
+	for (std::vector<Timer *>::iterator it = timers.begin(); it != timers.end(); ++it) {
+		Timer *timer = *it;
+		other.Unlink(timer);
+		timer->m_expiry = m_tick + (timer->m_expiry - other.m_tick);
+		Insert(timer);
+	}
+
+	m_count += other.m_count;
+	other.m_count = 0;
+}
+
+void KX_TimerWheel::Clear(std::vector<KX_GameObject *>& objects)
+{
+	std::vector<Timer *> timers;
+	GetTimers(timers);
+
+	for (std::vector<Timer *>::iterator it = timers.begin(); it != timers.end(); ++it) {
+		objects.push_back((*it)->m_object);
+		Remove(*it);
+	}
+}
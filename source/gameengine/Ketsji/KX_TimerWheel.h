@@ -0,0 +1,118 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file KX_TimerWheel.h
+ *  \ingroup ketsji
+ */
+
+#ifndef __KX_TIMERWHEEL_H__
+#define __KX_TIMERWHEEL_H__
+
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class KX_GameObject;
+
+/**
+ * Hierarchical timing wheel for the lifetime of the objects added with a time limit.
+ *
+ * Timers are kept in lists by expiry tick: the first wheel has a list per tick for the next
+ * 256 ticks, each following wheel has 64 lists covering 64 times the range of the previous
+ * one. Adding and removing a timer is constant time, and each tick only looks at the timers
+ * that expire, plus once in a while the timers of a list of the next wheel, which are spread
+ * over the finer wheel.
+ *
+ * The wheel doesn't hold references to the objects, its owner does.
+ */
+class KX_TimerWheel
+{
+public:
+	struct Timer {
+		Timer *m_next;
+		Timer **m_prev;			/* the pointer to this timer in its list */
+		unsigned int m_expiry;	/* tick the timer expires at */
+		KX_GameObject *m_object;
+	};
+
+	KX_TimerWheel();
+	~KX_TimerWheel();
+
+	/// Add a timer expiring at the \param ticks -th call to Advance() from now, ticks must be at least 1.
+	Timer *Add(KX_GameObject *object, unsigned int ticks);
+	/// Cancel a timer, it is freed.
+	void Remove(Timer *timer);
+
+	/// Number of calls to Advance() before the timer expires, 1 if it expires at the next one.
+	unsigned int GetRemaining(const Timer *timer) const
+	{
+		return timer->m_expiry - m_tick + 1;
+	}
+
+	int GetCount() const
+	{
+		return m_count;
+	}
+
+	/// Go to the next tick, the objects whose timer expired are added to \param expired and the timers are freed.
+	void Advance(std::vector<KX_GameObject *>& expired);
+
+	/// Take all the timers of \param other, they keep their remaining ticks and stay valid.
+	void Merge(KX_TimerWheel& other);
+
+	/// Free all the timers, their objects are added to \param objects.
+	void Clear(std::vector<KX_GameObject *>& objects);
+
+private:
+	enum {
+		ROOT_BITS = 8,
+		ROOT_SIZE = 1 << ROOT_BITS,
+		LEVEL_BITS = 6,
+		LEVEL_SIZE = 1 << LEVEL_BITS,
+		NUM_LEVELS = 4
+	};
+
+	/* not copyable, the timers point in the lists */
+	KX_TimerWheel(const KX_TimerWheel&);
+	KX_TimerWheel& operator=(const KX_TimerWheel&);
+
+	void Insert(Timer *timer);
+	void Unlink(Timer *timer);
+	int Cascade(int level, int index);
+	void GetTimers(std::vector<Timer *>& timers);
+
+	Timer *m_root[ROOT_SIZE];
+	Timer *m_levels[NUM_LEVELS][LEVEL_SIZE];
+	/* freed timers, linked with m_next */
+	Timer *m_free;
+	/* the tick the next Advance() processes */
+	unsigned int m_tick;
+	int m_count;
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:KX_TimerWheel")
+#endif
+};
+
+#endif  /* __KX_TIMERWHEEL_H__ */
@@ -103,6 +103,7 @@ bool KX_TouchSensor::Evaluate()
 KX_TouchSensor::KX_TouchSensor(SCA_EventManager* eventmgr,KX_GameObject* gameobj,bool bFindMaterial,bool bTouchPulse,const STR_String& touchedpropname)
 :SCA_ISensor(gameobj,eventmgr),
 m_touchedpropname(touchedpropname),
+m_touchedpropkey(touchedpropname),
 m_bFindMaterial(bFindMaterial),
 m_bTouchPulse(bTouchPulse),
 m_hitMaterial("")
@@ -232,7 +233,7 @@ bool	KX_TouchSensor::BroadPhaseSensorFilterCollision(void*obj1,void*obj2)
 			}
 		}
 		else {
-			found = (otherobj->GetProperty(m_touchedpropname) != NULL);
+			found = (otherobj->GetProperty(m_touchedpropkey) != NULL);
 		}
 	}
 	return found;
@@ -276,7 +277,7 @@ bool	KX_TouchSensor::NewHandleCollision(void*object1,void*object2,const PHY_Coll
 				}
 			}
 			else {
-				found = (gameobj->GetProperty(m_touchedpropname) != NULL);
+				found = (gameobj->GetProperty(m_touchedpropkey) != NULL);
 			}
 		}
 		if (found)
@@ -330,7 +331,7 @@ PyMethodDef KX_TouchSensor::Methods[] = {
 };
 
 PyAttributeDef KX_TouchSensor::Attributes[] = {
-	KX_PYATTRIBUTE_STRING_RW("propName",0,MAX_PROP_NAME,false,KX_TouchSensor,m_touchedpropname),
+	KX_PYATTRIBUTE_STRING_RW_CHECK("propName",0,MAX_PROP_NAME,false,KX_TouchSensor,m_touchedpropname,pyattr_check_propname),
 	KX_PYATTRIBUTE_BOOL_RW("useMaterial",KX_TouchSensor,m_bFindMaterial),
 	KX_PYATTRIBUTE_BOOL_RW("usePulseCollision",KX_TouchSensor,m_bTouchPulse),
 	KX_PYATTRIBUTE_STRING_RO("hitMaterial", KX_TouchSensor, m_hitMaterial),
@@ -357,6 +358,13 @@ PyObject *KX_TouchSensor::pyattr_get_object_hit_list(void *self_v, const KX_PYAT
 	return self->m_colliders->GetProxy();
 }
 
+int KX_TouchSensor::pyattr_check_propname(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef)
+{
+	KX_TouchSensor* self = static_cast<KX_TouchSensor*>(self_v);
+	self->m_touchedpropkey = CPropertyKey(self->m_touchedpropname);
+	return 0;
+}
+
 #endif
 
 /* eof */
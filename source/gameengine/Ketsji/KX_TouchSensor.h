@@ -57,6 +57,7 @@ protected:
 	 * The sensor should only look for objects with this property.
 	 */
 	STR_String				m_touchedpropname;
+	CPropertyKey			m_touchedpropkey;	/* m_touchedpropname and its slot in the layout of the last object */
 	bool					m_bFindMaterial;
 	bool					m_bTouchPulse;		/* changes in the colliding objects trigger pulses */
 	
@@ -130,6 +131,7 @@ public:
 	
 	static PyObject*	pyattr_get_object_hit(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 	static PyObject*	pyattr_get_object_hit_list(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
+	static int			pyattr_check_propname(void *self_v, const KX_PYATTRIBUTE_DEF *attrdef);
 
 #endif
 	
@@ -217,7 +217,7 @@ int KX_VertexProxy::pyattr_set_x(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		MT_Point3 pos(self->m_vertex->getXYZ());
 		pos.x() = val;
 		self->m_vertex->SetXYZ(pos);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -232,7 +232,7 @@ int KX_VertexProxy::pyattr_set_y(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		MT_Point3 pos(self->m_vertex->getXYZ());
 		pos.y() = val;
 		self->m_vertex->SetXYZ(pos);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -247,7 +247,7 @@ int KX_VertexProxy::pyattr_set_z(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		MT_Point3 pos(self->m_vertex->getXYZ());
 		pos.z() = val;
 		self->m_vertex->SetXYZ(pos);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -262,7 +262,7 @@ int KX_VertexProxy::pyattr_set_u(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		MT_Point2 uv = self->m_vertex->getUV(0);
 		uv[0] = val;
 		self->m_vertex->SetUV(0, uv);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -277,7 +277,7 @@ int KX_VertexProxy::pyattr_set_v(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		MT_Point2 uv = self->m_vertex->getUV(0);
 		uv[1] = val;
 		self->m_vertex->SetUV(0, uv);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -292,7 +292,7 @@ int KX_VertexProxy::pyattr_set_u2(void *self_v, const struct KX_PYATTRIBUTE_DEF
 		MT_Point2 uv = self->m_vertex->getUV(1);
 		uv[0] = val;
 		self->m_vertex->SetUV(1, uv);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -307,7 +307,7 @@ int KX_VertexProxy::pyattr_set_v2(void *self_v, const struct KX_PYATTRIBUTE_DEF
 		MT_Point2 uv = self->m_vertex->getUV(1);
 		uv[1] = val;
 		self->m_vertex->SetUV(1, uv);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -324,7 +324,7 @@ int KX_VertexProxy::pyattr_set_r(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		val *= 255.0;
 		cp[0] = (unsigned char) val;
 		self->m_vertex->SetRGBA(icol);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -341,7 +341,7 @@ int KX_VertexProxy::pyattr_set_g(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		val *= 255.0;
 		cp[1] = (unsigned char) val;
 		self->m_vertex->SetRGBA(icol);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -358,7 +358,7 @@ int KX_VertexProxy::pyattr_set_b(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		val *= 255.0;
 		cp[2] = (unsigned char) val;
 		self->m_vertex->SetRGBA(icol);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -375,7 +375,7 @@ int KX_VertexProxy::pyattr_set_a(void *self_v, const struct KX_PYATTRIBUTE_DEF *
 		val *= 255.0;
 		cp[3] = (unsigned char) val;
 		self->m_vertex->SetRGBA(icol);
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -390,7 +390,7 @@ int KX_VertexProxy::pyattr_set_XYZ(void *self_v, const struct KX_PYATTRIBUTE_DEF
 		if (PyVecTo(value, vec))
 		{
 			self->m_vertex->SetXYZ(vec);
-			self->m_mesh->SetMeshModified(true);
+			self->m_mesh->SetVertexModified(self->m_vertex);
 			return PY_SET_ATTR_SUCCESS;
 		}
 	}
@@ -405,7 +405,7 @@ int KX_VertexProxy::pyattr_set_UV(void *self_v, const struct KX_PYATTRIBUTE_DEF
 		MT_Point2 vec;
 		if (PyVecTo(value, vec)) {
 			self->m_vertex->SetUV(0, vec);
-			self->m_mesh->SetMeshModified(true);
+			self->m_mesh->SetVertexModified(self->m_vertex);
 			return PY_SET_ATTR_SUCCESS;
 		}
 	}
@@ -423,7 +423,7 @@ int KX_VertexProxy::pyattr_set_uvs(void *self_v, const struct KX_PYATTRIBUTE_DEF
 			if (PyVecTo(PySequence_GetItem(value, i), vec))
 			{
 				self->m_vertex->SetUV(i, vec);
-				self->m_mesh->SetMeshModified(true);
+				self->m_mesh->SetVertexModified(self->m_vertex);
 			}
 			else
 			{
@@ -432,7 +432,7 @@ int KX_VertexProxy::pyattr_set_uvs(void *self_v, const struct KX_PYATTRIBUTE_DEF
 			}
 		}
 		
-		self->m_mesh->SetMeshModified(true);
+		self->m_mesh->SetVertexModified(self->m_vertex);
 		return PY_SET_ATTR_SUCCESS;
 	}
 	return PY_SET_ATTR_FAIL;
@@ -447,7 +447,7 @@ int KX_VertexProxy::pyattr_set_color(void *self_v, const struct KX_PYATTRIBUTE_D
 		if (PyVecTo(value, vec))
 		{
 			self->m_vertex->SetRGBA(vec);
-			self->m_mesh->SetMeshModified(true);
+			self->m_mesh->SetVertexModified(self->m_vertex);
 			return PY_SET_ATTR_SUCCESS;
 		}
 	}
@@ -463,7 +463,7 @@ int KX_VertexProxy::pyattr_set_normal(void *self_v, const struct KX_PYATTRIBUTE_
 		if (PyVecTo(value, vec))
 		{
 			self->m_vertex->SetNormal(vec);
-			self->m_mesh->SetMeshModified(true);
+			self->m_mesh->SetVertexModified(self->m_vertex);
 			return PY_SET_ATTR_SUCCESS;
 		}
 	}
@@ -510,7 +510,7 @@ PyObject *KX_VertexProxy::PySetXYZ(PyObject *value)
 		return NULL;
 
 	m_vertex->SetXYZ(vec);
-	m_mesh->SetMeshModified(true);
+	m_mesh->SetVertexModified(m_vertex);
 	Py_RETURN_NONE;
 }
 
@@ -526,7 +526,7 @@ PyObject *KX_VertexProxy::PySetNormal(PyObject *value)
 		return NULL;
 
 	m_vertex->SetNormal(vec);
-	m_mesh->SetMeshModified(true);
+	m_mesh->SetVertexModified(m_vertex);
 	Py_RETURN_NONE;
 }
 
@@ -542,7 +542,7 @@ PyObject *KX_VertexProxy::PySetRGBA(PyObject *value)
 	if (PyLong_Check(value)) {
 		int rgba = PyLong_AsLong(value);
 		m_vertex->SetRGBA(rgba);
-		m_mesh->SetMeshModified(true);
+		m_mesh->SetVertexModified(m_vertex);
 		Py_RETURN_NONE;
 	}
 	else {
@@ -550,7 +550,7 @@ PyObject *KX_VertexProxy::PySetRGBA(PyObject *value)
 		if (PyVecTo(value, vec))
 		{
 			m_vertex->SetRGBA(vec);
-			m_mesh->SetMeshModified(true);
+			m_mesh->SetVertexModified(m_vertex);
 			Py_RETURN_NONE;
 		}
 	}
@@ -572,7 +572,7 @@ PyObject *KX_VertexProxy::PySetUV1(PyObject *value)
 		return NULL;
 
 	m_vertex->SetUV(0, vec);
-	m_mesh->SetMeshModified(true);
+	m_mesh->SetVertexModified(m_vertex);
 	Py_RETURN_NONE;
 }
 
@@ -588,7 +588,7 @@ PyObject *KX_VertexProxy::PySetUV2(PyObject *args)
 		return NULL;
 
 	m_vertex->SetUV(1, vec);
-	m_mesh->SetMeshModified(true);
+	m_mesh->SetVertexModified(m_vertex);
 	Py_RETURN_NONE;
 }
 
@@ -1382,6 +1382,22 @@ void		CcdPhysicsController::Jump()
 
 void		CcdPhysicsController::SetActive(bool active)
 {
+	// take the object out of the world and put it back, as for the replicas kept in an object pool
+	if (active) {
+		m_cci.m_physicsEnv->AddCcdPhysicsController(this);
+		m_object->activate();
+	}
+	else
+		m_cci.m_physicsEnv->RemoveCcdPhysicsController(this);
+}
+
+void		CcdPhysicsController::SetSleeping(bool sleeping)
+{
+	// the objects that never sleep keep their state
+	if (sleeping)
+		m_object->setActivationState(ISLAND_SLEEPING);
+	else
+		m_object->activate(true);
 }
 
 float		CcdPhysicsController::GetLinearDamping() const
@@ -1729,7 +1745,7 @@ bool CcdPhysicsController::ReinstancePhysicsShape(KX_GameObject *from_gameobj, R
 	return true;
 }
 
-void CcdPhysicsController::ReplicateConstraints(KX_GameObject *replica, std::vector<KX_GameObject*> constobj)
+void CcdPhysicsController::ReplicateConstraints(KX_GameObject *replica, const std::vector<KX_GameObject*>& constobj)
 {
 	if (replica->GetConstraints().size() == 0 || !replica->GetPhysicsController())
 		return;
@@ -1743,7 +1759,7 @@ void CcdPhysicsController::ReplicateConstraints(KX_GameObject *replica, std::vec
 	for (consit = constraints.begin(); consit != constraints.end(); ++consit) {
 		/* Try to find the constraint targets in the list of group objects. */
 		bRigidBodyJointConstraint *dat = (*consit);
-		vector<KX_GameObject*>::iterator memit; 
+		vector<KX_GameObject*>::const_iterator memit;
 		for (memit = constobj.begin(); memit != constobj.end(); ++memit) {
 			KX_GameObject *member = (*memit);
 			/* If the group member is the actual target for the constraint. */
@@ -2489,6 +2505,20 @@ bool CcdShapeConstructionInfo::SetProxy(CcdShapeConstructionInfo* shapeInfo)
 	return true;
 }
 
+size_t CcdShapeConstructionInfo::GetMemoryUsage() const
+{
+	size_t size = sizeof(CcdShapeConstructionInfo) +
+	              m_vertexArray.capacity() * sizeof(btScalar) +
+	              m_polygonIndexArray.capacity() * sizeof(int) +
+	              m_triFaceArray.capacity() * sizeof(int) +
+	              m_triFaceUVcoArray.capacity() * sizeof(UVco);
+
+	for (std::vector<CcdShapeConstructionInfo *>::const_iterator it = m_shapeArray.begin(); it != m_shapeArray.end(); ++it)
+		size += (*it)->GetMemoryUsage();
+
+	return size;
+}
+
 btCollisionShape* CcdShapeConstructionInfo::CreateBulletShape(btScalar margin, bool useGimpact, bool useBvh)
 {
 	btCollisionShape* collisionShape = 0;
@@ -166,6 +166,9 @@ public:
 
 	btCollisionShape* CreateBulletShape(btScalar margin, bool useGimpact=false, bool useBvh=true);
 
+	/// Bytes used by the shape data and the child shapes, the bullet shapes made from it aren't counted.
+	size_t GetMemoryUsage() const;
+
 	// member variables
 	PHY_ShapeType			m_shapeType;
 	btScalar				m_radius;
@@ -622,6 +625,7 @@ protected:
 		virtual void		SetLinearVelocity(const MT_Vector3& lin_vel,bool local);
 		virtual void		Jump();
 		virtual void		SetActive(bool active);
+		virtual void		SetSleeping(bool sleeping);
 
 		virtual float		GetLinearDamping() const;
 		virtual float		GetAngularDamping() const;
@@ -788,7 +792,7 @@ protected:
 		virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject* from_meshobj);
 
 		/* Method to replicate rigid body joint contraints for group instances. */
-		virtual void ReplicateConstraints(KX_GameObject *gameobj, std::vector<KX_GameObject*> constobj);
+		virtual void ReplicateConstraints(KX_GameObject *gameobj, const std::vector<KX_GameObject*>& constobj);
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CcdPhysicsController")
@@ -27,6 +27,7 @@ subject to the following restrictions:
 #include "btBulletDynamicsCommon.h"
 #include "LinearMath/btIDebugDraw.h"
 #include "BulletCollision/CollisionDispatch/btGhostObject.h"
+#include "BulletCollision/CollisionShapes/btScaledBvhTriangleMeshShape.h"
 #include "BulletCollision/CollisionDispatch/btSimulationIslandManager.h"
 #include "BulletSoftBody/btSoftRigidDynamicsWorld.h"
 #include "BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h"
@@ -46,6 +47,7 @@ subject to the following restrictions:
 #include "RAS_MeshObject.h"
 #include "RAS_Polygon.h"
 #include "RAS_TexVert.h"
+#include "EXP_Profiler.h"
 
 #include "DNA_scene_types.h"
 #include "DNA_world_types.h"
@@ -53,6 +55,7 @@ subject to the following restrictions:
 
 extern "C" {
 	#include "BLI_utildefines.h"
+	#include "BLI_task.h"
 	#include "BKE_object.h"
 }
 
@@ -71,6 +74,14 @@ static btRaycastVehicle::btVehicleTuning	gTuning;
 #include "MT_Vector3.h"
 #include "MT_MinMax.h"
 
+#include <vector>
+
+/* vectorized depth rasterization of the occlusion buffer */
+#if defined(__SSE2__) && !defined(BT_USE_DOUBLE_PRECISION)
+#  include <emmintrin.h>
+#  define OCCLUSION_SSE
+#endif
+
 #ifdef WIN32
 void DrawRasterizerLine(const float* from,const float* to,int color);
 #endif
@@ -419,7 +430,8 @@ m_ownPairCache(NULL),
 m_filterCallback(NULL),
 m_ghostPairCallback(NULL),
 m_ownDispatcher(NULL),
-m_scalingPropagated(false)
+m_scalingPropagated(false),
+m_deferShapeCooking(false)
 {
 
 	for (int i=0;i<PHY_NUM_RESPONSE;i++)
@@ -730,7 +742,10 @@ bool	CcdPhysicsEnvironment::ProceedDeltaTime(double curTime,float timeStep,float
 	}
 
 	float subStep = timeStep / float(m_numTimeSubSteps);
-	i = m_dynamicsWorld->stepSimulation(interval,25,subStep);//perform always a full simulation step
+	{
+		CProfileZone zone("Physics step");
+		i = m_dynamicsWorld->stepSimulation(interval,25,subStep);//perform always a full simulation step
+	}
 //uncomment next line to see where Bullet spend its time (printf in console)
 //CProfileManager::dumpAll();
 
@@ -1405,19 +1420,47 @@ struct OcclusionBuffer
 {
 	struct WriteOCL
 	{
+		static const bool Write = true;
 		static inline bool Process(btScalar& q,btScalar v) { if (q<v) q=v;return(false); }
 		static inline void Occlusion(bool& flag) { flag = true; }
+#ifdef OCCLUSION_SSE
+		// 4 pixels at once, only those in mask are written
+		static inline bool Process4(btScalar* q, __m128 v, __m128 mask)
+		{
+			const __m128 o = _mm_loadu_ps(q);
+			_mm_storeu_ps(q, _mm_or_ps(_mm_and_ps(mask, _mm_max_ps(o, v)), _mm_andnot_ps(mask, o)));
+			return(false);
+		}
+#endif
 	};
 	struct QueryOCL
 	{
+		static const bool Write = false;
 		static inline bool Process(btScalar& q,btScalar v) { return(q<=v); }
 		static inline void Occlusion(bool& flag) { }
+#ifdef OCCLUSION_SSE
+		static inline bool Process4(btScalar* q, __m128 v, __m128 mask)
+		{
+			return(_mm_movemask_ps(_mm_and_ps(mask, _mm_cmple_ps(_mm_loadu_ps(q), v))) != 0);
+		}
+#endif
 	};
+	// the buffer is split in tiles of 8x8 pixels keeping the depth range of
+	// their pixels, so boxes can be accepted or rejected without drawing them
+	enum { TILE_SHIFT = 3, TILE_SIZE = 1 << TILE_SHIFT };
 	btScalar*						m_buffer;
 	size_t							m_bufferSize;
 	bool							m_initialized;
 	bool							m_occlusion;
 	int								m_sizes[2];
+	int								m_tiles[2];
+	std::vector<btScalar>			m_tileMin;		// farthest occluder depth of each tile
+	std::vector<btScalar>			m_tileMax;		// nearest occluder depth of each tile
+	std::vector<unsigned char>		m_tileDirty;	// depth range must be computed again
+	// counters of the last culling test
+	int								m_occluders;
+	int								m_tested;
+	int								m_rejected;
 	btScalar						m_scales[2];
 	btScalar						m_offsets[2];
 	btScalar						m_wtc[16];		// world to clip transform
@@ -1430,6 +1473,9 @@ struct OcclusionBuffer
 		m_occlusion = false;
 		m_buffer = NULL;
 		m_bufferSize = 0;
+		m_occluders = 0;
+		m_tested = 0;
+		m_rejected = 0;
 	}
 	// multiplication of column major matrices: m=m1*m2
 	template<typename T1, typename T2>
@@ -1459,6 +1505,9 @@ struct OcclusionBuffer
 	{
 		m_initialized=false;
 		m_occlusion=false;
+		m_occluders = 0;
+		m_tested = 0;
+		m_rejected = 0;
 		// compute the size of the buffer
 		int			maxsize;
 		double		ratio;
@@ -1502,9 +1551,48 @@ struct OcclusionBuffer
 		}
 		// memory allocate must succeed
 		assert(m_buffer != NULL);
+		// the cleared buffer is at depth 0 everywhere
+		m_tiles[0] = (m_sizes[0] + TILE_SIZE - 1) >> TILE_SHIFT;
+		m_tiles[1] = (m_sizes[1] + TILE_SIZE - 1) >> TILE_SHIFT;
+		m_tileMin.assign(m_tiles[0] * m_tiles[1], btScalar(0.f));
+		m_tileMax.assign(m_tiles[0] * m_tiles[1], btScalar(0.f));
+		m_tileDirty.assign(m_tiles[0] * m_tiles[1], 0);
 		m_initialized = true;
 		m_occlusion = false;
 	}
+	// flag the tiles overlapping a pixel rectangle that is written
+	void		markTiles(int mix, int mxx, int miy, int mxy)
+	{
+		for (int ty = miy >> TILE_SHIFT; ty <= ((mxy - 1) >> TILE_SHIFT); ++ty)
+		{
+			unsigned char *dirty = &m_tileDirty[ty * m_tiles[0]];
+			for (int tx = mix >> TILE_SHIFT; tx <= ((mxx - 1) >> TILE_SHIFT); ++tx)
+				dirty[tx] = 1;
+		}
+	}
+	// compute again the depth range of a tile
+	void		updateTile(int tx, int ty)
+	{
+		const int	t = ty * m_tiles[0] + tx;
+		const int	mix = tx << TILE_SHIFT;
+		const int	mxx = btMin(m_sizes[0], mix + TILE_SIZE);
+		const int	miy = ty << TILE_SHIFT;
+		const int	mxy = btMin(m_sizes[1], miy + TILE_SIZE);
+		btScalar	zmin = m_buffer[miy * m_sizes[0] + mix];
+		btScalar	zmax = zmin;
+		for (int iy = miy; iy < mxy; ++iy)
+		{
+			const btScalar* scan = &m_buffer[iy * m_sizes[0]];
+			for (int ix = mix; ix < mxx; ++ix)
+			{
+				zmin = btMin(zmin, scan[ix]);
+				zmax = btMax(zmax, scan[ix]);
+			}
+		}
+		m_tileMin[t] = zmin;
+		m_tileMax[t] = zmax;
+		m_tileDirty[t] = 0;
+	}
 	void		SetModelMatrix(double *fl)
 	{
 		CMmat4mul(m_mtc,m_wtc,fl);
@@ -1647,6 +1735,8 @@ struct OcclusionBuffer
 		const int		mxy=btMin(m_sizes[1],1+btMax(y[0],btMax(y[1],y[2])));
 		const int		width=mxx-mix;
 		const int		height=mxy-miy;
+		if (POLICY::Write)
+			markTiles(mix, mxx, miy, mxy);
 		if ((width*height) <= 1)
 		{
 			// degenerated in at most one single pixel
@@ -1759,7 +1849,37 @@ struct OcclusionBuffer
 			btScalar       *scan = &m_buffer[miy*m_sizes[0]];
 			for (int iy=miy;iy<mxy;++iy)
 			{
-				for (int ix=mix;ix<mxx;++ix)
+				int ix=mix;
+#ifdef OCCLUSION_SSE
+				if (width >= 4)
+				{
+					// a pixel is inside when the 3 edge functions are positive, that is when their
+					// bitwise or is positive
+					__m128i c0 = _mm_setr_epi32(c[0], c[0]+dx[0], c[0]+2*dx[0], c[0]+3*dx[0]);
+					__m128i c1 = _mm_setr_epi32(c[1], c[1]+dx[1], c[1]+2*dx[1], c[1]+3*dx[1]);
+					__m128i c2 = _mm_setr_epi32(c[2], c[2]+dx[2], c[2]+2*dx[2], c[2]+3*dx[2]);
+					__m128 v4 = _mm_setr_ps(v, v+dzx, v+2*dzx, v+3*dzx);
+					const __m128i dc0 = _mm_set1_epi32(4*dx[0]);
+					const __m128i dc1 = _mm_set1_epi32(4*dx[1]);
+					const __m128i dc2 = _mm_set1_epi32(4*dx[2]);
+					const __m128 dv4 = _mm_set1_ps(4*dzx);
+					const __m128i outside = _mm_set1_epi32(-1);
+					for (;ix+4<=mxx;ix+=4)
+					{
+						const __m128i in = _mm_or_si128(_mm_or_si128(c0, c1), c2);
+						const __m128 mask = _mm_castsi128_ps(_mm_cmpgt_epi32(in, outside));
+						if (POLICY::Process4(&scan[ix], v4, mask))
+							return(true);
+						c0 = _mm_add_epi32(c0, dc0);
+						c1 = _mm_add_epi32(c1, dc1);
+						c2 = _mm_add_epi32(c2, dc2);
+						v4 = _mm_add_ps(v4, dv4);
+					}
+					const int done = ix-mix;
+					c[0]+=dx[0]*done;c[1]+=dx[1]*done;c[2]+=dx[2]*done;v+=dzx*done;
+				}
+#endif
+				for (;ix<mxx;++ix)
 				{
 					if ((c[0]>=0)&&(c[1]>=0)&&(c[2]>=0))
 					{
@@ -1829,6 +1949,7 @@ struct OcclusionBuffer
 		if (!m_occlusion)
 			// no occlusion yet, no need to check
 			return true;
+		m_tested++;
 		btVector4	x[8];
 		transformW(btVector3(c[0]-e[0],c[1]-e[1],c[2]-e[2]),x[0]);
 		transformW(btVector3(c[0]+e[0],c[1]-e[1],c[2]-e[2]),x[1]);
@@ -1843,6 +1964,52 @@ struct OcclusionBuffer
 			// the box is clipped, it's probably a large box, don't waste our time to check
 			if ((x[i][2]+x[i][3])<=0) return(true);
 		}
+		// compare the depth range of the box with the one of the tiles covered by its
+		// screen rectangle, the depth in the buffer is 1/w, larger is nearer
+		int			mix = m_sizes[0], mxx = 0, miy = m_sizes[1], mxy = 0;
+		btScalar	zmin = BT_LARGE_FLOAT, zmax = btScalar(0.f);
+		for (int i=0;i<8;++i)
+		{
+			const btScalar	iw = 1/x[i][3];
+			const int		px = (int)(x[i][0]*iw*m_scales[0]+m_offsets[0]);
+			const int		py = (int)(x[i][1]*iw*m_scales[1]+m_offsets[1]);
+			mix = btMin(mix, px);
+			mxx = btMax(mxx, px + 1);
+			miy = btMin(miy, py);
+			mxy = btMax(mxy, py + 1);
+			zmin = btMin(zmin, iw);
+			zmax = btMax(zmax, iw);
+		}
+		mix = btMax(0, mix);
+		mxx = btMin(m_sizes[0], mxx);
+		miy = btMax(0, miy);
+		mxy = btMin(m_sizes[1], mxy);
+		if (mix < mxx && miy < mxy)
+		{
+			bool hidden = true, exposed = true;
+			for (int ty = miy >> TILE_SHIFT; ty <= ((mxy - 1) >> TILE_SHIFT) && (hidden || exposed); ++ty)
+			{
+				for (int tx = mix >> TILE_SHIFT; tx <= ((mxx - 1) >> TILE_SHIFT) && (hidden || exposed); ++tx)
+				{
+					const int t = ty * m_tiles[0] + tx;
+					if (m_tileDirty[t])
+						updateTile(tx, ty);
+					// some pixel of the tile may be behind the box
+					if (zmax >= m_tileMin[t])
+						hidden = false;
+					// some pixel of the tile may be in front of the box
+					if (zmin < m_tileMax[t])
+						exposed = false;
+				}
+			}
+			if (hidden)
+			{
+				m_rejected++;
+				return false;
+			}
+			if (exposed)
+				return true;
+		}
 		static const int d[] = {1,0,3,2,
 		                        4,5,6,7,
 		                        4,7,3,0,
@@ -1859,6 +2026,7 @@ struct OcclusionBuffer
 				return true;
 			}
 		}
+		m_rejected++;
 		return false;
 	}
 };
@@ -1900,11 +2068,15 @@ struct	DbvtCullingCallback : btDbvt::ICollide
 				// this will create the occlusion buffer if not already done
 				// and compute the transformation from model local space to clip space
 				m_ocb->SetModelMatrix(fl);
+				m_ocb->m_occluders++;
 				float face = (gameobj->IsNegativeScaling()) ? -1.0f : 1.0f;
+				// a simplified proxy mesh replaces the object meshes when enabled on the object
+				RAS_MeshObject* proxy = gameobj->GetOccluderMesh();
+				const int meshcount = (proxy) ? 1 : gameobj->GetMeshCount();
 				// walk through the meshes and for each add to buffer
-				for (int i=0; i<gameobj->GetMeshCount(); i++)
+				for (int i=0; i<meshcount; i++)
 				{
-					RAS_MeshObject* meshobj = gameobj->GetMesh(i);
+					RAS_MeshObject* meshobj = (proxy) ? proxy : gameobj->GetMesh(i);
 					const float *v1, *v2, *v3, *v4;
 
 					int polycount = meshobj->NumPolygons();
@@ -1967,6 +2139,13 @@ bool CcdPhysicsEnvironment::CullingTest(PHY_CullingCallback callback, void* user
 	return true;
 }
 
+void CcdPhysicsEnvironment::GetOcclusionStats(int &occluders, int &tested, int &rejected)
+{
+	occluders = gOcb.m_occluders;
+	tested = gOcb.m_tested;
+	rejected = gOcb.m_rejected;
+}
+
 int	CcdPhysicsEnvironment::GetNumContactPoints()
 {
 	return 0;
@@ -2007,7 +2186,39 @@ void CcdPhysicsEnvironment::MergeEnvironment(PHY_IPhysicsEnvironment *other_env)
 
 		other->RemoveCcdPhysicsController(ctrl);
 		this->AddCcdPhysicsController(ctrl);
+		// only updates its environment now, the other one is freed next
+		ctrl->SetPhysicsEnvironment(this);
+	}
+}
+
+void CcdPhysicsEnvironment::DeferShapeCooking()
+{
+	m_deferShapeCooking = true;
+}
+
+static void cook_shape_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	((btBvhTriangleMeshShape *)taskdata)->buildOptimizedBvh();
+}
+
+void CcdPhysicsEnvironment::CookDeferredShapes(TaskScheduler *scheduler)
+{
+	m_deferShapeCooking = false;
+
+	/* the shapes only read their own triangles, they can be built in any order */
+	if (scheduler && m_uncookedShapes.size() > 1) {
+		TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+		for (unsigned int i = 0; i < m_uncookedShapes.size(); i++)
+			BLI_task_pool_push(pool, cook_shape_task, m_uncookedShapes[i], false, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		BLI_task_pool_free(pool);
+	}
+	else {
+		for (unsigned int i = 0; i < m_uncookedShapes.size(); i++)
+			m_uncookedShapes[i]->buildOptimizedBvh();
 	}
+
+	m_uncookedShapes.clear();
 }
 
 CcdPhysicsEnvironment::~CcdPhysicsEnvironment()
@@ -3047,6 +3258,50 @@ void	CcdPhysicsEnvironment::ExportFile(const char* filename)
 	}
 }
 
+size_t CcdPhysicsEnvironment::GetMemoryUsage()
+{
+	std::set<CcdShapeConstructionInfo *> shapeinfos;
+	std::set<btOptimizedBvh *> bvhs;
+	size_t size = 0;
+
+	for (std::set<CcdPhysicsController *>::iterator it = m_controllers.begin(); it != m_controllers.end(); ++it) {
+		CcdPhysicsController *ctrl = *it;
+		btSoftBody *softbody = ctrl->GetSoftBody();
+
+		size += sizeof(CcdPhysicsController);
+		if (softbody) {
+			size += sizeof(btSoftBody) +
+			        softbody->m_nodes.size() * sizeof(btSoftBody::Node) +
+			        softbody->m_links.size() * sizeof(btSoftBody::Link) +
+			        softbody->m_faces.size() * sizeof(btSoftBody::Face);
+		}
+		else if (ctrl->GetRigidBody()) {
+			size += sizeof(btRigidBody);
+		}
+		else {
+			size += sizeof(btCollisionObject);
+		}
+
+		/* shape data and triangle mesh trees are shared between replicas */
+		if (ctrl->GetShapeInfo())
+			shapeinfos.insert(ctrl->GetShapeInfo());
+
+		btCollisionShape *shape = ctrl->GetCollisionShape();
+		if (shape && shape->getShapeType() == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE) {
+			btOptimizedBvh *bvh = ((btScaledBvhTriangleMeshShape *)shape)->getChildShape()->getOptimizedBvh();
+			if (bvh)
+				bvhs.insert(bvh);
+		}
+	}
+
+	for (std::set<CcdShapeConstructionInfo *>::iterator it = shapeinfos.begin(); it != shapeinfos.end(); ++it)
+		size += (*it)->GetMemoryUsage();
+	for (std::set<btOptimizedBvh *>::iterator it = bvhs.begin(); it != bvhs.end(); ++it)
+		size += (*it)->calculateSerializeBufferSize();
+
+	return size;
+}
+
 struct	BlenderDebugDraw : public btIDebugDraw
 {
 	BlenderDebugDraw () :
@@ -3389,7 +3644,11 @@ void CcdPhysicsEnvironment::ConvertObject(KX_GameObject *gameobj, RAS_MeshObject
 				shapeInfo->setVertexWeldingThreshold1(0.f); //todo: expose this to the UI
 			}
 
-			bm = shapeInfo->CreateBulletShape(ci.m_margin, useGimpact, !isbulletsoftbody);
+			// The bvh of the triangles is the longest part of the conversion, it can be left to CookDeferredShapes()
+			const bool deferBvh = m_deferShapeCooking && !useGimpact && !isbulletsoftbody;
+			bm = shapeInfo->CreateBulletShape(ci.m_margin, useGimpact, !isbulletsoftbody && !deferBvh);
+			if (deferBvh && bm && bm->getShapeType() == SCALED_TRIANGLE_MESH_SHAPE_PROXYTYPE)
+				m_uncookedShapes.push_back(static_cast<btScaledBvhTriangleMeshShape *>(bm)->getChildShape());
 			//should we compute inertia for dynamic shape?
 			//bm->calculateLocalInertia(ci.m_mass,ci.m_localInertiaTensor);
 
@@ -212,6 +212,7 @@ protected:
 
 		virtual PHY_IPhysicsController* RayTest(PHY_IRayCastFilterCallback &filterCallback, float fromX,float fromY,float fromZ, float toX,float toY,float toZ);
 		virtual bool CullingTest(PHY_CullingCallback callback, void* userData, MT_Vector4* planes, int nplanes, int occlusionRes, const int *viewport, double modelview[16], double projection[16]);
+		virtual void GetOcclusionStats(int &occluders, int &tested, int &rejected);
 
 
 		//Methods for gamelogic collision/physics callbacks
@@ -286,6 +287,9 @@ protected:
 
 		void MergeEnvironment(PHY_IPhysicsEnvironment *other_env);
 
+		virtual void	DeferShapeCooking();
+		virtual void	CookDeferredShapes(struct TaskScheduler *scheduler);
+
 		static CcdPhysicsEnvironment *Create(struct Scene *blenderscene, bool visualizePhysics);
 
 		virtual void ConvertObject(KX_GameObject* gameobj,
@@ -334,8 +338,14 @@ protected:
 
 		bool	m_scalingPropagated;
 
+		/* triangle mesh shapes converted without their bvh, built by CookDeferredShapes() */
+		bool	m_deferShapeCooking;
+		std::vector<class btBvhTriangleMeshShape *>	m_uncookedShapes;
+
 		virtual void	ExportFile(const char* filename);
 
+		virtual size_t	GetMemoryUsage();
+
 		
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:CcdPhysicsEnvironment")
@@ -101,6 +101,8 @@ class PHY_IPhysicsController : public PHY_IController
 		virtual void		RestoreDynamics()=0;
 
 		virtual void		SetActive(bool active)=0;
+		/// Keep the object still until something touches it or it is woken again.
+		virtual void		SetSleeping(bool sleeping)=0;
 
 		// reading out information from physics
 		virtual MT_Vector3	GetLinearVelocity()=0;
@@ -144,7 +146,7 @@ class PHY_IPhysicsController : public PHY_IController
 		virtual bool ReinstancePhysicsShape(KX_GameObject *from_gameobj, RAS_MeshObject* from_meshobj) = 0;
 
 		/* Method to replicate rigid body joint contraints for group instances. */
-		virtual void ReplicateConstraints(KX_GameObject *gameobj, std::vector<KX_GameObject*> constobj) = 0;
+		virtual void ReplicateConstraints(KX_GameObject *gameobj, const std::vector<KX_GameObject*>& constobj) = 0;
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:PHY_IPhysicsController")
@@ -56,6 +56,7 @@ struct PHY_ShapeProps;
 struct PHY_MaterialProps;
 class PHY_IMotionState;
 struct bRigidBodyJointConstraint;
+struct TaskScheduler;
 
 /**
  * pass back information from rayTest
@@ -184,6 +185,9 @@ class PHY_IPhysicsEnvironment
 		// the plane number must be set as follow: near, far, left, right, top, botton
 		// the near plane must be the first one and must always be present, it is used to get the direction of the view
 		virtual bool CullingTest(PHY_CullingCallback callback, void *userData, MT_Vector4* planeNormals, int planeNumber, int occlusionRes, const int *viewport, double modelview[16], double projection[16]) = 0;
+		// counters of the occlusion culling done by the last CullingTest: occluders drawn in the buffer,
+		// bounding volumes tested against it and the ones found hidden
+		virtual void GetOcclusionStats(int &occluders, int &tested, int &rejected) { occluders = tested = rejected = 0; }
 
 		//Methods for gamelogic collision/physics callbacks
 		//todo:
@@ -201,8 +205,16 @@ class PHY_IPhysicsEnvironment
 		
 		virtual void	ExportFile(const char* filename) {};
 
+		/// Approximate bytes used by the bodies and collision shapes of the environment.
+		virtual size_t	GetMemoryUsage() { return 0; }
+
 		virtual void MergeEnvironment(PHY_IPhysicsEnvironment *other_env) = 0;
 
+		/// Leave the expensive part of the shapes made by ConvertObject() to CookDeferredShapes().
+		virtual void	DeferShapeCooking() {}
+		/// Finish the deferred shapes over the threads of \param scheduler, before the scene runs.
+		virtual void	CookDeferredShapes(struct TaskScheduler *scheduler) {}
+
 		virtual void ConvertObject(KX_GameObject* gameobj,
 							RAS_MeshObject* meshobj,
 							DerivedMesh* dm,
@@ -42,29 +42,60 @@
 
 #include "RAS_BucketManager.h"
 
+#include "EXP_Profiler.h"
+
 #include <algorithm>
-/* sorting */
+#include <string.h>
 
-struct RAS_BucketManager::sortedmeshslot
+/* Profiler zone of the mesh slots drawn in a row with the same material,
+ * the sorted lists go back and forth between the buckets. */
+class BucketZone
 {
 public:
-	MT_Scalar m_z;					/* depth */
-	RAS_MeshSlot *m_ms;				/* mesh slot */
-	RAS_MaterialBucket *m_bucket;	/* buck mesh slot came from */
-
-	sortedmeshslot() {}
+	BucketZone()
+		:m_bucket(NULL),
+		m_start(-1.0)
+	{
+	}
 
-	void set(RAS_MeshSlot *ms, RAS_MaterialBucket *bucket, const MT_Vector3& pnorm)
+	~BucketZone()
 	{
-		// would be good to use the actual bounding box center instead
-		MT_Point3 pos(ms->m_OpenGLMatrix[12], ms->m_OpenGLMatrix[13], ms->m_OpenGLMatrix[14]);
+		End();
+	}
 
-		m_z = MT_dot(pnorm, pos);
-		m_ms = ms;
+	void Next(RAS_MaterialBucket *bucket)
+	{
+		if (bucket == m_bucket || !CProfiler::IsTracing())
+			return;
+		End();
 		m_bucket = bucket;
+		m_start = CProfiler::GetTime();
 	}
+
+private:
+	void End()
+	{
+		if (m_start >= 0.0)
+			CProfiler::AddZone(m_bucket->GetPolyMaterial()->GetMaterialName().ReadPtr(), m_start);
+	}
+
+	RAS_MaterialBucket *m_bucket;
+	double m_start;
 };
 
+/* sorting */
+
+void RAS_BucketManager::sortedmeshslot::set(RAS_MeshSlot *ms, RAS_MaterialBucket *bucket, const MT_Vector3& pnorm)
+{
+	// would be good to use the actual bounding box center instead
+	MT_Point3 pos(ms->m_OpenGLMatrix[12], ms->m_OpenGLMatrix[13], ms->m_OpenGLMatrix[14]);
+
+	m_z = MT_dot(pnorm, pos);
+	m_key = 0;
+	m_ms = ms;
+	m_bucket = bucket;
+}
+
 struct RAS_BucketManager::backtofront
 {
 	bool operator()(const sortedmeshslot &a, const sortedmeshslot &b)
@@ -81,6 +112,86 @@ struct RAS_BucketManager::fronttoback
 	}
 };
 
+/* Groups materials using the same drawing path and texture set,
+ * the flags are the ones deciding which shader setup is used */
+#define RAS_STATE_FLAGS (RAS_MULTITEX | RAS_GLSHADER | RAS_BLENDERGLSL | RAS_MULTILIGHT)
+
+struct RAS_BucketManager::materialstate
+{
+	bool operator()(const RAS_MaterialBucket *a, const RAS_MaterialBucket *b) const
+	{
+		const RAS_IPolyMaterial *mata = a->GetPolyMaterial();
+		const RAS_IPolyMaterial *matb = b->GetPolyMaterial();
+		unsigned int flaga = mata->GetFlag() & RAS_STATE_FLAGS;
+		unsigned int flagb = matb->GetFlag() & RAS_STATE_FLAGS;
+
+		if (flaga != flagb)
+			return flaga < flagb;
+		if (mata->hash() != matb->hash())
+			return mata->hash() < matb->hash();
+		if (mata->GetMaterialNameHash() != matb->GetMaterialNameHash())
+			return mata->GetMaterialNameHash() < matb->GetMaterialNameHash();
+		return mata < matb;
+	}
+};
+
+/* Number of bits of the sort key used for the quantized depth,
+ * the bucket rank is stored in the bits above */
+#define RAS_SORT_DEPTH_BITS 24
+
+/* Stable LSD radix sort on sortedmeshslot::m_key, 8 bits per pass.
+ * Passes where all keys share the same digit are skipped, so in practice
+ * only the depth bits and the few low bits of the bucket rank are sorted. */
+void RAS_BucketManager::RadixSortSolidSlots()
+{
+	vector<sortedmeshslot>& slots = m_solidSlots;
+	vector<sortedmeshslot>& tmp = m_solidSlotsTmp;
+	const size_t size = slots.size();
+	unsigned int count[8][256];
+	size_t i;
+	int pass;
+
+	if (size < 2)
+		return;
+
+	memset(count, 0, sizeof(count));
+
+	for (i = 0; i < size; i++) {
+		uint64_t key = slots[i].m_key;
+		for (pass = 0; pass < 8; pass++)
+			count[pass][(key >> (pass * 8)) & 0xFF]++;
+	}
+
+	tmp.resize(size);
+
+	sortedmeshslot *src = &slots[0];
+	sortedmeshslot *dst = &tmp[0];
+
+	for (pass = 0; pass < 8; pass++) {
+		const int shift = pass * 8;
+		unsigned int *digits = count[pass];
+		unsigned int offset = 0;
+
+		/* all keys have the same digit, nothing to do */
+		if (digits[(src[0].m_key >> shift) & 0xFF] == size)
+			continue;
+
+		for (i = 0; i < 256; i++) {
+			unsigned int num = digits[i];
+			digits[i] = offset;
+			offset += num;
+		}
+
+		for (i = 0; i < size; i++)
+			dst[digits[(src[i].m_key >> shift) & 0xFF]++] = src[i];
+
+		std::swap(src, dst);
+	}
+
+	if (src != &slots[0])
+		slots.swap(tmp);
+}
+
 /* bucket manager */
 
 RAS_BucketManager::RAS_BucketManager()
@@ -139,7 +250,7 @@ void RAS_BucketManager::OrderBuckets(const MT_Transform& cameratrans, BucketList
 
 void RAS_BucketManager::RenderAlphaBuckets(const MT_Transform& cameratrans, RAS_IRasterizer* rasty)
 {
-	vector<sortedmeshslot> slots;
+	vector<sortedmeshslot>& slots = m_alphaSlots;
 	vector<sortedmeshslot>::iterator sit;
 
 	// Having depth masks disabled/enabled gives different artifacts in
@@ -149,8 +260,11 @@ void RAS_BucketManager::RenderAlphaBuckets(const MT_Transform& cameratrans, RAS_
 		rasty->SetDepthMask(RAS_IRasterizer::KX_DEPTHMASK_DISABLED);
 
 	OrderBuckets(cameratrans, m_AlphaBuckets, slots, true);
-	
+	rasty->GetFrameStats().m_meshSlots += slots.size();
+
+	BucketZone zone;
 	for (sit=slots.begin(); sit!=slots.end(); ++sit) {
+		zone.Next(sit->m_bucket);
 		rasty->SetClientObject(sit->m_ms->m_clientObj);
 
 		while (sit->m_bucket->ActivateMaterial(cameratrans, rasty))
@@ -164,18 +278,113 @@ void RAS_BucketManager::RenderAlphaBuckets(const MT_Transform& cameratrans, RAS_
 	rasty->SetDepthMask(RAS_IRasterizer::KX_DEPTHMASK_ENABLED);
 }
 
+void RAS_BucketManager::OrderSolidBuckets(const MT_Transform& cameratrans)
+{
+	BucketList::iterator bit;
+	size_t size = 0, i = 0;
+	uint64_t rank = 0;
+
+	/* See OrderBuckets, larger values are closer to the camera */
+	const MT_Vector3 pnorm(cameratrans.getBasis()[2]);
+	MT_Scalar zmin = MT_INFINITY, zmax = -MT_INFINITY;
+
+	/* Rank the buckets so that materials with the same drawing path and
+	 * textures end up next to each other in the sorted list. */
+	m_stateBuckets.assign(m_SolidBuckets.begin(), m_SolidBuckets.end());
+	std::sort(m_stateBuckets.begin(), m_stateBuckets.end(), materialstate());
+
+	for (bit = m_stateBuckets.begin(); bit != m_stateBuckets.end(); ++bit)
+	{
+		SG_DList::iterator<RAS_MeshSlot> mit((*bit)->GetActiveMeshSlots());
+		for (mit.begin(); !mit.end(); ++mit)
+			size++;
+	}
+
+	m_solidSlots.resize(size);
+
+	for (bit = m_stateBuckets.begin(); bit != m_stateBuckets.end(); ++bit, ++rank)
+	{
+		RAS_MaterialBucket* bucket = *bit;
+		RAS_MeshSlot* ms;
+		// remove the mesh slot form the list, it culls them automatically for next frame
+		while ((ms = bucket->GetNextActiveMeshSlot())) {
+			sortedmeshslot& slot = m_solidSlots[i++];
+			slot.set(ms, bucket, pnorm);
+			slot.m_key = rank << RAS_SORT_DEPTH_BITS;
+
+			if (slot.m_z < zmin)
+				zmin = slot.m_z;
+			if (slot.m_z > zmax)
+				zmax = slot.m_z;
+		}
+	}
+
+	/* Quantize the depth in the low bits of the key, front to back */
+	const MT_Scalar range = zmax - zmin;
+	const MT_Scalar scale = (range > MT_EPSILON) ? ((1 << RAS_SORT_DEPTH_BITS) - 1) / range : 0.0;
+
+	for (i = 0; i < size; i++) {
+		sortedmeshslot& slot = m_solidSlots[i];
+		slot.m_key |= (uint64_t)((zmax - slot.m_z) * scale);
+	}
+
+	RadixSortSolidSlots();
+}
+
+void RAS_BucketManager::RenderSortedSolidBuckets(const MT_Transform& cameratrans, RAS_IRasterizer* rasty)
+{
+	RAS_IRasterizer::FrameStats& stats = rasty->GetFrameStats();
+	vector<sortedmeshslot>::iterator sit;
+
+	OrderSolidBuckets(cameratrans);
+
+	BucketZone zone;
+	for (sit = m_solidSlots.begin(); sit != m_solidSlots.end(); ++sit) {
+		zone.Next(sit->m_bucket);
+		rasty->SetClientObject(sit->m_ms->m_clientObj);
+
+		while (sit->m_bucket->ActivateMaterial(cameratrans, rasty))
+			sit->m_bucket->RenderMeshSlot(cameratrans, rasty, *(sit->m_ms));
+
+		// make this mesh slot culled automatically for next frame
+		// it will be culled out by frustrum culling
+		sit->m_ms->SetCulled(true);
+	}
+
+	stats.m_meshSlots += m_solidSlots.size();
+}
+
 void RAS_BucketManager::RenderSolidBuckets(const MT_Transform& cameratrans, RAS_IRasterizer* rasty)
 {
 	BucketList::iterator bit;
 
 	rasty->SetDepthMask(RAS_IRasterizer::KX_DEPTHMASK_ENABLED);
 
+	/* Copies of small meshes go first as batches, the remaining
+	 * slots are drawn one by one below. */
+	if (rasty->GetMeshBatching()) {
+		for (bit = m_SolidBuckets.begin(); bit != m_SolidBuckets.end(); ++bit)
+			if ((*bit)->GetPolyMaterial()->CanBatch())
+				(*bit)->RenderBatches(cameratrans, rasty);
+	}
+
+	/* Draws meshes sorted on a material state key first and front-to-back
+	 * second, to reduce overdraw without adding material switches. */
+	if (rasty->GetSortMode() == RAS_IRasterizer::RAS_SORT_STATE) {
+		RenderSortedSolidBuckets(cameratrans, rasty);
+		return;
+	}
+
+	RAS_IRasterizer::FrameStats& stats = rasty->GetFrameStats();
+	BucketZone zone;
+
 	for (bit = m_SolidBuckets.begin(); bit != m_SolidBuckets.end(); ++bit) {
 #if 1
 		RAS_MaterialBucket* bucket = *bit;
 		RAS_MeshSlot* ms;
 		// remove the mesh slot form the list, it culls them automatically for next frame
 		while ((ms = bucket->GetNextActiveMeshSlot())) {
+			zone.Next(bucket);
 			rasty->SetClientObject(ms->m_clientObj);
 			while (bucket->ActivateMaterial(cameratrans, rasty))
 				bucket->RenderMeshSlot(cameratrans, rasty, *ms);
@@ -183,6 +392,7 @@ void RAS_BucketManager::RenderSolidBuckets(const MT_Transform& cameratrans, RAS_
 			// make this mesh slot culled automatically for next frame
 			// it will be culled out by frustrum culling
 			ms->SetCulled(true);
+			stats.m_meshSlots++;
 		}
 #else
 		list<RAS_MeshSlot>::iterator mit;
@@ -201,23 +411,6 @@ void RAS_BucketManager::RenderSolidBuckets(const MT_Transform& cameratrans, RAS_
 		}
 #endif
 	}
-	
-	/* this code draws meshes order front-to-back instead to reduce overdraw.
-	 * it turned out slower due to much material state switching, a more clever
-	 * algorithm might do better. */
-#if 0
-	vector<sortedmeshslot> slots;
-	vector<sortedmeshslot>::iterator sit;
-
-	OrderBuckets(cameratrans, m_SolidBuckets, slots, false);
-
-	for (sit=slots.begin(); sit!=slots.end(); ++sit) {
-		rendertools->SetClientObject(rasty, sit->m_ms->m_clientObj);
-
-		while (sit->m_bucket->ActivateMaterial(cameratrans, rasty))
-			sit->m_bucket->RenderMeshSlot(cameratrans, rasty, *(sit->m_ms));
-	}
-#endif
 }
 
 void RAS_BucketManager::Renderbuckets(const MT_Transform& cameratrans, RAS_IRasterizer* rasty)
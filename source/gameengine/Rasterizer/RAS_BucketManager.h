@@ -35,6 +35,8 @@
 #include "MT_Transform.h"
 #include "RAS_MaterialBucket.h"
 
+#include "BLI_sys_types.h"
+
 #include <vector>
 
 class RAS_BucketManager
@@ -44,10 +46,26 @@ public:
 private:
 	BucketList m_SolidBuckets;
 	BucketList m_AlphaBuckets;
-	
-	struct sortedmeshslot;
+
+	struct sortedmeshslot
+	{
+		MT_Scalar m_z;					/* depth */
+		uint64_t m_key;					/* state sort key, see OrderSolidBuckets */
+		RAS_MeshSlot *m_ms;				/* mesh slot */
+		RAS_MaterialBucket *m_bucket;	/* buck mesh slot came from */
+
+		void set(RAS_MeshSlot *ms, RAS_MaterialBucket *bucket, const MT_Vector3& pnorm);
+	};
 	struct backtofront;
 	struct fronttoback;
+	struct materialstate;
+
+	/* Buffers of the state sorted solid pass, kept between frames to avoid reallocating them */
+	BucketList m_stateBuckets;
+	std::vector<sortedmeshslot> m_solidSlots;
+	std::vector<sortedmeshslot> m_solidSlotsTmp;
+	/* Same for the depth sorted alpha pass */
+	std::vector<sortedmeshslot> m_alphaSlots;
 
 public:
 	RAS_BucketManager();
@@ -78,9 +96,13 @@ public:
 
 private:
 	void OrderBuckets(const MT_Transform& cameratrans, BucketList& buckets, vector<sortedmeshslot>& slots, bool alpha);
+	void OrderSolidBuckets(const MT_Transform& cameratrans);
+	void RadixSortSolidSlots();
 
 	void RenderSolidBuckets(const MT_Transform& cameratrans,
 		RAS_IRasterizer* rasty);
+	void RenderSortedSolidBuckets(const MT_Transform& cameratrans,
+		RAS_IRasterizer* rasty);
 	void RenderAlphaBuckets(const MT_Transform& cameratrans,
 		RAS_IRasterizer* rasty);
 
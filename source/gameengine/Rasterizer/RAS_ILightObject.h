@@ -75,8 +75,17 @@ public:
 
 	virtual bool HasShadowBuffer() = 0;
 	virtual int GetShadowLayer() = 0;
-	virtual void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans) = 0;
+	/// Place the shadow camera at the lamp, without binding the shadow buffer.
+	virtual void SetShadowCamera(KX_Camera *cam, MT_Transform& camtrans) = 0;
+	virtual void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam) = 0;
 	virtual void UnbindShadowBuffer() = 0;
+	/// True if the last shadow map drawn in the buffer is ours, the buffer is shared by added lamps.
+	virtual bool IsShadowBufferUser() = 0;
+	/// True if the shadow map can be split in static and dynamic casters (not for variance shadow maps).
+	virtual bool HasShadowCache() = 0;
+	/// Copy the shadow map to or from the static depth cache, the shadow buffer must not be bound.
+	virtual bool StoreShadowCache() = 0;
+	virtual bool RestoreShadowCache() = 0;
 	virtual Image *GetTextureImage(short texslot) = 0;
 	virtual void Update() = 0;
 };
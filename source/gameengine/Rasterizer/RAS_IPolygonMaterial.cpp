@@ -287,6 +287,18 @@ bool RAS_IPolyMaterial::OnlyShadow() const
 	return (m_flag & RAS_ONLYSHADOW) != 0;
 }
 
+bool RAS_IPolyMaterial::CanBatch() const
+{
+	/* custom shaders read the object matrix, zsort reorders the polygons of each
+	 * object, billboards, shadow faces and text are placed per object. GLSL
+	 * materials are checked by KX_BlenderMaterial */
+	if (m_flag & (RAS_GLSHADER | RAS_ZSORT))
+		return false;
+	if (m_drawingmode & (BILLBOARD_SCREENALIGNED | BILLBOARD_AXISALIGNED | SHADOW | RAS_IRasterizer::RAS_RENDER_3DPOLYGON_TEXT))
+		return false;
+	return true;
+}
+
 bool RAS_IPolyMaterial::UsesObjectColor() const
 {
 	return !(m_flag & RAS_BLENDERGLSL);
@@ -176,6 +176,8 @@ public:
 	virtual bool		UsesObjectColor() const;
 	virtual bool		CastsShadows() const;
 	virtual bool		OnlyShadow() const;
+	/// True if mesh slots using this material can be drawn pre-transformed in world space, see RAS_MaterialBucket::RenderBatches.
+	virtual bool		CanBatch() const;
 
 	virtual void		Replace_IScene(SCA_IScene *val) {} /* overridden by KX_BlenderMaterial */
 
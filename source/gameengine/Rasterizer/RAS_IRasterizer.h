@@ -171,6 +171,30 @@ public:
 		RAS_MIPMAP_MAX,  /* Should always be last */
 	};
 
+	/**
+	 * Solid pass ordering options, see RAS_BucketManager::RenderSolidBuckets
+	 */
+	enum SortMode {
+		RAS_SORT_NONE,   /* draw material buckets in creation order */
+		RAS_SORT_STATE,  /* sort mesh slots by material state, then front to back */
+
+		RAS_SORT_MAX,  /* Should always be last */
+	};
+
+	/**
+	 * Rendering counters, cleared in BeginFrame.
+	 */
+	struct FrameStats {
+		unsigned int m_meshSlots;        /* mesh slots drawn in all passes */
+		unsigned int m_drawCalls;        /* mesh slot passes sent to the storage */
+		unsigned int m_materialChanges;  /* SetMaterial calls that changed the cached material */
+		unsigned int m_batchedSlots;     /* mesh slots drawn as part of a batch */
+		unsigned int m_occluders;        /* objects drawn in the occlusion buffer */
+		unsigned int m_occlusionTests;   /* bounding volumes tested against the occlusion buffer */
+		unsigned int m_occlusionRejects; /* bounding volumes found hidden by the occluders */
+		double m_occlusionTime;          /* seconds spent in the culling tests with occlusion */
+	};
+
 	/**
 	 * SetDepthMask enables or disables writing a fragment's depth value
 	 * to the Z buffer.
@@ -420,6 +444,21 @@ public:
 	virtual void SetUsingOverrideShader(bool val) = 0;
 	virtual bool GetUsingOverrideShader() = 0;
 
+	virtual void SetSortMode(SortMode mode) = 0;
+	virtual SortMode GetSortMode() = 0;
+
+	/**
+	 * Draw visible copies of small meshes sharing a material in one call,
+	 * see RAS_MaterialBucket::RenderBatches.
+	 */
+	virtual void SetMeshBatching(bool enable) = 0;
+	virtual bool GetMeshBatching() = 0;
+
+	/**
+	 * Counters of the frame being drawn, the bucket manager updates them.
+	 */
+	virtual FrameStats& GetFrameStats() = 0;
+
 	/**
 	 * Render Tools
 	 */
@@ -46,6 +46,15 @@
 #include "RAS_MeshObject.h"
 #include "RAS_Deformer.h"	// __NLA
 
+#include <algorithm>
+#include <string.h>
+#include <math.h>
+
+/* Larger meshes cost more to transform than the draw call they save */
+#define RAS_BATCH_MAX_VERTEX 512
+/* Matrix and object color of a batched copy */
+#define RAS_BATCH_STATE_SIZE 20
+
 /* mesh slot */
 
 RAS_MeshSlot::RAS_MeshSlot() : SG_QList()
@@ -61,6 +70,8 @@ RAS_MeshSlot::RAS_MeshSlot() : SG_QList()
 	m_RGBAcolor = MT_Vector4(0.0, 0.0, 0.0, 0.0);
 	m_DisplayList = NULL;
 	m_bDisplayList = true;
+	m_layer = 0;
+	m_bBatch = false;
 	m_joinSlot = NULL;
 	m_pDerivedMesh = NULL;
 }
@@ -104,6 +115,8 @@ RAS_MeshSlot::RAS_MeshSlot(const RAS_MeshSlot& slot) : SG_QList()
 	m_RGBAcolor = slot.m_RGBAcolor;
 	m_DisplayList = NULL;
 	m_bDisplayList = slot.m_bDisplayList;
+	m_layer = slot.m_layer;
+	m_bBatch = false;
 	m_joinSlot = NULL;
 	m_currentArray = slot.m_currentArray;
 	m_displayArrays = slot.m_displayArrays;
@@ -297,6 +310,36 @@ void RAS_MeshSlot::UpdateDisplayArraysOffset()
 	}
 }
 
+/* The arrays are only copied when a good part of them is unused, the sizes
+ * reserved by RAS_MeshObject::AddPolygon() are close enough most of the time */
+template <class T>
+static void trim_array(vector<T>& array)
+{
+	if (array.capacity() - array.size() > array.size() / 8)
+		vector<T>(array).swap(array);
+}
+
+void RAS_MeshSlot::TrimDisplayArrays()
+{
+	for (unsigned short i = 0; i < m_displayArrays.size(); ++i) {
+		RAS_DisplayArray *darray = m_displayArrays[i];
+		trim_array(darray->m_vertex);
+		trim_array(darray->m_index);
+	}
+}
+
+RAS_DisplayArray *RAS_MeshSlot::ResizeDisplayArray(unsigned int numvertex, unsigned int numindex)
+{
+	RAS_DisplayArray *darray = m_displayArrays[0];
+
+	darray->m_vertex.resize(numvertex);
+	darray->m_index.resize(numindex);
+	m_endvertex = numvertex;
+	m_endindex = numindex;
+
+	return darray;
+}
+
 void RAS_MeshSlot::SetDeformer(RAS_Deformer* deformer)
 {
 	if (deformer && m_pDeformer != deformer) {
@@ -525,6 +568,27 @@ struct RAS_MaterialBucket::less
 
 /* material bucket */
 
+/* A slot drawing copies of one display array, m_state keeps the matrix
+ * and object color each copy had when its vertices were last transformed */
+struct RAS_MaterialBucket::MeshBatch
+{
+	RAS_MeshSlot			m_slot;
+	RAS_DisplayArray*		m_source;
+	unsigned int			m_sourceRevision;
+	vector<RAS_MeshSlot*>	m_instances;
+	vector<double>			m_state;
+
+	MeshBatch()
+		:m_source(NULL),
+		m_sourceRevision(0)
+	{
+	}
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:RAS_MeshBatch")
+#endif
+};
+
 RAS_MaterialBucket::RAS_MaterialBucket(RAS_IPolyMaterial* mat)
 {
 	m_material = mat;
@@ -532,6 +596,12 @@ RAS_MaterialBucket::RAS_MaterialBucket(RAS_IPolyMaterial* mat)
 
 RAS_MaterialBucket::~RAS_MaterialBucket()
 {
+	vector<MeshBatch*>::iterator it;
+
+	for (it = m_batches.begin(); it != m_batches.end(); it++)
+		delete *it;
+	for (it = m_shadowBatches.begin(); it != m_shadowBatches.end(); it++)
+		delete *it;
 }
 
 RAS_IPolyMaterial* RAS_MaterialBucket::GetPolyMaterial() const
@@ -646,9 +716,13 @@ void RAS_MaterialBucket::RenderMeshSlot(const MT_Transform& cameratrans, RAS_IRa
 		ms.m_bDisplayList = false;
 	else if (m_material->UsesObjectColor() && ms.m_bObjectColor)
 		ms.m_bDisplayList = false;
+	else if (ms.m_bBatch)
+		ms.m_bDisplayList = false;
 	else
 		ms.m_bDisplayList = true;
 
+	rasty->GetFrameStats().m_drawCalls++;
+
 	// for text drawing using faces
 	if (m_material->GetDrawingMode() & RAS_IRasterizer::RAS_RENDER_3DPOLYGON_TEXT)
 		rasty->IndexPrimitives_3DText(ms, m_material);
@@ -662,6 +736,250 @@ void RAS_MaterialBucket::RenderMeshSlot(const MT_Transform& cameratrans, RAS_IRa
 	rasty->PopMatrix();
 }
 
+static double batch_identity[16] = {
+	1.0, 0.0, 0.0, 0.0,
+	0.0, 1.0, 0.0, 0.0,
+	0.0, 0.0, 1.0, 0.0,
+	0.0, 0.0, 0.0, 1.0
+};
+
+/* Group copies of the same array lit by the same lights, keep the order
+ * stable between frames so unchanged copies aren't transformed again */
+static bool batch_slot_less(const pair<RAS_DisplayArray*, RAS_MeshSlot*>& a, const pair<RAS_DisplayArray*, RAS_MeshSlot*>& b)
+{
+	if (a.first != b.first)
+		return a.first < b.first;
+	if (a.second->m_layer != b.second->m_layer)
+		return a.second->m_layer < b.second->m_layer;
+	return a.second < b.second;
+}
+
+/* Determinant of the rotation and scale part of an OpenGL matrix */
+static double batch_determinant(const double *m)
+{
+	return m[0] * (m[5] * m[10] - m[9] * m[6]) -
+	       m[4] * (m[1] * m[10] - m[9] * m[2]) +
+	       m[8] * (m[1] * m[6] - m[5] * m[2]);
+}
+
+static void batch_normalize(float v[3])
+{
+	const float len = sqrtf(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+
+	if (len > 0.0f) {
+		v[0] /= len;
+		v[1] /= len;
+		v[2] /= len;
+	}
+}
+
+void RAS_MaterialBucket::TransformBatchVertices(const double *m, const RAS_TexVert *src, RAS_TexVert *dst,
+                                                unsigned int numvertex, bool tangent)
+{
+	/* normals use the inverse transpose, the transposed cofactors (adjugate)
+	 * are enough as the determinant is positive and the result normalized */
+	const float adj[9] = {
+		(float)(m[5] * m[10] - m[6] * m[9]), (float)(m[6] * m[8] - m[4] * m[10]), (float)(m[4] * m[9] - m[5] * m[8]),
+		(float)(m[9] * m[2] - m[10] * m[1]), (float)(m[10] * m[0] - m[8] * m[2]), (float)(m[8] * m[1] - m[9] * m[0]),
+		(float)(m[1] * m[6] - m[2] * m[5]), (float)(m[2] * m[4] - m[0] * m[6]), (float)(m[0] * m[5] - m[1] * m[4])
+	};
+	unsigned int v;
+
+	for (v = 0; v < numvertex; v++) {
+		const float *co = src[v].getXYZ();
+		const float *no = src[v].getNormal();
+		float xyz[3], normal[3];
+
+		xyz[0] = (float)(m[0] * co[0] + m[4] * co[1] + m[8] * co[2] + m[12]);
+		xyz[1] = (float)(m[1] * co[0] + m[5] * co[1] + m[9] * co[2] + m[13]);
+		xyz[2] = (float)(m[2] * co[0] + m[6] * co[1] + m[10] * co[2] + m[14]);
+		dst[v].SetXYZ(xyz);
+
+		/* adj^T * no */
+		normal[0] = adj[0] * no[0] + adj[3] * no[1] + adj[6] * no[2];
+		normal[1] = adj[1] * no[0] + adj[4] * no[1] + adj[7] * no[2];
+		normal[2] = adj[2] * no[0] + adj[5] * no[1] + adj[8] * no[2];
+		batch_normalize(normal);
+		dst[v].SetNormal(MT_Vector3(normal));
+
+		if (tangent) {
+			const float *tan = src[v].getTangent();
+			float t[3];
+
+			t[0] = (float)(m[0] * tan[0] + m[4] * tan[1] + m[8] * tan[2]);
+			t[1] = (float)(m[1] * tan[0] + m[5] * tan[1] + m[9] * tan[2]);
+			t[2] = (float)(m[2] * tan[0] + m[6] * tan[1] + m[10] * tan[2]);
+			batch_normalize(t);
+			dst[v].SetTangent(MT_Vector3(t));
+		}
+	}
+}
+
+void RAS_MaterialBucket::BuildBatch(MeshBatch *batch, vector<BatchSlot>::iterator begin, vector<BatchSlot>::iterator end)
+{
+	RAS_DisplayArray *source = begin->first;
+	RAS_MeshSlot *first = begin->second;
+	const unsigned int numvertex = source->m_vertex.size();
+	const unsigned int numindex = source->m_index.size();
+	const unsigned int count = end - begin;
+	const bool tangent = (m_vertexFormat.m_flag & RAS_VertexFormat::TANGENT) != 0;
+	const bool objectcolor = m_material->UsesObjectColor();
+	RAS_DisplayArray *darray;
+	unsigned int i, v;
+
+	if (!batch->m_slot.m_bucket) {
+		batch->m_slot.init(this, source->m_type);
+		batch->m_slot.m_bBatch = true;
+		batch->m_slot.m_bDisplayList = false;
+		batch->m_slot.m_OpenGLMatrix = batch_identity;
+	}
+
+	batch->m_slot.m_mesh = first->m_mesh;
+	batch->m_slot.m_clientObj = first->m_clientObj;
+	batch->m_slot.m_layer = first->m_layer;
+
+	darray = batch->m_slot.ResizeDisplayArray(count * numvertex, count * numindex);
+
+	/* another array, number of copies or python changed the source: start over.
+	 * The revision is compared instead of the modified flag, only the storage
+	 * drawing the source itself may clear that one */
+	if (batch->m_source != source || batch->m_instances.size() != count || batch->m_sourceRevision != source->m_revision) {
+		darray->m_type = source->m_type;
+		for (i = 0; i < count; i++)
+			for (v = 0; v < numindex; v++)
+				darray->m_index[i * numindex + v] = source->m_index[v] + i * numvertex;
+
+		darray->SetModified(RAS_DisplayArray::INDEX_MODIFIED, 0, 0);
+		batch->m_source = source;
+		batch->m_sourceRevision = source->m_revision;
+		batch->m_instances.assign(count, (RAS_MeshSlot *)NULL);
+		batch->m_state.resize(count * RAS_BATCH_STATE_SIZE);
+	}
+
+	for (i = 0; begin != end; ++begin, ++i) {
+		RAS_MeshSlot *ms = begin->second;
+		const double *m = ms->m_OpenGLMatrix;
+		double *state = &batch->m_state[i * RAS_BATCH_STATE_SIZE];
+		double color[4] = {-1.0, -1.0, -1.0, -1.0};
+		short modified = 0;
+
+		if (objectcolor && ms->m_bObjectColor)
+			ms->m_RGBAcolor.getValue(color);
+
+		if (batch->m_instances[i] != ms)
+			modified = RAS_DisplayArray::ALL_MODIFIED;
+		else {
+			if (memcmp(state, m, sizeof(double) * 16) != 0)
+				modified |= RAS_DisplayArray::POSITION_MODIFIED | RAS_DisplayArray::NORMAL_MODIFIED |
+				            (tangent ? RAS_DisplayArray::ATTRIB_MODIFIED : 0);
+			if (memcmp(state + 16, color, sizeof(double) * 4) != 0)
+				modified |= RAS_DisplayArray::ATTRIB_MODIFIED;
+		}
+
+		if (!modified)
+			continue;
+
+		RAS_TexVert *dst = &darray->m_vertex[i * numvertex];
+		const RAS_TexVert *src = &source->m_vertex[0];
+
+		if (modified == RAS_DisplayArray::ALL_MODIFIED)
+			std::copy(src, src + numvertex, dst);
+
+		TransformBatchVertices(m, src, dst, numvertex, tangent);
+
+		/* bake the object color, the batch itself has none. GLSL shaders using
+		 * it aren't batched, the others only read the vertex colors */
+		for (v = 0; v < numvertex; v++) {
+			if (objectcolor && ms->m_bObjectColor)
+				dst[v].SetRGBA(ms->m_RGBAcolor);
+			else
+				dst[v].SetRGBA(*(const unsigned int *)src[v].getRGBA());
+		}
+
+		darray->SetModified(modified, i * numvertex, (i + 1) * numvertex);
+		batch->m_instances[i] = ms;
+		memcpy(state, m, sizeof(double) * 16);
+		memcpy(state + 16, color, sizeof(double) * 4);
+	}
+}
+
+void RAS_MaterialBucket::RenderBatches(const MT_Transform& cameratrans, RAS_IRasterizer* rasty)
+{
+	RAS_IRasterizer::FrameStats& stats = rasty->GetFrameStats();
+	vector<MeshBatch*>& batches = (rasty->GetDrawingMode() == RAS_IRasterizer::KX_SHADOW) ? m_shadowBatches : m_batches;
+	vector<BatchSlot>::iterator sit, send, bit;
+	RAS_MeshSlot::iterator it;
+	RAS_MeshSlot *ms;
+	size_t numbatch = 0;
+
+	/* Take all slots out of the active list, those that can't be batched go back in */
+	m_batchSlots.clear();
+	while ((ms = GetNextActiveMeshSlot())) {
+		RAS_DisplayArray *array = NULL;
+
+		if (!ms->m_pDeformer && !ms->m_pDerivedMesh && !ms->m_joinSlot && ms->m_joinedSlots.empty() &&
+		    ms->m_OpenGLMatrix && batch_determinant(ms->m_OpenGLMatrix) > 0.0)
+		{
+			/* a single whole display array of a small mesh */
+			ms->begin(it);
+			array = it.array;
+			if (array && (array->m_type == RAS_DisplayArray::LINE || it.startvertex != 0 ||
+			              it.endvertex != array->m_vertex.size() || it.totindex != array->m_index.size() ||
+			              it.endvertex > RAS_BATCH_MAX_VERTEX))
+			{
+				array = NULL;
+			}
+			if (array) {
+				ms->next(it);
+				if (!ms->end(it))
+					array = NULL;
+			}
+		}
+
+		m_batchSlots.push_back(BatchSlot(array, ms));
+	}
+
+	std::sort(m_batchSlots.begin(), m_batchSlots.end(), batch_slot_less);
+
+	for (sit = m_batchSlots.begin(); sit != m_batchSlots.end(); sit = send) {
+		RAS_DisplayArray *array = sit->first;
+		const int layer = sit->second->m_layer;
+		size_t count = 0;
+
+		/* as many copies as fit in one display array */
+		for (send = sit; send != m_batchSlots.end() && send->first == array && send->second->m_layer == layer; ++send, ++count) {
+			if (array && ((count + 1) * array->m_vertex.size() > RAS_DisplayArray::BUCKET_MAX_VERTEX ||
+			              (count + 1) * array->m_index.size() > RAS_DisplayArray::BUCKET_MAX_INDEX))
+			{
+				break;
+			}
+		}
+
+		if (!array || count < 2) {
+			for (bit = sit; bit != send; ++bit)
+				ActivateMesh(bit->second);
+			continue;
+		}
+
+		if (numbatch == batches.size())
+			batches.push_back(new MeshBatch());
+		MeshBatch *batch = batches[numbatch++];
+
+		BuildBatch(batch, sit, send);
+
+		rasty->SetClientObject(batch->m_slot.m_clientObj);
+		while (ActivateMaterial(cameratrans, rasty))
+			RenderMeshSlot(cameratrans, rasty, batch->m_slot);
+
+		// make these mesh slots culled automatically for next frame
+		for (bit = sit; bit != send; ++bit)
+			bit->second->SetCulled(true);
+
+		stats.m_meshSlots += count;
+		stats.m_batchedSlots += count;
+	}
+}
+
 void RAS_MaterialBucket::Optimize(MT_Scalar distance)
 {
 	/* TODO: still have to check before this works correct:
@@ -33,6 +33,7 @@
 #define __RAS_MATERIALBUCKET_H__
 
 #include "RAS_TexVert.h"
+#include "RAS_VertexFormat.h"
 #include "CTR_Map.h"
 #include "SG_QList.h"
 
@@ -96,8 +97,59 @@ public:
 	/* Number of RAS_MeshSlot using this array */
 	int m_users;
 
+	/* What changed in the vertices since the storage last uploaded them,
+	 * in the range [m_modifiedStart, m_modifiedEnd[ */
+	enum {
+		POSITION_MODIFIED = 1,
+		NORMAL_MODIFIED = 2,
+		ATTRIB_MODIFIED = 4,	/* colors, uvs or tangents */
+		ALL_MODIFIED = POSITION_MODIFIED | NORMAL_MODIFIED | ATTRIB_MODIFIED,
+		INDEX_MODIFIED = 8		/* polygon order or count, the vertex range is ignored */
+	};
+	short m_modified;
+	unsigned int m_modifiedStart;
+	unsigned int m_modifiedEnd;
+	/* Bumped on every change, for the copies that outlive the modified flag (batches) */
+	unsigned int m_revision;
+
 	enum { BUCKET_MAX_INDEX = 65535 };
 	enum { BUCKET_MAX_VERTEX = 65535 };
+
+	RAS_DisplayArray()
+		:m_offset(0),
+		m_type(TRIANGLE),
+		m_users(0),
+		m_modified(0),
+		m_modifiedStart(0),
+		m_modifiedEnd(0),
+		m_revision(0)
+	{
+	}
+
+	/// Called by deformers and mesh editing to tell the storage what to upload again.
+	void SetModified(short flag, unsigned int start, unsigned int end)
+	{
+		m_revision++;
+		if (!(flag & ALL_MODIFIED)) {
+			m_modified |= flag;
+			return;
+		}
+		if (m_modified & ALL_MODIFIED) {
+			if (start < m_modifiedStart)
+				m_modifiedStart = start;
+			if (end > m_modifiedEnd)
+				m_modifiedEnd = end;
+		}
+		else {
+			m_modifiedStart = start;
+			m_modifiedEnd = end;
+		}
+		m_modified |= flag;
+	}
+	void ClearModified()
+	{
+		m_modified = 0;
+	}
 };
 
 /* Entry of a RAS_MeshObject into RAS_MaterialBucket */
@@ -138,6 +190,10 @@ public:
 	// display lists
 	KX_ListSlot*			m_DisplayList;
 	bool					m_bDisplayList;
+	// light layer of the client object
+	int						m_layer;
+	// draws pre-transformed copies of other slots, see RAS_MaterialBucket::RenderBatches
+	bool					m_bBatch;
 	// joined mesh slots
 	RAS_MeshSlot*			m_joinSlot;
 	MT_Matrix4x4			m_joinInvTransform;
@@ -175,6 +231,12 @@ public:
 	/// Update offset of each display array
 	void UpdateDisplayArraysOffset();
 
+	/// Free the room reserved in the display arrays during the conversion and left unused.
+	void TrimDisplayArrays();
+
+	/// Resize the only display array of a batch slot, see RAS_MaterialBucket::RenderBatches.
+	RAS_DisplayArray *ResizeDisplayArray(unsigned int numvertex, unsigned int numindex);
+
 	/* optimization */
 	bool Split(bool force=false);
 	bool Join(RAS_MeshSlot *target, MT_Scalar distance);
@@ -227,10 +289,27 @@ public:
 	RAS_IPolyMaterial*		GetPolyMaterial() const;
 	bool					IsAlpha() const;
 	bool					IsZSort() const;
+
+	/* Vertex data read by the material, filled by the converter */
+	RAS_VertexFormat&		GetVertexFormat() { return m_vertexFormat; }
 		
 	/* Rendering */
 	bool ActivateMaterial(const MT_Transform& cameratrans, RAS_IRasterizer* rasty);
 	void RenderMeshSlot(const MT_Transform& cameratrans, RAS_IRasterizer* rasty, RAS_MeshSlot &ms);
+
+	/**
+	 * Draw the active slots of small meshes that share a display array as
+	 * batches, their vertices are transformed in world space on the CPU and
+	 * drawn with one call. Slots that can't be batched are left active.
+	 */
+	void RenderBatches(const MT_Transform& cameratrans, RAS_IRasterizer* rasty);
+
+	/**
+	 * Copy the positions, normals and tangents of \a src into \a dst transformed by
+	 * the OpenGL matrix \a m, as a batch draws them. The determinant of \a m must be positive.
+	 */
+	static void TransformBatchVertices(const double *m, const RAS_TexVert *src, RAS_TexVert *dst,
+	                                   unsigned int numvertex, bool tangent);
 	
 	/* Mesh Slot Access */
 	list<RAS_MeshSlot>::iterator msBegin();
@@ -256,7 +335,17 @@ public:
 private:
 	list<RAS_MeshSlot>			m_meshSlots;			// all the mesh slots
 	RAS_IPolyMaterial*			m_material;
+	RAS_VertexFormat			m_vertexFormat;
 	SG_DList					m_activeMeshSlotsHead;	// only those which must be rendered
+
+	/* Batches are kept between frames, copies that didn't move aren't transformed again */
+	struct MeshBatch;
+	typedef pair<RAS_DisplayArray*, RAS_MeshSlot*> BatchSlot;
+	vector<MeshBatch*>			m_batches;
+	vector<MeshBatch*>			m_shadowBatches;		// the shadow pass sees other slots
+	vector<BatchSlot>			m_batchSlots;
+
+	void						BuildBatch(MeshBatch *batch, vector<BatchSlot>::iterator begin, vector<BatchSlot>::iterator end);
 	
 
 #ifdef WITH_CXX_GUARDEDALLOC
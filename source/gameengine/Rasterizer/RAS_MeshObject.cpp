@@ -96,6 +96,23 @@ struct RAS_MeshObject::fronttoback
 	}
 };
 
+/* Vertices made from each original vertex, as a linked list, the key
+ * skips most of the RAS_TexVert::closeTo tests. */
+struct RAS_MeshObject::ConversionData
+{
+	struct WeldVertex {
+		RAS_DisplayArray *m_darray;
+		unsigned int m_offset;
+		unsigned int m_key;
+		int m_next;
+	};
+
+	vector<int> m_head;
+	vector<WeldVertex> m_vertices;
+	/* expected vertices per polygon corner, to size display arrays */
+	float m_vertexRatio;
+};
+
 /* mesh object */
 
 STR_String RAS_MeshObject::s_emptyname = "";
@@ -103,6 +120,7 @@ STR_String RAS_MeshObject::s_emptyname = "";
 RAS_MeshObject::RAS_MeshObject(Mesh* mesh)
 	: m_bModified(true),
 	m_bMeshModified(true),
+	m_conversion(NULL),
 	m_mesh(mesh)
 {
 	if (m_mesh && m_mesh->key)
@@ -124,6 +142,8 @@ RAS_MeshObject::~RAS_MeshObject()
 	for (it=m_Polygons.begin(); it!=m_Polygons.end(); it++)
 		delete (*it);
 
+	delete m_conversion;
+
 	m_sharedvertex_map.clear();
 	m_Polygons.clear();
 	m_materials.clear();
@@ -134,6 +154,26 @@ bool RAS_MeshObject::MeshModified()
 	return m_bMeshModified;
 }
 
+void RAS_MeshObject::SetVertexModified(RAS_TexVert *vertex)
+{
+	list<RAS_MeshMaterial>::iterator mit;
+	RAS_MeshSlot::iterator it;
+
+	m_bMeshModified = true;
+
+	for (mit = m_materials.begin(); mit != m_materials.end(); ++mit) {
+		RAS_MeshSlot *slot = mit->m_baseslot;
+
+		for (slot->begin(it); !slot->end(it); slot->next(it)) {
+			if (vertex >= it.vertex + it.startvertex && vertex < it.vertex + it.endvertex) {
+				const unsigned int index = vertex - it.vertex;
+				it.array->SetModified(RAS_DisplayArray::ALL_MODIFIED, index, index + 1);
+				return;
+			}
+		}
+	}
+}
+
 //unsigned int RAS_MeshObject::GetLightLayer()
 //{
 //	return m_lightlayer;
@@ -250,7 +290,22 @@ int RAS_MeshObject::GetMaterialId(RAS_IPolyMaterial *mat)
 	return -1;
 }
 
-RAS_Polygon* RAS_MeshObject::AddPolygon(RAS_MaterialBucket *bucket, int numverts)
+void RAS_MeshObject::BeginConversion(unsigned int numorigverts, unsigned int numcorners)
+{
+	if (!m_conversion)
+		m_conversion = new ConversionData();
+
+	m_conversion->m_head.assign(numorigverts, -1);
+	m_conversion->m_vertices.clear();
+	m_conversion->m_vertices.reserve(numorigverts);
+	/* smooth meshes split some vertices along seams */
+	m_conversion->m_vertexRatio = (numcorners) ? std::min(1.0f, 1.25f * numorigverts / numcorners) : 1.0f;
+
+	SharedVertex none = {NULL, 0};
+	m_sharedvertex_map.assign(numorigverts, none);
+}
+
+RAS_Polygon* RAS_MeshObject::AddPolygon(RAS_MaterialBucket *bucket, int numverts, unsigned int numcorners)
 {
 	RAS_MeshMaterial *mmat;
 	RAS_Polygon *poly;
@@ -275,6 +330,15 @@ RAS_Polygon* RAS_MeshObject::AddPolygon(RAS_MaterialBucket *bucket, int numverts
 
 	/* create a new polygon */
 	RAS_DisplayArray *darray = slot->CurrentDisplayArray();
+
+	/* size new display arrays once instead of growing them vertex by vertex */
+	if (numcorners && m_conversion && darray->m_index.capacity() == 0) {
+		const unsigned int numindex = std::min(numcorners, (unsigned int)RAS_DisplayArray::BUCKET_MAX_INDEX);
+		const unsigned int numvertex = (unsigned int)(numindex * m_conversion->m_vertexRatio) + numverts;
+
+		darray->m_index.reserve(numindex);
+		darray->m_vertex.reserve(std::min(numvertex, (unsigned int)RAS_DisplayArray::BUCKET_MAX_VERTEX));
+	}
 	poly = new RAS_Polygon(bucket, darray, numverts);
 	m_Polygons.push_back(poly);
 
@@ -302,17 +366,19 @@ void RAS_MeshObject::SetVertexColor(RAS_IPolyMaterial* mat,MT_Vector4 rgba)
 	RAS_MeshSlot::iterator it;
 	size_t i;
 
-	for (slot->begin(it); !slot->end(it); slot->next(it))
+	for (slot->begin(it); !slot->end(it); slot->next(it)) {
 		for (i=it.startvertex; i<it.endvertex; i++)
 			it.vertex[i].SetRGBA(rgba);
+		it.array->SetModified(RAS_DisplayArray::ATTRIB_MODIFIED, it.startvertex, it.endvertex);
+	}
 }
 
 void RAS_MeshObject::AddVertex(RAS_Polygon *poly, int i,
-								const MT_Point3& xyz,
-								const MT_Point2 uvs[RAS_TexVert::MAX_UNIT],
-								const MT_Vector4& tangent,
+								const float xyz[3],
+								const float uvs[RAS_TexVert::MAX_UNIT][2],
+								const float tangent[4],
 								const unsigned int rgba,
-								const MT_Vector3& normal,
+								const float normal[3],
 								bool flat,
 								int origindex)
 {
@@ -326,24 +392,38 @@ void RAS_MeshObject::AddVertex(RAS_Polygon *poly, int i,
 	slot = mmat->m_baseslot;
 	darray = slot->CurrentDisplayArray();
 
+	if (!m_conversion || (unsigned int)origindex >= m_conversion->m_head.size()) {
+		/* not sized by BeginConversion */
+		SharedVertex none = {NULL, 0};
+		if (!m_conversion) {
+			m_conversion = new ConversionData();
+			m_conversion->m_vertexRatio = 1.0f;
+		}
+		m_conversion->m_head.resize(origindex + 1, -1);
+		m_sharedvertex_map.resize(origindex + 1, none);
+	}
+
+	vector<ConversionData::WeldVertex>& welds = m_conversion->m_vertices;
+	int& head = m_conversion->m_head[origindex];
+	const unsigned int key = texvert.closeToKey();
+
 	{ /* Shared Vertex! */
 		/* find vertices shared between faces, with the restriction
 		 * that they exist in the same display array, and have the
 		 * same uv coordinate etc */
-		vector<SharedVertex>& sharedmap = m_sharedvertex_map[origindex];
-		vector<SharedVertex>::iterator it;
-
-		for (it = sharedmap.begin(); it != sharedmap.end(); it++)
+		for (int w = head; w != -1; w = welds[w].m_next)
 		{
-			if (it->m_darray != darray)
+			const ConversionData::WeldVertex& weld = welds[w];
+
+			if (weld.m_darray != darray || weld.m_key != key)
 				continue;
-			if (!it->m_darray->m_vertex[it->m_offset].closeTo(&texvert))
+			if (!darray->m_vertex[weld.m_offset].closeTo(&texvert))
 				continue;
 
 			/* found one, add it and we're done */
 			if (poly->IsVisible())
-				slot->AddPolygonVertex(it->m_offset);
-			poly->SetVertexOffset(i, it->m_offset);
+				slot->AddPolygonVertex(weld.m_offset);
+			poly->SetVertexOffset(i, weld.m_offset);
 			return;
 		}
 	}
@@ -355,10 +435,19 @@ void RAS_MeshObject::AddVertex(RAS_Polygon *poly, int i,
 	poly->SetVertexOffset(i, offset);
 
 	{ /* Shared Vertex! */
-		SharedVertex shared;
-		shared.m_darray = darray;
-		shared.m_offset = offset;
-		m_sharedvertex_map[origindex].push_back(shared);
+		ConversionData::WeldVertex weld;
+		weld.m_darray = darray;
+		weld.m_offset = offset;
+		weld.m_key = key;
+		weld.m_next = head;
+		head = welds.size();
+		welds.push_back(weld);
+
+		SharedVertex& shared = m_sharedvertex_map[origindex];
+		if (!shared.m_darray) {
+			shared.m_darray = darray;
+			shared.m_offset = offset;
+		}
 	}
 }
 
@@ -378,6 +467,33 @@ int RAS_MeshObject::NumVertices(RAS_IPolyMaterial* mat)
 }
 
 
+void RAS_MeshObject::GetVertexMemory(unsigned int& fullsize, unsigned int& packedsize)
+{
+	list<RAS_MeshMaterial>::iterator mit;
+	RAS_MeshSlot::iterator it;
+
+	fullsize = 0;
+	packedsize = 0;
+
+	for (mit = m_materials.begin(); mit != m_materials.end(); ++mit) {
+		RAS_MeshSlot *slot = mit->m_baseslot;
+		RAS_VertexFormat format = mit->m_bucket->GetVertexFormat();
+
+		for (slot->begin(it); !slot->end(it); slot->next(it)) {
+			const unsigned int num = it.endvertex - it.startvertex;
+
+			/* assumes half float vertex support, like the vbo storage does when available */
+			if (RAS_VertexLayout::UVFitsHalf(it.vertex + it.startvertex, num, format.m_uvSize))
+				format.m_flag |= RAS_VertexFormat::HALF_UV;
+			else
+				format.m_flag &= ~RAS_VertexFormat::HALF_UV;
+
+			fullsize += num * sizeof(RAS_TexVert);
+			packedsize += num * RAS_VertexLayout(format).m_stride;
+		}
+	}
+}
+
 RAS_TexVert* RAS_MeshObject::GetVertex(unsigned int matid,
 									   unsigned int index)
 {
@@ -405,9 +521,8 @@ RAS_TexVert* RAS_MeshObject::GetVertex(unsigned int matid,
 
 const float* RAS_MeshObject::GetVertexLocation(unsigned int orig_index)
 {
-	vector<SharedVertex>& sharedmap = m_sharedvertex_map[orig_index];
-	vector<SharedVertex>::iterator it= sharedmap.begin();
-	return it->m_darray->m_vertex[it->m_offset].getXYZ();
+	const SharedVertex& shared = m_sharedvertex_map[orig_index];
+	return shared.m_darray->m_vertex[shared.m_offset].getXYZ();
 }
 
 void RAS_MeshObject::AddMeshUser(void *clientobj, SG_QList *head, RAS_Deformer* deformer)
@@ -469,15 +584,19 @@ void RAS_MeshObject::EndConversion()
 {
 #if 0
 	m_sharedvertex_map.clear(); // SharedVertex
-	vector<vector<SharedVertex> >	shared_null(0);
+	vector<SharedVertex>	shared_null(0);
 	shared_null.swap( m_sharedvertex_map ); /* really free the memory */
 #endif
 
+	delete m_conversion;
+	m_conversion = NULL;
+
 	for (std::list<RAS_MeshMaterial>::iterator it = m_materials.begin();
 		 it != m_materials.end();
 		 ++it)
 	{
 		RAS_MeshSlot *ms = it->m_baseslot;
+		ms->TrimDisplayArrays();
 		ms->UpdateDisplayArraysOffset();
 	}
 }
@@ -549,6 +668,8 @@ void RAS_MeshObject::SortPolygons(RAS_MeshSlot& ms, const MT_Transform &transfor
 		/* get indices from temporary array again */
 		for (j=0; j<totpoly; j++)
 			poly_slots[j].set(it.index, j*nvert, nvert);
+
+		it.array->SetModified(RAS_DisplayArray::INDEX_MODIFIED, 0, 0);
 	}
 }
 
@@ -70,6 +70,10 @@ private:
 	struct backtofront;
 	struct fronttoback;
 
+	/* vertex sharing, only during conversion */
+	struct ConversionData;
+	ConversionData*				m_conversion;
+
 protected:
 	vector<int>						m_cacheWeightIndex;
 	list<RAS_MeshMaterial>			m_materials;
@@ -102,19 +106,24 @@ public:
 	/* modification state */
 	bool				MeshModified();
 	void				SetMeshModified(bool v) { m_bMeshModified = v; }
+	/// Flag the mesh and the display array holding this vertex as modified.
+	void				SetVertexModified(RAS_TexVert *vertex);
 
 	/* original blender mesh */
 	Mesh*				GetMesh() { return m_mesh; }
 
 	/* mesh construction */
 	
-	virtual RAS_Polygon*	AddPolygon(RAS_MaterialBucket *bucket, int numverts);
+	/// Size the vertex sharing data from the original vertex and polygon corner counts.
+	void					BeginConversion(unsigned int numorigverts, unsigned int numcorners);
+	/// numcorners is the count of corners left to add with this material, to size new display arrays.
+	virtual RAS_Polygon*	AddPolygon(RAS_MaterialBucket *bucket, int numverts, unsigned int numcorners = 0);
 	virtual void			AddVertex(RAS_Polygon *poly, int i,
-							const MT_Point3& xyz,
-							const MT_Point2 uvs[RAS_TexVert::MAX_UNIT],
-							const MT_Vector4& tangent,
+							const float xyz[3],
+							const float uvs[RAS_TexVert::MAX_UNIT][2],
+							const float tangent[4],
 							const unsigned int rgbacolor,
-							const MT_Vector3& normal,
+							const float normal[3],
 							bool flat,
 							int origindex);
 
@@ -124,6 +133,8 @@ public:
 	int					NumVertices(RAS_IPolyMaterial* mat);
 	RAS_TexVert*		GetVertex(unsigned int matid, unsigned int index);
 	const float*		GetVertexLocation(unsigned int orig_index);
+	/// Bytes used by the vertices as RAS_TexVert and once packed with the material vertex formats.
+	void				GetVertexMemory(unsigned int& fullsize, unsigned int& packedsize);
 
 	int					NumPolygons();
 	RAS_Polygon*		GetPolygon(int num) const;
@@ -144,13 +155,13 @@ public:
 
 	bool				HasColliderPolygon();
 
-	/* for construction to find shared vertices */
+	/* first vertex made from each original vertex, m_darray is NULL for unused ones */
 	struct SharedVertex {
 		RAS_DisplayArray *m_darray;
 		int m_offset;
 	};
 
-	vector<vector<SharedVertex> >	m_sharedvertex_map;
+	vector<SharedVertex>	m_sharedvertex_map;
 
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -0,0 +1,115 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Rasterizer/RAS_NullRasterizer.cpp
+ *  \ingroup bgerast
+ */
+
+#include "RAS_NullRasterizer.h"
+
+#include <string.h>
+
+RAS_NullRasterizer::RAS_NullRasterizer(RAS_ICanvas *canvas)
+	:RAS_IRasterizer(canvas),
+	m_campos(0.0f, 0.0f, 0.0f),
+	m_camortho(false),
+	m_time(0.0),
+	m_drawingmode(KX_TEXTURED),
+	m_stereomode(RAS_STEREO_NOSTEREO),
+	m_curreye(RAS_STEREO_LEFTEYE),
+	m_eyeseparation(0.0f),
+	m_focallength(0.0f),
+	m_motionblurvalue(-1.0f),
+	m_motionblur(0),
+	m_anisotropic(0),
+	m_mipmapping(RAS_MIPMAP_NONE),
+	m_usingoverrideshader(false),
+	m_sortmode(RAS_SORT_NONE),
+	m_meshbatching(false)
+{
+	m_viewmatrix.setIdentity();
+	m_viewinvmatrix.setIdentity();
+	memset(&m_frameStats, 0, sizeof(m_frameStats));
+}
+
+RAS_NullRasterizer::~RAS_NullRasterizer()
+{
+}
+
+bool RAS_NullRasterizer::BeginFrame(double time)
+{
+	m_time = time;
+	memset(&m_frameStats, 0, sizeof(m_frameStats));
+	return true;
+}
+
+void RAS_NullRasterizer::SetViewMatrix(const MT_Matrix4x4 &mat, const MT_Matrix3x3 &ori,
+                                       const MT_Point3 &pos, bool perspective)
+{
+	m_viewmatrix = mat;
+	m_viewinvmatrix = m_viewmatrix;
+	m_viewinvmatrix.invert();
+	m_campos = pos;
+	m_camortho = !perspective;
+}
+
+/* the matrices of glFrustum() and glOrtho(), without stereo */
+MT_Matrix4x4 RAS_NullRasterizer::GetFrustumMatrix(
+        float left, float right, float bottom, float top,
+        float frustnear, float frustfar,
+        float focallength, bool perspective)
+{
+	return MT_Matrix4x4(
+	        2.0f * frustnear / (right - left), 0.0f, (right + left) / (right - left), 0.0f,
+	        0.0f, 2.0f * frustnear / (top - bottom), (top + bottom) / (top - bottom), 0.0f,
+	        0.0f, 0.0f, -(frustfar + frustnear) / (frustfar - frustnear), -2.0f * frustfar * frustnear / (frustfar - frustnear),
+	        0.0f, 0.0f, -1.0f, 0.0f);
+}
+
+MT_Matrix4x4 RAS_NullRasterizer::GetOrthoMatrix(
+        float left, float right, float bottom, float top,
+        float frustnear, float frustfar)
+{
+	return MT_Matrix4x4(
+	        2.0f / (right - left), 0.0f, 0.0f, -(right + left) / (right - left),
+	        0.0f, 2.0f / (top - bottom), 0.0f, -(top + bottom) / (top - bottom),
+	        0.0f, 0.0f, -2.0f / (frustfar - frustnear), -(frustfar + frustnear) / (frustfar - frustnear),
+	        0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void RAS_NullRasterizer::EnableMotionBlur(float motionblurvalue)
+{
+	if (m_motionblur == 0)
+		m_motionblur = 1;
+	m_motionblurvalue = motionblurvalue;
+}
+
+void RAS_NullRasterizer::DisableMotionBlur()
+{
+	m_motionblur = 0;
+	m_motionblurvalue = -1.0f;
+}
@@ -187,21 +187,12 @@ int RAS_OpenGLLight::GetShadowLayer()
 		return 0;
 }
 
-void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans)
+void RAS_OpenGLLight::SetShadowCamera(KX_Camera *cam, MT_Transform& camtrans)
 {
-	GPULamp *lamp;
+	GPULamp *lamp = GetGPULamp();
 	float viewmat[4][4], winmat[4][4];
-	int winsize;
-
-	/* bind framebuffer */
-	lamp = GetGPULamp();
-	GPU_lamp_shadow_buffer_bind(lamp, viewmat, &winsize, winmat);
-
-	if (GPU_lamp_shadow_buffer_type(lamp) == LA_SHADMAP_VARIANCE)
-		m_rasterizer->SetUsingOverrideShader(true);
 
-	/* GPU_lamp_shadow_buffer_bind() changes the viewport, so update the canvas */
-	canvas->UpdateViewPort(0, 0, winsize, winsize);
+	GPU_lamp_shadow_buffer_mats(lamp, viewmat, winmat);
 
 	/* setup camera transformation */
 	MT_Matrix4x4 modelviewmat((float*)viewmat);
@@ -216,13 +207,31 @@ void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_T
 	cam->NodeSetLocalPosition(camtrans.getOrigin());
 	cam->NodeSetLocalOrientation(camtrans.getBasis());
 	cam->NodeUpdateGS(0);
+}
+
+void RAS_OpenGLLight::BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam)
+{
+	GPULamp *lamp;
+	float viewmat[4][4], winmat[4][4];
+	int winsize;
+
+	/* bind framebuffer */
+	lamp = GetGPULamp();
+	GPU_lamp_shadow_buffer_bind(lamp, viewmat, &winsize, winmat);
+	GPU_lamp_shadow_buffer_set_user(lamp, this);
+
+	if (GPU_lamp_shadow_buffer_type(lamp) == LA_SHADMAP_VARIANCE)
+		m_rasterizer->SetUsingOverrideShader(true);
 
-	/* setup rasterizer transformations */
+	/* GPU_lamp_shadow_buffer_bind() changes the viewport, so update the canvas */
+	canvas->UpdateViewPort(0, 0, winsize, winsize);
+
+	/* setup rasterizer transformations, the camera was placed by SetShadowCamera() */
 	/* SetViewMatrix may use stereomode which we temporarily disable here */
 	RAS_IRasterizer::StereoMode stereomode = m_rasterizer->GetStereoMode();
 	m_rasterizer->SetStereoMode(RAS_IRasterizer::RAS_STEREO_NOSTEREO);
-	m_rasterizer->SetProjectionMatrix(projectionmat);
-	m_rasterizer->SetViewMatrix(modelviewmat, cam->NodeGetWorldOrientation(), cam->NodeGetWorldPosition(), cam->GetCameraData()->m_perspective);
+	m_rasterizer->SetProjectionMatrix(cam->GetProjectionMatrix());
+	m_rasterizer->SetViewMatrix(cam->GetModelviewMatrix(), cam->NodeGetWorldOrientation(), cam->NodeGetWorldPosition(), cam->GetCameraData()->m_perspective);
 	m_rasterizer->SetStereoMode(stereomode);
 }
 
@@ -235,6 +244,26 @@ void RAS_OpenGLLight::UnbindShadowBuffer()
 		m_rasterizer->SetUsingOverrideShader(false);
 }
 
+bool RAS_OpenGLLight::IsShadowBufferUser()
+{
+	return GPU_lamp_shadow_buffer_user(GetGPULamp()) == this;
+}
+
+bool RAS_OpenGLLight::HasShadowCache()
+{
+	return GPU_lamp_shadow_buffer_type(GetGPULamp()) != LA_SHADMAP_VARIANCE;
+}
+
+bool RAS_OpenGLLight::StoreShadowCache()
+{
+	return GPU_lamp_shadow_cache_store(GetGPULamp());
+}
+
+bool RAS_OpenGLLight::RestoreShadowCache()
+{
+	return GPU_lamp_shadow_cache_restore(GetGPULamp());
+}
+
 Image *RAS_OpenGLLight::GetTextureImage(short texslot)
 {
 	KX_LightObject* kxlight = (KX_LightObject*)m_light;
@@ -47,8 +47,13 @@ public:
 
 	bool HasShadowBuffer();
 	int GetShadowLayer();
-	void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam, MT_Transform& camtrans);
+	void SetShadowCamera(KX_Camera *cam, MT_Transform& camtrans);
+	void BindShadowBuffer(RAS_ICanvas *canvas, KX_Camera *cam);
 	void UnbindShadowBuffer();
+	bool IsShadowBufferUser();
+	bool HasShadowCache();
+	bool StoreShadowCache();
+	bool RestoreShadowCache();
 	Image *GetTextureImage(short texslot);
 	void Update();
 };
@@ -32,6 +32,7 @@
  
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
  
 #include "RAS_OpenGLRasterizer.h"
 
@@ -99,6 +100,8 @@ RAS_OpenGLRasterizer::RAS_OpenGLRasterizer(RAS_ICanvas* canvas, int storage)
 	m_motionblur(0),
 	m_motionblurvalue(-1.0),
 	m_usingoverrideshader(false),
+	m_sortmode(RAS_SORT_NONE),
+	m_meshbatching(false),
 	m_clientobject(NULL),
 	m_auxilaryClientInfo(NULL),
 	m_drawingmode(KX_TEXTURED),
@@ -120,6 +123,8 @@ RAS_OpenGLRasterizer::RAS_OpenGLRasterizer(RAS_ICanvas* canvas, int storage)
 	}
 	hinterlace_mask[32] = 0;
 
+	memset(&m_stats, 0, sizeof(m_stats));
+
 	m_prevafvalue = GPU_get_anisotropic();
 
 	if (m_storage_type == RAS_VBO /*|| m_storage_type == RAS_AUTO_STORAGE && GLEW_ARB_vertex_buffer_object*/)
@@ -242,7 +247,13 @@ void RAS_OpenGLRasterizer::DisplayFog()
 
 bool RAS_OpenGLRasterizer::SetMaterial(const RAS_IPolyMaterial& mat)
 {
-	return mat.Activate(this, m_materialCachingInfo);
+	RAS_IPolyMaterial::TCachingInfo lastCachingInfo = m_materialCachingInfo;
+	bool result = mat.Activate(this, m_materialCachingInfo);
+
+	if (m_materialCachingInfo != lastCachingInfo)
+		m_stats.m_materialChanges++;
+
+	return result;
 }
 
 
@@ -275,6 +286,8 @@ bool RAS_OpenGLRasterizer::BeginFrame(double time)
 {
 	m_time = time;
 
+	memset(&m_stats, 0, sizeof(m_stats));
+
 	// Blender camera routine destroys the settings
 	if (m_drawingmode < KX_SOLID)
 	{
@@ -377,10 +390,10 @@ void RAS_OpenGLRasterizer::FlushDebugShapes(SCA_IScene *scene)
 		if (debugShapes[i].m_type != OglDebugShape::LINE)
 			continue;
 		glColor4f(debugShapes[i].m_color[0], debugShapes[i].m_color[1], debugShapes[i].m_color[2], 1.0f);
-		const MT_Scalar *fromPtr = &debugShapes[i].m_pos.x();
-		const MT_Scalar *toPtr= &debugShapes[i].m_param.x();
-		glVertex3dv(fromPtr);
-		glVertex3dv(toPtr);
+		const MT_Vector3& from = debugShapes[i].m_pos;
+		const MT_Vector3& to = debugShapes[i].m_param;
+		glVertex3d(from.x(), from.y(), from.z());
+		glVertex3d(to.x(), to.y(), to.z());
 	}
 	glEnd();
 
@@ -415,8 +428,7 @@ void RAS_OpenGLRasterizer::FlushDebugShapes(SCA_IScene *scene)
 			MT_Vector3 pos(cos(theta) * rad, sin(theta) * rad, 0.0);
 			pos = pos*tr;
 			pos += debugShapes[i].m_pos;
-			const MT_Scalar* posPtr = &pos.x();
-			glVertex3dv(posPtr);
+			glVertex3d(pos.x(), pos.y(), pos.z());
 		}
 		glEnd();
 	}
@@ -913,7 +925,7 @@ void RAS_OpenGLRasterizer::SetViewMatrix(const MT_Matrix4x4 &mat,
 	glMatrixMode(GL_MODELVIEW);
 	glLoadMatrixf(glviewmat);
 #else
-	MT_Scalar glviewmat[16];
+	double glviewmat[16];
 	m_viewmatrix.getValue(glviewmat);
 
 	glMatrixMode(GL_MODELVIEW);
@@ -1117,6 +1129,31 @@ bool RAS_OpenGLRasterizer::GetUsingOverrideShader()
 	return m_usingoverrideshader;
 }
 
+void RAS_OpenGLRasterizer::SetSortMode(SortMode mode)
+{
+	m_sortmode = mode;
+}
+
+RAS_IRasterizer::SortMode RAS_OpenGLRasterizer::GetSortMode()
+{
+	return m_sortmode;
+}
+
+void RAS_OpenGLRasterizer::SetMeshBatching(bool enable)
+{
+	m_meshbatching = enable;
+}
+
+bool RAS_OpenGLRasterizer::GetMeshBatching()
+{
+	return m_meshbatching;
+}
+
+RAS_IRasterizer::FrameStats& RAS_OpenGLRasterizer::GetFrameStats()
+{
+	return m_stats;
+}
+
 /**
  * Render Tools
  */
@@ -111,6 +111,10 @@ class RAS_OpenGLRasterizer : public RAS_IRasterizer
 
 	bool m_usingoverrideshader;
 
+	SortMode m_sortmode;
+	bool m_meshbatching;
+	FrameStats m_stats;
+
 	/* Render tools */
 	void *m_clientobject;
 	void *m_auxilaryClientInfo;
@@ -288,6 +292,13 @@ public:
 	virtual void SetUsingOverrideShader(bool val);
 	virtual bool GetUsingOverrideShader();
 
+	virtual void SetSortMode(SortMode mode);
+	virtual SortMode GetSortMode();
+	virtual void SetMeshBatching(bool enable);
+	virtual bool GetMeshBatching();
+
+	virtual FrameStats& GetFrameStats();
+
 	/**
 	 * Render Tools
 	 */
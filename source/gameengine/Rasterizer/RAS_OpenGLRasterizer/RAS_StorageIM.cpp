@@ -306,5 +306,7 @@ void RAS_StorageIM::IndexPrimitivesInternal(RAS_MeshSlot& ms, bool multi)
 
 			glEnd();
 		}
+
+		it.array->ClearModified();
 	}
 }
@@ -107,6 +107,9 @@ void RAS_StorageVA::IndexPrimitives(RAS_MeshSlot& ms)
 
 		// here the actual drawing takes places
 		glDrawElements(drawmode, it.totindex, GL_UNSIGNED_SHORT, it.index);
+
+		// client arrays are read at draw time, nothing is left to upload
+		it.array->ClearModified();
 	}
 	
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -171,6 +174,9 @@ void RAS_StorageVA::IndexPrimitivesMulti(class RAS_MeshSlot& ms)
 
 		// here the actual drawing takes places
 		glDrawElements(drawmode, it.totindex, GL_UNSIGNED_SHORT, it.index);
+
+		// client arrays are read at draw time, nothing is left to upload
+		it.array->ClearModified();
 	}
 	
 	glDisableClientState(GL_VERTEX_ARRAY);
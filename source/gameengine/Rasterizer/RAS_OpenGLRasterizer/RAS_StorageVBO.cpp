@@ -30,75 +30,260 @@
 
 #include "glew-mx.h"
 
-VBO::VBO(RAS_DisplayArray *data, unsigned int indices)
+VBO::VBO(RAS_DisplayArray *data, unsigned int indices, const RAS_VertexFormat& format, bool dynamic)
+	:layout(format)
 {
+	RAS_VertexFormat vboformat = format;
+
 	this->data = data;
 	this->size = data->m_vertex.size();
 	this->indices = indices;
-	this->stride = sizeof(RAS_TexVert);
+	this->dynamic = dynamic;
+	this->stream_id = 0;
 
-	//	Determine drawmode
-	if (data->m_type == data->QUAD)
-		this->mode = GL_QUADS;
-	else if (data->m_type == data->TRIANGLE)
-		this->mode = GL_TRIANGLES;
-	else
-		this->mode = GL_LINE;
+	// Half float uvs when supported, UpdateData falls back to floats if they don't fit
+	if (GLEW_ARB_half_float_vertex)
+		vboformat.m_flag |= RAS_VertexFormat::HALF_UV;
+	SetLayout(vboformat);
 
 	// Generate Buffers
 	glGenBuffersARB(1, &this->ibo);
 	glGenBuffersARB(1, &this->vbo_id);
+	if (this->dynamic)
+		glGenBuffersARB(1, &this->stream_id);
 
 	// Fill the buffers with initial data
 	UpdateIndices();
 	UpdateData();
-
-	// Establish offsets
-	this->vertex_offset = (void*)(((RAS_TexVert*)0)->getXYZ());
-	this->normal_offset = (void*)(((RAS_TexVert*)0)->getNormal());
-	this->tangent_offset = (void*)(((RAS_TexVert*)0)->getTangent());
-	this->color_offset = (void*)(((RAS_TexVert*)0)->getRGBA());
-	this->uv_offset = (void*)(((RAS_TexVert*)0)->getUV(0));
 }
 
 VBO::~VBO()
 {
 	glDeleteBuffersARB(1, &this->ibo);
 	glDeleteBuffersARB(1, &this->vbo_id);
+	if (this->dynamic)
+		glDeleteBuffersARB(1, &this->stream_id);
 }
 
-void VBO::UpdateData()
+void VBO::SetLayout(const RAS_VertexFormat& format)
+{
+	const bool floatnormal = (format.m_flag & RAS_VertexFormat::FLOAT_NORMAL) != 0;
+
+	this->layout = RAS_VertexLayout(format, this->dynamic);
+	this->normal_type = floatnormal ? GL_FLOAT : GL_SHORT;
+	this->tangent_type = floatnormal ? GL_FLOAT : GL_SHORT;
+	this->uv_type = (format.m_flag & RAS_VertexFormat::HALF_UV) ? GL_HALF_FLOAT_ARB : GL_FLOAT;
+}
+
+void VBO::UploadStatic(unsigned int start, unsigned int end)
 {
+	const unsigned int stride = this->layout.m_stride;
+	const RAS_TexVert *vertex = &this->data->m_vertex[start];
+	unsigned char *dest;
+
 	glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
-	glBufferData(GL_ARRAY_BUFFER, this->stride*this->size, &this->data->m_vertex[0], GL_STATIC_DRAW);
+
+	if (start == 0 && end == this->size) {
+		// Pack straight into a new buffer, no copy of the vertices is kept around
+		glBufferData(GL_ARRAY_BUFFER, stride*this->size, NULL, GL_STATIC_DRAW);
+		dest = (unsigned char *)glMapBufferARB(GL_ARRAY_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+		if (dest) {
+			this->layout.Pack(vertex, this->size, dest);
+			glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+			return;
+		}
+	}
+
+	this->scratch.resize(stride*(end - start));
+	this->layout.Pack(vertex, end - start, &this->scratch[0]);
+	glBufferSubData(GL_ARRAY_BUFFER, stride*start, stride*(end - start), &this->scratch[0]);
+}
+
+void VBO::UploadStream(unsigned int start, unsigned int end)
+{
+	const unsigned int stride = this->layout.m_streamStride;
+	const RAS_TexVert *vertex = &this->data->m_vertex[start];
+	unsigned char *dest;
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->stream_id);
+
+	if (start == 0 && end == this->size) {
+		// Orphan the buffer so we don't wait for draws still using last frame's data
+		glBufferData(GL_ARRAY_BUFFER, stride*this->size, NULL, GL_STREAM_DRAW);
+		dest = (unsigned char *)glMapBufferARB(GL_ARRAY_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+		if (dest) {
+			this->layout.PackStream(vertex, this->size, dest);
+			glUnmapBufferARB(GL_ARRAY_BUFFER_ARB);
+			return;
+		}
+	}
+
+	this->scratch.resize(stride*(end - start));
+	this->layout.PackStream(vertex, end - start, &this->scratch[0]);
+	glBufferSubData(GL_ARRAY_BUFFER, stride*start, stride*(end - start), &this->scratch[0]);
+}
+
+void VBO::UpdateData()
+{
+	if ((this->layout.m_format.m_flag & RAS_VertexFormat::HALF_UV) &&
+	    !RAS_VertexLayout::UVFitsHalf(&this->data->m_vertex[0], this->size, this->layout.m_format.m_uvSize))
+	{
+		RAS_VertexFormat format = this->layout.m_format;
+		format.m_flag &= ~RAS_VertexFormat::HALF_UV;
+		SetLayout(format);
+	}
+
+	UploadStatic(0, this->size);
+	if (this->dynamic)
+		UploadStream(0, this->size);
+
+	this->data->ClearModified();
+}
+
+void VBO::UpdateModified()
+{
+	const short modified = this->data->m_modified;
+	unsigned int start, end;
+
+	if (!modified)
+		return;
+
+	// Sorted and batched arrays change their polygons, batches also their vertex count
+	if (modified & RAS_DisplayArray::INDEX_MODIFIED) {
+		this->indices = this->data->m_index.size();
+		UpdateIndices();
+	}
+	if (this->data->m_vertex.size() != this->size) {
+		this->size = this->data->m_vertex.size();
+		UpdateData();
+		return;
+	}
+	if (!(modified & RAS_DisplayArray::ALL_MODIFIED)) {
+		this->data->ClearModified();
+		return;
+	}
+
+	start = this->data->m_modifiedStart;
+	end = (this->data->m_modifiedEnd < this->size) ? this->data->m_modifiedEnd : this->size;
+
+	// Positions and normals of static arrays are interleaved with the rest
+	if (!this->dynamic || (modified & RAS_DisplayArray::ATTRIB_MODIFIED)) {
+		if ((this->layout.m_format.m_flag & RAS_VertexFormat::HALF_UV) &&
+		    !RAS_VertexLayout::UVFitsHalf(&this->data->m_vertex[start], end - start, this->layout.m_format.m_uvSize))
+		{
+			// needs a float layout, repack everything
+			UpdateData();
+			return;
+		}
+		UploadStatic(start, end);
+	}
+
+	if (this->dynamic && (modified & (RAS_DisplayArray::POSITION_MODIFIED | RAS_DisplayArray::NORMAL_MODIFIED)))
+		UploadStream(start, end);
+
+	this->data->ClearModified();
 }
 
 void VBO::UpdateIndices()
 {
+	//	Determine drawmode
+	if (data->m_type == data->QUAD)
+		this->mode = GL_QUADS;
+	else if (data->m_type == data->TRIANGLE)
+		this->mode = GL_TRIANGLES;
+	else
+		this->mode = GL_LINE;
+
 	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, this->ibo);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, data->m_index.size() * sizeof(GLushort),
 					&data->m_index[0], GL_STATIC_DRAW);
 }
 
+/* Vertex data the current material reads, see KX_BlenderMaterial::ActivateTexGen
+ * and BL_BlenderShader::SetAttribs */
+static RAS_VertexFormat required_format(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num, RAS_IRasterizer::TexCoGen* attrib, int *attrib_layer, bool multi)
+{
+	RAS_VertexFormat format;
+	int unit;
+
+	if (multi) {
+		for (unit = 0; unit < texco_num; ++unit) {
+			switch (texco[unit]) {
+				case RAS_IRasterizer::RAS_TEXCO_UV:
+					if (unit + 1 > format.m_uvSize)
+						format.m_uvSize = unit + 1;
+					break;
+				case RAS_IRasterizer::RAS_TEXCO_NORM:
+					format.m_flag |= RAS_VertexFormat::FLOAT_NORMAL;
+					break;
+				case RAS_IRasterizer::RAS_TEXTANGENT:
+					format.m_flag |= RAS_VertexFormat::FLOAT_NORMAL | RAS_VertexFormat::TANGENT;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	if (GLEW_ARB_vertex_program) {
+		for (unit = 0; unit < attrib_num; ++unit) {
+			switch (attrib[unit]) {
+				case RAS_IRasterizer::RAS_TEXCO_UV:
+					if (attrib_layer[unit] + 1 > format.m_uvSize)
+						format.m_uvSize = attrib_layer[unit] + 1;
+					break;
+				case RAS_IRasterizer::RAS_TEXTANGENT:
+					format.m_flag |= RAS_VertexFormat::TANGENT;
+					break;
+				default:
+					break;
+			}
+		}
+	}
+
+	return format;
+}
+
 void VBO::Draw(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num, RAS_IRasterizer::TexCoGen* attrib, int *attrib_layer, bool multi)
 {
+	RAS_VertexFormat format = required_format(texco_num, texco, attrib_num, attrib, attrib_layer, multi);
+	GLsizei stride;
 	int unit;
 
+	// Repack with a wider layout if the material reads data we left out
+	if (!this->layout.m_format.Contains(format)) {
+		format.Merge(this->layout.m_format);
+		SetLayout(format);
+		UpdateData();
+	}
+
+	stride = this->layout.m_stride;
+	// positions and normals come from the stream buffer of deformed arrays
+	const GLuint stream = this->dynamic ? this->stream_id : this->vbo_id;
+	const GLsizei streamstride = this->dynamic ? this->layout.m_streamStride : stride;
+	void *vertex_offset = (void*)(intptr_t)this->layout.m_xyz;
+	void *normal_offset = (void*)(intptr_t)this->layout.m_normal;
+	void *color_offset = (void*)(intptr_t)this->layout.m_color;
+	void *tangent_offset = (void*)(intptr_t)this->layout.m_tangent;
+	void *uv_offset = (void*)(intptr_t)this->layout.m_uv;
+
 	// Bind buffers
 	glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, this->ibo);
-	glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, stream);
 
 	// Vertexes
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, this->stride, this->vertex_offset);
+	glVertexPointer(3, GL_FLOAT, streamstride, vertex_offset);
 
 	// Normals
 	glEnableClientState(GL_NORMAL_ARRAY);
-	glNormalPointer(GL_FLOAT, this->stride, this->normal_offset);
+	glNormalPointer(this->normal_type, streamstride, normal_offset);
+
+	glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
 
 	// Colors
 	glEnableClientState(GL_COLOR_ARRAY);
-	glColorPointer(4, GL_UNSIGNED_BYTE, this->stride, this->color_offset);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, color_offset);
 
 	if (multi)
 	{
@@ -109,19 +294,23 @@ void VBO::Draw(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num,
 				case RAS_IRasterizer::RAS_TEXCO_ORCO:
 				case RAS_IRasterizer::RAS_TEXCO_GLOB:
 					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-					glTexCoordPointer(3, GL_FLOAT, this->stride, this->vertex_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, stream);
+					glTexCoordPointer(3, GL_FLOAT, streamstride, vertex_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
 					break;
 				case RAS_IRasterizer::RAS_TEXCO_UV:
 					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-					glTexCoordPointer(2, GL_FLOAT, this->stride, (void*)((intptr_t)this->uv_offset+(sizeof(GLfloat)*2*unit)));
+					glTexCoordPointer(2, this->uv_type, stride, (void*)((intptr_t)uv_offset+this->layout.m_uvStride*unit));
 					break;
 				case RAS_IRasterizer::RAS_TEXCO_NORM:
 					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-					glTexCoordPointer(3, GL_FLOAT, this->stride, this->normal_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, stream);
+					glTexCoordPointer(3, GL_FLOAT, streamstride, normal_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
 					break;
 				case RAS_IRasterizer::RAS_TEXTANGENT:
 					glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-					glTexCoordPointer(4, GL_FLOAT, this->stride, this->tangent_offset);
+					glTexCoordPointer(4, GL_FLOAT, stride, tangent_offset);
 					break;
 				default:
 					break;
@@ -133,7 +322,7 @@ void VBO::Draw(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num,
 	{
 		glClientActiveTextureARB(GL_TEXTURE0_ARB);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, this->stride, this->uv_offset);
+		glTexCoordPointer(2, this->uv_type, stride, uv_offset);
 	}
 
 	if (GLEW_ARB_vertex_program)
@@ -143,19 +332,23 @@ void VBO::Draw(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num,
 			switch (attrib[unit]) {
 				case RAS_IRasterizer::RAS_TEXCO_ORCO:
 				case RAS_IRasterizer::RAS_TEXCO_GLOB:
-					glVertexAttribPointerARB(unit, 3, GL_FLOAT, GL_FALSE, this->stride, this->vertex_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, stream);
+					glVertexAttribPointerARB(unit, 3, GL_FLOAT, GL_FALSE, streamstride, vertex_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
 					glEnableVertexAttribArrayARB(unit);
 					break;
 				case RAS_IRasterizer::RAS_TEXCO_UV:
-					glVertexAttribPointerARB(unit, 2, GL_FLOAT, GL_FALSE, this->stride, (void*)((intptr_t)this->uv_offset+attrib_layer[unit]*sizeof(GLfloat)*2));
+					glVertexAttribPointerARB(unit, 2, this->uv_type, GL_FALSE, stride, (void*)((intptr_t)uv_offset+attrib_layer[unit]*this->layout.m_uvStride));
 					glEnableVertexAttribArrayARB(unit);
 					break;
 				case RAS_IRasterizer::RAS_TEXCO_NORM:
-					glVertexAttribPointerARB(unit, 2, GL_FLOAT, GL_FALSE, stride, this->normal_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, stream);
+					glVertexAttribPointerARB(unit, 3, this->normal_type, GL_TRUE, streamstride, normal_offset);
+					glBindBufferARB(GL_ARRAY_BUFFER_ARB, this->vbo_id);
 					glEnableVertexAttribArrayARB(unit);
 					break;
 				case RAS_IRasterizer::RAS_TEXTANGENT:
-					glVertexAttribPointerARB(unit, 4, GL_FLOAT, GL_FALSE, this->stride, this->tangent_offset);
+					glVertexAttribPointerARB(unit, 4, this->tangent_type, GL_TRUE, stride, tangent_offset);
 					glEnableVertexAttribArrayARB(unit);
 					break;
 				default:
@@ -225,13 +418,10 @@ void RAS_StorageVBO::IndexPrimitivesInternal(RAS_MeshSlot& ms, bool multi)
 		vbo = m_vbo_lookup[it.array];
 
 		if (vbo == 0)
-			m_vbo_lookup[it.array] = vbo = new VBO(it.array, it.totindex);
+			m_vbo_lookup[it.array] = vbo = new VBO(it.array, it.totindex, ms.m_bucket->GetVertexFormat(), ms.m_pDeformer != NULL || ms.m_bBatch);
 
-		// Update the vbo
-		if (ms.m_mesh->MeshModified())
-		{
-			vbo->UpdateData();
-		}
+		// Upload what deformers or python changed, static arrays are left alone
+		vbo->UpdateModified();
 
 		vbo->Draw(*m_texco_num, m_texco, *m_attrib_num, m_attrib, m_attrib_layer, multi);
 	}
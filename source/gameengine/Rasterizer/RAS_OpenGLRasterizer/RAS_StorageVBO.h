@@ -29,37 +29,48 @@
 #define __KX_VERTEXBUFFEROBJECTSTORAGE
 
 #include <map>
+#include <vector>
 #include "glew-mx.h"
 
 #include "RAS_IStorage.h"
 #include "RAS_IRasterizer.h"
+#include "RAS_VertexFormat.h"
 
 #include "RAS_OpenGLRasterizer.h"
 
 class VBO
 {
 public:
-	VBO(RAS_DisplayArray *data, unsigned int indices);
+	VBO(RAS_DisplayArray *data, unsigned int indices, const RAS_VertexFormat& format, bool dynamic);
 	~VBO();
 
 	void	Draw(int texco_num, RAS_IRasterizer::TexCoGen* texco, int attrib_num, RAS_IRasterizer::TexCoGen* attrib, int *attrib_layer, bool multi);
 
 	void	UpdateData();
+	void	UpdateModified();
 	void	UpdateIndices();
 private:
 	RAS_DisplayArray*	data;
 	GLuint			size;
-	GLuint			stride;
 	GLuint			indices;
 	GLenum			mode;
 	GLuint			ibo;
 	GLuint			vbo_id;
 
-	void*			vertex_offset;
-	void*			normal_offset;
-	void*			color_offset;
-	void*			tangent_offset;
-	void*			uv_offset;
+	/* deformed arrays keep positions and normals in their own GL_STREAM_DRAW buffer */
+	bool			dynamic;
+	GLuint			stream_id;
+	std::vector<unsigned char>	scratch;
+
+	/* packed vertex layout, widened when a material reads more than the converter expected */
+	RAS_VertexLayout	layout;
+	GLenum			normal_type;
+	GLenum			uv_type;
+	GLenum			tangent_type;
+
+	void	SetLayout(const RAS_VertexFormat& format);
+	void	UploadStatic(unsigned int start, unsigned int end);
+	void	UploadStream(unsigned int start, unsigned int end);
 };
 
 class RAS_StorageVBO : public RAS_IStorage
@@ -34,27 +34,26 @@
 #include "MT_Matrix4x4.h"
 #include "BLI_math.h"
 
-RAS_TexVert::RAS_TexVert(const MT_Point3& xyz,
-                         const MT_Point2 uvs[MAX_UNIT],
-                         const MT_Vector4& tangent,
+#include <string.h>
+
+RAS_TexVert::RAS_TexVert(const float xyz[3],
+                         const float uvs[MAX_UNIT][2],
+                         const float tangent[4],
                          const unsigned int rgba,
-                         const MT_Vector3& normal,
+                         const float normal[3],
                          const bool flat,
                          const unsigned int origindex)
 {
-	xyz.getValue(m_localxyz);
+	copy_v3_v3(m_localxyz, xyz);
 	SetRGBA(rgba);
-	SetNormal(normal);
-	tangent.getValue(m_tangent);
+	copy_v3_v3(m_normal, normal);
+	copy_v4_v4(m_tangent, tangent);
 	m_flag = (flat) ? FLAT: 0;
 	m_origindex = origindex;
 	m_unit = 2;
 	m_softBodyIndex = -1;
 
-	for (int i = 0; i < MAX_UNIT; ++i)
-	{
-		uvs[i].getValue(m_uvs[i]);
-	}
+	memcpy(m_uvs, uvs, sizeof(m_uvs));
 }
 
 const MT_Point3& RAS_TexVert::xyz()
@@ -140,6 +139,30 @@ bool RAS_TexVert::closeTo(const RAS_TexVert* other)
 	        );
 }
 
+static inline unsigned int close_to_key_add(unsigned int key, float value)
+{
+	/* grid of 1/1024, adding 0 turns -0 into 0 */
+	union { float f; unsigned int i; } cell;
+	cell.f = floorf(value * 1024.0f + 0.5f) + 0.0f;
+	return (key ^ cell.i) * 16777619u;
+}
+
+unsigned int RAS_TexVert::closeToKey() const
+{
+	unsigned int key = 2166136261u ^ m_rgba;
+
+	for (int i = 0; i < MAX_UNIT; i++) {
+		key = close_to_key_add(key, m_uvs[i][0]);
+		key = close_to_key_add(key, m_uvs[i][1]);
+	}
+	for (int i = 0; i < 3; i++) {
+		key = close_to_key_add(key, m_normal[i]);
+		key = close_to_key_add(key, m_tangent[i]);
+	}
+
+	return key;
+}
+
 short RAS_TexVert::getFlag() const
 {
 	return m_flag;
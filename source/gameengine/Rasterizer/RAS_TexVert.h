@@ -72,11 +72,11 @@ public:
 	
 	RAS_TexVert()// :m_xyz(0,0,0),m_uv(0,0),m_rgba(0)
 	{}
-	RAS_TexVert(const MT_Point3& xyz,
-				const MT_Point2 uvs[MAX_UNIT],
-				const MT_Vector4& tangent,
+	RAS_TexVert(const float xyz[3],
+				const float uvs[MAX_UNIT][2],
+				const float tangent[4],
 				const unsigned int rgba,
-				const MT_Vector3& normal,
+				const float normal[3],
 				const bool flat,
 				const unsigned int origindex);
 	~RAS_TexVert() {};
@@ -136,6 +136,9 @@ public:
 	// compare two vertices, to test if they can be shared, used for
 	// splitting up based on uv's, colors, etc
 	bool				closeTo(const RAS_TexVert* other);
+	// hash of the attributes compared by closeTo, rounded so that close
+	// vertices nearly always get the same key
+	unsigned int		closeToKey() const;
 
 
 #ifdef WITH_CXX_GUARDEDALLOC
@@ -0,0 +1,188 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/Rasterizer/RAS_VertexFormat.cpp
+ *  \ingroup bgerast
+ */
+
+#include "RAS_VertexFormat.h"
+
+#include <string.h>
+#include <math.h>
+
+/* Past 1.0 the spacing of half floats is bigger than 1/2048,
+ * half a texel of a 1024 texture, so keep those uvs in floats. */
+#define RAS_HALF_UV_RANGE 1.0f
+
+void RAS_VertexFormat::Merge(const RAS_VertexFormat& other)
+{
+	if (other.m_uvSize > m_uvSize)
+		m_uvSize = other.m_uvSize;
+	m_flag |= other.m_flag;
+}
+
+bool RAS_VertexFormat::Contains(const RAS_VertexFormat& other) const
+{
+	const unsigned char flag = other.m_flag & ~HALF_UV;
+	return (m_uvSize >= other.m_uvSize) && ((m_flag & flag) == flag);
+}
+
+RAS_VertexLayout::RAS_VertexLayout(const RAS_VertexFormat& format, bool split)
+	:m_format(format)
+{
+	const bool floatnormal = (format.m_flag & RAS_VertexFormat::FLOAT_NORMAL) != 0;
+	const unsigned int normalsize = floatnormal ? sizeof(float) * 3 : sizeof(short) * 4;
+
+	if (m_format.m_uvSize > RAS_TexVert::MAX_UNIT)
+		m_format.m_uvSize = RAS_TexVert::MAX_UNIT;
+
+	m_xyz = 0;
+	m_normal = m_xyz + sizeof(float) * 3;
+	if (split) {
+		m_streamStride = m_normal + normalsize;
+		m_color = 0;
+	}
+	else {
+		m_streamStride = 0;
+		m_color = m_normal + normalsize;
+	}
+	m_uv = m_color + sizeof(unsigned int);
+	m_uvStride = (format.m_flag & RAS_VertexFormat::HALF_UV) ? sizeof(short) * 2 : sizeof(float) * 2;
+	m_tangent = m_uv + m_uvStride * m_format.m_uvSize;
+	m_stride = m_tangent;
+	if (format.m_flag & RAS_VertexFormat::TANGENT)
+		m_stride += floatnormal ? sizeof(float) * 4 : sizeof(short) * 4;
+}
+
+static unsigned short float_to_half(float f)
+{
+	union { float f; unsigned int i; } v;
+	v.f = f;
+
+	const unsigned short sign = (v.i >> 16) & 0x8000;
+	int exponent = (int)((v.i >> 23) & 0xff) - 127 + 15;
+	unsigned int mantissa = v.i & 0x7fffff;
+
+	/* too small for a normalized half, flush to zero */
+	if (exponent <= 0)
+		return sign;
+	/* round to nearest */
+	mantissa += 0x1000;
+	if (mantissa & 0x800000) {
+		mantissa = 0;
+		exponent++;
+	}
+	if (exponent >= 31)
+		return sign | 0x7c00;
+
+	return sign | (exponent << 10) | (mantissa >> 13);
+}
+
+static short quantize_unit(float f)
+{
+	if (f >= 1.0f)
+		return 32767;
+	if (f <= -1.0f)
+		return -32767;
+	return (short)floorf(f * 32767.0f + 0.5f);
+}
+
+bool RAS_VertexLayout::UVFitsHalf(const RAS_TexVert *src, unsigned int num, unsigned int uvSize)
+{
+	for (unsigned int i = 0; i < num; ++i) {
+		for (unsigned int unit = 0; unit < uvSize; ++unit) {
+			const float *uv = src[i].getUV(unit);
+			if (fabsf(uv[0]) > RAS_HALF_UV_RANGE || fabsf(uv[1]) > RAS_HALF_UV_RANGE)
+				return false;
+		}
+	}
+	return true;
+}
+
+bool RAS_VertexLayout::Pack(const RAS_TexVert *src, unsigned int num, unsigned char *dest) const
+{
+	const bool floatnormal = (m_format.m_flag & RAS_VertexFormat::FLOAT_NORMAL) != 0;
+	const bool halfuv = (m_format.m_flag & RAS_VertexFormat::HALF_UV) != 0;
+	const bool tangent = (m_format.m_flag & RAS_VertexFormat::TANGENT) != 0;
+
+	if (halfuv && !UVFitsHalf(src, num, m_format.m_uvSize))
+		return false;
+
+	if (m_streamStride == 0)
+		PackStream(src, num, dest);
+
+	for (unsigned int i = 0; i < num; ++i, dest += m_stride) {
+		const RAS_TexVert& tv = src[i];
+
+		memcpy(dest + m_color, tv.getRGBA(), sizeof(unsigned int));
+
+		for (unsigned int unit = 0; unit < m_format.m_uvSize; ++unit) {
+			const float *uv = tv.getUV(unit);
+			unsigned char *uvdest = dest + m_uv + unit * m_uvStride;
+			if (halfuv) {
+				((unsigned short *)uvdest)[0] = float_to_half(uv[0]);
+				((unsigned short *)uvdest)[1] = float_to_half(uv[1]);
+			}
+			else {
+				memcpy(uvdest, uv, sizeof(float) * 2);
+			}
+		}
+
+		if (tangent) {
+			if (floatnormal) {
+				memcpy(dest + m_tangent, tv.getTangent(), sizeof(float) * 4);
+			}
+			else {
+				short *tan = (short *)(dest + m_tangent);
+				tan[0] = quantize_unit(tv.getTangent()[0]);
+				tan[1] = quantize_unit(tv.getTangent()[1]);
+				tan[2] = quantize_unit(tv.getTangent()[2]);
+				tan[3] = quantize_unit(tv.getTangent()[3]);
+			}
+		}
+	}
+
+	return true;
+}
+
+void RAS_VertexLayout::PackStream(const RAS_TexVert *src, unsigned int num, unsigned char *dest) const
+{
+	const bool floatnormal = (m_format.m_flag & RAS_VertexFormat::FLOAT_NORMAL) != 0;
+	const unsigned int stride = m_streamStride ? m_streamStride : m_stride;
+
+	for (unsigned int i = 0; i < num; ++i, dest += stride) {
+		const RAS_TexVert& tv = src[i];
+
+		memcpy(dest + m_xyz, tv.getXYZ(), sizeof(float) * 3);
+
+		if (floatnormal) {
+			memcpy(dest + m_normal, tv.getNormal(), sizeof(float) * 3);
+		}
+		else {
+			short *no = (short *)(dest + m_normal);
+			no[0] = quantize_unit(tv.getNormal()[0]);
+			no[1] = quantize_unit(tv.getNormal()[1]);
+			no[2] = quantize_unit(tv.getNormal()[2]);
+			no[3] = 0;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file RAS_VertexFormat.h
+ *  \ingroup bgerast
+ */
+
+#ifndef __RAS_VERTEXFORMAT_H__
+#define __RAS_VERTEXFORMAT_H__
+
+#include "RAS_TexVert.h"
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+/**
+ * Describes which parts of a RAS_TexVert a material actually reads.
+ * The converter fills it in per material bucket, storages use it to
+ * upload a packed vertex instead of the full 128 bytes RAS_TexVert.
+ */
+class RAS_VertexFormat
+{
+public:
+	enum {
+		TANGENT = 1,		/* tangents are read */
+		FLOAT_NORMAL = 2,	/* normals or tangents are read as texture coordinates, don't quantize them */
+		HALF_UV = 4			/* uvs fit in half floats */
+	};
+
+	unsigned char m_uvSize;	/* number of uv layers used */
+	unsigned char m_flag;
+
+	RAS_VertexFormat()
+		:m_uvSize(1),
+		m_flag(0)
+	{
+	}
+
+	void Merge(const RAS_VertexFormat& other);
+	/// True when this format holds everything 'other' needs, the HALF_UV flag is ignored.
+	bool Contains(const RAS_VertexFormat& other) const;
+};
+
+/**
+ * Byte layout of a packed vertex built from a RAS_VertexFormat:
+ * float position, short normal (or float with FLOAT_NORMAL), byte color,
+ * float or half float uvs and optionally a short (or float) tangent.
+ *
+ * A split layout keeps position and normal in a separate stream so
+ * deformed meshes only upload what the deformer changes.
+ */
+class RAS_VertexLayout
+{
+public:
+	RAS_VertexFormat m_format;
+	unsigned int m_stride;
+	unsigned int m_streamStride;	/* position and normal stride of a split layout, 0 otherwise */
+	unsigned int m_xyz;
+	unsigned int m_normal;
+	unsigned int m_color;
+	unsigned int m_uv;
+	unsigned int m_uvStride;	/* size in bytes of one uv layer */
+	unsigned int m_tangent;
+
+	RAS_VertexLayout(const RAS_VertexFormat& format, bool split = false);
+
+	/**
+	 * Pack num vertices into dest, which must hold num * m_stride bytes,
+	 * positions and normals are left out for split layouts.
+	 * Returns false when the layout uses half float uvs and a uv doesn't
+	 * fit in one, the caller should then drop HALF_UV and pack again.
+	 */
+	bool Pack(const RAS_TexVert *src, unsigned int num, unsigned char *dest) const;
+
+	/// Pack positions and normals of a split layout, dest must hold num * m_streamStride bytes.
+	void PackStream(const RAS_TexVert *src, unsigned int num, unsigned char *dest) const;
+
+	/// True if all uvs of the used layers can be stored in half floats without visible loss.
+	static bool UVFitsHalf(const RAS_TexVert *src, unsigned int num, unsigned int uvSize);
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:RAS_VertexLayout")
+#endif
+};
+
+#endif  /* __RAS_VERTEXFORMAT_H__ */
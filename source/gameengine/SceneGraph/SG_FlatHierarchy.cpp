@@ -0,0 +1,267 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/SceneGraph/SG_FlatHierarchy.cpp
+ *  \ingroup bgesg
+ */
+
+#include "SG_FlatHierarchy.h"
+#include "SG_Node.h"
+#include "SG_ParentRelation.h"
+#include "SG_TransformStore.h"
+
+#include "atomic_ops.h"
+
+/* a node updated by the recursion costs about as much as FLAT_SPARSE_RATIO nodes skipped by the sweep */
+#define FLAT_SPARSE_RATIO 32
+
+SG_FlatHierarchy::SG_FlatHierarchy()
+	:m_version(0),
+	m_builtVersion((uint32_t)-1),
+	m_numUpdated(0)
+{
+}
+
+SG_FlatHierarchy::~SG_FlatHierarchy()
+{
+	Clear();
+}
+
+void SG_FlatHierarchy::Invalidate()
+{
+	atomic_add_uint32(&m_version, 1);
+}
+
+void SG_FlatHierarchy::RemoveNode(int index)
+{
+	m_nodes[index] = NULL;
+	Invalidate();
+}
+
+bool SG_FlatHierarchy::IsOutdated() const
+{
+	return m_builtVersion != atomic_add_uint32((uint32_t *)&m_version, 0);
+}
+
+void SG_FlatHierarchy::Clear()
+{
+	// the deleted nodes left their entry empty
+	for (std::vector<SG_Node *>::iterator it = m_nodes.begin(); it != m_nodes.end(); ++it) {
+		if (*it && (*it)->m_flatHierarchy == this) {
+			(*it)->m_flatHierarchy = NULL;
+			(*it)->m_flatIndex = -1;
+		}
+	}
+
+	m_nodes.clear();
+	m_parents.clear();
+}
+
+void SG_FlatHierarchy::Build(const std::vector<SG_Node *>& roots)
+{
+	Clear();
+
+	m_builtVersion = atomic_add_uint32(&m_version, 0);
+
+	for (std::vector<SG_Node *>::const_iterator it = roots.begin(); it != roots.end(); ++it) {
+		m_nodes.push_back(*it);
+		m_parents.push_back(-1);
+	}
+
+	// the array is its own queue, so each depth follows the previous one
+	for (size_t i = 0; i < m_nodes.size(); ++i) {
+		const NodeList& children = m_nodes[i]->GetSGChildren();
+
+		for (NodeList::const_iterator it = children.begin(); it != children.end(); ++it) {
+			m_nodes.push_back(*it);
+			m_parents.push_back((int)i);
+		}
+	}
+
+	const size_t size = m_nodes.size();
+	m_pages.resize(size);
+	m_slots.resize(size);
+	m_flags.resize(size);
+	m_subtrees.assign(size, 1);
+
+	for (size_t i = size; i-- > 0;) {
+		if (m_parents[i] >= 0)
+			m_subtrees[m_parents[i]] += m_subtrees[i];
+	}
+
+	for (size_t i = 0; i < size; ++i) {
+		SG_Node *node = m_nodes[i];
+		SG_ParentRelation *relation = node->GetParentRelation();
+
+		// a node gathered by another hierarchy, like a merged scene, leaves it
+		if (node->m_flatHierarchy && node->m_flatHierarchy != this)
+			node->m_flatHierarchy->RemoveNode(node->m_flatIndex);
+		node->m_flatHierarchy = this;
+		node->m_flatIndex = (int)i;
+		m_pages[i] = node->m_transforms;
+		m_slots[i] = node->m_slot;
+		m_flags[i] = 0;
+
+		// a root with a parent outside of the arrays can't be computed by the sweep
+		if (relation && relation->IsNormalRelation() && node->GetSGControllerList().empty() &&
+		    (m_parents[i] >= 0 || !node->GetSGParent()))
+		{
+			m_flags[i] |= FLAT_NORMAL;
+		}
+	}
+}
+
+/**
+ * Same as KX_NormalParentRelation::UpdateChildCoordinates on the arrays.
+ * The products are written out, the MoTo operators aren't inlined.
+ */
+bool SG_FlatHierarchy::UpdateNormal(int index, bool& parentUpdated)
+{
+	SG_TransformPage *page = m_pages[index];
+	const unsigned int slot = m_slots[index];
+
+	if (!parentUpdated && !page->m_modified[slot])
+		return false;
+
+	parentUpdated = true;
+
+	const int parent = m_parents[index];
+
+	if (parent < 0) {
+		page->m_worldPosition[slot] = page->m_localPosition[slot];
+		page->m_worldScaling[slot] = page->m_localScaling[slot];
+		page->m_worldRotation[slot] = page->m_localRotation[slot];
+	}
+	else {
+		const SG_TransformPage *ppage = m_pages[parent];
+		const unsigned int pslot = m_slots[parent];
+		const MT_Vector3& p_world_scale = ppage->m_worldScaling[pslot];
+		const MT_Point3& p_world_pos = ppage->m_worldPosition[pslot];
+		const MT_Matrix3x3& p_world_rotation = ppage->m_worldRotation[pslot];
+		const MT_Point3& position = page->m_localPosition[slot];
+		const MT_Matrix3x3& rotation = page->m_localRotation[slot];
+		const MT_Vector3& scaling = page->m_localScaling[slot];
+		MT_Point3& world_position = page->m_worldPosition[slot];
+		MT_Matrix3x3& world_rotation = page->m_worldRotation[slot];
+		MT_Vector3& world_scaling = page->m_worldScaling[slot];
+
+		for (int i = 0; i < 3; i++) {
+			const MT_Vector3& row = p_world_rotation[i];
+
+			world_scaling[i] = p_world_scale[i] * scaling[i];
+			world_rotation[i][0] = row[0] * rotation[0][0] + row[1] * rotation[1][0] + row[2] * rotation[2][0];
+			world_rotation[i][1] = row[0] * rotation[0][1] + row[1] * rotation[1][1] + row[2] * rotation[2][1];
+			world_rotation[i][2] = row[0] * rotation[0][2] + row[1] * rotation[1][2] + row[2] * rotation[2][2];
+			world_position[i] = p_world_pos[i] + p_world_scale[i] *
+			                    (row[0] * position[0] + row[1] * position[1] + row[2] * position[2]);
+		}
+	}
+
+	page->m_modified[slot] = false;
+	page->m_ogldirty[slot] = true;
+	return true;
+}
+
+void SG_FlatHierarchy::UpdateScheduled(SG_QList& head, double time)
+{
+	const size_t size = m_nodes.size();
+	SG_Node *node;
+
+	size_t visits = 0;
+
+	m_numUpdated = 0;
+
+	while ((node = SG_Node::GetNextScheduled(head)) != NULL) {
+		const int index = node->m_flatIndex;
+
+		if (node->m_flatHierarchy == this) {
+			m_scheduled.push_back(index);
+			visits += m_subtrees[index];
+		}
+		else {
+			m_fallback.push_back(node);
+		}
+	}
+
+	if (visits * FLAT_SPARSE_RATIO < size) {
+		for (std::vector<int>::iterator it = m_scheduled.begin(); it != m_scheduled.end(); ++it)
+			m_fallback.push_back(m_nodes[*it]);
+		m_scheduled.clear();
+	}
+
+	for (std::vector<int>::iterator it = m_scheduled.begin(); it != m_scheduled.end(); ++it)
+		m_flags[*it] |= FLAT_SCHEDULED;
+
+	for (size_t i = 0; (i < size) && !m_scheduled.empty(); ++i) {
+		unsigned char flags = m_flags[i];
+		const int parent = m_parents[i];
+		bool parentUpdated = false;
+		bool visit = (flags & FLAT_SCHEDULED) != 0;
+
+		if (parent >= 0 && (m_flags[parent] & FLAT_VISITED)) {
+			visit = true;
+			parentUpdated = (m_flags[parent] & FLAT_UPDATED) != 0;
+		}
+
+		flags &= ~(FLAT_SCHEDULED | FLAT_VISITED | FLAT_UPDATED);
+
+		if (visit) {
+			bool updated;
+
+			node = m_nodes[i];
+			flags |= FLAT_VISITED;
+
+			if (flags & FLAT_NORMAL) {
+				updated = UpdateNormal(i, parentUpdated);
+			}
+			else {
+				updated = node->UpdateSpatialData(node->GetSGParent(), time, parentUpdated);
+				// scheduled again by a callback of a node updated before
+				node->Delink();
+			}
+
+			if (updated) {
+				node->ActivateUpdateTransformCallback();
+				m_numUpdated++;
+			}
+
+			if (parentUpdated)
+				flags |= FLAT_UPDATED;
+		}
+
+		m_flags[i] = flags;
+	}
+
+	m_scheduled.clear();
+
+	for (std::vector<SG_Node *>::iterator it = m_fallback.begin(); it != m_fallback.end(); ++it)
+		(*it)->UpdateWorldData(time);
+	m_fallback.clear();
+
+	while ((node = SG_Node::GetNextScheduled(head)) != NULL)
+		node->UpdateWorldData(time);
+}
@@ -0,0 +1,143 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SG_FlatHierarchy.h
+ *  \ingroup bgesg
+ */
+
+#ifndef __SG_FLATHIERARCHY_H__
+#define __SG_FLATHIERARCHY_H__
+
+#include "SG_QList.h"
+#include <vector>
+
+#include <stdint.h>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+class SG_Node;
+struct SG_TransformPage;
+
+/**
+ * Transform update of a scene without recursion.
+ * The nodes of the hierarchies are kept in arrays ordered by depth, each
+ * entry holding the index of its parent entry and the slot of its transforms
+ * in SG_TransformStore. An update marks the scheduled nodes then sweeps the
+ * arrays once: an entry is visited when it is scheduled or its parent was,
+ * and the world transforms of the nodes with a normal parent relation and
+ * no controller are computed in place. The other nodes go through their
+ * parent relation, as in SG_Node::UpdateWorldData.
+ * The arrays are built again after a change of the gathered nodes. Nodes
+ * created since, like the spawned objects, don't change them: they are
+ * updated recursively until a change of the arrays gathers them.
+ */
+class SG_FlatHierarchy
+{
+public:
+	SG_FlatHierarchy();
+	~SG_FlatHierarchy();
+
+	/**
+	 * Tell the flat hierarchy that one of its nodes was removed or changed
+	 * parent, relation or children. Can be called from any thread.
+	 */
+	void Invalidate();
+
+	/**
+	 * Drop the entry of a deleted node, the arrays are outdated.
+	 */
+	void RemoveNode(int index);
+
+	/// True if the gathered nodes changed since the last Build.
+	bool IsOutdated() const;
+
+	/**
+	 * Gather the nodes of the hierarchies starting at roots.
+	 */
+	void Build(const std::vector<SG_Node *>& roots);
+
+	/**
+	 * Update the nodes scheduled in head and their children. The scheduled
+	 * nodes that were not gathered by the last Build and the nodes scheduled
+	 * by the update callbacks are updated recursively after the sweep.
+	 * When the scheduled nodes have few children they are updated
+	 * recursively, the sweep would cost more. The list is empty on return.
+	 */
+	void UpdateScheduled(SG_QList& head, double time);
+
+	/// Number of gathered nodes.
+	unsigned int GetNumNodes() const
+	{
+		return m_nodes.size();
+	}
+
+	/// Number of nodes whose world transform changed in the last sweep.
+	unsigned int GetNumUpdated() const
+	{
+		return m_numUpdated;
+	}
+
+private:
+	enum {
+		FLAT_SCHEDULED = (1 << 0),	/* the node was in the update list */
+		FLAT_VISITED = (1 << 1),	/* the node was updated by the current sweep */
+		FLAT_UPDATED = (1 << 2),	/* the world transform changed, children must follow */
+		FLAT_NORMAL = (1 << 3),		/* normal parent relation, computed by the sweep */
+	};
+
+	std::vector<SG_Node *> m_nodes;
+	std::vector<int> m_parents;
+	std::vector<SG_TransformPage *> m_pages;
+	std::vector<unsigned int> m_slots;
+	std::vector<unsigned char> m_flags;
+	/* number of nodes in the hierarchy of each entry */
+	std::vector<unsigned int> m_subtrees;
+
+	/* scheduled entries of the current update */
+	std::vector<int> m_scheduled;
+	/* scheduled nodes missing from the arrays or updated recursively */
+	std::vector<SG_Node *> m_fallback;
+
+	/* changed by any change of the gathered nodes */
+	uint32_t m_version;
+	uint32_t m_builtVersion;
+	unsigned int m_numUpdated;
+
+	bool UpdateNormal(int index, bool& parentUpdated);
+
+	/// Forget the gathered nodes, they no longer invalidate this hierarchy.
+	void Clear();
+
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:SG_FlatHierarchy")
+#endif
+};
+
+#endif  /* __SG_FLATHIERARCHY_H__ */
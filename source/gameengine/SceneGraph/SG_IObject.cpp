@@ -32,6 +32,7 @@
 
 #include "SG_IObject.h"
 #include "SG_Controller.h"
+#include "SG_FlatHierarchy.h"
 
 #include <algorithm>
 
@@ -45,7 +46,9 @@ SG_IObject(
 ): 
 	SG_QList(),
 	m_SGclientObject(clientobj),
-	m_SGclientInfo(clientinfo)
+	m_SGclientInfo(clientinfo),
+	m_flatHierarchy(NULL),
+	m_flatIndex(-1)
 {
 	m_callbacks = callbacks;
 }
@@ -57,7 +60,9 @@ SG_IObject(
 	SG_QList(),
 	m_SGclientObject(other.m_SGclientObject),
 	m_SGclientInfo(other.m_SGclientInfo),
-	m_callbacks(other.m_callbacks) 
+	m_callbacks(other.m_callbacks),
+	m_flatHierarchy(NULL),
+	m_flatIndex(-1) 
 {
 	//nothing to do
 }
@@ -68,6 +73,7 @@ AddSGController(
 	SG_Controller* cont
 ) {
 	m_SGcontrollers.push_back(cont);
+	InvalidateFlatHierarchy();
 }
 
 	void
@@ -78,6 +84,7 @@ RemoveSGController(
 	SGControllerList::iterator contit;
 
 	m_SGcontrollers.erase(std::remove(m_SGcontrollers.begin(), m_SGcontrollers.end(), cont));
+	InvalidateFlatHierarchy();
 }
 
 	void
@@ -85,6 +92,13 @@ SG_IObject::
 RemoveAllControllers(
 ) { 
 	m_SGcontrollers.clear(); 
+	InvalidateFlatHierarchy();
+}
+
+void SG_IObject::InvalidateFlatHierarchy()
+{
+	if (m_flatHierarchy)
+		m_flatHierarchy->Invalidate();
 }
 
 void SG_IObject::SetControllerTime(double time)
@@ -104,6 +118,9 @@ SG_IObject::
 {
 	SGControllerList::iterator contit;
 
+	if (m_flatHierarchy)
+		m_flatHierarchy->RemoveNode(m_flatIndex);
+
 	for (contit = m_SGcontrollers.begin();contit!=m_SGcontrollers.end();++contit)
 	{
 		delete (*contit);
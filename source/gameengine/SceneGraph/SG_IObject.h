@@ -68,6 +68,7 @@ inline void SG_SetActiveStage(SG_Stage stage)
 
 class SG_Controller;
 class SG_IObject;
+class SG_FlatHierarchy;
 
 typedef std::vector<SG_Controller*> SGControllerList;
 
@@ -163,6 +164,15 @@ private :
 	SG_Callbacks m_callbacks;
 	SGControllerList	m_SGcontrollers;
 
+	/**
+	 * The SG_FlatHierarchy that last gathered this object and the index
+	 * of the object in its arrays, NULL and -1 if none
+	 */
+	SG_FlatHierarchy *m_flatHierarchy;
+	int m_flatIndex;
+
+	friend class SG_FlatHierarchy;
+
 public:
 	virtual ~SG_IObject();
 
@@ -365,6 +375,12 @@ protected :
 		const SG_IObject &other
 	);
 
+	/**
+	 * Tell the flat hierarchy that gathered this object that it was
+	 * removed or changed parent, relation, controllers or children.
+	 */
+	void InvalidateFlatHierarchy();
+
 
 #ifdef WITH_CXX_GUARDEDALLOC
 	MEM_CXX_CLASS_ALLOC_FUNCS("GE:SG_IObject")
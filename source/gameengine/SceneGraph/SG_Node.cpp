@@ -46,7 +46,7 @@ SG_Node::SG_Node(
 	: SG_Spatial(clientobj,clientinfo,callbacks),
 	m_SGparent(NULL)
 {
-	m_modified = true;
+	m_transforms->m_modified[m_slot] = true;
 }
 
 SG_Node::SG_Node(
@@ -56,7 +56,7 @@ SG_Node::SG_Node(
 	m_children(other.m_children),
 	m_SGparent(other.m_SGparent)
 {
-	m_modified = true;
+	m_transforms->m_modified[m_slot] = true;
 }
 
 SG_Node::~SG_Node()
@@ -172,6 +172,7 @@ void SG_Node::AddChild(SG_Node* child)
 {
 	m_children.push_back(child);
 	child->SetSGParent(this); // this way ?
+	InvalidateFlatHierarchy();
 }
 
 void SG_Node::RemoveChild(SG_Node* child)
@@ -181,6 +182,7 @@ void SG_Node::RemoveChild(SG_Node* child)
 	if (childfound != m_children.end())
 	{
 		m_children.erase(childfound);
+		InvalidateFlatHierarchy();
 	}
 }
 
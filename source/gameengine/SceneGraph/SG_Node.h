@@ -116,6 +116,7 @@ public:
 	void ClearSGChildren()
 	{
 		m_children.clear();
+		InvalidateFlatHierarchy();
 	}
 
 	/**
@@ -134,6 +135,7 @@ public:
 	void SetSGParent(SG_Node* parent)
 	{
 		m_SGparent = parent;
+		InvalidateFlatHierarchy();
 	}
 
 	/**
@@ -101,6 +101,17 @@ public :
 		return false;
 	}
 	
+	/**
+	 * Normal Parent Relation inherit the whole parent transform,
+	 * SG_FlatHierarchy computes them without calling UpdateChildCoordinates
+	 */
+	virtual
+		bool
+	IsNormalRelation(
+	) {
+		return false;
+	}
+
 	/**
 	 * Need this to see if we are able to adjust time-offset from the python api
 	 */
@@ -43,21 +43,24 @@ SG_Spatial(
 ): 
 
 	SG_IObject(clientobj,clientinfo,callbacks),
-	m_localPosition(0.0,0.0,0.0),
-	m_localRotation(1.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,1.0),
-	m_localScaling(1.f,1.f,1.f),
-	
-	m_worldPosition(0.0,0.0,0.0),
-	m_worldRotation(1.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,1.0),
-	m_worldScaling(1.f,1.f,1.f),
 
 	m_parent_relation (NULL),
 	
 	m_bbox(MT_Point3(-1.0, -1.0, -1.0), MT_Point3(1.0, 1.0, 1.0)),
-	m_radius(1.0),
-	m_modified(false),
-	m_ogldirty(false)
+	m_radius(1.0)
 {
+	m_transforms = SG_TransformStore::Alloc(m_slot);
+
+	m_transforms->m_localPosition[m_slot].setValue(0.0, 0.0, 0.0);
+	m_transforms->m_localRotation[m_slot].setIdentity();
+	m_transforms->m_localScaling[m_slot].setValue(1.0, 1.0, 1.0);
+
+	m_transforms->m_worldPosition[m_slot].setValue(0.0, 0.0, 0.0);
+	m_transforms->m_worldRotation[m_slot].setIdentity();
+	m_transforms->m_worldScaling[m_slot].setValue(1.0, 1.0, 1.0);
+
+	m_transforms->m_modified[m_slot] = false;
+	m_transforms->m_ogldirty[m_slot] = false;
 }
 
 SG_Spatial::
@@ -65,21 +68,25 @@ SG_Spatial(
 	const SG_Spatial& other
 ) : 
 	SG_IObject(other),
-	m_localPosition(other.m_localPosition),
-	m_localRotation(other.m_localRotation),
-	m_localScaling(other.m_localScaling),
-	
-	m_worldPosition(other.m_worldPosition),
-	m_worldRotation(other.m_worldRotation),
-	m_worldScaling(other.m_worldScaling),
 	
 	m_parent_relation(NULL),
 	
 	m_bbox(other.m_bbox),
-	m_radius(other.m_radius),
-	m_modified(false),
-	m_ogldirty(false)
+	m_radius(other.m_radius)
 {
+	m_transforms = SG_TransformStore::Alloc(m_slot);
+
+	m_transforms->m_localPosition[m_slot] = other.GetLocalPosition();
+	m_transforms->m_localRotation[m_slot] = other.GetLocalOrientation();
+	m_transforms->m_localScaling[m_slot] = other.GetLocalScale();
+
+	m_transforms->m_worldPosition[m_slot] = other.GetWorldPosition();
+	m_transforms->m_worldRotation[m_slot] = other.GetWorldOrientation();
+	m_transforms->m_worldScaling[m_slot] = other.GetWorldScaling();
+
+	m_transforms->m_modified[m_slot] = false;
+	m_transforms->m_ogldirty[m_slot] = false;
+
 	// duplicate the parent relation for this object
 	m_parent_relation = other.m_parent_relation->NewCopy();
 }
@@ -88,6 +95,7 @@ SG_Spatial::
 ~SG_Spatial()
 {
 	delete (m_parent_relation);
+	SG_TransformStore::Free(m_transforms, m_slot);
 }
 
 	void
@@ -97,6 +105,7 @@ SetParentRelation(
 ) {
 	delete (m_parent_relation);
 	m_parent_relation = relation;
+	InvalidateFlatHierarchy();
 	SetModified();
 }
 
@@ -149,15 +158,17 @@ RelativeTranslate(
 	const SG_Spatial *parent,
 	bool local
 ) {
+	MT_Point3& position = m_transforms->m_localPosition[m_slot];
+
 	if (local) {
-			m_localPosition += m_localRotation * trans;
+			position += GetLocalOrientation() * trans;
 	}
 	else {
 		if (parent) {
-			m_localPosition += trans * parent->GetWorldOrientation();
+			position += trans * parent->GetWorldOrientation();
 		}
 		else {
-			m_localPosition += trans;
+			position += trans;
 		}
 	}
 	SetModified();
@@ -180,7 +191,9 @@ RelativeRotate(
 	const MT_Matrix3x3& rot,
 	bool local
 ) {
-	m_localRotation = m_localRotation * (
+	MT_Matrix3x3& rotation = m_transforms->m_localRotation[m_slot];
+
+	rotation = rotation * (
 	local ? 
 		rot 
 	:
@@ -192,15 +205,18 @@ RelativeRotate(
 
 MT_Transform SG_Spatial::GetWorldTransform() const
 {
-	return MT_Transform(m_worldPosition, 
-		m_worldRotation.scaled(
-		m_worldScaling[0], m_worldScaling[1], m_worldScaling[2]));
+	const MT_Vector3& scaling = GetWorldScaling();
+
+	return MT_Transform(GetWorldPosition(), 
+		GetWorldOrientation().scaled(
+		scaling[0], scaling[1], scaling[2]));
 }
 
 bool SG_Spatial::inside(const MT_Point3 &point) const
 {
-	MT_Scalar radius = m_worldScaling[m_worldScaling.closestAxis()]*m_radius;
-	return (m_worldPosition.distance2(point) <= radius*radius) ?
+	const MT_Vector3& scaling = GetWorldScaling();
+	MT_Scalar radius = scaling[scaling.closestAxis()]*m_radius;
+	return (GetWorldPosition().distance2(point) <= radius*radius) ?
 		m_bbox.transform(GetWorldTransform()).inside(point) :
 		false;
 }
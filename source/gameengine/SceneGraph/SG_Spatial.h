@@ -38,6 +38,7 @@
 #include "SG_IObject.h"
 #include "SG_BBox.h"
 #include "SG_ParentRelation.h"
+#include "SG_TransformStore.h"
 
 
 class SG_Node;
@@ -47,40 +48,34 @@ class SG_ParentRelation;
  * SG_Spatial contains spatial information (local & world position, rotation 
  * and scaling) for a Scene graph node.
  * It also contains a link to the node's parent.
+ * The transforms are kept in a slot of SG_TransformStore, see SG_FlatHierarchy.
  */
 class SG_Spatial : public SG_IObject
 {
 
 protected:
-	MT_Point3		m_localPosition;
-	MT_Matrix3x3		m_localRotation;
-	MT_Vector3		m_localScaling;
-
-	MT_Point3		m_worldPosition;
-	MT_Matrix3x3		m_worldRotation;
-	MT_Vector3		m_worldScaling;
+	SG_TransformPage *	m_transforms;	// page holding the transforms of this node
+	unsigned int		m_slot;			// slot of this node in the page
 	
 	SG_ParentRelation *	m_parent_relation;
 	
 	SG_BBox			m_bbox;
 	MT_Scalar		m_radius;
-	bool			m_modified;
-	bool			m_ogldirty;		// true if the openGL matrix for this object must be recomputed
 
 public:
 	inline void ClearModified() 
 	{ 
-		m_modified = false; 
-		m_ogldirty = true;
+		m_transforms->m_modified[m_slot] = false;
+		m_transforms->m_ogldirty[m_slot] = true;
 	}
 	inline void SetModified()
 	{
-		m_modified = true;
+		m_transforms->m_modified[m_slot] = true;
 		ActivateScheduleUpdateCallback();
 	}
 	inline void ClearDirty()
 	{
-		m_ogldirty = false;
+		m_transforms->m_ogldirty[m_slot] = false;
 	}
 	/** 
 	 * Define the relationship this node has with it's parent
@@ -127,13 +122,13 @@ public:
 
 	void SetLocalPosition(const MT_Point3& trans)
 	{
-		m_localPosition = trans;
+		m_transforms->m_localPosition[m_slot] = trans;
 		SetModified();
 	}
 
 	void SetWorldPosition(const MT_Point3& trans)
 	{
-		m_worldPosition = trans;
+		m_transforms->m_worldPosition[m_slot] = trans;
 	}
 
 	
@@ -145,74 +140,75 @@ public:
 
 	void SetLocalOrientation(const MT_Matrix3x3& rot)
 	{
-		m_localRotation = rot;
+		m_transforms->m_localRotation[m_slot] = rot;
 		SetModified();
 	}
 
 	// rot is arrange like openGL matrix
 	void SetLocalOrientation(const float* rot)
 	{
-		m_localRotation.setValue(rot);
+		m_transforms->m_localRotation[m_slot].setValue(rot);
 		SetModified();
 	}
 
 	void SetWorldOrientation(const MT_Matrix3x3& rot) 
 	{
-		m_worldRotation = rot;
+		m_transforms->m_worldRotation[m_slot] = rot;
 	}
 
 	void RelativeScale(const MT_Vector3& scale)
 	{
-		m_localScaling = m_localScaling * scale;
+		MT_Vector3& scaling = m_transforms->m_localScaling[m_slot];
+		scaling = scaling * scale;
 		SetModified();
 	}
 
 	void SetLocalScale(const MT_Vector3& scale)
 	{
-		m_localScaling = scale;
+		m_transforms->m_localScaling[m_slot] = scale;
 		SetModified();
 	}
 
 	void SetWorldScale(const MT_Vector3& scale)
 	{ 
-		m_worldScaling = scale;
+		m_transforms->m_worldScaling[m_slot] = scale;
 	}
 
 	const MT_Point3& GetLocalPosition() const
 	{
-		return m_localPosition;
+		return m_transforms->m_localPosition[m_slot];
 	}
 
 	const MT_Matrix3x3& GetLocalOrientation() const
 	{
-		return m_localRotation;
+		return m_transforms->m_localRotation[m_slot];
 	}
 
 	const MT_Vector3& GetLocalScale() const
 	{
-		return m_localScaling;
+		return m_transforms->m_localScaling[m_slot];
 	}
 
 	const MT_Point3& GetWorldPosition() const
 	{
-		return m_worldPosition;
+		return m_transforms->m_worldPosition[m_slot];
 	}
 
 	const MT_Matrix3x3&	GetWorldOrientation() const
 	{
-		return m_worldRotation;
+		return m_transforms->m_worldRotation[m_slot];
 	}
 
 	const MT_Vector3& GetWorldScaling() const
 	{
-		return m_worldScaling;
+		return m_transforms->m_worldScaling[m_slot];
 	}
 
 	void SetWorldFromLocalTransform()
 	{
-		m_worldPosition= m_localPosition;
-		m_worldScaling= m_localScaling;
-		m_worldRotation= m_localRotation;
+		m_transforms->m_worldPosition[m_slot]= m_transforms->m_localPosition[m_slot];
+		m_transforms->m_worldScaling[m_slot]= m_transforms->m_localScaling[m_slot];
+		m_transforms->m_worldRotation[m_slot]= m_transforms->m_localRotation[m_slot];
 	}
 
 
@@ -245,8 +241,8 @@ public:
 	
 	MT_Scalar Radius() const { return m_radius; }
 	void SetRadius(MT_Scalar radius) { m_radius = radius; }
-	bool IsModified() { return m_modified; }
-	bool IsDirty() { return m_ogldirty; }
+	bool IsModified() { return m_transforms->m_modified[m_slot]; }
+	bool IsDirty() { return m_transforms->m_ogldirty[m_slot]; }
 	
 protected:
 	friend class SG_Controller;
@@ -254,6 +250,7 @@ protected:
 	friend class KX_VertexParentRelation;
 	friend class KX_SlowParentRelation;
 	friend class KX_NormalParentRelation;
+	friend class SG_FlatHierarchy;
 	
 	/** 
 	 * Protected constructor this class is not
@@ -0,0 +1,101 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file gameengine/SceneGraph/SG_TransformStore.cpp
+ *  \ingroup bgesg
+ */
+
+#include "SG_TransformStore.h"
+
+#include "atomic_ops.h"
+
+std::vector<SG_TransformPage *> SG_TransformStore::m_pages;
+std::vector<unsigned int> SG_TransformStore::m_freeSlots;
+unsigned int SG_TransformStore::m_numUsed = 0;
+
+static uint32_t store_lock = 0;
+
+static void lock_store()
+{
+	while (atomic_cas_uint32(&store_lock, 0, 1) != 0);
+}
+
+static void unlock_store()
+{
+	atomic_sub_uint32(&store_lock, 1);
+}
+
+SG_TransformPage *SG_TransformStore::Alloc(unsigned int& slot)
+{
+	lock_store();
+
+	if (m_freeSlots.empty()) {
+		SG_TransformPage *page = new SG_TransformPage();
+		page->m_index = m_pages.size();
+		m_pages.push_back(page);
+
+		// pushed backward so that the first slot of the page is used first
+		for (unsigned int i = SG_TRANSFORM_PAGE_SIZE; i > 0; i--)
+			m_freeSlots.push_back(page->m_index * SG_TRANSFORM_PAGE_SIZE + i - 1);
+	}
+
+	const unsigned int index = m_freeSlots.back();
+	m_freeSlots.pop_back();
+	m_numUsed++;
+
+	SG_TransformPage *page = m_pages[index / SG_TRANSFORM_PAGE_SIZE];
+	slot = index % SG_TRANSFORM_PAGE_SIZE;
+
+	unlock_store();
+	return page;
+}
+
+void SG_TransformStore::Free(SG_TransformPage *page, unsigned int slot)
+{
+	lock_store();
+
+	m_freeSlots.push_back(page->m_index * SG_TRANSFORM_PAGE_SIZE + slot);
+
+	if (--m_numUsed == 0) {
+		for (std::vector<SG_TransformPage *>::iterator it = m_pages.begin(); it != m_pages.end(); ++it)
+			delete *it;
+		m_pages.clear();
+		m_freeSlots.clear();
+	}
+
+	unlock_store();
+}
+
+unsigned int SG_TransformStore::GetNumUsed()
+{
+	return m_numUsed;
+}
+
+unsigned int SG_TransformStore::GetNumPages()
+{
+	return m_pages.size();
+}
@@ -0,0 +1,107 @@
+/*
+ * ***** BEGIN GPL LICENSE BLOCK *****
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2001-2002 by NaN Holding BV.
+ * All rights reserved.
+ *
+ * The Original Code is: all of this file.
+ *
+ * Contributor(s): none yet.
+ *
+ * ***** END GPL LICENSE BLOCK *****
+ */
+
+/** \file SG_TransformStore.h
+ *  \ingroup bgesg
+ */
+
+#ifndef __SG_TRANSFORMSTORE_H__
+#define __SG_TRANSFORMSTORE_H__
+
+#include <MT_Vector3.h>
+#include <MT_Point3.h>
+#include <MT_Matrix3x3.h>
+#include <vector>
+
+#ifdef WITH_CXX_GUARDEDALLOC
+#include "MEM_guardedalloc.h"
+#endif
+
+#define SG_TRANSFORM_PAGE_SIZE 256
+
+/**
+ * Local and world transforms of SG_TRANSFORM_PAGE_SIZE nodes, one array
+ * per component. A page is never moved while nodes use it, so SG_Spatial
+ * can hand out references into it.
+ */
+struct SG_TransformPage
+{
+	MT_Point3		m_localPosition[SG_TRANSFORM_PAGE_SIZE];
+	MT_Matrix3x3	m_localRotation[SG_TRANSFORM_PAGE_SIZE];
+	MT_Vector3		m_localScaling[SG_TRANSFORM_PAGE_SIZE];
+
+	MT_Point3		m_worldPosition[SG_TRANSFORM_PAGE_SIZE];
+	MT_Matrix3x3	m_worldRotation[SG_TRANSFORM_PAGE_SIZE];
+	MT_Vector3		m_worldScaling[SG_TRANSFORM_PAGE_SIZE];
+
+	/* the local transform changed since the last world update */
+	bool			m_modified[SG_TRANSFORM_PAGE_SIZE];
+	/* the openGL matrix must be computed again */
+	bool			m_ogldirty[SG_TRANSFORM_PAGE_SIZE];
+
+	unsigned int	m_index;
+
+
+#ifdef WITH_CXX_GUARDEDALLOC
+	MEM_CXX_CLASS_ALLOC_FUNCS("GE:SG_TransformPage")
+#endif
+};
+
+/**
+ * Pages holding the transforms of all the scene graph nodes.
+ * Nodes created one after the other get neighbour slots, so a sweep over
+ * a hierarchy reads the transforms mostly in order. Slots are allocated
+ * under a lock because the async LibLoad creates nodes in its own thread.
+ */
+class SG_TransformStore
+{
+public:
+	/**
+	 * Return the page of a free slot and the slot in it.
+	 * The transforms of the slot are not initialized.
+	 */
+	static SG_TransformPage *Alloc(unsigned int& slot);
+
+	/**
+	 * Give a slot back, the pages are freed with the last slot.
+	 */
+	static void Free(SG_TransformPage *page, unsigned int slot);
+
+	/// Number of slots in use.
+	static unsigned int GetNumUsed();
+
+	/// Number of allocated pages.
+	static unsigned int GetNumPages();
+
+private:
+	static std::vector<SG_TransformPage *> m_pages;
+	/* global indices of the free slots, the last one is used first */
+	static std::vector<unsigned int> m_freeSlots;
+	static unsigned int m_numUsed;
+};
+
+#endif  /* __SG_TRANSFORMSTORE_H__ */
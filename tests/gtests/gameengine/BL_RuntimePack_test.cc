@@ -0,0 +1,251 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BL_RuntimePack.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_ID.h"
+#include "DNA_image_types.h"
+#include "DNA_meshdata_types.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_endian_switch.h"
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+}
+
+#define PACK_PATH "BL_RuntimePack_test.bgepack"
+#define MESH_NAME "MEtest"
+#define MESH_HASH 0xCAFEF00Du
+
+/* A quad and a triangle with colors, tangents and two uv layers using two images,
+ * as BL_MeshArrays::FromMesh() would give them */
+struct TestMesh
+{
+	MVert mvert[5];
+	MFace mface[2];
+	MCol mcol[2 * 4];
+	float tangent[2 * 4][4];
+	MTFace layers[2][2];
+	Image *images[2];
+	Main *bmain;
+	BL_MeshArrays arrays;
+
+	TestMesh()
+	{
+		memset(mvert, 0, sizeof(mvert));
+		memset(mface, 0, sizeof(mface));
+		memset(layers, 0, sizeof(layers));
+
+		bmain = (Main *)MEM_callocN(sizeof(Main), "test main");
+		for (int i = 0; i < 2; i++) {
+			images[i] = (Image *)MEM_callocN(sizeof(Image), "test image");
+			BLI_snprintf(images[i]->id.name, sizeof(images[i]->id.name), "IMimage.%d", i);
+			BLI_addtail(&bmain->image, images[i]);
+		}
+
+		for (int i = 0; i < 5; i++) {
+			mvert[i].co[0] = 1.5f * i;
+			mvert[i].co[1] = -0.25f * i;
+			mvert[i].co[2] = 1000.0f + i;
+			mvert[i].no[0] = (short)(100 * i);
+			mvert[i].no[1] = (short)(-32767 + i);
+			mvert[i].no[2] = 257;
+		}
+
+		mface[0].v1 = 0; mface[0].v2 = 1; mface[0].v3 = 2; mface[0].v4 = 3;
+		mface[0].mat_nr = 1;
+		mface[0].flag = ME_SMOOTH;
+		mface[1].v1 = 2; mface[1].v2 = 3; mface[1].v3 = 4; mface[1].v4 = 0;
+		mface[1].mat_nr = 258;
+
+		for (int i = 0; i < 8; i++) {
+			mcol[i].a = (unsigned char)i;
+			mcol[i].r = (unsigned char)(i * 2);
+			mcol[i].g = (unsigned char)(i * 3);
+			mcol[i].b = (unsigned char)(255 - i);
+			for (int j = 0; j < 4; j++)
+				tangent[i][j] = 0.1f * i - 0.3f * j;
+		}
+
+		for (int l = 0; l < 2; l++) {
+			for (int f = 0; f < 2; f++) {
+				MTFace& tf = layers[l][f];
+				for (int c = 0; c < 4; c++) {
+					tf.uv[c][0] = 0.5f * l + 0.125f * c;
+					tf.uv[c][1] = 0.75f * f - 0.0625f * c;
+				}
+				/* the second face of the first layer has no image */
+				tf.tpage = (l == 0 && f == 1) ? NULL : images[(l + f) % 2];
+				tf.flag = (char)(l + 1);
+				tf.transp = (char)f;
+				tf.mode = (short)(0x1234 + l);
+				tf.tile = (short)(f + 3);
+				tf.unwrap = (short)(0x0102 * (l + 1));
+			}
+		}
+
+		arrays.m_mvert = mvert;
+		arrays.m_totvert = 5;
+		arrays.m_mface = mface;
+		arrays.m_totface = 2;
+		arrays.m_mcol = mcol;
+		arrays.m_tangent = tangent;
+		arrays.m_numLayers = 2;
+		arrays.m_layers[0] = layers[0];
+		arrays.m_layers[1] = layers[1];
+		arrays.m_layerNames[0] = "UVMap";
+		arrays.m_layerNames[1] = "UVLightmap";
+		arrays.m_tface = layers[1];
+	}
+
+	~TestMesh()
+	{
+		BLI_freelistN(&bmain->image);
+		MEM_freeN(bmain);
+	}
+
+	bool Write(bool bigEndian)
+	{
+		BL_RuntimePackWriter writer(bigEndian);
+		writer.AddMesh(MESH_NAME, MESH_HASH, arrays);
+		return writer.Write(PACK_PATH);
+	}
+
+	void Compare(const BL_MeshArrays& baked)
+	{
+		ASSERT_EQ(5, baked.m_totvert);
+		ASSERT_EQ(2, baked.m_totface);
+		ASSERT_EQ(2, baked.m_numLayers);
+		ASSERT_TRUE(baked.m_mcol != NULL);
+		ASSERT_TRUE(baked.m_tangent != NULL);
+		EXPECT_EQ(baked.m_layers[1], baked.m_tface);
+		EXPECT_STREQ("UVMap", baked.m_layerNames[0]);
+		EXPECT_STREQ("UVLightmap", baked.m_layerNames[1]);
+
+		EXPECT_EQ(0, memcmp(mvert, baked.m_mvert, sizeof(mvert)));
+		EXPECT_EQ(0, memcmp(mface, baked.m_mface, sizeof(mface)));
+		EXPECT_EQ(0, memcmp(mcol, baked.m_mcol, sizeof(mcol)));
+		EXPECT_EQ(0, memcmp(tangent, baked.m_tangent, sizeof(tangent)));
+
+		for (int l = 0; l < 2; l++) {
+			for (int f = 0; f < 2; f++) {
+				const MTFace& tf = layers[l][f];
+				const MTFace& btf = baked.m_layers[l][f];
+
+				EXPECT_EQ(0, memcmp(tf.uv, btf.uv, sizeof(tf.uv)));
+				EXPECT_EQ(tf.tpage, btf.tpage);
+				EXPECT_EQ(tf.flag, btf.flag);
+				EXPECT_EQ(tf.transp, btf.transp);
+				EXPECT_EQ(tf.mode, btf.mode);
+				EXPECT_EQ(tf.tile, btf.tile);
+				EXPECT_EQ(tf.unwrap, btf.unwrap);
+			}
+		}
+	}
+};
+
+static size_t read_pack(char *data, size_t size)
+{
+	FILE *fp = BLI_fopen(PACK_PATH, "rb");
+	if (!fp)
+		return 0;
+	const size_t len = fread(data, 1, size, fp);
+	fclose(fp);
+	return len;
+}
+
+static void write_pack(const char *data, size_t size)
+{
+	FILE *fp = BLI_fopen(PACK_PATH, "wb");
+	fwrite(data, 1, size, fp);
+	fclose(fp);
+}
+
+TEST(runtime_pack, RoundTrip)
+{
+	TestMesh mesh;
+	ASSERT_TRUE(mesh.Write(ENDIAN_ORDER == B_ENDIAN));
+
+	BL_RuntimePack *pack = BL_RuntimePack::OpenFile(PACK_PATH, mesh.bmain);
+	ASSERT_TRUE(pack != NULL);
+
+	BL_MeshArrays baked;
+	ASSERT_TRUE(pack->GetMesh(MESH_NAME, MESH_HASH, baked));
+	mesh.Compare(baked);
+
+	/* edited since the bake or not baked */
+	BL_MeshArrays stale, missing;
+	EXPECT_FALSE(pack->GetMesh(MESH_NAME, MESH_HASH + 1, stale));
+	EXPECT_FALSE(pack->GetMesh("MEother", MESH_HASH, missing));
+
+	delete pack;
+	BLI_delete(PACK_PATH, false, false);
+}
+
+TEST(runtime_pack, OtherByteOrder)
+{
+	TestMesh mesh;
+	static char native[16384], other[16384];
+
+	ASSERT_TRUE(mesh.Write(ENDIAN_ORDER == B_ENDIAN));
+	const size_t size = read_pack(native, sizeof(native));
+	ASSERT_TRUE(mesh.Write(ENDIAN_ORDER != B_ENDIAN));
+	ASSERT_EQ(size, read_pack(other, sizeof(other)));
+
+	/* the same layout, the vertices switched */
+	int totvert = 0;
+	for (size_t i = 0; i + sizeof(MVert) <= size; i += 16) {
+		if (memcmp(native + i, mesh.mvert, sizeof(MVert)) == 0) {
+			MVert mv = *(MVert *)(other + i);
+			BLI_endian_switch_float_array(mv.co, 3);
+			BLI_endian_switch_int16_array(mv.no, 3);
+			EXPECT_EQ(0, memcmp(&mv, mesh.mvert, sizeof(MVert)));
+			totvert++;
+		}
+	}
+	EXPECT_EQ(1, totvert);
+
+	/* switched back while loading */
+	BL_RuntimePack *pack = BL_RuntimePack::OpenFile(PACK_PATH, mesh.bmain);
+	ASSERT_TRUE(pack != NULL);
+
+	BL_MeshArrays baked;
+	ASSERT_TRUE(pack->GetMesh(MESH_NAME, MESH_HASH, baked));
+	mesh.Compare(baked);
+
+	delete pack;
+	BLI_delete(PACK_PATH, false, false);
+}
+
+TEST(runtime_pack, Damaged)
+{
+	TestMesh mesh;
+	static char data[16384];
+
+	ASSERT_TRUE(mesh.Write(ENDIAN_ORDER == B_ENDIAN));
+	const size_t size = read_pack(data, sizeof(data));
+
+	/* a mesh count overflowing the size of the mesh table: magic, endian, version, nummeshes */
+	int *nummeshes = (int *)(data + 16);
+	ASSERT_EQ(1, *nummeshes);
+	*nummeshes = 0x7FFFFFFF;
+	write_pack(data, size);
+	EXPECT_TRUE(BL_RuntimePack::OpenFile(PACK_PATH, mesh.bmain) == NULL);
+	*nummeshes = -1;
+	write_pack(data, size);
+	EXPECT_TRUE(BL_RuntimePack::OpenFile(PACK_PATH, mesh.bmain) == NULL);
+	*nummeshes = 1;
+
+	/* truncated in the arrays */
+	write_pack(data, size / 2);
+	EXPECT_TRUE(BL_RuntimePack::OpenFile(PACK_PATH, mesh.bmain) == NULL);
+
+	BLI_delete(PACK_PATH, false, false);
+}
@@ -0,0 +1,266 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BL_SkinKernel.h"
+
+#include <Eigen/LU>
+
+#include "DNA_meshdata_types.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+#define NUM_BONES 30
+
+/* A character: a mesh with 4 influences per vertex and the pose of its bones */
+struct Character {
+	std::vector<MDeformVert> m_dverts;
+	std::vector<MDeformWeight> m_weights;
+	std::vector<float> m_rest;
+	std::vector<float> m_co;
+	std::vector<float> m_no;
+	float m_chanMats[NUM_BONES][4][4];
+	float m_obmat[4][4];
+	float m_armmat[4][4];
+	BL_SkinKernel *m_kernel;
+};
+
+static void init_character(Character& character, RNG *rng, int numVerts)
+{
+	character.m_dverts.resize(numVerts);
+	character.m_weights.resize(numVerts * 4);
+	character.m_rest.resize(numVerts * 3);
+	character.m_no.resize(numVerts * 3);
+
+	for (int v = 0; v < numVerts; v++) {
+		MDeformVert& dv = character.m_dverts[v];
+		dv.dw = &character.m_weights[v * 4];
+		dv.totweight = 4;
+		for (int j = 0; j < 4; j++) {
+			dv.dw[j].def_nr = BLI_rng_get_int(rng) % NUM_BONES;
+			dv.dw[j].weight = 0.1f + BLI_rng_get_float(rng);
+		}
+		for (int k = 0; k < 3; k++)
+			character.m_rest[v * 3 + k] = BLI_rng_get_float(rng) * 2.0f - 1.0f;
+	}
+
+	Eigen::Matrix4f::Map((float *)character.m_obmat) = Eigen::Matrix4f::Identity();
+	Eigen::Matrix4f::Map((float *)character.m_armmat) = Eigen::Matrix4f::Identity();
+	character.m_armmat[3][0] = 0.5f;
+	character.m_armmat[3][2] = 1.0f;
+
+	int groupBones[NUM_BONES];
+	for (int i = 0; i < NUM_BONES; i++)
+		groupBones[i] = i;
+	character.m_kernel = new BL_SkinKernel(&character.m_dverts[0], numVerts, groupBones, NUM_BONES, NUM_BONES);
+}
+
+static void pose_character(Character& character, int frame)
+{
+	for (int b = 0; b < NUM_BONES; b++) {
+		const float angle = 0.01f * (float)((frame + 1) * (b + 1));
+		float (*mat)[4] = character.m_chanMats[b];
+		memset(mat, 0, sizeof(float[4][4]));
+		mat[0][0] = cosf(angle);
+		mat[0][1] = sinf(angle);
+		mat[1][0] = -sinf(angle);
+		mat[1][1] = cosf(angle);
+		mat[2][2] = 1.0f;
+		mat[3][0] = 0.1f * b;
+		mat[3][3] = 1.0f;
+	}
+
+	character.m_co = character.m_rest;
+	for (size_t i = 0; i < character.m_no.size(); i += 3) {
+		character.m_no[i] = 0.0f;
+		character.m_no[i + 1] = 0.0f;
+		character.m_no[i + 2] = 1.0f;
+	}
+}
+
+/* The deform BL_SkinDeformer::BGEDeformVerts() used to do, for each weight of each vertex */
+static void deform_reference(Character& character)
+{
+	Eigen::Matrix4f pre_mat, post_mat, chan_mat, norm_chan_mat;
+	float (*transverts)[3] = (float (*)[3])&character.m_co[0];
+	float (*transnors)[3] = (float (*)[3])&character.m_no[0];
+
+	post_mat = Eigen::Matrix4f::Map((float*)character.m_obmat).inverse() * Eigen::Matrix4f::Map((float*)character.m_armmat);
+	pre_mat = post_mat.inverse();
+
+	for (size_t i = 0; i < character.m_dverts.size(); ++i) {
+		const MDeformVert *dv = &character.m_dverts[i];
+		const MDeformWeight *dw = dv->dw;
+		float contrib = 0.f, max_weight = -1.f;
+		Eigen::Map<Eigen::Vector3f> norm = Eigen::Vector3f::Map(transnors[i]);
+		Eigen::Vector4f vec(0, 0, 0, 1);
+		Eigen::Vector4f co(transverts[i][0], transverts[i][1], transverts[i][2], 1.f);
+
+		co = pre_mat * co;
+
+		for (unsigned int j = dv->totweight; j != 0; j--, dw++) {
+			const float weight = dw->weight;
+			chan_mat = Eigen::Matrix4f::Map((float*)character.m_chanMats[dw->def_nr]);
+			vec.noalias() += (chan_mat * co - co) * weight;
+			if (weight > max_weight) {
+				max_weight = weight;
+				norm_chan_mat = chan_mat;
+			}
+			contrib += weight;
+		}
+
+		norm = norm_chan_mat.topLeftCorner<3, 3>() * norm;
+
+		co.noalias() += vec / contrib;
+		co[3] = 1.f;
+		co = post_mat * co;
+
+		transverts[i][0] = co[0];
+		transverts[i][1] = co[1];
+		transverts[i][2] = co[2];
+	}
+}
+
+static void set_palette(Character& character)
+{
+	const Eigen::Matrix4f post_mat = Eigen::Matrix4f::Map((float*)character.m_obmat).inverse() *
+	                                 Eigen::Matrix4f::Map((float*)character.m_armmat);
+	const Eigen::Matrix4f pre_mat = post_mat.inverse();
+	float bone_mat[4][4];
+
+	for (int b = 0; b < NUM_BONES; b++) {
+		Eigen::Matrix4f::Map((float*)bone_mat) = post_mat * Eigen::Matrix4f::Map((float*)character.m_chanMats[b]) * pre_mat;
+		character.m_kernel->SetBone(b, bone_mat);
+	}
+}
+
+static void deform_kernel(Character& character, TaskScheduler *scheduler)
+{
+	set_palette(character);
+	character.m_kernel->Deform((float (*)[3])&character.m_co[0], (float (*)[3])&character.m_no[0], scheduler);
+}
+
+static void deform_task(TaskPool *pool, void *taskdata, int UNUSED(threadid))
+{
+	deform_kernel(*(Character *)taskdata, (TaskScheduler *)BLI_task_pool_userdata(pool));
+}
+
+TEST(converter, SkinKernelCrowd)
+{
+	const int numCharacters = 200, numVerts = 2000, frames = 20;
+	std::vector<Character> characters(numCharacters);
+	std::vector<float> reference;
+
+	RNG *rng = BLI_rng_new(0);
+	for (int c = 0; c < numCharacters; c++)
+		init_character(characters[c], rng, numVerts);
+	BLI_rng_free(rng);
+
+	BLI_threadapi_init();
+	TaskScheduler *scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+	TaskPool *pool = BLI_task_pool_create(scheduler, scheduler);
+
+	printf("\n========== %d characters of %d vertices, %d frames ==========\n", numCharacters, numVerts, frames);
+
+	{
+		TIMEIT_START(reference);
+		for (int f = 0; f < frames; f++) {
+			for (int c = 0; c < numCharacters; c++) {
+				pose_character(characters[c], f);
+				deform_reference(characters[c]);
+			}
+		}
+		TIMEIT_END(reference);
+	}
+	reference = characters[0].m_co;
+
+	{
+		TIMEIT_START(kernel);
+		for (int f = 0; f < frames; f++) {
+			for (int c = 0; c < numCharacters; c++) {
+				pose_character(characters[c], f);
+				deform_kernel(characters[c], NULL);
+			}
+		}
+		TIMEIT_END(kernel);
+	}
+
+	for (size_t i = 0; i < reference.size(); i++) {
+		if (fabsf(reference[i] - characters[0].m_co[i]) > 1e-4f) {
+			ADD_FAILURE() << "coordinate " << i << ": " << reference[i] << " != " << characters[0].m_co[i];
+			break;
+		}
+	}
+
+	/* the characters are deformed by the task pool, as the animations of the scene are */
+	{
+		TIMEIT_START(kernel_threads);
+		for (int f = 0; f < frames; f++) {
+			for (int c = 0; c < numCharacters; c++) {
+				pose_character(characters[c], f);
+				BLI_task_pool_push(pool, deform_task, &characters[c], false, TASK_PRIORITY_LOW);
+			}
+			BLI_task_pool_work_and_wait(pool);
+		}
+		TIMEIT_END(kernel_threads);
+	}
+
+	for (int c = 0; c < numCharacters; c++)
+		delete characters[c].m_kernel;
+	BLI_task_pool_free(pool);
+	BLI_task_scheduler_free(scheduler);
+	BLI_threadapi_exit();
+}
+
+TEST(converter, SkinKernelLargeMesh)
+{
+	/* split in chunks over the threads */
+	const int numVerts = 100000, frames = 20;
+	Character character;
+	std::vector<float> single;
+
+	RNG *rng = BLI_rng_new(1);
+	init_character(character, rng, numVerts);
+	BLI_rng_free(rng);
+
+	BLI_threadapi_init();
+	TaskScheduler *scheduler = BLI_task_scheduler_create(TASK_SCHEDULER_AUTO_THREADS);
+
+	printf("\n========== %d vertices, %d frames ==========\n", numVerts, frames);
+
+	{
+		TIMEIT_START(single_thread);
+		for (int f = 0; f < frames; f++) {
+			pose_character(character, f);
+			deform_kernel(character, NULL);
+		}
+		TIMEIT_END(single_thread);
+	}
+	single = character.m_co;
+
+	{
+		TIMEIT_START(threads);
+		for (int f = 0; f < frames; f++) {
+			pose_character(character, f);
+			deform_kernel(character, scheduler);
+		}
+		TIMEIT_END(threads);
+	}
+
+	EXPECT_TRUE(single == character.m_co);
+
+	delete character.m_kernel;
+	BLI_task_scheduler_free(scheduler);
+	BLI_threadapi_exit();
+}
@@ -0,0 +1,39 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "BL_SkinKernel.h"
+
+#include "DNA_meshdata_types.h"
+
+TEST(converter, SkinKernelInfluences)
+{
+	/* 6 weights: the 4 largest are kept and normalized, the groups without bone are skipped */
+	MDeformWeight weights[6] = {{0, 0.1f}, {1, 0.5f}, {2, 0.2f}, {3, 0.9f}, {4, 0.3f}, {5, 0.05f}};
+	MDeformVert dverts[2];
+	dverts[0].dw = weights;
+	dverts[0].totweight = 6;
+	dverts[1].dw = NULL;
+	dverts[1].totweight = 0;
+	const int groupBones[6] = {0, 1, -1, 2, 3, 4};
+
+	BL_SkinKernel kernel(dverts, 2, groupBones, 6, 5);
+	float mat[4][4];
+	for (int b = 0; b < 5; b++) {
+		/* each bone moves the vertices by its index along x */
+		Eigen::Matrix4f::Map((float *)mat) = Eigen::Matrix4f::Identity();
+		mat[3][0] = (float)b;
+		kernel.SetBone(b, mat);
+	}
+
+	float co[2][3] = {{0.0f, 0.0f, 0.0f}, {1.0f, 2.0f, 3.0f}};
+	float no[2][3] = {{0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, 1.0f}};
+	kernel.Deform(co, no, NULL);
+
+	/* bones 2 (0.9), 1 (0.5), 3 (0.3), 0 (0.1) */
+	EXPECT_NEAR((0.9f * 2.0f + 0.5f * 1.0f + 0.3f * 3.0f) / 1.8f, co[0][0], 1e-5f);
+	EXPECT_FLOAT_EQ(1.0f, no[0][2]);
+	/* no weight, not moved */
+	EXPECT_EQ(1.0f, co[1][0]);
+	EXPECT_EQ(3.0f, co[1][2]);
+}
@@ -0,0 +1,199 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "CTR_Map.h"
+#include "STR_HashedString.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <vector>
+
+/* The chained map CTR_Map used to be, with its 100 buckets */
+template <class Key, class Value>
+class ChainedMap {
+private:
+	struct Entry {
+		Entry(Entry *next, Key key, Value value) : m_next(next), m_key(key), m_value(value) {}
+
+		Entry *m_next;
+		Key m_key;
+		Value m_value;
+	};
+
+public:
+	ChainedMap(int num_buckets = 100) : m_num_buckets(num_buckets)
+	{
+		m_buckets = new Entry *[num_buckets];
+		for (int i = 0; i < num_buckets; ++i)
+			m_buckets[i] = 0;
+	}
+
+	~ChainedMap()
+	{
+		for (int i = 0; i < m_num_buckets; ++i) {
+			Entry *entry_ptr = m_buckets[i];
+			while (entry_ptr != 0) {
+				Entry *tmp_ptr = entry_ptr->m_next;
+				delete entry_ptr;
+				entry_ptr = tmp_ptr;
+			}
+		}
+		delete[] m_buckets;
+	}
+
+	int size()
+	{
+		int count = 0;
+		for (int i = 0; i < m_num_buckets; i++)
+			for (Entry *bucket = m_buckets[i]; bucket; bucket = bucket->m_next)
+				count++;
+		return count;
+	}
+
+	Value *at(int index)
+	{
+		int count = 0;
+		for (int i = 0; i < m_num_buckets; i++) {
+			for (Entry *bucket = m_buckets[i]; bucket; bucket = bucket->m_next) {
+				if (count == index)
+					return &bucket->m_value;
+				count++;
+			}
+		}
+		return 0;
+	}
+
+	void insert(const Key& key, const Value& value)
+	{
+		Entry **bucket = &m_buckets[key.hash() % m_num_buckets];
+		*bucket = new Entry(*bucket, key, value);
+	}
+
+	void remove(const Key& key)
+	{
+		Entry **entry_ptr = &m_buckets[key.hash() % m_num_buckets];
+		while ((*entry_ptr != 0) && !(key == (*entry_ptr)->m_key))
+			entry_ptr = &(*entry_ptr)->m_next;
+
+		if (*entry_ptr != 0) {
+			Entry *tmp_ptr = (*entry_ptr)->m_next;
+			delete *entry_ptr;
+			*entry_ptr = tmp_ptr;
+		}
+	}
+
+	Value *operator[](Key key)
+	{
+		Entry *bucket = m_buckets[key.hash() % m_num_buckets];
+		while ((bucket != 0) && !(key == bucket->m_key))
+			bucket = bucket->m_next;
+		return bucket != 0 ? &bucket->m_value : 0;
+	}
+
+private:
+	int m_num_buckets;
+	Entry **m_buckets;
+};
+
+struct TestMesh {
+	STR_HashedString m_name;
+	bool m_tagged;
+};
+
+static void make_meshes(std::vector<TestMesh>& meshes, int num)
+{
+	meshes.resize(num);
+	for (int i = 0; i < num; i++) {
+		meshes[i].m_name = STR_String("ME") + STR_String(i);
+		meshes[i].m_tagged = (i % 2) == 0;
+	}
+}
+
+/* Name lookups as done by SCA_LogicManager */
+template <class Map>
+static int lookup_names(Map& map, std::vector<TestMesh>& meshes, int rounds)
+{
+	int found = 0;
+	for (int r = 0; r < rounds; r++) {
+		for (size_t i = 0; i < meshes.size(); i++) {
+			if (map[meshes[i].m_name])
+				found++;
+		}
+	}
+	return found;
+}
+
+/* Remove the meshes of a freed library, as KX_BlenderSceneConverter::FreeBlendFile does */
+template <class Map>
+static void free_tagged(Map& map)
+{
+	for (int i = 0; i < map.size(); i++) {
+		TestMesh *mesh = (TestMesh *)*map.at(i);
+		if (mesh->m_tagged) {
+			map.remove(mesh->m_name);
+			i--;
+		}
+	}
+}
+
+static void map_test(int num, int rounds)
+{
+	std::vector<TestMesh> meshes;
+	ChainedMap<STR_HashedString, void *> chained;
+	CTR_Map<STR_HashedString, void *> map;
+	int found_chained, found;
+
+	make_meshes(meshes, num);
+
+	printf("\n========== %d names, %d lookup rounds ==========\n", num, rounds);
+
+	{
+		TIMEIT_START(chained_insert);
+		for (int i = 0; i < num; i++)
+			chained.insert(meshes[i].m_name, &meshes[i]);
+		TIMEIT_END(chained_insert);
+	}
+	{
+		TIMEIT_START(open_insert);
+		for (int i = 0; i < num; i++)
+			map.insert(meshes[i].m_name, &meshes[i]);
+		TIMEIT_END(open_insert);
+	}
+
+	{
+		TIMEIT_START(chained_lookup);
+		found_chained = lookup_names(chained, meshes, rounds);
+		TIMEIT_END(chained_lookup);
+	}
+	{
+		TIMEIT_START(open_lookup);
+		found = lookup_names(map, meshes, rounds);
+		TIMEIT_END(open_lookup);
+	}
+
+	EXPECT_EQ(num * rounds, found_chained);
+	EXPECT_EQ(num * rounds, found);
+
+	{
+		TIMEIT_START(chained_free);
+		free_tagged(chained);
+		TIMEIT_END(chained_free);
+	}
+	{
+		TIMEIT_START(open_free);
+		free_tagged(map);
+		TIMEIT_END(open_free);
+	}
+
+	EXPECT_EQ(num / 2, chained.size());
+	EXPECT_EQ(num / 2, map.size());
+}
+
+TEST(container, MapNames10k)
+{
+	map_test(10000, 100);
+}
@@ -0,0 +1,78 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "CTR_Map.h"
+#include "CTR_HashedPtr.h"
+#include "STR_HashedString.h"
+
+#include <vector>
+
+TEST(container, MapNames)
+{
+	CTR_Map<STR_HashedString, int> map;
+	std::vector<STR_HashedString> names(1000);
+
+	for (int i = 0; i < (int)names.size(); i++) {
+		names[i] = STR_String("ME") + STR_String(i);
+		map.insert(names[i], i);
+	}
+	EXPECT_EQ((int)names.size(), map.size());
+
+	/* inserting a key again replaces its value */
+	map.insert(names[10], -10);
+	EXPECT_EQ((int)names.size(), map.size());
+	EXPECT_EQ(-10, *map[names[10]]);
+	map.insert(names[10], 10);
+
+	/* removing while iterating by index, as KX_BlenderSceneConverter::FreeBlendFile does */
+	for (int i = 0; i < map.size(); i++) {
+		if (*map.at(i) % 2 == 0) {
+			map.remove(*map.getKey(i));
+			i--;
+		}
+	}
+	EXPECT_EQ((int)names.size() / 2, map.size());
+
+	for (int i = 0; i < (int)names.size(); i++) {
+		int *value = map[names[i]];
+		if (i % 2 == 0) {
+			EXPECT_TRUE(value == NULL);
+		}
+		else {
+			ASSERT_TRUE(value != NULL);
+			EXPECT_EQ(i, *value);
+		}
+	}
+
+	map.clear();
+	EXPECT_EQ(0, map.size());
+	EXPECT_TRUE(map[names[1]] == NULL);
+}
+
+TEST(container, MapPointers)
+{
+	CTR_Map<CTR_HashedPtr, int> map;
+	std::vector<int> values(10000);
+
+	for (int i = 0; i < (int)values.size(); i++)
+		map.insert(CTR_HashedPtr(&values[i]), i);
+	for (int i = 0; i < (int)values.size(); i += 3)
+		map.remove(CTR_HashedPtr(&values[i]));
+
+	CTR_Map<CTR_HashedPtr, int> copy(map);
+	for (int i = 0; i < (int)values.size(); i++) {
+		int *value = copy[CTR_HashedPtr(&values[i])];
+		if (i % 3 == 0) {
+			EXPECT_TRUE(value == NULL);
+		}
+		else {
+			ASSERT_TRUE(value != NULL);
+			EXPECT_EQ(i, *value);
+		}
+	}
+	EXPECT_EQ(map.size(), copy.size());
+
+	for (int i = 0; i < copy.size(); i++)
+		EXPECT_EQ(copy.at(i), copy[*copy.getKey(i)]);
+}
@@ -0,0 +1,299 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "EXP_CompiledExpr.h"
+#include "EXP_InputParser.h"
+#include "EXP_BoolValue.h"
+#include "EXP_FloatValue.h"
+#include "EXP_IntValue.h"
+#include "EXP_StringValue.h"
+
+/* The bytecode of an expression must give what the expression tree calculates,
+ * or fail so that its owner calculates the tree instead */
+
+/* holds the properties the identifiers are read from, like a game object */
+class TestContext : public CValue
+{
+	STR_String m_name;
+
+public:
+	TestContext()
+		:m_name("context")
+	{
+	}
+
+	virtual CValue *Calc(VALUE_OPERATOR op, CValue *val) { return NULL; }
+	virtual CValue *CalcFinal(VALUE_DATA_TYPE dtype, VALUE_OPERATOR op, CValue *val) { return NULL; }
+	virtual const STR_String &GetText() { return m_name; }
+	virtual double GetNumber() { return 0.0; }
+	virtual STR_String &GetName() { return m_name; }
+	virtual void SetName(const char *name) { m_name = name; }
+	virtual CValue *GetReplica() { return NULL; }
+};
+
+static void set_property(CValue *context, const char *name, CValue *value)
+{
+	context->SetProperty(name, value);
+	value->Release();
+}
+
+static TestContext *make_context()
+{
+	TestContext *context = new TestContext();
+	set_property(context, "i", new CIntValue(7));
+	set_property(context, "zero", new CIntValue(0));
+	set_property(context, "f", new CFloatValue(2.5f));
+	set_property(context, "b", new CBoolValue(true));
+	set_property(context, "s", new CStringValue("abc", "s"));
+	return context;
+}
+
+static CExpression *parse(CValue *context, const char *text)
+{
+	CParser parser;
+	parser.SetContext(context->AddRef());
+	return parser.ProcessText(text);
+}
+
+/* What SCA_ExpressionController::BindIdentifiers() does for the properties */
+static void bind(CCompiledExpr& program, CValue *context)
+{
+	for (int i = 0; i < program.GetIdentifierCount(); i++)
+		program.SetIdentifier(i, context->GetProperty(program.GetIdentifierName(i)));
+}
+
+/* The number of the result of the expression tree, false for an error */
+static bool calculate(CExpression *expr, double& number)
+{
+	CValue *value = expr->Calculate();
+	const bool ok = (value && !value->IsError());
+
+	if (ok)
+		number = value->GetNumber();
+	if (value)
+		value->Release();
+	return ok;
+}
+
+static void expect_same(CValue *context, const char *text)
+{
+	SCOPED_TRACE(text);
+
+	CExpression *expr = parse(context, text);
+	ASSERT_TRUE(expr != NULL);
+
+	CCompiledExpr program;
+	ASSERT_TRUE(program.Compile(expr));
+	bind(program, context);
+
+	double tree, compiled;
+	ASSERT_TRUE(calculate(expr, tree));
+	ASSERT_TRUE(program.Evaluate(compiled));
+	EXPECT_EQ((float)tree, (float)compiled);
+
+	expr->Release();
+}
+
+/* compiled, but left to the expression tree when evaluated */
+static void expect_fallback(CValue *context, const char *text)
+{
+	SCOPED_TRACE(text);
+
+	CExpression *expr = parse(context, text);
+	ASSERT_TRUE(expr != NULL);
+
+	CCompiledExpr program;
+	ASSERT_TRUE(program.Compile(expr));
+	bind(program, context);
+
+	double compiled;
+	EXPECT_FALSE(program.Evaluate(compiled));
+
+	expr->Release();
+}
+
+TEST(expressions, CompiledArithmetic)
+{
+	TestContext *context = make_context();
+
+	expect_same(context, "i + 3");
+	expect_same(context, "i - 10");
+	expect_same(context, "i * 3");
+	expect_same(context, "i / 2");
+	expect_same(context, "i % 4");
+	expect_same(context, "-i");
+	expect_same(context, "f * 2");
+	expect_same(context, "f / 0.5");
+	expect_same(context, "i + f");
+	expect_same(context, "f - i");
+	expect_same(context, "i / f");
+	expect_same(context, "f % 2");
+	expect_same(context, "-f + 1.25");
+	expect_same(context, "(i + 1) * (f - 0.5)");
+	expect_same(context, "2 + 3 * 4");
+	expect_same(context, "s");
+	expect_same(context, "b");
+
+	context->Release();
+}
+
+TEST(expressions, CompiledComparisons)
+{
+	TestContext *context = make_context();
+
+	expect_same(context, "i > 5");
+	expect_same(context, "i < 5");
+	expect_same(context, "i >= 7");
+	expect_same(context, "i <= 6");
+	expect_same(context, "i == 7");
+	expect_same(context, "i != 7");
+	expect_same(context, "f > 2");
+	expect_same(context, "i == 7.0");
+	expect_same(context, "f <= i");
+	expect_same(context, "b == TRUE");
+	expect_same(context, "b != TRUE");
+	expect_same(context, "s == \"abc\"");
+	expect_same(context, "s != \"abc\"");
+	expect_same(context, "s < \"abd\"");
+	expect_same(context, "s > \"abd\"");
+
+	context->Release();
+}
+
+TEST(expressions, CompiledLogic)
+{
+	TestContext *context = make_context();
+
+	expect_same(context, "b AND i > 5");
+	expect_same(context, "b && i < 5");
+	expect_same(context, "NOT b OR f > 2.0");
+	expect_same(context, "!b || FALSE");
+	expect_same(context, "NOT (i == 7)");
+	expect_same(context, "NOT b");
+	expect_same(context, "NOT zero");
+	expect_same(context, "NOT f");
+	expect_same(context, "i > 5 AND f < 3 AND s == \"abc\"");
+	expect_same(context, "IF(b, i, f)");
+	expect_same(context, "IF(NOT b, i, f)");
+	expect_same(context, "IF(i > 10, 1, 2)");
+	expect_same(context, "IF(i > 5, IF(f > 3, 1, 2), 3)");
+	expect_same(context, "IF(b, 1.5, 2) + 1");
+	expect_same(context, "IF(b, s == \"abc\", FALSE)");
+
+	context->Release();
+}
+
+TEST(expressions, CompiledFallbacks)
+{
+	TestContext *context = make_context();
+
+	/* division by zero */
+	expect_fallback(context, "i / 0");
+	expect_fallback(context, "i / zero");
+	expect_fallback(context, "i % zero");
+	expect_fallback(context, "f / 0.0");
+	expect_fallback(context, "f / zero");
+
+	/* type mismatch */
+	expect_fallback(context, "i + s");
+	expect_fallback(context, "s - 1");
+	expect_fallback(context, "b + 1");
+	expect_fallback(context, "b > FALSE");
+	expect_fallback(context, "b AND i");
+	expect_fallback(context, "-b");
+	expect_fallback(context, "-s");
+	expect_fallback(context, "IF(i, 1, 2)");
+
+	/* concatenation */
+	expect_fallback(context, "s + \"def\"");
+	expect_fallback(context, "IF(b, s + s, s) == \"abcabc\"");
+
+	/* the identifier is no property */
+	expect_fallback(context, "missing + 1");
+
+	/* the tree gives the same errors and strings as before */
+	double number;
+	CExpression *expr = parse(context, "i / zero");
+	EXPECT_FALSE(calculate(expr, number));
+	expr->Release();
+
+	expr = parse(context, "s + \"def\"");
+	CValue *value = expr->Calculate();
+	EXPECT_EQ(VALUE_STRING_TYPE, value->GetValueType());
+	EXPECT_STREQ("abcdef", value->GetText().ReadPtr());
+	value->Release();
+	expr->Release();
+
+	/* an IF without else has an empty value, it isn't compiled */
+	expr = parse(context, "IF(b, 1)");
+	CCompiledExpr program;
+	EXPECT_FALSE(program.Compile(expr));
+	expr->Release();
+
+	context->Release();
+}
+
+TEST(expressions, CompiledRebinding)
+{
+	TestContext *context = make_context();
+	set_property(context, "health", new CIntValue(20));
+
+	CExpression *expr = parse(context, "health > 10 AND b");
+	CCompiledExpr program;
+	ASSERT_TRUE(program.Compile(expr));
+	ASSERT_EQ(2, program.GetIdentifierCount());
+	bind(program, context);
+
+	double tree, compiled;
+	ASSERT_TRUE(program.Evaluate(compiled));
+	EXPECT_EQ(1.0, compiled);
+
+	/* a value changed in place is read again without binding */
+	CValue *health = context->GetProperty("health");
+	CIntValue *lower = new CIntValue(5);
+	health->SetValue(lower);
+	lower->Release();
+	ASSERT_TRUE(program.Evaluate(compiled));
+	EXPECT_EQ(0.0, compiled);
+
+	/* removing the property changes the generation, the next binding
+	 * finds no value and the tree gives the error */
+	unsigned int generation = context->GetPropertyGeneration();
+	EXPECT_TRUE(context->RemoveProperty("health"));
+	EXPECT_NE(generation, context->GetPropertyGeneration());
+	bind(program, context);
+	EXPECT_FALSE(program.Evaluate(compiled));
+	EXPECT_FALSE(calculate(expr, tree));
+
+	/* adding it again, of another type */
+	generation = context->GetPropertyGeneration();
+	set_property(context, "health", new CFloatValue(12.5f));
+	EXPECT_NE(generation, context->GetPropertyGeneration());
+	bind(program, context);
+	ASSERT_TRUE(program.Evaluate(compiled));
+	ASSERT_TRUE(calculate(expr, tree));
+	EXPECT_EQ(1.0, compiled);
+	EXPECT_EQ(tree, compiled);
+
+	/* replaced by a value the bytecode can't compare */
+	set_property(context, "health", new CStringValue("full", "health"));
+	bind(program, context);
+	EXPECT_FALSE(program.Evaluate(compiled));
+
+	/* a property added under another name doesn't change the result */
+	set_property(context, "health", new CIntValue(30));
+	set_property(context, "armor", new CIntValue(1));
+	bind(program, context);
+	ASSERT_TRUE(program.Evaluate(compiled));
+	ASSERT_TRUE(calculate(expr, tree));
+	EXPECT_EQ(tree, compiled);
+
+	/* sensor states are booleans set by the owner */
+	program.SetIdentifier(1, false);
+	ASSERT_TRUE(program.Evaluate(compiled));
+	EXPECT_EQ(0.0, compiled);
+
+	expr->Release();
+	context->Release();
+}
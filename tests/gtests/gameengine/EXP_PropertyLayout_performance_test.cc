@@ -0,0 +1,156 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "EXP_PropertyLayout.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <map>
+#include <vector>
+
+#define NUM_PROPERTIES 12
+#define NUM_READS 10
+
+static const char *property_names[NUM_PROPERTIES] = {
+	"health", "ammo", "speed", "state", "target", "timer",
+	"score", "team", "alive", "counter", "cooldown", "mode"
+};
+
+static CPropertyLayout::Name make_name(const char *name)
+{
+	return CPropertyLayout::Name(name, strlen(name));
+}
+
+/* Properties the way CValue stored them before, copied for each replica */
+struct MapObject {
+	std::map<STR_String, int *> m_properties;
+};
+
+/* Properties in slots, the layout is shared with the replicas */
+struct SlotObject {
+	CPropertyLayout *m_layout;
+	std::vector<int *> m_values;
+};
+
+static int read_map(std::vector<MapObject>& objects, int ticks)
+{
+	int sum = 0;
+	for (int t = 0; t < ticks; t++) {
+		for (size_t i = 0; i < objects.size(); i++) {
+			for (int p = 0; p < NUM_READS; p++) {
+				std::map<STR_String, int *>::iterator it = objects[i].m_properties.find(property_names[p]);
+				if (it != objects[i].m_properties.end())
+					sum += *it->second;
+			}
+		}
+	}
+	return sum;
+}
+
+/* CValue::GetProperty(const char *) */
+static int read_slots_by_name(std::vector<SlotObject>& objects, int ticks)
+{
+	int sum = 0;
+	for (int t = 0; t < ticks; t++) {
+		for (size_t i = 0; i < objects.size(); i++) {
+			for (int p = 0; p < NUM_READS; p++) {
+				const int slot = objects[i].m_layout->FindSlot(make_name(property_names[p]));
+				if (slot >= 0 && objects[i].m_values[slot])
+					sum += *objects[i].m_values[slot];
+			}
+		}
+	}
+	return sum;
+}
+
+/* CValue::GetProperty(CPropertyKey&), the slots are looked up again when the layout changes */
+static int read_slots_by_key(std::vector<SlotObject>& objects, int ticks)
+{
+	unsigned int layout_ids[NUM_READS] = {0};
+	int slots[NUM_READS];
+	int sum = 0;
+
+	for (int t = 0; t < ticks; t++) {
+		for (size_t i = 0; i < objects.size(); i++) {
+			const CPropertyLayout *layout = objects[i].m_layout;
+			for (int p = 0; p < NUM_READS; p++) {
+				if (layout_ids[p] != layout->GetId()) {
+					slots[p] = layout->FindSlot(make_name(property_names[p]));
+					layout_ids[p] = layout->GetId();
+				}
+				if (slots[p] >= 0 && objects[i].m_values[slots[p]])
+					sum += *objects[i].m_values[slots[p]];
+			}
+		}
+	}
+	return sum;
+}
+
+static void properties_test(int num, int ticks)
+{
+	int values[NUM_PROPERTIES];
+	MapObject map_template;
+	SlotObject slot_template;
+	std::vector<MapObject> map_objects;
+	std::vector<SlotObject> slot_objects;
+	int sum_map, sum_name, sum_key;
+
+	slot_template.m_layout = new CPropertyLayout();
+	for (int p = 0; p < NUM_PROPERTIES; p++) {
+		values[p] = p;
+		map_template.m_properties[property_names[p]] = &values[p];
+		CPropertyLayout::AddSlot(slot_template.m_layout, make_name(property_names[p]));
+		slot_template.m_values.push_back(&values[p]);
+	}
+
+	printf("\n========== %d objects, %d property reads, %d ticks ==========\n", num, NUM_READS, ticks);
+
+	{
+		TIMEIT_START(map_replicate);
+		map_objects.resize(num, map_template);
+		TIMEIT_END(map_replicate);
+	}
+	{
+		TIMEIT_START(slots_replicate);
+		slot_objects.resize(num);
+		for (int i = 0; i < num; i++) {
+			slot_objects[i].m_layout = slot_template.m_layout->AddRef();
+			slot_objects[i].m_values = slot_template.m_values;
+		}
+		TIMEIT_END(slots_replicate);
+	}
+
+	{
+		TIMEIT_START(map_read);
+		sum_map = read_map(map_objects, ticks);
+		TIMEIT_END(map_read);
+	}
+	{
+		TIMEIT_START(slots_read_name);
+		sum_name = read_slots_by_name(slot_objects, ticks);
+		TIMEIT_END(slots_read_name);
+	}
+	{
+		TIMEIT_START(slots_read_key);
+		sum_key = read_slots_by_key(slot_objects, ticks);
+		TIMEIT_END(slots_read_key);
+	}
+
+	const int expected = num * ticks * (NUM_READS * (NUM_READS - 1) / 2);
+	EXPECT_EQ(expected, sum_map);
+	EXPECT_EQ(expected, sum_name);
+	EXPECT_EQ(expected, sum_key);
+
+	for (int i = 0; i < num; i++)
+		slot_objects[i].m_layout->Release();
+	slot_template.m_layout->Release();
+}
+
+TEST(expressions, PropertyReads10k)
+{
+	properties_test(10000, 60);
+}
@@ -0,0 +1,139 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "EXP_PropertyLayout.h"
+#include "EXP_IntValue.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_string.h"
+}
+
+#define NUM_PROPERTIES 12
+
+static const char *property_names[NUM_PROPERTIES] = {
+	"health", "ammo", "speed", "state", "target", "timer",
+	"score", "team", "alive", "counter", "cooldown", "mode"
+};
+
+static CPropertyLayout::Name make_name(const char *name)
+{
+	return CPropertyLayout::Name(name, strlen(name));
+}
+
+TEST(expressions, PropertyLayoutDerived)
+{
+	CPropertyLayout *template_layout = new CPropertyLayout();
+	for (int p = 0; p < NUM_PROPERTIES; p++)
+		EXPECT_EQ(p, CPropertyLayout::AddSlot(template_layout, make_name(property_names[p])));
+
+	/* "mode" comes before "score" */
+	EXPECT_EQ(11, template_layout->GetSortedSlot(5));
+	EXPECT_EQ(6, template_layout->GetSortedSlot(6));
+
+	/* two replicas adding the same name share the derived layout */
+	CPropertyLayout *first = template_layout->AddRef();
+	CPropertyLayout *second = template_layout->AddRef();
+	EXPECT_EQ(NUM_PROPERTIES, CPropertyLayout::AddSlot(first, make_name("::timebomb")));
+	EXPECT_EQ(NUM_PROPERTIES, CPropertyLayout::AddSlot(second, make_name("::timebomb")));
+	EXPECT_TRUE(first != template_layout);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(-1, template_layout->FindSlot(make_name("::timebomb")));
+	EXPECT_EQ(NUM_PROPERTIES, first->FindSlot(make_name("::timebomb")));
+	EXPECT_EQ(3, first->FindSlot(make_name("state")));
+	EXPECT_EQ(NUM_PROPERTIES, first->GetSortedSlot(0));
+	EXPECT_STREQ("::timebomb", first->GetSlotName(first->GetSortedSlot(0)).ReadPtr());
+
+	/* a layout used by one value only is changed in place, with a new id */
+	CPropertyLayout *single = new CPropertyLayout();
+	CPropertyLayout *before = single;
+	const unsigned int id = single->GetId();
+	CPropertyLayout::AddSlot(single, make_name("health"));
+	EXPECT_EQ(before, single);
+	EXPECT_NE(id, single->GetId());
+
+	single->Release();
+	first->Release();
+	second->Release();
+	template_layout->Release();
+}
+
+TEST(expressions, PropertyLayoutChain)
+{
+	char name[32];
+
+	CPropertyLayout *template_layout = new CPropertyLayout();
+	for (int p = 0; p < NUM_PROPERTIES; p++)
+		CPropertyLayout::AddSlot(template_layout, make_name(property_names[p]));
+
+	/* a replica adding many names: the derived layout leaves the template once the
+	 * replica is its only user, then it takes the next names in place */
+	CPropertyLayout *replica = template_layout->AddRef();
+	CPropertyLayout *chain = NULL;
+	for (int i = 0; i < 100; i++) {
+		BLI_snprintf(name, sizeof(name), "added.%d", i);
+		EXPECT_EQ(NUM_PROPERTIES + i, CPropertyLayout::AddSlot(replica, make_name(name)));
+		if (i == 1) {
+			chain = replica;
+		}
+		else if (i > 1) {
+			EXPECT_EQ(chain, replica);
+		}
+	}
+	EXPECT_EQ(NUM_PROPERTIES + 100, replica->GetSlotCount());
+	EXPECT_EQ(NUM_PROPERTIES, template_layout->GetSlotCount());
+
+	/* the next replica adding the first name doesn't get the names of the chain */
+	CPropertyLayout *other = template_layout->AddRef();
+	EXPECT_EQ(NUM_PROPERTIES, CPropertyLayout::AddSlot(other, make_name("added.0")));
+	EXPECT_EQ(NUM_PROPERTIES + 1, other->GetSlotCount());
+	EXPECT_EQ(-1, other->FindSlot(make_name("added.1")));
+
+	/* a derived layout outlives the template */
+	template_layout->Release();
+	EXPECT_EQ(NUM_PROPERTIES + 1, CPropertyLayout::AddSlot(other, make_name("added.1")));
+	EXPECT_EQ(3, other->FindSlot(make_name("state")));
+
+	other->Release();
+	replica->Release();
+}
+
+TEST(expressions, PropertyKey)
+{
+	CValue *first = new CIntValue(0);
+	CValue *second = new CIntValue(0);
+	CPropertyKey key("speed");
+
+	for (int p = 0; p < NUM_PROPERTIES; p++) {
+		CValue *value = new CIntValue(p);
+		first->SetProperty(property_names[p], value);
+		second->SetProperty(property_names[p], value);
+		value->Release();
+	}
+
+	/* the replicas share the layout of their object, the slot found in one is used in the other */
+	EXPECT_EQ(first->GetProperty("speed"), first->GetProperty(key));
+	CValue *replica = first->GetReplica();
+	EXPECT_EQ(replica->GetProperty("speed"), replica->GetProperty(key));
+	EXPECT_EQ(2.0, replica->GetProperty(key)->GetNumber());
+
+	/* a layout built in another order */
+	CValue *other = new CIntValue(0);
+	CValue *value = new CIntValue(7);
+	other->SetProperty("mode", value);
+	other->SetProperty("speed", value);
+	value->Release();
+	EXPECT_EQ(7.0, other->GetProperty(key)->GetNumber());
+	EXPECT_EQ(2.0, second->GetProperty(key)->GetNumber());
+
+	/* a removed property keeps its slot, without value */
+	EXPECT_TRUE(other->RemoveProperty("speed"));
+	EXPECT_TRUE(other->GetProperty(key) == NULL);
+	EXPECT_TRUE(second->GetProperty(key) == second->GetProperty("speed"));
+
+	other->Release();
+	replica->Release();
+	second->Release();
+	first->Release();
+}
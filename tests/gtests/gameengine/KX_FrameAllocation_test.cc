@@ -0,0 +1,211 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Node.h"
+#include "SG_ParentRelation.h"
+
+#include "MEM_guardedalloc.h"
+
+#include <new>
+#include <stdlib.h>
+#include <vector>
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+#include "atomic_ops.h"
+}
+
+#define NUM_ROOTS 50
+#define NUM_CHILDREN 20
+#define NUM_WARMUP_FRAMES 10
+#define NUM_FRAMES 200
+
+/* The C++ allocations of the whole test binary, the C ones go through guardedalloc
+ * and are counted by MEM_get_memory_blocks_allocated(), also while the engine is
+ * built without WITH_CXX_GUARDEDALLOC */
+static size_t num_new = 0;
+
+void *operator new(size_t size) throw(std::bad_alloc)
+{
+	atomic_add_z(&num_new, 1);
+	void *ptr = malloc(size ? size : 1);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void *operator new[](size_t size) throw(std::bad_alloc)
+{
+	return operator new(size);
+}
+
+void operator delete(void *ptr) throw()
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) throw()
+{
+	free(ptr);
+}
+
+static size_t num_allocations()
+{
+	return atomic_add_z(&num_new, 0) + MEM_get_memory_blocks_allocated();
+}
+
+/* Same as KX_NormalParentRelation, which lives in the engine */
+class TestParentRelation : public SG_ParentRelation
+{
+public:
+	TestParentRelation() {}
+
+	virtual bool UpdateChildCoordinates(SG_Spatial *child, const SG_Spatial *parent, bool& parentUpdated)
+	{
+		if (!parentUpdated && !child->IsModified())
+			return false;
+
+		parentUpdated = true;
+
+		if (parent == NULL) {
+			child->SetWorldFromLocalTransform();
+		}
+		else {
+			const MT_Vector3& p_world_scale = parent->GetWorldScaling();
+			const MT_Point3& p_world_pos = parent->GetWorldPosition();
+			const MT_Matrix3x3& p_world_rotation = parent->GetWorldOrientation();
+
+			child->SetWorldScale(p_world_scale * child->GetLocalScale());
+			child->SetWorldOrientation(p_world_rotation * child->GetLocalOrientation());
+			child->SetWorldPosition(p_world_pos + p_world_scale * (p_world_rotation * child->GetLocalPosition()));
+		}
+		child->ClearModified();
+		return true;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestParentRelation();
+	}
+};
+
+static bool test_schedule(SG_IObject *node, void *, void *clientinfo)
+{
+	return ((SG_Node *)node)->Schedule(*(SG_QList *)clientinfo);
+}
+
+/* What KX_Scene::UpdateAnimations() runs for each animated object */
+struct AnimatedObject {
+	SG_Node *m_node;
+	MT_Matrix3x3 m_orientation;
+	double m_frame;
+};
+
+static void animate_task(TaskPool *__restrict pool, void *taskdata, int UNUSED(threadid))
+{
+	AnimatedObject *object = (AnimatedObject *)taskdata;
+	const double time = *(double *)BLI_task_pool_userdata(pool);
+
+	object->m_frame = time * 60.0;
+	object->m_orientation.setEuler(MT_Vector3(0.0, 0.0, time));
+}
+
+/* The passes of a logic frame that run each frame on the same objects: the
+ * animations in a task pool kept by the scene, then the scene graph update of
+ * KX_Scene::UpdateParents() */
+TEST(frame_allocation, AnimationsAndSceneGraph)
+{
+	SG_QList head;
+	SG_Callbacks callbacks(NULL, NULL, NULL, test_schedule, NULL);
+	std::vector<SG_Node *> nodes;
+	std::vector<AnimatedObject> objects(NUM_ROOTS);
+	double time = 0.0;
+
+	BLI_threadapi_init();
+	TaskScheduler *scheduler = BLI_task_scheduler_create(4);
+	TaskPool *pool = BLI_task_pool_create(scheduler, &time);
+
+	for (int i = 0; i < NUM_ROOTS; i++) {
+		SG_Node *root = new SG_Node(NULL, &head, callbacks);
+		root->SetParentRelation(new TestParentRelation());
+		nodes.push_back(root);
+		objects[i].m_node = root;
+
+		for (int c = 0; c < NUM_CHILDREN; c++) {
+			SG_Node *child = new SG_Node(NULL, &head, callbacks);
+			child->SetParentRelation(new TestParentRelation());
+			child->SetLocalPosition(MT_Point3(0.0, c + 1.0, 0.0));
+			root->AddChild(child);
+			nodes.push_back(child);
+		}
+	}
+
+	size_t start = 0;
+	for (int frame = 0; frame < NUM_WARMUP_FRAMES + NUM_FRAMES; frame++) {
+		if (frame == NUM_WARMUP_FRAMES)
+			start = num_allocations();
+
+		time = frame / 60.0;
+
+		BLI_task_pool_reuse_tasks(pool, NUM_ROOTS);
+		for (int i = 0; i < NUM_ROOTS; i++)
+			BLI_task_pool_push(pool, animate_task, &objects[i], false, TASK_PRIORITY_LOW);
+		BLI_task_pool_work_and_wait(pool);
+
+		/* the transforms are applied after the tasks, scheduling the nodes isn't thread safe */
+		for (int i = 0; i < NUM_ROOTS; i++)
+			objects[i].m_node->SetLocalOrientation(objects[i].m_orientation);
+
+		SG_Node *node;
+		while ((node = SG_Node::GetNextScheduled(head)) != NULL)
+			node->UpdateWorldData(time);
+	}
+
+	EXPECT_EQ((size_t)0, num_allocations() - start);
+	EXPECT_TRUE(head.Empty());
+	EXPECT_NEAR((NUM_WARMUP_FRAMES + NUM_FRAMES - 1), objects[0].m_frame, 1e-9);
+
+	BLI_task_pool_free(pool);
+	BLI_task_scheduler_free(scheduler);
+	BLI_threadapi_exit();
+
+	for (size_t i = 0; i < nodes.size(); i++) {
+		nodes[i]->Delink();
+		delete nodes[i];
+	}
+}
+
+static void empty_task(TaskPool *__restrict UNUSED(pool), void *UNUSED(taskdata), int UNUSED(threadid))
+{
+}
+
+/* The pools of Blender free their tasks, the ones reusing them keep no more than asked */
+TEST(frame_allocation, TaskPoolReuseLimit)
+{
+	BLI_threadapi_init();
+	TaskScheduler *scheduler = BLI_task_scheduler_create(4);
+
+	const int max_tasks[] = {0, 4, 16};
+	for (int m = 0; m < 3; m++) {
+		TaskPool *pool = BLI_task_pool_create(scheduler, NULL);
+		const unsigned int in_use = MEM_get_memory_blocks_in_use();
+
+		BLI_task_pool_reuse_tasks(pool, max_tasks[m]);
+		for (int i = 0; i < 16; i++)
+			BLI_task_pool_push(pool, empty_task, NULL, false, TASK_PRIORITY_HIGH);
+		BLI_task_pool_work_and_wait(pool);
+		EXPECT_EQ(in_use + max_tasks[m], MEM_get_memory_blocks_in_use());
+
+		BLI_task_pool_reuse_tasks(pool, 2);
+		const int kept = (max_tasks[m] < 2) ? max_tasks[m] : 2;
+		EXPECT_EQ(in_use + kept, MEM_get_memory_blocks_in_use());
+
+		BLI_task_pool_free(pool);
+	}
+
+	BLI_task_scheduler_free(scheduler);
+	BLI_threadapi_exit();
+}
@@ -0,0 +1,96 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "KX_TimerWheel.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "BLI_compiler_attrs.h"
+#include "BLI_rand.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <algorithm>
+#include <vector>
+
+struct Projectile {
+	float m_timeleft;
+	KX_TimerWheel::Timer *m_timer;
+};
+
+static KX_GameObject *as_object(Projectile *projectile)
+{
+	return (KX_GameObject *)projectile;
+}
+
+/* The temp object list KX_Scene used to scan each tick, with the removal from the list */
+static int scan_ticks(std::vector<Projectile>& projectiles, const std::vector<int>& lifetimes, int spawn, int ticks)
+{
+	std::vector<Projectile *> temp;
+	std::vector<Projectile *> expired;
+	int next = 0, removed = 0;
+
+	for (int t = 0; t < ticks; t++) {
+		expired.clear();
+		for (int i = (int)temp.size() - 1; i >= 0; i--) {
+			temp[i]->m_timeleft -= 1.0f;
+			if (temp[i]->m_timeleft <= 0.0f)
+				expired.push_back(temp[i]);
+		}
+		for (size_t i = 0; i < expired.size(); i++)
+			temp.erase(std::find(temp.begin(), temp.end(), expired[i]));
+		removed += (int)expired.size();
+
+		for (int i = 0; i < spawn; i++, next++) {
+			projectiles[next].m_timeleft = (float)lifetimes[next];
+			temp.push_back(&projectiles[next]);
+		}
+	}
+	return removed;
+}
+
+static int wheel_ticks(std::vector<Projectile>& projectiles, const std::vector<int>& lifetimes, int spawn, int ticks)
+{
+	KX_TimerWheel wheel;
+	std::vector<KX_GameObject *> expired;
+	int next = 0, removed = 0;
+
+	for (int t = 0; t < ticks; t++) {
+		expired.clear();
+		wheel.Advance(expired);
+		removed += (int)expired.size();
+
+		for (int i = 0; i < spawn; i++, next++)
+			projectiles[next].m_timer = wheel.Add(as_object(&projectiles[next]), lifetimes[next]);
+	}
+	return removed;
+}
+
+TEST(ketsji, TimerWheelProjectiles)
+{
+	const int spawn = 100, ticks = 3000;
+	std::vector<Projectile> projectiles(spawn * ticks);
+	std::vector<int> lifetimes(spawn * ticks);
+	int removed_scan, removed_wheel;
+
+	RNG *rng = BLI_rng_new(0);
+	for (size_t i = 0; i < lifetimes.size(); i++)
+		lifetimes[i] = 30 + BLI_rng_get_int(rng) % 50;
+	BLI_rng_free(rng);
+
+	printf("\n========== %d projectiles per tick, %d ticks ==========\n", spawn, ticks);
+
+	{
+		TIMEIT_START(scan);
+		removed_scan = scan_ticks(projectiles, lifetimes, spawn, ticks);
+		TIMEIT_END(scan);
+	}
+	{
+		TIMEIT_START(wheel);
+		removed_wheel = wheel_ticks(projectiles, lifetimes, spawn, ticks);
+		TIMEIT_END(wheel);
+	}
+
+	EXPECT_EQ(removed_scan, removed_wheel);
+}
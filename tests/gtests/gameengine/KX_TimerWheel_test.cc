@@ -0,0 +1,76 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "KX_TimerWheel.h"
+
+#include <algorithm>
+#include <vector>
+
+struct Projectile {
+	KX_TimerWheel::Timer *m_timer;
+};
+
+static KX_GameObject *as_object(Projectile *projectile)
+{
+	return (KX_GameObject *)projectile;
+}
+
+TEST(ketsji, TimerWheelExpiry)
+{
+	const unsigned int delays[] = {1, 2, 255, 256, 257, 1000, 16383, 16384, 16385, 70000, 1100000};
+	const int num = sizeof(delays) / sizeof(*delays);
+	Projectile projectiles[num];
+	KX_TimerWheel wheel;
+	std::vector<KX_GameObject *> expired;
+
+	/* start away from tick 0 so the wheels are not aligned */
+	for (int t = 0; t < 1000; t++)
+		wheel.Advance(expired);
+
+	for (int i = 0; i < num; i++)
+		projectiles[i].m_timer = wheel.Add(as_object(&projectiles[i]), delays[i]);
+	EXPECT_EQ(num, wheel.GetCount());
+	EXPECT_EQ(70000, wheel.GetRemaining(projectiles[9].m_timer));
+
+	/* cancelled timers don't expire */
+	wheel.Remove(projectiles[3].m_timer);
+
+	for (unsigned int t = 1; t <= delays[num - 1]; t++) {
+		expired.clear();
+		wheel.Advance(expired);
+		for (int i = 0; i < num; i++) {
+			const bool expected = (delays[i] == t && i != 3);
+			const bool found = std::find(expired.begin(), expired.end(), as_object(&projectiles[i])) != expired.end();
+			if (found != expected) {
+				ADD_FAILURE() << "timer " << delays[i] << " at tick " << t;
+			}
+		}
+	}
+	EXPECT_EQ(0, wheel.GetCount());
+}
+
+TEST(ketsji, TimerWheelMerge)
+{
+	Projectile projectiles[2];
+	KX_TimerWheel wheel, other;
+	std::vector<KX_GameObject *> expired;
+
+	for (int t = 0; t < 300; t++)
+		other.Advance(expired);
+
+	projectiles[0].m_timer = wheel.Add(as_object(&projectiles[0]), 10);
+	projectiles[1].m_timer = other.Add(as_object(&projectiles[1]), 500);
+	wheel.Merge(other);
+
+	EXPECT_EQ(2, wheel.GetCount());
+	EXPECT_EQ(0, other.GetCount());
+	EXPECT_EQ(500, wheel.GetRemaining(projectiles[1].m_timer));
+
+	for (int t = 0; t < 499; t++)
+		wheel.Advance(expired);
+	EXPECT_EQ(1, expired.size());
+	wheel.Advance(expired);
+	ASSERT_EQ(2, expired.size());
+	EXPECT_EQ(as_object(&projectiles[1]), expired[1]);
+}
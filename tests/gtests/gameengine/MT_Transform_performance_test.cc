@@ -0,0 +1,186 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MT_Point3.h"
+#include "MT_Vector3.h"
+#include "MT_Vector4.h"
+#include "MT_Matrix3x3.h"
+#include "MT_Transform.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <vector>
+
+/* The transform math of the scene graph on plain MoTo arrays, without the nodes,
+ * to compare the double and the WITH_GAMEENGINE_FLOAT_MATH builds */
+
+#define NUM_NODES 100000
+#define NUM_BRANCHES 4
+#define NUM_FRAMES 100
+
+struct TestTransforms {
+	std::vector<int> m_parents;
+	std::vector<MT_Vector3> m_localScale;
+	std::vector<MT_Matrix3x3> m_localOrientation;
+	std::vector<MT_Point3> m_localPosition;
+	std::vector<MT_Vector3> m_worldScale;
+	std::vector<MT_Matrix3x3> m_worldOrientation;
+	std::vector<MT_Point3> m_worldPosition;
+};
+
+/* A tree in breadth first order, the parents come before their children */
+static void build_transforms(TestTransforms& trans, int num)
+{
+	trans.m_parents.resize(num);
+	trans.m_localScale.resize(num);
+	trans.m_localOrientation.resize(num);
+	trans.m_localPosition.resize(num);
+	trans.m_worldScale.resize(num);
+	trans.m_worldOrientation.resize(num);
+	trans.m_worldPosition.resize(num);
+
+	for (int i = 0; i < num; i++) {
+		trans.m_parents[i] = (i == 0) ? -1 : (i - 1) / NUM_BRANCHES;
+		trans.m_localScale[i] = MT_Vector3(1.0, 1.0, 1.0);
+		trans.m_localOrientation[i] = MT_Matrix3x3(MT_Vector3(0.0, 0.0, 0.01 * (i % 7)));
+		trans.m_localPosition[i] = MT_Point3(0.0, 1.0 + i % NUM_BRANCHES, 0.1);
+	}
+}
+
+/* Same as KX_NormalParentRelation::UpdateChildCoordinates() */
+static void update_world(TestTransforms& trans)
+{
+	const int num = trans.m_parents.size();
+
+	for (int i = 0; i < num; i++) {
+		const int parent = trans.m_parents[i];
+		if (parent < 0) {
+			trans.m_worldScale[i] = trans.m_localScale[i];
+			trans.m_worldOrientation[i] = trans.m_localOrientation[i];
+			trans.m_worldPosition[i] = trans.m_localPosition[i];
+		}
+		else {
+			const MT_Vector3& p_world_scale = trans.m_worldScale[parent];
+			const MT_Matrix3x3& p_world_rotation = trans.m_worldOrientation[parent];
+
+			trans.m_worldScale[i] = p_world_scale * trans.m_localScale[i];
+			trans.m_worldOrientation[i] = p_world_rotation * trans.m_localOrientation[i];
+			trans.m_worldPosition[i] = trans.m_worldPosition[parent] +
+			                           p_world_scale * (p_world_rotation * trans.m_localPosition[i]);
+		}
+	}
+}
+
+static void expect_finite(const TestTransforms& trans)
+{
+	const MT_Point3& position = trans.m_worldPosition.back();
+	EXPECT_TRUE(MT_abs(position[0]) < 1.0e10 && MT_abs(position[1]) < 1.0e10 && MT_abs(position[2]) < 1.0e10);
+}
+
+static void print_mode(const char *name)
+{
+	printf("\n========== %s, %d bytes MT_Scalar, %d nodes, %d frames ==========\n",
+	       name, (int)sizeof(MT_Scalar), NUM_NODES, NUM_FRAMES);
+}
+
+TEST(moto, ComposeWorldTransforms)
+{
+	TestTransforms trans;
+	build_transforms(trans, NUM_NODES);
+
+	print_mode("world transforms");
+
+	TIMEIT_START(compose_world);
+
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		trans.m_localPosition[0] = MT_Point3(frame * 0.01, 0.0, 0.0);
+		update_world(trans);
+	}
+
+	TIMEIT_END(compose_world);
+
+	expect_finite(trans);
+}
+
+/* Same as KX_GameObject::GetOpenGLMatrix() */
+TEST(moto, OpenGLMatrices)
+{
+	TestTransforms trans;
+	build_transforms(trans, NUM_NODES);
+	update_world(trans);
+
+	std::vector<double> matrices(NUM_NODES * 16);
+	double sum = 0.0;
+
+	print_mode("OpenGL matrices");
+
+	TIMEIT_START(opengl_matrices);
+
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		for (int i = 0; i < NUM_NODES; i++) {
+			MT_Transform t;
+			t.setOrigin(trans.m_worldPosition[i]);
+			t.setBasis(trans.m_worldOrientation[i]);
+			const MT_Vector3& scaling = trans.m_worldScale[i];
+			t.scale(scaling[0], scaling[1], scaling[2]);
+			t.getValue(&matrices[i * 16]);
+		}
+		sum += matrices[frame * 16 + 12];
+	}
+
+	TIMEIT_END(opengl_matrices);
+
+	EXPECT_EQ(1.0, matrices[15]);
+	EXPECT_TRUE(sum == sum);
+}
+
+/* The corners of a box in world space against the planes of a frustum, like the culling */
+TEST(moto, CullBoxes)
+{
+	TestTransforms trans;
+	build_transforms(trans, NUM_NODES);
+	update_world(trans);
+
+	const MT_Vector4 planes[6] = {
+		MT_Vector4(1.0, 0.0, 0.0, 5.0), MT_Vector4(-1.0, 0.0, 0.0, 5.0),
+		MT_Vector4(0.0, 1.0, 0.0, 5.0), MT_Vector4(0.0, -1.0, 0.0, 5.0),
+		MT_Vector4(0.0, 0.0, 1.0, 5.0), MT_Vector4(0.0, 0.0, -1.0, 5.0),
+	};
+	int inside = 0;
+
+	print_mode("box culling");
+
+	TIMEIT_START(cull_boxes);
+
+	for (int frame = 0; frame < NUM_FRAMES; frame++) {
+		inside = 0;
+		for (int i = 0; i < NUM_NODES; i++) {
+			const MT_Transform t(trans.m_worldPosition[i], trans.m_worldOrientation[i]);
+			MT_Point3 corners[8];
+			bool culled = false;
+
+			for (int c = 0; c < 8; c++)
+				corners[c] = t(MT_Point3((c & 1) ? 0.5 : -0.5, (c & 2) ? 0.5 : -0.5, (c & 4) ? 0.5 : -0.5));
+
+			for (int p = 0; p < 6 && !culled; p++) {
+				int outside = 0;
+				for (int c = 0; c < 8; c++) {
+					if (planes[p][0] * corners[c][0] + planes[p][1] * corners[c][1] + planes[p][2] * corners[c][2] + planes[p][3] < 0.0)
+						outside++;
+				}
+				culled = (outside == 8);
+			}
+			if (!culled)
+				inside++;
+		}
+	}
+
+	TIMEIT_END(cull_boxes);
+
+	EXPECT_LT(0, inside);
+	EXPECT_GT(NUM_NODES, inside);
+}
@@ -0,0 +1,62 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "RAS_MaterialBucket.h"
+#include "RAS_TexVert.h"
+
+#include "MT_Transform.h"
+#include "MT_Matrix3x3.h"
+
+/* A batch bakes the slot transform in its vertices, they must match what the
+ * unbatched draw gets from OpenGL: the matrix for positions and its inverse
+ * transpose for normals */
+static void batch_transform_test(const MT_Matrix3x3& basis, const MT_Point3& origin)
+{
+	const float uvs[RAS_TexVert::MAX_UNIT][2] = {{0.0f}};
+	const float tangent[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+	const float coords[4][3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.3f, -0.7f, 2.0f}, {-1.0f, 0.5f, 0.25f}};
+	const float normals[4][3] = {{0.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 0.6f, 0.8f}, {0.48f, -0.6f, 0.64f}};
+	RAS_TexVert src[4], dst[4];
+	double m[16];
+
+	MT_Transform(origin, basis).getValue(m);
+	ASSERT_GT(basis.determinant(), 0.0);
+
+	for (int i = 0; i < 4; i++)
+		src[i] = RAS_TexVert(coords[i], uvs, tangent, 0xFFFFFFFF, normals[i], false, i);
+
+	RAS_MaterialBucket::TransformBatchVertices(m, src, dst, 4, false);
+
+	const MT_Matrix3x3 nmat = basis.inverse().transposed();
+
+	for (int i = 0; i < 4; i++) {
+		const MT_Vector3 co = basis * MT_Vector3(coords[i]) + origin;
+		const MT_Vector3 no = (nmat * MT_Vector3(normals[i])).normalized();
+		const float *bco = dst[i].getXYZ();
+		const float *bno = dst[i].getNormal();
+
+		for (int j = 0; j < 3; j++) {
+			EXPECT_NEAR(co[j], bco[j], 1e-5);
+			EXPECT_NEAR(no[j], bno[j], 1e-5);
+		}
+	}
+}
+
+TEST(batch, TransformRotated)
+{
+	MT_Matrix3x3 basis;
+	basis.setEuler(MT_Vector3(0.3, -1.1, 2.4));
+	batch_transform_test(basis, MT_Point3(1.0, -2.0, 3.0));
+}
+
+TEST(batch, TransformRotatedNonUniformScale)
+{
+	MT_Matrix3x3 rot, scale;
+	rot.setEuler(MT_Vector3(0.7, 0.2, -0.9));
+	scale.setValue(3.0, 0.0, 0.0,
+	               0.0, 0.5, 0.0,
+	               0.0, 0.0, 1.5);
+	batch_transform_test(rot * scale, MT_Point3(0.0, 4.0, -1.0));
+	batch_transform_test(scale * rot, MT_Point3(0.0, 4.0, -1.0));
+}
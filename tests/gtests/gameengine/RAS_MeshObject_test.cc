@@ -0,0 +1,69 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "RAS_MeshObject.h"
+#include "RAS_MaterialBucket.h"
+#include "RAS_IPolygonMaterial.h"
+#include "RAS_TexVert.h"
+#include "RAS_Polygon.h"
+
+/* Triangulated grid of size x size quads, smooth shaded, with a UV seam every 'seam' columns,
+ * added the way BL_ConvertMesh does */
+static RAS_MeshObject *convert_grid(RAS_MaterialBucket *bucket, int size, int seam)
+{
+	RAS_MeshObject *meshobj = new RAS_MeshObject(NULL);
+	const int numorigverts = (size + 1) * (size + 1);
+	unsigned int corners = size * size * 6;
+	float uvs[RAS_TexVert::MAX_UNIT][2] = {{0.0f}};
+	const float tangent[4] = {1.0f, 0.0f, 0.0f, 1.0f};
+	const float normal[3] = {0.0f, 0.0f, 1.0f};
+	/* quad corners as (column, row) offsets, split in two triangles */
+	static const int tris[6][2] = {{0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1}};
+
+	meshobj->BeginConversion(numorigverts, corners);
+
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			for (int t = 0; t < 2; t++) {
+				RAS_Polygon *poly = meshobj->AddPolygon(bucket, 3, corners);
+				poly->SetVisible(true);
+
+				for (int i = 0; i < 3; i++) {
+					const int cx = x + tris[t * 3 + i][0];
+					const int cy = y + tris[t * 3 + i][1];
+					const float xyz[3] = {(float)cx, (float)cy, 0.0f};
+
+					/* the quads left of a seam end at u = 1, the ones right of it start at u = 0 */
+					uvs[0][0] = (float)(cx - (x / seam) * seam) / (float)seam;
+					uvs[0][1] = (float)cy / (float)size;
+
+					meshobj->AddVertex(poly, i, xyz, uvs, tangent, 0xFFFFFFFF, normal, false,
+					                   cy * (size + 1) + cx);
+				}
+				corners -= 3;
+			}
+		}
+	}
+
+	meshobj->EndConversion();
+	return meshobj;
+}
+
+/* The corners sharing a position, normal and UV are one vertex, the seams split them */
+TEST(rasterizer, ConvertMeshSmall)
+{
+	const int size = 64, seam = 16;
+	RAS_IPolyMaterial *polymat = new RAS_IPolyMaterial();
+	RAS_MaterialBucket *bucket = new RAS_MaterialBucket(polymat);
+
+	RAS_MeshObject *meshobj = convert_grid(bucket, size, seam);
+
+	/* each seam column has its vertices twice */
+	EXPECT_EQ(size * size * 2, meshobj->NumPolygons());
+	EXPECT_EQ((size + 1) * (size + 1) + ((size - 1) / seam) * (size + 1), meshobj->NumVertices(polymat));
+
+	delete meshobj;
+	delete bucket;
+	delete polymat;
+}
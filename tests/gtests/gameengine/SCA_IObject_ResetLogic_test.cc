@@ -0,0 +1,191 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SCA_IObject.h"
+#include "SCA_ISensor.h"
+#include "SCA_IActuator.h"
+#include "SCA_DelaySensor.h"
+#include "SCA_ANDController.h"
+
+/* A replica taken again from an object pool keeps its bricks, they must get
+ * back the state and the links of the bricks of a new replica */
+
+class TestObject : public SCA_IObject
+{
+	STR_String m_name;
+
+public:
+	TestObject(const char *name)
+		:m_name(name)
+	{
+	}
+
+	virtual CValue *Calc(VALUE_OPERATOR op, CValue *val) { return NULL; }
+	virtual CValue *CalcFinal(VALUE_DATA_TYPE dtype, VALUE_OPERATOR op, CValue *val) { return NULL; }
+	virtual const STR_String &GetText() { return m_name; }
+	virtual double GetNumber() { return 0.0; }
+	virtual STR_String &GetName() { return m_name; }
+	virtual void SetName(const char *name) { m_name = name; }
+
+	virtual CValue *GetReplica()
+	{
+		TestObject *replica = new TestObject(*this);
+		replica->ProcessReplica();
+		return replica;
+	}
+};
+
+/* counts its updates like the runtime state of an actuator */
+class TestActuator : public SCA_IActuator
+{
+public:
+	int m_numUpdates;
+
+	TestActuator(SCA_IObject *gameobj)
+		:SCA_IActuator(gameobj, KX_ACT_PROPERTY),
+		m_numUpdates(0)
+	{
+	}
+
+	virtual CValue *GetReplica()
+	{
+		TestActuator *replica = new TestActuator(*this);
+		replica->ProcessReplica();
+		return replica;
+	}
+
+	virtual bool Update()
+	{
+		m_numUpdates++;
+		return false;
+	}
+
+	virtual void ResetReplica()
+	{
+		SCA_IActuator::ResetReplica();
+		m_numUpdates = 0;
+	}
+};
+
+struct TestTemplate {
+	TestObject *m_object;
+	SCA_DelaySensor *m_sensor;
+	SCA_ANDController *m_controller;
+	TestActuator *m_actuator;
+
+	TestTemplate()
+	{
+		m_object = new TestObject("template");
+		m_sensor = new SCA_DelaySensor(NULL, m_object, 2, 0, false);
+		m_controller = new SCA_ANDController(m_object);
+		m_actuator = new TestActuator(m_object);
+
+		m_object->AddSensor(m_sensor);
+		m_object->AddController(m_controller);
+		m_object->AddActuator(m_actuator);
+		m_controller->LinkToSensor(m_sensor);
+		m_controller->LinkToActuator(m_actuator);
+		m_sensor->Release();
+		m_controller->Release();
+		m_actuator->Release();
+	}
+
+	~TestTemplate()
+	{
+		m_object->Release();
+	}
+
+	/* like KX_Scene::AddReplicaObject() */
+	TestObject *Spawn()
+	{
+		TestObject *replica = (TestObject *)m_object->GetReplica();
+		replica->ReParentLogic();
+		return replica;
+	}
+};
+
+static void expect_template_bricks(TestTemplate& temp, TestObject *replica)
+{
+	ASSERT_EQ(1, replica->GetSensors().size());
+	ASSERT_EQ(1, replica->GetControllers().size());
+	ASSERT_EQ(1, replica->GetActuators().size());
+
+	SCA_ISensor *sensor = replica->GetSensors()[0];
+	SCA_IController *controller = replica->GetControllers()[0];
+	TestActuator *actuator = (TestActuator *)replica->GetActuators()[0];
+
+	EXPECT_NE((SCA_ISensor *)temp.m_sensor, sensor);
+	EXPECT_NE((SCA_IController *)temp.m_controller, controller);
+	EXPECT_NE((SCA_IActuator *)temp.m_actuator, actuator);
+	EXPECT_EQ(replica, sensor->GetParent());
+	EXPECT_EQ(replica, controller->GetParent());
+	EXPECT_EQ(replica, actuator->GetParent());
+
+	/* the links still point to the bricks of the template, KX_Scene::ReplicateLogic() maps them */
+	ASSERT_EQ(1, controller->GetLinkedSensors().size());
+	ASSERT_EQ(1, controller->GetLinkedActuators().size());
+	EXPECT_EQ((SCA_ISensor *)temp.m_sensor, controller->GetLinkedSensors()[0]);
+	EXPECT_EQ((SCA_IActuator *)temp.m_actuator, controller->GetLinkedActuators()[0]);
+
+	EXPECT_EQ(0, actuator->m_numUpdates);
+	EXPECT_FALSE(sensor->IsActive());
+	EXPECT_TRUE(sensor->IsNoLink());
+	EXPECT_TRUE(actuator->IsNoLink());
+}
+
+/* the sensor fires once after its delay, a new one must start over */
+static void expect_new_delay(SCA_ISensor *sensor)
+{
+	EXPECT_FALSE(sensor->Evaluate());
+	EXPECT_FALSE(sensor->IsPositiveTrigger());
+	EXPECT_FALSE(sensor->Evaluate());
+	EXPECT_TRUE(sensor->Evaluate());
+	EXPECT_TRUE(sensor->IsPositiveTrigger());
+}
+
+TEST(logic, ResetLogicRespawn)
+{
+	TestTemplate temp;
+
+	/* spawn */
+	TestObject *replica = temp.Spawn();
+	expect_template_bricks(temp, replica);
+
+	/* change the runtime state of every brick */
+	SCA_ISensor *sensor = replica->GetSensors()[0];
+	TestActuator *actuator = (TestActuator *)replica->GetActuators()[0];
+	expect_new_delay(sensor);
+	sensor->SetActive(true);
+	actuator->IncLink();
+	actuator->Update();
+	actuator->Update();
+	replica->GetControllers()[0]->GetLinkedSensors().clear();
+	EXPECT_TRUE(sensor->IsPositiveTrigger());
+	EXPECT_EQ(2, actuator->m_numUpdates);
+
+	/* end, the replica is kept, and respawn */
+	SCA_IController *controller = replica->GetControllers()[0];
+	replica->ResetLogic(temp.m_object);
+	expect_template_bricks(temp, replica);
+	expect_new_delay(replica->GetSensors()[0]);
+
+	/* with the same bricks */
+	EXPECT_EQ(sensor, replica->GetSensors()[0]);
+	EXPECT_EQ(controller, replica->GetControllers()[0]);
+	EXPECT_EQ((SCA_IActuator *)actuator, replica->GetActuators()[0]);
+
+	/* the template is unchanged */
+	EXPECT_EQ(temp.m_object, temp.m_sensor->GetParent());
+	EXPECT_EQ(temp.m_object, temp.m_actuator->GetParent());
+	EXPECT_EQ(1, temp.m_controller->GetLinkedSensors().size());
+	EXPECT_EQ(0, temp.m_actuator->m_numUpdates);
+
+	/* a second life */
+	replica->GetSensors()[0]->Evaluate();
+	replica->ResetLogic(temp.m_object);
+	expect_template_bricks(temp, replica);
+	expect_new_delay(replica->GetSensors()[0]);
+
+	replica->Release();
+}
@@ -0,0 +1,354 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Node.h"
+#include "SG_FlatHierarchy.h"
+#include "SG_ParentRelation.h"
+#include "SG_TransformStore.h"
+
+extern "C" {
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+}
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+/* Same as KX_NormalParentRelation, which lives in the engine */
+class TestParentRelation : public SG_ParentRelation
+{
+public:
+	TestParentRelation() {}
+
+	virtual bool UpdateChildCoordinates(SG_Spatial *child, const SG_Spatial *parent, bool& parentUpdated)
+	{
+		if (!parentUpdated && !child->IsModified())
+			return false;
+
+		parentUpdated = true;
+
+		if (parent == NULL) {
+			child->SetWorldFromLocalTransform();
+		}
+		else {
+			const MT_Vector3& p_world_scale = parent->GetWorldScaling();
+			const MT_Point3& p_world_pos = parent->GetWorldPosition();
+			const MT_Matrix3x3& p_world_rotation = parent->GetWorldOrientation();
+
+			child->SetWorldScale(p_world_scale * child->GetLocalScale());
+			child->SetWorldOrientation(p_world_rotation * child->GetLocalOrientation());
+			child->SetWorldPosition(p_world_pos + p_world_scale * (p_world_rotation * child->GetLocalPosition()));
+		}
+		child->ClearModified();
+		return true;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestParentRelation();
+	}
+
+	virtual bool IsNormalRelation()
+	{
+		return true;
+	}
+};
+
+/* Same as KX_VertexParentRelation, updated through the relation by the flat sweep */
+class TestVertexRelation : public SG_ParentRelation
+{
+public:
+	TestVertexRelation() {}
+
+	virtual bool UpdateChildCoordinates(SG_Spatial *child, const SG_Spatial *parent, bool& parentUpdated)
+	{
+		if (!parentUpdated && !child->IsModified())
+			return false;
+
+		child->SetWorldScale(child->GetLocalScale());
+		if (parent)
+			child->SetWorldPosition(child->GetLocalPosition() + parent->GetWorldPosition());
+		else
+			child->SetWorldPosition(child->GetLocalPosition());
+		child->SetWorldOrientation(child->GetLocalOrientation());
+		child->ClearModified();
+		return true;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestVertexRelation();
+	}
+
+	virtual bool IsVertexRelation()
+	{
+		return true;
+	}
+};
+
+static bool test_schedule(SG_IObject *node, void *, void *clientinfo)
+{
+	return ((SG_Node *)node)->Schedule(*(SG_QList *)clientinfo);
+}
+
+struct TestHierarchy {
+	SG_QList m_head;
+	std::vector<SG_Node *> m_nodes;
+	std::vector<SG_Node *> m_roots;
+	/* added by spawn_roots, oldest first */
+	std::deque<SG_Node *> m_spawned;
+};
+
+/* Roots with 'branches' children each, 'depth' levels deep, every 'vertex' child has a vertex relation */
+static void build_hierarchy(TestHierarchy& hierarchy, SG_Callbacks& callbacks, int roots, int branches, int depth, int vertex)
+{
+	std::vector<SG_Node *> level, next;
+
+	for (int i = 0; i < roots; i++) {
+		SG_Node *root = new SG_Node(NULL, &hierarchy.m_head, callbacks);
+		root->SetParentRelation(new TestParentRelation());
+		root->SetLocalPosition(MT_Point3(i, 0.0, 0.0));
+		hierarchy.m_nodes.push_back(root);
+		hierarchy.m_roots.push_back(root);
+		level.push_back(root);
+	}
+
+	for (int d = 1; d < depth; d++) {
+		next.clear();
+		for (size_t i = 0; i < level.size(); i++) {
+			for (int b = 0; b < branches; b++) {
+				SG_Node *child = new SG_Node(NULL, &hierarchy.m_head, callbacks);
+				if (vertex && hierarchy.m_nodes.size() % vertex == 0)
+					child->SetParentRelation(new TestVertexRelation());
+				else
+					child->SetParentRelation(new TestParentRelation());
+				child->SetLocalPosition(MT_Point3(0.0, b + 1.0, d));
+				child->SetLocalOrientation(MT_Matrix3x3(MT_Vector3(0.0, 0.0, 0.1 * b)));
+				child->SetLocalScale(MT_Vector3(0.5, 0.5, 0.5));
+				level[i]->AddChild(child);
+				hierarchy.m_nodes.push_back(child);
+				next.push_back(child);
+			}
+		}
+		level.swap(next);
+	}
+}
+
+/* Move one root out of 'step' */
+static void move_roots(TestHierarchy& hierarchy, int frame, int step)
+{
+	for (size_t i = frame % step; i < hierarchy.m_roots.size(); i += step)
+		hierarchy.m_roots[i]->SetLocalPosition(MT_Point3(i, frame * 0.01, 0.0));
+}
+
+static void update_recursive(TestHierarchy& hierarchy)
+{
+	SG_Node *node;
+
+	while ((node = SG_Node::GetNextScheduled(hierarchy.m_head)) != NULL)
+		node->UpdateWorldData(0.0);
+}
+
+/* Return true when the arrays were built again */
+static bool update_flat(TestHierarchy& hierarchy, SG_FlatHierarchy& flat)
+{
+	const bool outdated = flat.IsOutdated();
+
+	if (outdated)
+		flat.Build(hierarchy.m_roots);
+	flat.UpdateScheduled(hierarchy.m_head, 0.0);
+	return outdated;
+}
+
+static void free_spawned(TestHierarchy& hierarchy, SG_Node *root)
+{
+	NodeList children = root->GetSGChildren();
+
+	for (NodeList::iterator it = children.begin(); it != children.end(); ++it) {
+		(*it)->Delink();
+		delete *it;
+	}
+	hierarchy.m_roots.erase(std::find(hierarchy.m_roots.begin(), hierarchy.m_roots.end(), root));
+	root->Delink();
+	delete root;
+}
+
+/* Like the objects added by an actuator every frame: 'num' roots with one child,
+ * moving and ended after 'lifetime' frames */
+static void spawn_roots(TestHierarchy& hierarchy, SG_Callbacks& callbacks, int frame, int num, int lifetime)
+{
+	for (int i = 0; i < num; i++) {
+		SG_Node *root = new SG_Node(NULL, &hierarchy.m_head, callbacks);
+		SG_Node *child = new SG_Node(NULL, &hierarchy.m_head, callbacks);
+
+		root->SetParentRelation(new TestParentRelation());
+		child->SetParentRelation(new TestParentRelation());
+		child->SetLocalPosition(MT_Point3(0.0, 0.0, 1.0));
+		root->AddChild(child);
+		hierarchy.m_roots.push_back(root);
+		hierarchy.m_spawned.push_back(root);
+	}
+
+	while (hierarchy.m_spawned.size() > (size_t)(num * lifetime)) {
+		free_spawned(hierarchy, hierarchy.m_spawned.front());
+		hierarchy.m_spawned.pop_front();
+	}
+
+	for (size_t i = 0; i < hierarchy.m_spawned.size(); i++)
+		hierarchy.m_spawned[i]->SetLocalPosition(MT_Point3(i, frame * 0.1, 0.0));
+}
+
+static void free_hierarchy(TestHierarchy& hierarchy)
+{
+	while (!hierarchy.m_spawned.empty()) {
+		free_spawned(hierarchy, hierarchy.m_spawned.front());
+		hierarchy.m_spawned.pop_front();
+	}
+	for (size_t i = 0; i < hierarchy.m_nodes.size(); i++) {
+		hierarchy.m_nodes[i]->Delink();
+		delete hierarchy.m_nodes[i];
+	}
+	hierarchy.m_nodes.clear();
+	hierarchy.m_roots.clear();
+}
+
+static void expect_same_transforms(TestHierarchy& a, TestHierarchy& b)
+{
+	ASSERT_EQ(a.m_nodes.size(), b.m_nodes.size());
+	for (size_t i = 0; i < a.m_nodes.size(); i++) {
+		EXPECT_EQ(a.m_nodes[i]->GetWorldPosition(), b.m_nodes[i]->GetWorldPosition());
+		EXPECT_EQ(a.m_nodes[i]->GetWorldScaling(), b.m_nodes[i]->GetWorldScaling());
+		EXPECT_EQ(a.m_nodes[i]->GetWorldOrientation()[0], b.m_nodes[i]->GetWorldOrientation()[0]);
+		EXPECT_EQ(a.m_nodes[i]->GetWorldOrientation()[1], b.m_nodes[i]->GetWorldOrientation()[1]);
+	}
+	ASSERT_EQ(a.m_spawned.size(), b.m_spawned.size());
+	for (size_t i = 0; i < a.m_spawned.size(); i++) {
+		EXPECT_EQ(a.m_spawned[i]->GetWorldPosition(), b.m_spawned[i]->GetWorldPosition());
+		EXPECT_EQ(a.m_spawned[i]->GetSGChildren()[0]->GetWorldPosition(),
+		          b.m_spawned[i]->GetSGChildren()[0]->GetWorldPosition());
+	}
+}
+
+static void scenegraph_update_test(int roots, int branches, int depth, int vertex, int step, int frames)
+{
+	SG_Callbacks callbacks(NULL, NULL, NULL, test_schedule, NULL);
+	TestHierarchy recursive, flat_nodes;
+	SG_FlatHierarchy flat;
+
+	build_hierarchy(recursive, callbacks, roots, branches, depth, vertex);
+	build_hierarchy(flat_nodes, callbacks, roots, branches, depth, vertex);
+
+	/* first update of everything, and the gathering of the flat arrays */
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	EXPECT_EQ(flat_nodes.m_nodes.size(), flat.GetNumNodes());
+
+	printf("\n========== %d nodes, one root out of %d moving, %d frames ==========\n",
+	       (int)flat_nodes.m_nodes.size(), step, frames);
+
+	{
+		TIMEIT_START(recursive_update);
+
+		for (int frame = 0; frame < frames; frame++) {
+			move_roots(recursive, frame, step);
+			update_recursive(recursive);
+		}
+
+		TIMEIT_END(recursive_update);
+	}
+
+	{
+		TIMEIT_START(flat_update);
+
+		for (int frame = 0; frame < frames; frame++) {
+			move_roots(flat_nodes, frame, step);
+			update_flat(flat_nodes, flat);
+		}
+
+		TIMEIT_END(flat_update);
+	}
+
+	EXPECT_TRUE(recursive.m_head.Empty());
+	EXPECT_TRUE(flat_nodes.m_head.Empty());
+	if (step == 1) {
+		EXPECT_EQ(flat_nodes.m_nodes.size(), flat.GetNumUpdated());
+	}
+	expect_same_transforms(recursive, flat_nodes);
+
+	free_hierarchy(recursive);
+	free_hierarchy(flat_nodes);
+}
+
+TEST(scenegraph, UpdateFlat13k)
+{
+	scenegraph_update_test(1000, 3, 3, 0, 1, 100);
+}
+
+TEST(scenegraph, UpdateFlatDeep10k)
+{
+	scenegraph_update_test(10, 2, 10, 0, 1, 100);
+}
+
+TEST(scenegraph, UpdateFlatSparse13k)
+{
+	scenegraph_update_test(1000, 3, 3, 0, 100, 1000);
+}
+
+TEST(scenegraph, UpdateFlatVertexParents)
+{
+	scenegraph_update_test(100, 3, 4, 7, 1, 10);
+}
+
+/* The spawned nodes don't build the arrays again */
+TEST(scenegraph, UpdateFlatSpawnEveryFrame)
+{
+	const int frames = 1000;
+	SG_Callbacks callbacks(NULL, NULL, NULL, test_schedule, NULL);
+	TestHierarchy recursive, flat_nodes;
+	SG_FlatHierarchy flat;
+
+	build_hierarchy(recursive, callbacks, 1000, 3, 3, 0);
+	build_hierarchy(flat_nodes, callbacks, 1000, 3, 3, 0);
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+
+	printf("\n========== %d nodes, all roots moving, 10 roots spawned per frame living 50 frames, %d frames ==========\n",
+	       (int)flat_nodes.m_nodes.size(), frames);
+
+	{
+		TIMEIT_START(recursive_update);
+
+		for (int frame = 0; frame < frames; frame++) {
+			spawn_roots(recursive, callbacks, frame, 10, 50);
+			move_roots(recursive, frame, 1);
+			update_recursive(recursive);
+		}
+
+		TIMEIT_END(recursive_update);
+	}
+
+	int builds = 0;
+
+	{
+		TIMEIT_START(flat_update);
+
+		for (int frame = 0; frame < frames; frame++) {
+			spawn_roots(flat_nodes, callbacks, frame, 10, 50);
+			move_roots(flat_nodes, frame, 1);
+			if (update_flat(flat_nodes, flat))
+				builds++;
+		}
+
+		TIMEIT_END(flat_update);
+	}
+
+	EXPECT_EQ(0, builds);
+	EXPECT_EQ(flat_nodes.m_nodes.size(), flat.GetNumNodes());
+	EXPECT_TRUE(flat_nodes.m_head.Empty());
+	expect_same_transforms(recursive, flat_nodes);
+
+	free_hierarchy(recursive);
+	free_hierarchy(flat_nodes);
+}
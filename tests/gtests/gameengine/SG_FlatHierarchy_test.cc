@@ -0,0 +1,279 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "SG_Node.h"
+#include "SG_FlatHierarchy.h"
+#include "SG_ParentRelation.h"
+#include "SG_TransformStore.h"
+
+#include <vector>
+
+/* Same as KX_NormalParentRelation, which lives in the engine */
+class TestParentRelation : public SG_ParentRelation
+{
+public:
+	TestParentRelation() {}
+
+	virtual bool UpdateChildCoordinates(SG_Spatial *child, const SG_Spatial *parent, bool& parentUpdated)
+	{
+		if (!parentUpdated && !child->IsModified())
+			return false;
+
+		parentUpdated = true;
+
+		if (parent == NULL) {
+			child->SetWorldFromLocalTransform();
+		}
+		else {
+			const MT_Vector3& p_world_scale = parent->GetWorldScaling();
+			const MT_Point3& p_world_pos = parent->GetWorldPosition();
+			const MT_Matrix3x3& p_world_rotation = parent->GetWorldOrientation();
+
+			child->SetWorldScale(p_world_scale * child->GetLocalScale());
+			child->SetWorldOrientation(p_world_rotation * child->GetLocalOrientation());
+			child->SetWorldPosition(p_world_pos + p_world_scale * (p_world_rotation * child->GetLocalPosition()));
+		}
+		child->ClearModified();
+		return true;
+	}
+
+	virtual SG_ParentRelation *NewCopy()
+	{
+		return new TestParentRelation();
+	}
+
+	virtual bool IsNormalRelation()
+	{
+		return true;
+	}
+};
+
+static bool test_schedule(SG_IObject *node, void *, void *clientinfo)
+{
+	return ((SG_Node *)node)->Schedule(*(SG_QList *)clientinfo);
+}
+
+struct TestHierarchy {
+	SG_QList m_head;
+	std::vector<SG_Node *> m_nodes;
+	std::vector<SG_Node *> m_roots;
+};
+
+static SG_Node *new_node(TestHierarchy& hierarchy, SG_Callbacks& callbacks, const MT_Point3& position)
+{
+	SG_Node *node = new SG_Node(NULL, &hierarchy.m_head, callbacks);
+	node->SetParentRelation(new TestParentRelation());
+	node->SetLocalPosition(position);
+	hierarchy.m_nodes.push_back(node);
+	return node;
+}
+
+/* Roots with 'branches' children each, 'depth' levels deep */
+static void build_hierarchy(TestHierarchy& hierarchy, SG_Callbacks& callbacks, int roots, int branches, int depth)
+{
+	std::vector<SG_Node *> level, next;
+
+	for (int i = 0; i < roots; i++) {
+		SG_Node *root = new_node(hierarchy, callbacks, MT_Point3(i, 0.0, 0.0));
+		hierarchy.m_roots.push_back(root);
+		level.push_back(root);
+	}
+
+	for (int d = 1; d < depth; d++) {
+		next.clear();
+		for (size_t i = 0; i < level.size(); i++) {
+			for (int b = 0; b < branches; b++) {
+				SG_Node *child = new_node(hierarchy, callbacks, MT_Point3(0.0, b + 1.0, d));
+				child->SetLocalOrientation(MT_Matrix3x3(MT_Vector3(0.0, 0.0, 0.1 * b)));
+				child->SetLocalScale(MT_Vector3(0.5, 0.5, 0.5));
+				level[i]->AddChild(child);
+				next.push_back(child);
+			}
+		}
+		level.swap(next);
+	}
+}
+
+static void update_recursive(TestHierarchy& hierarchy)
+{
+	SG_Node *node;
+
+	while ((node = SG_Node::GetNextScheduled(hierarchy.m_head)) != NULL)
+		node->UpdateWorldData(0.0);
+}
+
+static void update_flat(TestHierarchy& hierarchy, SG_FlatHierarchy& flat)
+{
+	if (flat.IsOutdated())
+		flat.Build(hierarchy.m_roots);
+	flat.UpdateScheduled(hierarchy.m_head, 0.0);
+}
+
+static void free_hierarchy(TestHierarchy& hierarchy)
+{
+	for (size_t i = 0; i < hierarchy.m_nodes.size(); i++) {
+		hierarchy.m_nodes[i]->Delink();
+		delete hierarchy.m_nodes[i];
+	}
+	hierarchy.m_nodes.clear();
+	hierarchy.m_roots.clear();
+}
+
+static void expect_same_transforms(TestHierarchy& a, TestHierarchy& b)
+{
+	ASSERT_EQ(a.m_nodes.size(), b.m_nodes.size());
+	for (size_t i = 0; i < a.m_nodes.size(); i++) {
+		EXPECT_EQ(a.m_nodes[i]->GetWorldPosition(), b.m_nodes[i]->GetWorldPosition());
+		EXPECT_EQ(a.m_nodes[i]->GetWorldScaling(), b.m_nodes[i]->GetWorldScaling());
+		EXPECT_EQ(a.m_nodes[i]->GetWorldOrientation()[0], b.m_nodes[i]->GetWorldOrientation()[0]);
+		EXPECT_EQ(a.m_nodes[i]->GetWorldOrientation()[1], b.m_nodes[i]->GetWorldOrientation()[1]);
+	}
+}
+
+TEST(scenegraph, UpdateFlatReparent)
+{
+	SG_Callbacks callbacks(NULL, NULL, NULL, test_schedule, NULL);
+	TestHierarchy recursive, flat_nodes;
+	SG_FlatHierarchy flat;
+
+	build_hierarchy(recursive, callbacks, 4, 2, 3);
+	build_hierarchy(flat_nodes, callbacks, 4, 2, 3);
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	EXPECT_FALSE(flat.IsOutdated());
+
+	/* move the first child of the first root under the last root */
+	TestHierarchy *hierarchies[2] = {&recursive, &flat_nodes};
+	for (int h = 0; h < 2; h++) {
+		SG_Node *child = hierarchies[h]->m_roots[0]->GetSGChildren()[0];
+		child->DisconnectFromParent();
+		hierarchies[h]->m_roots[3]->AddChild(child);
+		child->SetModified();
+		hierarchies[h]->m_roots[3]->SetLocalPosition(MT_Point3(10.0, 0.0, 0.0));
+	}
+	EXPECT_TRUE(flat.IsOutdated());
+
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	EXPECT_FALSE(flat.IsOutdated());
+	EXPECT_EQ(flat_nodes.m_nodes.size(), flat.GetNumNodes());
+	expect_same_transforms(recursive, flat_nodes);
+
+	/* a node the arrays don't have yet is updated after the sweep */
+	for (int h = 0; h < 2; h++)
+		new_node(*hierarchies[h], callbacks, MT_Point3(1.0, 2.0, 3.0));
+	update_recursive(recursive);
+	flat.UpdateScheduled(flat_nodes.m_head, 0.0);
+	EXPECT_TRUE(flat_nodes.m_head.Empty());
+	EXPECT_EQ(MT_Point3(1.0, 2.0, 3.0), flat_nodes.m_nodes.back()->GetWorldPosition());
+	expect_same_transforms(recursive, flat_nodes);
+
+	free_hierarchy(recursive);
+	free_hierarchy(flat_nodes);
+}
+
+/* New nodes don't outdate the arrays, they are updated after the sweep until
+ * a change of the gathered nodes gathers them */
+TEST(scenegraph, UpdateFlatSpawn)
+{
+	SG_Callbacks callbacks(NULL, NULL, NULL, test_schedule, NULL);
+	TestHierarchy recursive, flat_nodes;
+	SG_FlatHierarchy flat;
+
+	build_hierarchy(recursive, callbacks, 4, 2, 3);
+	build_hierarchy(flat_nodes, callbacks, 4, 2, 3);
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	const unsigned int gathered = flat.GetNumNodes();
+
+	/* a spawned root with a child */
+	TestHierarchy *hierarchies[2] = {&recursive, &flat_nodes};
+	for (int h = 0; h < 2; h++) {
+		SG_Node *root = new_node(*hierarchies[h], callbacks, MT_Point3(0.0, 0.0, 5.0));
+		SG_Node *child = new_node(*hierarchies[h], callbacks, MT_Point3(1.0, 0.0, 0.0));
+		root->AddChild(child);
+		hierarchies[h]->m_roots.push_back(root);
+		hierarchies[h]->m_roots[0]->SetLocalPosition(MT_Point3(0.0, 3.0, 0.0));
+	}
+	EXPECT_FALSE(flat.IsOutdated());
+
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	EXPECT_EQ(gathered, flat.GetNumNodes());
+	EXPECT_TRUE(flat_nodes.m_head.Empty());
+	EXPECT_EQ(MT_Point3(1.0, 0.0, 5.0), flat_nodes.m_nodes.back()->GetWorldPosition());
+	expect_same_transforms(recursive, flat_nodes);
+
+	/* the spawned child parented to a gathered node */
+	for (int h = 0; h < 2; h++) {
+		SG_Node *child = hierarchies[h]->m_nodes.back();
+		child->DisconnectFromParent();
+		hierarchies[h]->m_roots[1]->AddChild(child);
+		child->SetModified();
+	}
+	EXPECT_TRUE(flat.IsOutdated());
+
+	update_recursive(recursive);
+	update_flat(flat_nodes, flat);
+	EXPECT_EQ(gathered + 2, flat.GetNumNodes());
+	expect_same_transforms(recursive, flat_nodes);
+
+	/* deleting a gathered node outdates the arrays */
+	for (int h = 0; h < 2; h++) {
+		SG_Node *child = hierarchies[h]->m_nodes.back();
+		child->DisconnectFromParent();
+		delete child;
+		hierarchies[h]->m_nodes.pop_back();
+	}
+	EXPECT_TRUE(flat.IsOutdated());
+	update_flat(flat_nodes, flat);
+	EXPECT_EQ(gathered + 1, flat.GetNumNodes());
+
+	/* the arrays of another hierarchy don't change */
+	SG_FlatHierarchy other;
+	TestHierarchy other_nodes;
+	build_hierarchy(other_nodes, callbacks, 2, 2, 2);
+	update_flat(other_nodes, other);
+	flat_nodes.m_roots[0]->RemoveChild(flat_nodes.m_roots[0]->GetSGChildren()[0]);
+	EXPECT_TRUE(flat.IsOutdated());
+	EXPECT_FALSE(other.IsOutdated());
+
+	free_hierarchy(other_nodes);
+	free_hierarchy(recursive);
+	free_hierarchy(flat_nodes);
+}
+
+TEST(scenegraph, TransformStoreSlots)
+{
+	SG_Callbacks callbacks(NULL, NULL, NULL, NULL, NULL);
+	std::vector<SG_Node *> nodes;
+
+	EXPECT_EQ(0, SG_TransformStore::GetNumUsed());
+
+	for (int i = 0; i < SG_TRANSFORM_PAGE_SIZE + 1; i++) {
+		nodes.push_back(new SG_Node(NULL, NULL, callbacks));
+		nodes.back()->SetParentRelation(new TestParentRelation());
+		nodes.back()->SetLocalPosition(MT_Point3(i, 0.0, 0.0));
+	}
+	EXPECT_EQ(SG_TRANSFORM_PAGE_SIZE + 1, SG_TransformStore::GetNumUsed());
+	EXPECT_EQ(2, SG_TransformStore::GetNumPages());
+
+	/* references stay valid when the store grows */
+	const MT_Point3& position = nodes[1]->GetLocalPosition();
+	for (int i = 0; i < SG_TRANSFORM_PAGE_SIZE; i++)
+		nodes.push_back(new SG_Node(NULL, NULL, callbacks));
+	EXPECT_EQ(MT_Point3(1.0, 0.0, 0.0), position);
+	EXPECT_EQ(MT_Point3(SG_TRANSFORM_PAGE_SIZE, 0.0, 0.0), nodes[SG_TRANSFORM_PAGE_SIZE]->GetLocalPosition());
+
+	/* replicas get their own slot */
+	SG_Node *replica = new SG_Node(*nodes[5]);
+	replica->SetLocalPosition(MT_Point3(-1.0, 0.0, 0.0));
+	EXPECT_EQ(MT_Point3(5.0, 0.0, 0.0), nodes[5]->GetLocalPosition());
+	delete replica;
+
+	for (size_t i = 0; i < nodes.size(); i++)
+		delete nodes[i];
+	EXPECT_EQ(0, SG_TransformStore::GetNumUsed());
+	EXPECT_EQ(0, SG_TransformStore::GetNumPages());
+}
@@ -0,0 +1,46 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+namespace {
+
+void DoAllocatedCountChecks()
+{
+	const unsigned int start = MEM_get_memory_blocks_allocated();
+	const size_t start_size = MEM_get_memory_allocated();
+	const unsigned int start_in_use = MEM_get_memory_blocks_in_use();
+
+	int *foo = (int *) MEM_mallocN(sizeof(int) * 10, "test");
+	int *bar = (int *) MEM_callocN(sizeof(int) * 10, "test");
+	EXPECT_EQ(start + 2, MEM_get_memory_blocks_allocated());
+	EXPECT_EQ(start_size + sizeof(int) * 20, MEM_get_memory_allocated());
+
+	/* freeing doesn't change the count */
+	MEM_freeN(bar);
+	EXPECT_EQ(start + 2, MEM_get_memory_blocks_allocated());
+
+	/* a copy or a new size is a new block */
+	bar = (int *) MEM_dupallocN(foo);
+	foo = (int *) MEM_reallocN(foo, sizeof(int) * 20);
+	EXPECT_EQ(start + 4, MEM_get_memory_blocks_allocated());
+	EXPECT_EQ(start_size + sizeof(int) * 50, MEM_get_memory_allocated());
+
+	MEM_freeN(foo);
+	MEM_freeN(bar);
+	EXPECT_EQ(start_in_use, MEM_get_memory_blocks_in_use());
+}
+
+}  // namespace
+
+TEST(guardedalloc, LockfreeAllocatedCount)
+{
+	DoAllocatedCountChecks();
+}
+
+TEST(guardedalloc, GuardedAllocatedCount)
+{
+	MEM_use_guarded_allocator();
+	DoAllocatedCountChecks();
+}
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+# Apache License, Version 2.0
+
+"""
+Runs the game engine stress scenes with blenderplayer and gathers their reports.
+
+./tests/python/bge_benchmark.py -blenderplayer ./bin/blenderplayer -blender ./bin/blender \\
+    -testdir /tmp/bge_benchmark -output report.json [-baseline previous.json] [-window]
+
+The scenes are written by bge_benchmark_scenes.py when they are missing from the
+test directory. Each one runs a fixed number of logic ticks without input, see
+the "benchmark" options of blenderplayer. The player runs headless: it opens no
+window, draws nothing and needs no display, so the reports measure the logic,
+physics, animations and scene graph. With -window the frames are drawn in a
+window as well, on a machine without a display it is then run in xvfb-run when
+that is installed. The draw calls and batched mesh slots of the "render" part of
+the reports are only counted with -window, compare "crates" and "crates_batched".
+
+With a baseline report, the scenes whose mean frame time, steady state
+allocations or load time grew by more than the threshold are listed and the
+script fails. The longest frame of the streaming scene is compared as well.
+
+The load scenes are converted again with 1, 2, 4... threads up to the number of
+cores, their load times are listed by thread count.
+"""
+
+import argparse
+import json
+import os
+import shutil
+import subprocess
+import sys
+import tempfile
+
+
+SCENES = (
+    "many_objects",
+    "rigid_bodies",
+    "skinned_crowd",
+    "python_logic",
+    "spawn",
+    "spawn_pool",
+    "crates",
+    "crates_batched",
+    "libload_churn",
+    "stream",
+)
+
+# scenes whose longest frame is compared too, a hitch doesn't move the mean
+HITCH_SCENES = (
+    "stream",
+)
+
+# scenes whose conversion is measured for each thread count
+LOAD_SCENES = (
+    "load_meshes",
+)
+
+
+def write_scenes(blender, dirpath):
+    script = os.path.join(os.path.dirname(os.path.abspath(__file__)), "bge_benchmark_scenes.py")
+    command = (
+        blender,
+        "--background",
+        "-noaudio",
+        "--factory-startup",
+        "--python", script,
+        "--", dirpath,
+        )
+    subprocess.check_call(command)
+
+
+def run_scene(blenderplayer, filepath, ticks, warmup, threads=0):
+    reportpath = os.path.join(TEMP, "report.json")
+    if os.path.exists(reportpath):
+        os.remove(reportpath)
+
+    command = [
+        blenderplayer,
+        "-w", "640", "480",
+        "-g", "benchmark", "=", reportpath,
+        "-g", "benchmark_ticks", "=", str(ticks),
+        "-g", "benchmark_warmup", "=", str(warmup),
+        "-g", "threads", "=", str(threads),
+        "-g", "benchmark_window", "=", "1" if WINDOW else "0",
+        filepath,
+        ]
+    if WINDOW and not os.environ.get("DISPLAY") and shutil.which("xvfb-run"):
+        command = ["xvfb-run", "-a", "-s", "-screen 0 1024x768x24"] + command
+
+    try:
+        output = subprocess.check_output(command, stderr=subprocess.STDOUT)
+        if VERBOSE:
+            print(output.decode("utf-8"))
+    except subprocess.CalledProcessError as e:
+        if VERBOSE:
+            print(e.output.decode("utf-8"))
+        return None
+
+    if not os.path.exists(reportpath):
+        return None
+    with open(reportpath) as f:
+        return json.load(f)
+
+
+def compare(reports, baseline, threshold):
+    regressions = []
+    for name, report in sorted(reports.items()):
+        base = baseline.get("scenes", {}).get(name)
+        if not base:
+            continue
+        checks = [
+            ("frame ms", base["frame_ms"]["mean"], report["frame_ms"]["mean"]),
+            ("allocations", base["allocations"]["steady"], report["allocations"]["steady"]),
+            ]
+        if "load_ms" in base and "load_ms" in report:
+            checks.append(("load ms", base["load_ms"], report["load_ms"]))
+        if name in HITCH_SCENES:
+            checks.append(("max frame ms", base["frame_ms"]["max"], report["frame_ms"]["max"]))
+        for what, before, after in checks:
+            # a few allocations more on a scene that made none isn't a regression of 100%
+            if after > before * (1.0 + threshold) and after - before > 1.0:
+                regressions.append("%s: %s %.2f -> %.2f" % (name, what, before, after))
+    return regressions
+
+
+def thread_counts():
+    cores = os.cpu_count() or 1
+    counts = []
+    threads = 1
+    while threads < cores:
+        counts.append(threads)
+        threads *= 2
+    counts.append(cores)
+    return counts
+
+
+def run_load_scenes(blenderplayer, dirpath):
+    """The load time of each load scene by thread count, the scenes are only run for a few ticks."""
+    loads = {}
+    for name in LOAD_SCENES:
+        loads[name] = {}
+        for threads in thread_counts():
+            label = "%s, %d threads " % (name, threads)
+            print(label, "." * (32 - len(label)), end="")
+            sys.stdout.flush()
+            report = run_scene(blenderplayer, os.path.join(dirpath, name + ".blend"), 10, 0, threads)
+            if report is None:
+                print("FAIL")
+                continue
+            loads[name][threads] = report["load_ms"]
+            print("%8.3f ms load  x%.2f" % (report["load_ms"], loads[name].get(1, report["load_ms"]) / report["load_ms"]))
+    return loads
+
+
+def create_argparse():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("-blenderplayer", nargs=1, required=True)
+    parser.add_argument("-blender", nargs=1)
+    parser.add_argument("-testdir", nargs=1, required=True)
+    parser.add_argument("-output", nargs=1)
+    parser.add_argument("-baseline", nargs=1)
+    parser.add_argument("-ticks", nargs=1, type=int, default=[600])
+    parser.add_argument("-warmup", nargs=1, type=int, default=[60])
+    parser.add_argument("-threshold", nargs=1, type=float, default=[0.1])
+    parser.add_argument("-window", action="store_true")
+    return parser
+
+
+def main():
+    parser = create_argparse()
+    args = parser.parse_args()
+
+    global TEMP, VERBOSE, WINDOW
+    TEMP = tempfile.mkdtemp()
+    VERBOSE = os.environ.get("BLENDER_VERBOSE") is not None
+    WINDOW = args.window
+
+    dirpath = os.path.abspath(args.testdir[0])
+    if not all(os.path.exists(os.path.join(dirpath, name + ".blend")) for name in SCENES + LOAD_SCENES):
+        if not args.blender:
+            print("The scenes are missing from %s, pass -blender to write them." % dirpath)
+            sys.exit(1)
+        os.makedirs(dirpath, exist_ok=True)
+        write_scenes(args.blender[0], dirpath)
+
+    reports = {}
+    failed = []
+    for name in SCENES + LOAD_SCENES:
+        print(name, "." * (32 - len(name)), end="")
+        sys.stdout.flush()
+        report = run_scene(args.blenderplayer[0], os.path.join(dirpath, name + ".blend"), args.ticks[0], args.warmup[0])
+        if report is None:
+            print("FAIL")
+            failed.append(name)
+            continue
+        reports[name] = report
+        print("%8.3f ms  %8.1f allocations  %8.1f ms load" %
+              (report["frame_ms"]["mean"], report["allocations"]["steady"], report["load_ms"]))
+
+    loads = run_load_scenes(args.blenderplayer[0], dirpath)
+
+    shutil.rmtree(TEMP)
+
+    if args.output:
+        with open(args.output[0], "w") as f:
+            json.dump({"ticks": args.ticks[0], "scenes": reports, "load_by_threads": loads}, f, indent=1, sort_keys=True)
+
+    regressions = []
+    if args.baseline:
+        with open(args.baseline[0]) as f:
+            regressions = compare(reports, json.load(f), args.threshold[0])
+
+    if failed:
+        print("\nFAILED scenes:")
+        for name in failed:
+            print("   ", name)
+    if regressions:
+        print("\nREGRESSIONS:")
+        for line in regressions:
+            print("   ", line)
+
+    sys.exit(bool(failed or regressions))
+
+
+if __name__ == "__main__":
+    main()
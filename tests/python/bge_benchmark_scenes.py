@@ -0,0 +1,424 @@
+# Apache License, Version 2.0
+
+"""
+Writes the stress scenes of the game engine benchmark (see bge_benchmark.py).
+
+./blender.bin --background -noaudio --factory-startup --python tests/python/bge_benchmark_scenes.py -- /tmp/bge_benchmark
+
+Each scene is built from scratch and is driven by the "bench" text, run every
+logic tick by an always sensor of the "Driver" object. Nothing depends on the
+input or on the time of the frames, so each run does the same work.
+"""
+
+from __future__ import division, print_function
+
+import math
+import os
+import sys
+
+import bpy
+
+try:
+    long
+except NameError:
+    long = int
+
+
+# ------------------------------------------------------------------------------
+# Scene building
+
+def new_scene(name, script=None):
+    """A scene with a camera, a sun and a driver running the script, or an empty library scene without a script."""
+    bpy.ops.wm.read_factory_settings()
+    scene = bpy.context.scene
+    # the factory settings have no empty variant, their objects are removed
+    for ob in list(scene.objects):
+        scene.objects.unlink(ob)
+        bpy.data.objects.remove(ob)
+    scene.name = name
+    scene.render.engine = 'BLENDER_GAME'
+    scene.game_settings.material_mode = 'GLSL'
+    scene.game_settings.use_frame_rate = False
+
+    if script is None:
+        return scene
+
+    camera = bpy.data.objects.new("Camera", bpy.data.cameras.new("Camera"))
+    camera.location = (0.0, -60.0, 40.0)
+    camera.rotation_euler = (math.radians(55.0), 0.0, 0.0)
+    camera.data.clip_end = 500.0
+    scene.objects.link(camera)
+    scene.camera = camera
+
+    sun = bpy.data.objects.new("Sun", bpy.data.lamps.new("Sun", 'SUN'))
+    sun.rotation_euler = (math.radians(30.0), math.radians(20.0), 0.0)
+    scene.objects.link(sun)
+
+    text = bpy.data.texts.new("bench.py")
+    text.from_string(script)
+
+    driver = bpy.data.objects.new("Driver", None)
+    scene.objects.link(driver)
+    scene.objects.active = driver
+    bpy.ops.logic.sensor_add(type='ALWAYS', object=driver.name)
+    bpy.ops.logic.controller_add(type='PYTHON', object=driver.name)
+    sensor = driver.game.sensors[-1]
+    sensor.use_pulse_true_level = True
+    controller = driver.game.controllers[-1]
+    controller.mode = 'MODULE'
+    controller.module = "bench.tick"
+    sensor.link(controller)
+
+    return scene
+
+
+def indices(seq):
+    """The Python 2 build of bpy only takes longs in the sequences of indices."""
+    return [tuple(long(i) for i in item) if isinstance(item, tuple) else long(item) for item in seq]
+
+
+def cube_mesh(name, size=0.5):
+    verts = [(x * size, y * size, z * size) for x in (-1, 1) for y in (-1, 1) for z in (-1, 1)]
+    faces = [(0, 1, 3, 2), (4, 6, 7, 5), (0, 4, 5, 1), (2, 3, 7, 6), (0, 2, 6, 4), (1, 5, 7, 3)]
+    mesh = bpy.data.meshes.new(name)
+    mesh.from_pydata(verts, [], indices(faces))
+    mesh.update()
+    return mesh
+
+
+def terrain_mesh(name, size, seed):
+    """A grid of size x size quads with a uv layer, with heights of its own."""
+    verts = [(x * 0.1, y * 0.1, math.sin(x * 0.3 + seed) * math.cos(y * 0.2 + seed) * 0.5)
+             for y in range(size + 1) for x in range(size + 1)]
+    faces = [(y * (size + 1) + x, y * (size + 1) + x + 1, (y + 1) * (size + 1) + x + 1, (y + 1) * (size + 1) + x)
+             for y in range(size) for x in range(size)]
+    mesh = bpy.data.meshes.new(name)
+    mesh.from_pydata(verts, [], indices(faces))
+    mesh.uv_textures.new()
+    mesh.update()
+    return mesh
+
+
+def add_object(scene, name, data, location, layer=0):
+    ob = bpy.data.objects.new(name, data)
+    ob.location = location
+    scene.objects.link(ob)
+    ob.layers = [i == layer for i in range(20)]
+    return ob
+
+
+def grid(count, spacing):
+    side = int(math.ceil(math.sqrt(count)))
+    for i in range(count):
+        yield ((i % side - side / 2) * spacing, (i // side - side / 2) * spacing)
+
+
+def save(scene, dirpath):
+    filepath = os.path.join(dirpath, scene.name + ".blend")
+    bpy.ops.wm.save_as_mainfile(filepath=filepath, relative_remap=True)
+    print("Wrote", filepath)
+
+
+# ------------------------------------------------------------------------------
+# Stress scenes
+
+def write_many_objects(dirpath):
+    """Thousands of static objects, with the camera moving over them for the culling."""
+    scene = new_scene("many_objects", """
+import bge, math
+
+def tick(cont):
+    camera = bge.logic.getCurrentScene().active_camera
+    t = cont.owner.get("t", 0) + 1
+    cont.owner["t"] = t
+    camera.worldPosition.x = math.sin(t * 0.01) * 40.0
+""")
+    mesh = cube_mesh("Cube")
+    for i, (x, y) in enumerate(grid(4000, 2.0)):
+        add_object(scene, "Cube.%04d" % i, mesh, (x, y, 0.0))
+    save(scene, dirpath)
+
+
+def write_rigid_bodies(dirpath):
+    """Stacks of rigid bodies falling on a ground plane."""
+    scene = new_scene("rigid_bodies", """
+def tick(cont):
+    pass
+""")
+    ground = add_object(scene, "Ground", cube_mesh("Ground", 50.0), (0.0, 0.0, -50.0))
+    ground.game.physics_type = 'STATIC'
+
+    mesh = cube_mesh("Body")
+    for i, (x, y) in enumerate(grid(100, 1.5)):
+        for z in range(8):
+            ob = add_object(scene, "Body.%04d" % (i * 8 + z), mesh, (x, y, 1.0 + z * 1.2))
+            ob.game.physics_type = 'RIGID_BODY'
+            ob.game.collision_bounds_type = 'BOX'
+            ob.game.use_collision_bounds = True
+    save(scene, dirpath)
+
+
+def write_skinned_crowd(dirpath):
+    """Skinned characters playing a looping action."""
+    scene = new_scene("skinned_crowd", """
+import bge
+
+def tick(cont):
+    driver = cont.owner
+    if "started" in driver:
+        return
+    driver["started"] = True
+    for ob in bge.logic.getCurrentScene().objects:
+        if ob.name.startswith("Rig"):
+            ob.playAction("Walk", 1, 40, play_mode=bge.logic.KX_ACTION_MODE_LOOP)
+""")
+    armature = bpy.data.armatures.new("Rig")
+    rig = add_object(scene, "Rig", armature, (0.0, 0.0, 0.0))
+    scene.objects.active = rig
+    bpy.ops.object.mode_set(mode='EDIT')
+    lower = armature.edit_bones.new("Lower")
+    lower.head, lower.tail = (0.0, 0.0, 0.0), (0.0, 0.0, 1.0)
+    upper = armature.edit_bones.new("Upper")
+    upper.head, upper.tail = (0.0, 0.0, 1.0), (0.0, 0.0, 2.0)
+    upper.parent = lower
+    upper.use_connect = True
+    bpy.ops.object.mode_set(mode='OBJECT')
+
+    action = bpy.data.actions.new("Walk")
+    action.use_fake_user = True
+    fcurve = action.fcurves.new('pose.bones["Upper"].rotation_quaternion', index=0, action_group="Upper")
+    fcurve.keyframe_points.insert(1, 1.0)
+    fcurve.keyframe_points.insert(40, 1.0)
+    fcurve = action.fcurves.new('pose.bones["Upper"].rotation_quaternion', index=1, action_group="Upper")
+    for frame, value in ((1, -0.4), (20, 0.4), (40, -0.4)):
+        fcurve.keyframe_points.insert(frame, value)
+
+    # a ring of 16 vertices every 0.25 along the bones
+    verts, faces = [], []
+    rings, segments = 9, 16
+    for r in range(rings):
+        for s in range(segments):
+            angle = s * 2.0 * math.pi / segments
+            verts.append((math.cos(angle) * 0.3, math.sin(angle) * 0.3, r * 0.25))
+    for r in range(rings - 1):
+        for s in range(segments):
+            a, b = r * segments + s, r * segments + (s + 1) % segments
+            faces.append((a, b, b + segments, a + segments))
+    mesh = bpy.data.meshes.new("Body")
+    mesh.from_pydata(verts, [], indices(faces))
+    mesh.update()
+
+    for i, (x, y) in enumerate(grid(200, 2.0)):
+        if i == 0:
+            character = rig
+            character.location = (x, y, 0.0)
+        else:
+            character = add_object(scene, "Rig.%03d" % i, armature, (x, y, 0.0))
+        body = add_object(scene, "Body.%03d" % i, mesh, (0.0, 0.0, 0.0))
+        # parented as armature deform, so that the mesh is skinned by the engine skin deformer
+        body.parent = character
+        body.parent_type = 'ARMATURE'
+        lower_group = body.vertex_groups.new("Lower")
+        upper_group = body.vertex_groups.new("Upper")
+        lower_group.add(indices(v for v in range(len(verts)) if verts[v][2] <= 1.0), 1.0, 'REPLACE')
+        upper_group.add(indices(v for v in range(len(verts)) if verts[v][2] > 1.0), 1.0, 'REPLACE')
+    save(scene, dirpath)
+
+
+def write_python_logic(dirpath):
+    """Python logic touching every object each tick: transforms, properties and rays."""
+    scene = new_scene("python_logic", """
+import bge, math
+
+def tick(cont):
+    scene = bge.logic.getCurrentScene()
+    driver = cont.owner
+    t = driver.get("t", 0) + 1
+    driver["t"] = t
+    for ob in scene.objects:
+        if not ob.name.startswith("Agent"):
+            continue
+        phase = ob.get("phase", 0.0) + 0.05
+        ob["phase"] = phase
+        ob.worldPosition.z = math.sin(phase + t * 0.02)
+        ob.applyRotation((0.0, 0.0, 0.01), True)
+        if t % 10 == 0:
+            ob.rayCastTo(driver, 100.0)
+""")
+    mesh = cube_mesh("Agent")
+    for i, (x, y) in enumerate(grid(1000, 2.0)):
+        add_object(scene, "Agent.%04d" % i, mesh, (x, y, 0.0))
+    save(scene, dirpath)
+
+
+SPAWN_SCRIPT = """
+import bge
+
+POOL_SIZE = %d
+
+def tick(cont):
+    scene = bge.logic.getCurrentScene()
+    driver = cont.owner
+    template = scene.objectsInactive["Projectile"]
+    if POOL_SIZE and "started" not in driver:
+        driver["started"] = True
+        scene.setObjectPoolSize(template, POOL_SIZE)
+    for i in range(20):
+        ob = scene.addObject(template, driver, 90)
+        ob.worldPosition = (i - 10.0, 0.0, 0.0)
+        ob.setLinearVelocity((0.0, 10.0, 5.0))
+"""
+
+
+def write_spawn(dirpath, name, pool_size):
+    """Projectiles added and ended every tick, with or without an object pool."""
+    scene = new_scene(name, SPAWN_SCRIPT % pool_size)
+    ob = add_object(scene, "Projectile", cube_mesh("Projectile", 0.2), (0.0, 0.0, 0.0), layer=1)
+    ob.game.physics_type = 'RIGID_BODY'
+    # the projectiles of consecutive ticks overlap, they only fall
+    ob.game.use_ghost = True
+
+    # the bricks of a pooled projectile are reset each time it is added again
+    scene.objects.active = ob
+    bpy.ops.object.game_property_new(type='INT', name="age")
+    bpy.ops.logic.sensor_add(type='ALWAYS', object=ob.name)
+    bpy.ops.logic.controller_add(type='LOGIC_AND', object=ob.name)
+    bpy.ops.logic.actuator_add(type='PROPERTY', object=ob.name)
+    sensor = ob.game.sensors[-1]
+    sensor.use_pulse_true_level = True
+    controller = ob.game.controllers[-1]
+    actuator = ob.game.actuators[-1]
+    actuator.mode = 'ADD'
+    actuator.property = "age"
+    actuator.value = "1"
+    sensor.link(controller)
+    actuator.link(controller)
+
+    scene.layers = [i == 0 for i in range(20)]
+    save(scene, dirpath)
+
+
+CRATES_SCRIPT = """
+import bge
+
+BATCHING = %s
+
+def tick(cont):
+    if "started" not in cont.owner:
+        cont.owner["started"] = True
+        bge.render.setMeshBatching(BATCHING)
+"""
+
+
+def write_crates(dirpath, name, batching):
+    """5000 copies of a crate sharing a mesh and a material, drawn one by one or in batches."""
+    scene = new_scene(name, CRATES_SCRIPT % batching)
+    material = bpy.data.materials.new("Crate")
+    material.diffuse_color = (0.6, 0.4, 0.2)
+    mesh = cube_mesh("Crate", 0.3)
+    mesh.materials.append(material)
+    for i, (x, y) in enumerate(grid(5000, 1.0)):
+        add_object(scene, "Crate.%04d" % i, mesh, (x, y, 0.0))
+    save(scene, dirpath)
+
+
+def write_libload(dirpath):
+    """Loading and freeing a library of objects every 30 ticks."""
+    scene = new_scene("libload_asset")
+    mesh = cube_mesh("Asset")
+    for i, (x, y) in enumerate(grid(200, 2.0)):
+        add_object(scene, "Asset.%03d" % i, mesh, (x, y, 5.0))
+    save(scene, dirpath)
+
+    scene = new_scene("libload_churn", """
+import bge
+
+def tick(cont):
+    driver = cont.owner
+    t = driver.get("t", 0) + 1
+    driver["t"] = t
+    path = bge.logic.expandPath("//libload_asset.blend")
+    if t % 30 == 1:
+        bge.logic.LibLoad(path, "Scene")
+    elif t % 30 == 0:
+        bge.logic.LibFree(path)
+""")
+    save(scene, dirpath)
+
+
+def write_stream(dirpath):
+    """Streaming 100 chunks in and out of a large world, a chunk is loaded every 6 ticks and freed 24 ticks later."""
+    for c in range(100):
+        scene = new_scene("stream_chunk.%03d" % c)
+        material = bpy.data.materials.new("Chunk.%03d" % c)
+        material.diffuse_color = (c / 100.0, 0.5, 1.0 - c / 100.0)
+        terrain = terrain_mesh("Terrain.%03d" % c, 20, c * 0.3)
+        terrain.materials.append(material)
+        ob = add_object(scene, "Terrain.%03d" % c, terrain, (0.0, 0.0, 0.0))
+        ob.game.physics_type = 'STATIC'
+        rock = cube_mesh("Rock.%03d" % c, 0.3)
+        rock.materials.append(material)
+        for i, (x, y) in enumerate(grid(30, 0.6)):
+            add_object(scene, "Rock.%03d.%02d" % (c, i), rock, (x, y, 1.0))
+        save(scene, dirpath)
+
+    scene = new_scene("stream", """
+import bge
+
+def chunk_path(n):
+    return bge.logic.expandPath("//stream_chunk.%03d.blend" % (n % 100))
+
+def tick(cont):
+    driver = cont.owner
+    t = driver.get("t", 0)
+    driver["t"] = t + 1
+    if t % 6:
+        return
+    n = t // 6
+    if n >= 4:
+        bge.logic.LibFree(chunk_path(n - 4))
+    bge.logic.LibLoad(chunk_path(n), "Scene", async=True)
+""")
+    mesh = cube_mesh("World")
+    for i, (x, y) in enumerate(grid(3000, 2.0)):
+        add_object(scene, "World.%04d" % i, mesh, (x, y, -2.0))
+    save(scene, dirpath)
+
+
+def write_load_meshes(dirpath):
+    """Unique textured meshes with triangle mesh collisions, for the time taken to convert the scene."""
+    scene = new_scene("load_meshes", """
+def tick(cont):
+    pass
+""")
+    for i, (x, y) in enumerate(grid(64, 10.0)):
+        ob = add_object(scene, "Terrain.%02d" % i, terrain_mesh("Terrain.%02d" % i, 80, i * 0.7), (x, y, 0.0))
+        ob.game.physics_type = 'STATIC'
+    save(scene, dirpath)
+
+
+def main():
+    argv = sys.argv[sys.argv.index("--") + 1:] if "--" in sys.argv else []
+    dirpath = os.path.abspath(argv[0] if argv else "bge_benchmark")
+    if not os.path.isdir(dirpath):
+        os.makedirs(dirpath)
+
+    write_many_objects(dirpath)
+    write_rigid_bodies(dirpath)
+    write_skinned_crowd(dirpath)
+    write_python_logic(dirpath)
+    write_spawn(dirpath, "spawn", 0)
+    write_spawn(dirpath, "spawn_pool", 2000)
+    write_crates(dirpath, "crates", False)
+    write_crates(dirpath, "crates_batched", True)
+    write_libload(dirpath)
+    write_stream(dirpath)
+    write_load_meshes(dirpath)
+
+    # exit from the script, the factory settings read above freed the window
+    # that Blender goes back to after the script
+    sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()